@@ -136,59 +136,83 @@ static void adjustRegionMMX(uint8_t *buf, uint8_t *end, const uint8_t *table,
 }
 #endif /* HAVE_MMX */
 
-static int adjustFilter (VideoFilter *vf, VideoFrame *frame, int field)
+static void adjustRows (ThisFilter *filter, VideoFrame *frame,
+                        int first_row, int last_row)
 {
-    (void)field;
-    ThisFilter *filter = (ThisFilter *) vf;
-    TF_VARS;
-
-    TF_START;
+    int cfirst = first_row;
+    int clast  = last_row;
+    if (frame->codec == FMT_YV12)
     {
-        unsigned char *ybeg = frame->buf + frame->offsets[0];
-        unsigned char *yend = ybeg + (frame->pitches[0] * frame->height);
-        int cheight = (frame->codec == FMT_YV12) ?
-            (frame->height >> 1) : frame->height;
-        unsigned char *ubeg = frame->buf + frame->offsets[1];
-        unsigned char *uend = ubeg + (frame->pitches[1] * cheight);
-        unsigned char *vbeg = frame->buf + frame->offsets[2];
-        unsigned char *vend = ubeg + (frame->pitches[2] * cheight);
+        cfirst >>= 1;
+        clast  >>= 1;
+    }
 
-#if HAVE_MMX
-        if (filter->yfilt)
-            adjustRegionMMX(ybeg, yend, filter->ytable,
-                            &(filter->yshift), &(filter->yscale),
-                            &(filter->ymin), mm_cpool + 1, mm_cpool + 2);
-        else
-            adjustRegion(ybeg, yend, filter->ytable);
-
-        if (filter->cfilt)
-        {
-            adjustRegionMMX(ubeg, uend, filter->ctable,
-                            &(filter->cshift), &(filter->cscale),
-                            &(filter->cmin), mm_cpool + 3, mm_cpool + 4);
-            adjustRegionMMX(vbeg, vend, filter->ctable,
-                            &(filter->cshift), &(filter->cscale),
-                            &(filter->cmin), mm_cpool + 3, mm_cpool + 4);
-        }
-        else
-        {
-            adjustRegion(ubeg, uend, filter->ctable);
-            adjustRegion(vbeg, vend, filter->ctable);
-        }
-
-        if (filter->yfilt || filter->cfilt)
-            emms();
+    unsigned char *ybeg = frame->buf + frame->offsets[0] +
+        (frame->pitches[0] * first_row);
+    unsigned char *yend = frame->buf + frame->offsets[0] +
+        (frame->pitches[0] * last_row);
+    unsigned char *ubeg = frame->buf + frame->offsets[1] +
+        (frame->pitches[1] * cfirst);
+    unsigned char *uend = frame->buf + frame->offsets[1] +
+        (frame->pitches[1] * clast);
+    unsigned char *vbeg = frame->buf + frame->offsets[2] +
+        (frame->pitches[2] * cfirst);
+    unsigned char *vend = frame->buf + frame->offsets[2] +
+        (frame->pitches[2] * clast);
 
-#else /* HAVE_MMX */
+#if HAVE_MMX
+    if (filter->yfilt)
+        adjustRegionMMX(ybeg, yend, filter->ytable,
+                        &(filter->yshift), &(filter->yscale),
+                        &(filter->ymin), mm_cpool + 1, mm_cpool + 2);
+    else
         adjustRegion(ybeg, yend, filter->ytable);
+
+    if (filter->cfilt)
+    {
+        adjustRegionMMX(ubeg, uend, filter->ctable,
+                        &(filter->cshift), &(filter->cscale),
+                        &(filter->cmin), mm_cpool + 3, mm_cpool + 4);
+        adjustRegionMMX(vbeg, vend, filter->ctable,
+                        &(filter->cshift), &(filter->cscale),
+                        &(filter->cmin), mm_cpool + 3, mm_cpool + 4);
+    }
+    else
+    {
         adjustRegion(ubeg, uend, filter->ctable);
         adjustRegion(vbeg, vend, filter->ctable);
-#endif /* HAVE_MMX */
     }
+
+    if (filter->yfilt || filter->cfilt)
+        emms();
+
+#else /* HAVE_MMX */
+    adjustRegion(ybeg, yend, filter->ytable);
+    adjustRegion(ubeg, uend, filter->ctable);
+    adjustRegion(vbeg, vend, filter->ctable);
+#endif /* HAVE_MMX */
+}
+
+static int adjustFilter (VideoFilter *vf, VideoFrame *frame, int field)
+{
+    (void)field;
+    ThisFilter *filter = (ThisFilter *) vf;
+    TF_VARS;
+
+    TF_START;
+    adjustRows(filter, frame, 0, frame->height);
     TF_END(filter, "Adjust: ");
     return 0;
 }
 
+static int adjustSlice (VideoFilter *vf, VideoFrame *frame, int field,
+                        int first_row, int last_row)
+{
+    (void)field;
+    adjustRows((ThisFilter *) vf, frame, first_row, last_row);
+    return 0;
+}
+
 static void fillTable(uint8_t *table, int in_min, int in_max, int out_min,
                 int out_max, float gamma)
 {
@@ -280,6 +304,8 @@ newAdjustFilter (VideoFrameType inpixfmt, VideoFrameType outpixfmt,
     {
         filter->vf.filter = NULL;
         filter->vf.cleanup = NULL;
+        filter->vf.prepare = NULL;
+        filter->vf.filter_slice = NULL;
         return (VideoFilter *) filter;
     }
 
@@ -297,6 +323,8 @@ newAdjustFilter (VideoFrameType inpixfmt, VideoFrameType outpixfmt,
 
     filter->vf.filter = &adjustFilter;
     filter->vf.cleanup = NULL;
+    filter->vf.prepare = NULL;
+    filter->vf.filter_slice = &adjustSlice;
     
     TF_INIT(filter);
     return (VideoFilter *) filter;
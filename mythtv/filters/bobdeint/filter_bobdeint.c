@@ -131,6 +131,8 @@ static VideoFilter *new_filter(VideoFrameType inpixfmt,
     filter->state_size = 0;
     filter->line_state = NULL;
     filter->vf.cleanup = &bobDtor;
+    filter->vf.prepare = NULL;
+    filter->vf.filter_slice = NULL;
     return (VideoFilter *)filter;
 }
 
@@ -144,6 +144,8 @@ newConvertFilter (VideoFrameType inpixfmt, VideoFrameType outpixfmt,
     else if (inpixfmt == outpixfmt)
         filter->vf.filter = NULL;
     filter->vf.cleanup = NULL;
+    filter->vf.prepare = NULL;
+    filter->vf.filter_slice = NULL;
     TF_INIT(filter);
     return (VideoFilter *) filter;
 }
@@ -282,6 +282,8 @@ static VideoFilter *new_filter(VideoFrameType inpixfmt,
     }
 
     filter->vf.cleanup = NULL;
+    filter->vf.prepare = NULL;
+    filter->vf.filter_slice = NULL;
     filter->vf.filter  = &crop;
 
 #ifdef MMX
@@ -105,6 +105,13 @@ static void denoise(uint8_t *Frame,
 
 #ifdef MMX
 
+/*
+ * There is no SSE2 version of this. The MMX code only forms the 16 bit
+ * differences; every pixel still takes a Spatial and a Temporal table
+ * lookup, which SSE2 cannot gather, and the horizontal low-pass is a serial
+ * recurrence along the line. Wider registers would only save a few of the
+ * loads and stores around the lookups.
+ */
 static void denoiseMMX(uint8_t *Frame,
                        uint8_t *FramePrev,
                        uint8_t *Line,
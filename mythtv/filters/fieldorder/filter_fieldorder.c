@@ -217,6 +217,8 @@ static VideoFilter *FieldorderDeintFilter(VideoFrameType inpixfmt,
 
     filter->vf.filter = &FieldorderDeint;
     filter->vf.cleanup = &CleanupFieldorderDeintFilter;
+    filter->vf.prepare = NULL;
+    filter->vf.filter_slice = NULL;
     return (VideoFilter *) filter;
 }
 
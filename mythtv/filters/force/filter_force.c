@@ -21,6 +21,8 @@ new_force_template (VideoFrameType inpixfmt, VideoFrameType outpixfmt,
     {
         filter->filter = NULL;
         filter->cleanup = NULL;
+        filter->prepare = NULL;
+        filter->filter_slice = NULL;
     }
 
     return filter;
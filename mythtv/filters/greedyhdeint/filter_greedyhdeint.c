@@ -34,6 +34,13 @@ static unsigned int GreedyMaxComb = MAXCOMB_DEFAULT;
 static unsigned int GreedyMotionThreshold = MOTIONTHRESHOLD_DEFAULT;
 static unsigned int GreedyMotionSense = MOTIONSENSE_DEFAULT;
 
+/*
+ * greedyh.asm is only built for MMX registers. It works on packed YUY2 a
+ * qword at a time and carries the interpolated value of the previous qword
+ * (LastAvg) and the shifted neighbours into the next step, so an SSE2
+ * version would be a rewrite of the algorithm rather than a port of the
+ * macros. The SSE variant already gets pavgb, pminub, pmaxub and movntq.
+ */
 #define IS_MMX
 #define SSE_TYPE MMXT
 #define FUNCT_NAME greedyh_filter_mmx
@@ -263,6 +270,8 @@ static VideoFilter* GreedyHDeintFilter(VideoFrameType inpixfmt,
 
     filter->vf.filter = &GreedyHDeint;
     filter->vf.cleanup = &CleanupGreedyHDeintFilter;
+    filter->vf.prepare = NULL;
+    filter->vf.filter_slice = NULL;
     return (VideoFilter *) filter;
 }
 
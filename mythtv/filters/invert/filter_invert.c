@@ -64,6 +64,8 @@ static VideoFilter *new_filter(VideoFrameType inpixfmt,
     }
     filter->vf.filter = &invert;
     filter->vf.cleanup = NULL;
+    filter->vf.prepare = NULL;
+    filter->vf.filter_slice = NULL;
     TF_INIT(filter)
     return (VideoFilter *) filter;
 }
@@ -240,6 +240,8 @@ static VideoFilter *NewIvtcFilter(VideoFrameType inpixfmt,
     pullup_init_context(c);
     filter->vf.filter = &IvtcFilter;
     filter->vf.cleanup = &IvtcFilterCleanup;
+    filter->vf.prepare = NULL;
+    filter->vf.filter_slice = NULL;
     return (VideoFilter *) filter;
 }
 
@@ -2,7 +2,6 @@
 
 #include <stdlib.h>
 #include <stdio.h>
-#include <unistd.h>
 
 #include "mythconfig.h"
 #if HAVE_STDINT_H
@@ -11,7 +10,6 @@
 
 #include <string.h>
 #include <math.h>
-#include <pthread.h>
 
 #include "filter.h"
 #include "frame.h"
@@ -36,26 +34,10 @@ static const mmx_t mm_cpool[] = { { 0x0000000000000000LL }, };
 #define mmx_t int
 #endif
 
-struct DeintThread
-{
-    int       ready;
-    pthread_t id;
-    int       exists;
-};
-
 typedef struct ThisFilter
 {
     VideoFilter vf;
 
-    struct DeintThread *threads;
-    VideoFrame *frame;
-    int         field;
-    int         ready;
-    int         kill_threads;
-    int         actual_threads;
-    int         requested_threads;
-    pthread_mutex_t mutex;
-
     int       skipchroma;
     int       mm_flags;
     int       width;
@@ -270,34 +252,20 @@ static int AllocFilter(ThisFilter* filter, int width, int height)
 static void filter_func(struct ThisFilter *p, uint8_t *dst, int dst_offsets[3],
                         int dst_stride[3], int width, int height, int parity,
                         int tff, int double_rate, int dirty,
-                        int this_slice, int total_slices)
+                        int starth, int endh)
 {
-    if (height < 8 || total_slices < 1)
+    if (height < 8 || starth >= endh)
         return;
 
-    if (total_slices > 1 && !double_rate)
-    {
-        this_slice   = 0;
-        total_slices = 1;
-    }
-
     int i, y;
     uint8_t *dest, *src1, *src2, *src3, *src4, *src5;
     int channels = p->skipchroma ? 1 : 3;
     int    field = parity ^ tff;
 
-    int first_slice  = (this_slice == 0);
-    int last_slice   = 0;
-    int slice_height = height / total_slices;
-    slice_height     = (slice_height >> 1) << 1;
-    int starth       = slice_height * this_slice;
-    int endh         = starth + slice_height;
-
-    if ((this_slice + 1) >= total_slices)
-    {
+    int first_slice  = (starth == 0);
+    int last_slice   = (endh >= height);
+    if (last_slice)
         endh = height;
-        last_slice = 1;
-    }
 
     for (i = 0; i < channels; i++)
     {
@@ -417,43 +385,10 @@ static void filter_func(struct ThisFilter *p, uint8_t *dst, int dst_offsets[3],
 #endif
 }
 
-static void *KernelThread(void *args)
-{
-    ThisFilter *filter = (ThisFilter*)args;
-
-    pthread_mutex_lock(&(filter->mutex));
-    int num = filter->actual_threads;
-    filter->actual_threads = num + 1;
-    pthread_mutex_unlock(&(filter->mutex));
-
-    while (!filter->kill_threads)
-    {
-        usleep(1000);
-        if (filter->ready &&
-            filter->frame != NULL &&
-            filter->threads[num].ready)
-        {
-            filter_func(
-                filter, filter->frame->buf, filter->frame->offsets,
-                filter->frame->pitches, filter->frame->width,
-                filter->frame->height, filter->field,
-                filter->frame->top_field_first, filter->double_rate,
-                filter->dirty_frame, num, filter->actual_threads);
-
-            pthread_mutex_lock(&(filter->mutex));
-            filter->ready = filter->ready - 1;
-            filter->threads[num].ready = 0;
-            pthread_mutex_unlock(&(filter->mutex));
-        }
-    }
-    pthread_exit(NULL);
-    return NULL;
-}
-
-static int KernelDeint(VideoFilter *f, VideoFrame *frame, int field)
+static int KernelDeintPrepare(VideoFilter *f, VideoFrame *frame, int field)
 {
     ThisFilter *filter = (ThisFilter *) f;
-    TF_VARS;
+    (void) field;
 
     if (!AllocFilter(filter, frame->width, frame->height))
     {
@@ -461,8 +396,6 @@ static int KernelDeint(VideoFilter *f, VideoFrame *frame, int field)
         return -1;
     }
 
-    TF_START;
-
     filter->dirty_frame = 1;
     if (filter->last_framenr == frame->frameNumber)
     {
@@ -480,31 +413,37 @@ static int KernelDeint(VideoFilter *f, VideoFrame *frame, int field)
         }
     }
 
-    if (filter->actual_threads > 1 && filter->double_rate)
-    {
-        int i;
-        for (i = 0; i < filter->actual_threads; i++)
-            filter->threads[i].ready = 1;
-        filter->frame = frame;
-        filter->field = field;
-        filter->ready = filter->actual_threads;
-        i = 0;
-        while (filter->ready > 0 && i < 1000)
-        {
-            usleep(1000);
-            i++;
-        }
-    }
-    else
-    {
-        filter_func(
-            filter, frame->buf, frame->offsets, frame->pitches,
-            frame->width, frame->height, field, frame->top_field_first,
-            filter->double_rate, filter->dirty_frame, 0, 1);
-    }
-
     filter->last_framenr = frame->frameNumber;
 
+    /* Single rate filtering works in place, so it can not be split. */
+    return filter->double_rate;
+}
+
+static int KernelDeintSlice(VideoFilter *f, VideoFrame *frame, int field,
+                            int first_row, int last_row)
+{
+    ThisFilter *filter = (ThisFilter *) f;
+
+    filter_func(
+        filter, frame->buf, frame->offsets, frame->pitches,
+        frame->width, frame->height, field, frame->top_field_first,
+        filter->double_rate, filter->dirty_frame, first_row, last_row);
+
+    return 0;
+}
+
+static int KernelDeint(VideoFilter *f, VideoFrame *frame, int field)
+{
+    ThisFilter *filter = (ThisFilter *) f;
+    TF_VARS;
+
+    if (KernelDeintPrepare(&filter->vf, frame, field) < 0)
+        return -1;
+
+    TF_START;
+
+    KernelDeintSlice(&filter->vf, frame, field, 0, frame->height);
+
     TF_END(filter, "KernelDeint: ");
 
     return 0;
@@ -522,15 +461,6 @@ static void CleanupKernelDeintFilter(VideoFilter *f)
             free(*p);
         *p= NULL;
     }
-
-    if (filter->threads != NULL)
-    {
-        filter->kill_threads = 1;
-        for (i = 0; i < filter->requested_threads; i++)
-            if (filter->threads[i].exists)
-                pthread_join(filter->threads[i].id, NULL);
-        free(filter->threads);
-    }
 }
 
 static VideoFilter *NewKernelDeintFilter(VideoFrameType inpixfmt,
@@ -588,68 +518,8 @@ static VideoFilter *NewKernelDeintFilter(VideoFrameType inpixfmt,
 
     filter->vf.filter  = &KernelDeint;
     filter->vf.cleanup = &CleanupKernelDeintFilter;
-
-    filter->frame = NULL;
-    filter->field = 0;
-    filter->ready = 0;
-    filter->kill_threads = 0;
-    filter->actual_threads  = 0;
-    filter->requested_threads  = threads;
-    filter->threads = NULL; 
-
-    if (filter->requested_threads > 1)
-    {
-        filter->threads = (struct DeintThread *) calloc(threads,
-                          sizeof(struct DeintThread));
-        if (filter->threads == NULL)
-        {
-            VERBOSE(VB_IMPORTANT, "KernelDeint: failed to allocate memory "
-                    "for threads - falling back to existing, single thread.");
-            filter->requested_threads = 1;
-        }
-    }
-
-    if (filter->requested_threads > 1)
-    {
-        pthread_mutex_init(&(filter->mutex), NULL);
-        int success = 0;
-        for (int i = 0; i < filter->requested_threads; i++)
-        {
-            if (pthread_create(&(filter->threads[i].id), NULL,
-                               KernelThread, (void*)filter) != 0)
-                filter->threads[i].exists = 0;
-            else
-            {
-                success++;
-                filter->threads[i].exists = 1;
-            }
-        }
-
-        if (success < filter->requested_threads)
-        {
-            VERBOSE(VB_IMPORTANT, "KernelDeint: failed to create all threads"
-                   " - falling back to existing, single thread.");
-        }
-        else
-        {
-            int timeout = 0;
-            while (filter->actual_threads != filter->requested_threads)
-            {
-                timeout++;
-                if (timeout > 5000)
-                {
-                    VERBOSE(VB_IMPORTANT, "KernelDeint: waited too long for"
-                            " threads to start.- continuing.");
-                    break;
-                }
-                usleep(1000);
-            }
-            VERBOSE(VB_PLAYBACK, "KernelDeint: Created threads.");
-        }
-    }
-
-    if (filter->actual_threads < 1 )
-        VERBOSE(VB_PLAYBACK, "KernelDeint: Using existing thread.");
+    filter->vf.prepare = &KernelDeintPrepare;
+    filter->vf.filter_slice = &KernelDeintSlice;
 
     return (VideoFilter *) filter;
 }
@@ -16,6 +16,12 @@
 #define PAVGB(a,b)   "pavgb " #a ", " #b " \n\t"
 #define PAVGUSB(a,b) "pavgusb " #a ", " #b " \n\t"
 
+#ifdef __SSE__
+#define LB_CLOBBERS "xmm0", "xmm1", "xmm2",
+#else
+#define LB_CLOBBERS         /* registers unknown to gcc without -msse */
+#endif
+
 #include "filter.h"
 #include "frame.h"
 
@@ -26,12 +32,14 @@ typedef struct LBFilter
     /* functions and variables below here considered "private" */
     int mm_flags;
     void (*subfilter)(unsigned char *, int);
+    void (*subfilter16)(unsigned char *, int);  /* 16 columns, may be NULL */
     TF_STRUCT;
 } LBFilter;
 
 void linearBlend(unsigned char *src, int stride);
 void linearBlendMMX(unsigned char *src, int stride);
 void linearBlend3DNow(unsigned char *src, int stride);
+void linearBlendSSE2(unsigned char *src, int stride);
 int linearBlendFilterAltivec(VideoFilter *f, VideoFrame *frame, int field);
 
 #ifdef MMX
@@ -130,6 +138,53 @@ void linearBlend3DNow(unsigned char *src, int stride)
     );
 }
 
+/* linearBlendMMX on 16 columns, without the need for emms */
+void linearBlendSSE2(unsigned char *src, int stride)
+{
+    __asm__ volatile(
+       "lea (%0, %1), %%"REG_a"                        \n\t"
+       "lea (%%"REG_a", %1, 4), %%"REG_d"              \n\t"
+
+       "movdqu (%0), %%xmm0                            \n\t" // L0
+       "movdqu (%%"REG_a", %1), %%xmm1                 \n\t" // L2
+       PAVGB(%%xmm1, %%xmm0)                                 // L0+L2
+       "movdqu (%%"REG_a"), %%xmm2                     \n\t" // L1
+       PAVGB(%%xmm2, %%xmm0)
+       "movdqu %%xmm0, (%0)                            \n\t"
+       "movdqu (%%"REG_a", %1, 2), %%xmm0              \n\t" // L3
+       PAVGB(%%xmm0, %%xmm2)                                 // L1+L3
+       PAVGB(%%xmm1, %%xmm2)                                 // 2L2 + L1 + L3
+       "movdqu %%xmm2, (%%"REG_a")                     \n\t"
+       "movdqu (%0, %1, 4), %%xmm2                     \n\t" // L4
+       PAVGB(%%xmm2, %%xmm1)                                 // L2+L4
+       PAVGB(%%xmm0, %%xmm1)                                 // 2L3 + L2 + L4
+       "movdqu %%xmm1, (%%"REG_a", %1)                 \n\t"
+       "movdqu (%%"REG_d"), %%xmm1                     \n\t" // L5
+       PAVGB(%%xmm1, %%xmm0)                                 // L3+L5
+       PAVGB(%%xmm2, %%xmm0)                                 // 2L4 + L3 + L5
+       "movdqu %%xmm0, (%%"REG_a", %1, 2)              \n\t"
+       "movdqu (%%"REG_d", %1), %%xmm0                 \n\t" // L6
+       PAVGB(%%xmm0, %%xmm2)                                 // L4+L6
+       PAVGB(%%xmm1, %%xmm2)                                 // 2L5 + L4 + L6
+       "movdqu %%xmm2, (%0, %1, 4)                     \n\t"
+       "movdqu (%%"REG_d", %1, 2), %%xmm2              \n\t" // L7
+       PAVGB(%%xmm2, %%xmm1)                                 // L5+L7
+       PAVGB(%%xmm0, %%xmm1)                                 // 2L6 + L5 + L7
+       "movdqu %%xmm1, (%%"REG_d")                     \n\t"
+       "movdqu (%0, %1, 8), %%xmm1                     \n\t" // L8
+       PAVGB(%%xmm1, %%xmm0)                                 // L6+L8
+       PAVGB(%%xmm2, %%xmm0)                                 // 2L7 + L6 + L8
+       "movdqu %%xmm0, (%%"REG_d", %1)                 \n\t"
+       "movdqu (%%"REG_d", %1, 4), %%xmm0              \n\t" // L9
+       PAVGB(%%xmm0, %%xmm2)                                 // L7+L9
+       PAVGB(%%xmm1, %%xmm2)                                 // 2L8 + L7 + L9
+       "movdqu %%xmm2, (%%"REG_d", %1, 2)              \n\t"
+
+       : : "r" (src), "r" ((long)stride)
+       : "%"REG_a, "%"REG_d, LB_CLOBBERS "memory"
+    );
+}
+
 #endif
 
 #if HAVE_ALTIVEC
@@ -276,6 +331,21 @@ void linearBlend(unsigned char *src, int stride)
     }
 }
 
+/* Blends the 8 lines starting at src across the whole stride. */
+static void linearBlendRow(LBFilter *vf, unsigned char *src, int stride)
+{
+    int x = 0;
+
+    if (vf->subfilter16)
+    {
+        for (; x + 16 <= stride; x += 16)
+            (vf->subfilter16)(src + x, stride);
+    }
+
+    for (; x < stride; x += 8)
+        (vf->subfilter)(src + x, stride);
+}
+
 static int linearBlendFilter(VideoFilter *f, VideoFrame *frame, int  field)
 {
     (void)field;
@@ -283,8 +353,7 @@ static int linearBlendFilter(VideoFilter *f, VideoFrame *frame, int  field)
     unsigned char *yptr = frame->buf + frame->offsets[0];
     int stride = frame->pitches[0];
     int ymax = height - 8;
-    int x,y;
-    unsigned char *src;
+    int y;
     unsigned char *uoff = frame->buf + frame->offsets[1];
     unsigned char *voff = frame->buf + frame->offsets[2];
     LBFilter *vf = (LBFilter *)f;
@@ -293,27 +362,15 @@ static int linearBlendFilter(VideoFilter *f, VideoFrame *frame, int  field)
     TF_START;
 
     for (y = 0; y < ymax; y+=8)
-    {  
-        for (x = 0; x < stride; x+=8)
-        {
-            src = yptr + x + y * stride;
-            (vf->subfilter)(src, stride);  
-        }
-    }
+        linearBlendRow(vf, yptr + y * stride, stride);
  
     stride = frame->pitches[1];
     ymax = height / 2 - 8;
   
     for (y = 0; y < ymax; y += 8)
     {
-        for (x = 0; x < stride; x += 8)
-        {
-            src = uoff + x + y * stride;
-            (vf->subfilter)(src, stride);
-       
-            src = voff + x + y * stride;
-            (vf->subfilter)(src, stride);
-        }
+        linearBlendRow(vf, uoff + y * stride, stride);
+        linearBlendRow(vf, voff + y * stride, stride);
     }
 
 #if HAVE_MMX
@@ -348,8 +405,14 @@ static VideoFilter *new_filter(VideoFrameType inpixfmt,
 
     filter->vf.filter = &linearBlendFilter;
     filter->subfilter = &linearBlend;    /* Default, non accellerated */
+    filter->subfilter16 = NULL;
     filter->mm_flags = mm_support();
-    if (HAVE_MMX && filter->mm_flags & FF_MM_MMXEXT)
+    if (HAVE_MMX && filter->mm_flags & FF_MM_SSE2)
+    {
+        filter->subfilter16 = &linearBlendSSE2;
+        filter->subfilter   = &linearBlendMMX;
+    }
+    else if (HAVE_MMX && filter->mm_flags & FF_MM_MMXEXT)
         filter->subfilter = &linearBlendMMX;
     else if (HAVE_AMD3DNOW && filter->mm_flags & FF_MM_3DNOW)
         filter->subfilter = &linearBlend3DNow;
@@ -357,6 +420,8 @@ static VideoFilter *new_filter(VideoFrameType inpixfmt,
         filter->vf.filter = &linearBlendFilterAltivec;
 
     filter->vf.cleanup = NULL;
+    filter->vf.prepare = NULL;
+    filter->vf.filter_slice = NULL;
     TF_INIT(filter);
     return (VideoFilter *)filter;
 }
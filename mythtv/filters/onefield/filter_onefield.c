@@ -85,6 +85,8 @@ static VideoFilter *new_filter(VideoFrameType inpixfmt,
         filter->bottom = 1;
 
     filter->vf.cleanup = NULL;
+    filter->vf.prepare = NULL;
+    filter->vf.filter_slice = NULL;
     return (VideoFilter *)filter;
 }
 
@@ -123,6 +123,8 @@ static VideoFilter *new_filter(VideoFrameType inpixfmt,
 
     filter->vf.filter = &pp;
     filter->vf.cleanup = &cleanup;
+    filter->vf.prepare = NULL;
+    filter->vf.filter_slice = NULL;
     TF_INIT(filter);
     return (VideoFilter *)filter;
 }
@@ -27,6 +27,12 @@
 
 #ifdef MMX
 #include "libavcodec/x86/mmx.h"
+#ifdef __SSE__
+#define DNR_CLOBBERS "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", \
+                     "xmm6", "xmm7",
+#else
+#define DNR_CLOBBERS        /* registers unknown to gcc without -msse */
+#endif
 #endif
 
 //Regular filter
@@ -127,13 +133,45 @@ static void init_vars(ThisFilter *tf, VideoFrame *frame,
     buf[2] = frame->buf + frame->offsets[2];
 }
 
+static void quickdnr_plane(uint8_t *avg, uint8_t *buf, int size, int thr1)
+{
+    int y;
+    for (y = 0; y < size; y++)
+    {
+        if (abs(avg[y] - buf[y]) < thr1)
+            buf[y] = avg[y] = (avg[y] + buf[y]) >> 1;
+        else
+            avg[y] = buf[y];
+    }
+}
+
+static void quickdnr2_plane(uint8_t *avg, uint8_t *buf, int size,
+                            int thr1, int thr2)
+{
+    int y;
+    for (y = 0; y < size; y++)
+    {
+        int t = abs(avg[y] - buf[y]);
+        if (t < thr1)
+        {
+            if (t > thr2)
+                avg[y] = (avg[y] + buf[y]) >> 1;
+            buf[y] = avg[y];
+        }
+        else
+        {
+            avg[y] = buf[y];
+        }
+    }
+}
+
 static int quickdnr(VideoFilter *f, VideoFrame *frame, int field)
 {
     (void)field;
     ThisFilter *tf = (ThisFilter *)f; 
     int thr1[3], thr2[3], height[3];
     uint8_t *avg[3], *buf[3];
-    int i, y;
+    int i;
 
     TF_VARS;
 
@@ -145,16 +183,7 @@ static int quickdnr(VideoFilter *f, VideoFrame *frame, int field)
     init_vars(tf, frame, thr1, thr2, height, avg, buf);
 
     for (i = 0; i < 3; i++)
-    {
-        int sz = height[i] * frame->pitches[i];
-        for (y = 0; y < sz; y++)
-        {
-            if (abs(avg[i][y] - buf[i][y]) < thr1[i])
-                buf[i][y] = avg[i][y] = (avg[i][y] + buf[i][y]) >> 1;
-            else
-                avg[i][y] = buf[i][y];
-        }
-    }
+        quickdnr_plane(avg[i], buf[i], height[i] * frame->pitches[i], thr1[i]);
 
     TF_END(tf, "QuickDNR: ");
  
@@ -167,7 +196,7 @@ static int quickdnr2(VideoFilter *f, VideoFrame *frame, int field)
     ThisFilter *tf = (ThisFilter *)f; 
     int thr1[3], thr2[3], height[3];
     uint8_t *avg[3], *buf[3];
-    int i, y;
+    int i;
 
     TF_VARS;
  
@@ -180,21 +209,8 @@ static int quickdnr2(VideoFilter *f, VideoFrame *frame, int field)
 
     for (i = 0; i < 3; i++)
     {
-        int sz = height[i] * frame->pitches[i];
-        for (y = 0; y < sz; y++)
-        {
-            int t = abs(avg[i][y] - buf[i][y]);
-            if (t < thr1[i])
-            {
-                if (t > thr2[i])
-                    avg[i][y] = (avg[i][y] + buf[i][y]) >> 1;
-                buf[i][y] = avg[i][y];
-            }
-            else
-            {
-                avg[i][y] = buf[i][y];
-            }
-        }
+        quickdnr2_plane(avg[i], buf[i], height[i] * frame->pitches[i],
+                        thr1[i], thr2[i]);
     }
 
     TF_END(tf, "QuickDNR2: ");
@@ -439,6 +455,172 @@ static int quickdnr2MMX(VideoFilter *f, VideoFrame *frame, int field)
 
     return 0;
 }
+
+/*
+ * SSE2 versions of quickdnr_plane() and quickdnr2_plane(). These do 16
+ * bytes per step, use unsigned compares and truncate the average like the
+ * C versions, so the output is the same as theirs. No emms is needed.
+ */
+static void quickdnr_plane_sse2(uint8_t *avg, uint8_t *buf, int size,
+                                int thr1)
+{
+    uint8_t consts[32];
+    long blocks = size >> 4;
+
+    memset(consts,      thr1, 16);
+    memset(consts + 16, 1,    16);
+
+    if (blocks)
+    {
+        __asm__ volatile(
+            "movdqu       (%3), %%xmm4  \n\t"    // thr1
+            "movdqu     16(%3), %%xmm6  \n\t"    // 0x01
+            "1:                         \n\t"
+            "movdqu       (%0), %%xmm0  \n\t"    // avg
+            "movdqu       (%1), %%xmm1  \n\t"    // buf
+            "movdqa     %%xmm0, %%xmm2  \n\t"
+            "psubusb    %%xmm1, %%xmm2  \n\t"
+            "movdqa     %%xmm1, %%xmm3  \n\t"
+            "psubusb    %%xmm0, %%xmm3  \n\t"
+            "por        %%xmm3, %%xmm2  \n\t"    // |avg - buf|
+            "movdqa     %%xmm0, %%xmm3  \n\t"
+            "pavgb      %%xmm1, %%xmm3  \n\t"
+            "pxor       %%xmm1, %%xmm0  \n\t"
+            "pand       %%xmm6, %%xmm0  \n\t"
+            "psubb      %%xmm0, %%xmm3  \n\t"    // (avg + buf) >> 1
+            "movdqa     %%xmm2, %%xmm7  \n\t"
+            "pmaxub     %%xmm4, %%xmm7  \n\t"
+            "pcmpeqb    %%xmm2, %%xmm7  \n\t"    // |avg - buf| >= thr1
+            "pand       %%xmm7, %%xmm1  \n\t"
+            "pandn      %%xmm3, %%xmm7  \n\t"
+            "por        %%xmm1, %%xmm7  \n\t"
+            "movdqu     %%xmm7, (%0)    \n\t"
+            "movdqu     %%xmm7, (%1)    \n\t"
+            "add        $16, %0         \n\t"
+            "add        $16, %1         \n\t"
+            "dec        %2              \n\t"
+            "jnz        1b              \n\t"
+            : "+r" (avg), "+r" (buf), "+r" (blocks)
+            : "r" (consts)
+            : DNR_CLOBBERS "memory"
+        );
+    }
+
+    quickdnr_plane(avg, buf, size & 0xf, thr1);
+}
+
+static void quickdnr2_plane_sse2(uint8_t *avg, uint8_t *buf, int size,
+                                 int thr1, int thr2)
+{
+    uint8_t consts[48];
+    long blocks = size >> 4;
+
+    memset(consts,      thr1, 16);
+    memset(consts + 16, thr2, 16);
+    memset(consts + 32, 1,    16);
+
+    if (blocks)
+    {
+        __asm__ volatile(
+            "movdqu       (%3), %%xmm4  \n\t"    // thr1
+            "movdqu     16(%3), %%xmm5  \n\t"    // thr2
+            "movdqu     32(%3), %%xmm6  \n\t"    // 0x01
+            "1:                         \n\t"
+            "movdqu       (%0), %%xmm0  \n\t"    // avg
+            "movdqu       (%1), %%xmm1  \n\t"    // buf
+            "movdqa     %%xmm0, %%xmm2  \n\t"
+            "psubusb    %%xmm1, %%xmm2  \n\t"
+            "movdqa     %%xmm1, %%xmm3  \n\t"
+            "psubusb    %%xmm0, %%xmm3  \n\t"
+            "por        %%xmm3, %%xmm2  \n\t"    // |avg - buf|
+            "movdqa     %%xmm0, %%xmm3  \n\t"
+            "pavgb      %%xmm1, %%xmm3  \n\t"
+            "movdqa     %%xmm0, %%xmm7  \n\t"
+            "pxor       %%xmm1, %%xmm7  \n\t"
+            "pand       %%xmm6, %%xmm7  \n\t"
+            "psubb      %%xmm7, %%xmm3  \n\t"    // (avg + buf) >> 1
+            "movdqa     %%xmm2, %%xmm7  \n\t"
+            "pminub     %%xmm5, %%xmm7  \n\t"
+            "pcmpeqb    %%xmm2, %%xmm7  \n\t"    // |avg - buf| <= thr2
+            "pand       %%xmm7, %%xmm0  \n\t"
+            "pandn      %%xmm3, %%xmm7  \n\t"
+            "por        %%xmm0, %%xmm7  \n\t"    // new average
+            "movdqa     %%xmm2, %%xmm3  \n\t"
+            "pmaxub     %%xmm4, %%xmm3  \n\t"
+            "pcmpeqb    %%xmm2, %%xmm3  \n\t"    // |avg - buf| >= thr1
+            "pand       %%xmm3, %%xmm1  \n\t"
+            "pandn      %%xmm7, %%xmm3  \n\t"
+            "por        %%xmm1, %%xmm3  \n\t"
+            "movdqu     %%xmm3, (%0)    \n\t"
+            "movdqu     %%xmm3, (%1)    \n\t"
+            "add        $16, %0         \n\t"
+            "add        $16, %1         \n\t"
+            "dec        %2              \n\t"
+            "jnz        1b              \n\t"
+            : "+r" (avg), "+r" (buf), "+r" (blocks)
+            : "r" (consts)
+            : DNR_CLOBBERS "memory"
+        );
+    }
+
+    quickdnr2_plane(avg, buf, size & 0xf, thr1, thr2);
+}
+
+static int quickdnrSSE2(VideoFilter *f, VideoFrame *frame, int field)
+{
+    (void)field;
+    ThisFilter *tf = (ThisFilter *)f;
+    int thr1[3], thr2[3], height[3];
+    uint8_t *avg[3], *buf[3];
+    int i;
+
+    TF_VARS;
+
+    TF_START;
+
+    if (!init_avg(tf, frame))
+        return 0;
+
+    init_vars(tf, frame, thr1, thr2, height, avg, buf);
+
+    for (i = 0; i < 3; i++)
+    {
+        quickdnr_plane_sse2(avg[i], buf[i], height[i] * frame->pitches[i],
+                            thr1[i]);
+    }
+
+    TF_END(tf, "QuickDNRsse2: ");
+
+    return 0;
+}
+
+static int quickdnr2SSE2(VideoFilter *f, VideoFrame *frame, int field)
+{
+    (void)field;
+    ThisFilter *tf = (ThisFilter *)f;
+    int thr1[3], thr2[3], height[3];
+    uint8_t *avg[3], *buf[3];
+    int i;
+
+    TF_VARS;
+
+    TF_START;
+
+    if (!init_avg(tf, frame))
+        return 0;
+
+    init_vars(tf, frame, thr1, thr2, height, avg, buf);
+
+    for (i = 0; i < 3; i++)
+    {
+        quickdnr2_plane_sse2(avg[i], buf[i], height[i] * frame->pitches[i],
+                             thr1[i], thr2[i]);
+    }
+
+    TF_END(tf, "QuickDNR2sse2: ");
+
+    return 0;
+}
 #endif /* MMX */
 
 static void cleanup(VideoFilter *vf)
@@ -522,7 +704,11 @@ static VideoFilter *new_filter(VideoFrameType inpixfmt,
     filter->vf.filter  = (double_threshold) ? &quickdnr2 : &quickdnr;
 
 #ifdef MMX
-    if (mm_support() > FF_MM_MMXEXT)
+    if (mm_support() & FF_MM_SSE2)
+    {
+        filter->vf.filter = (double_threshold) ? &quickdnr2SSE2 : &quickdnrSSE2;
+    }
+    else if (mm_support() > FF_MM_MMXEXT)
     {
         filter->vf.filter = (double_threshold) ? &quickdnr2MMX : &quickdnrMMX;
         for (i = 0; i < 8; i++)
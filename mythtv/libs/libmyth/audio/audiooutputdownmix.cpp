@@ -1,4 +1,6 @@
+#include "mythconfig.h"
 #include "audiooutputdownmix.h"
+#include "audiooutpututil.h"
 
 #include "string.h"
 
@@ -141,7 +143,67 @@ int AudioOutputDownmix::DownmixFrames(int channels_in, int  channels_out,
     {
         float tmp;
         int index = channels_in - 1;
-        for (int n=0; n < frames; n++)
+        int n = 0;
+#if ARCH_X86
+        // The SSE code reads 8 samples per frame. The samples past
+        // channels_in belong to the next frame and are masked to zero
+        // before the multiply, as they could be Inf or NaN. The frames
+        // at the end of the buffer which would make it read past the
+        // end are left for the C
+        int loops = frames - (8 - 1) / channels_in;
+        if (AudioOutputUtil::has_hardware_fpu() && loops > 0)
+        {
+            // left coefficients, right coefficients, sample mask
+            float coeff[24];
+            for (int j = 0; j < 8; j++)
+            {
+                bool used = j < channels_in;
+                coeff[j]     = used ? stereo_matrix[index][j][0] : 0.0f;
+                coeff[j + 8] = used ? stereo_matrix[index][j][1] : 0.0f;
+                memset(&coeff[j + 16], used ? 0xff : 0, sizeof(float));
+            }
+            n = loops;
+            int stride = channels_in * sizeof(float);
+
+            __asm__ volatile (
+                "movups     (%4), %%xmm4        \n\t"
+                "movups     16(%4), %%xmm5      \n\t"
+                "movups     32(%4), %%xmm6      \n\t"
+                "movups     48(%4), %%xmm7      \n\t"
+                "1:                             \n\t"
+                "movups     (%1), %%xmm0        \n\t"
+                "movups     16(%1), %%xmm1      \n\t"
+                "movups     64(%4), %%xmm2      \n\t"
+                "movups     80(%4), %%xmm3      \n\t"
+                "andps      %%xmm2, %%xmm0      \n\t"
+                "andps      %%xmm3, %%xmm1      \n\t"
+                "movaps     %%xmm0, %%xmm2      \n\t"
+                "movaps     %%xmm1, %%xmm3      \n\t"
+                "mulps      %%xmm4, %%xmm0      \n\t"
+                "mulps      %%xmm5, %%xmm1      \n\t"
+                "mulps      %%xmm6, %%xmm2      \n\t"
+                "mulps      %%xmm7, %%xmm3      \n\t"
+                "addps      %%xmm1, %%xmm0      \n\t"
+                "addps      %%xmm3, %%xmm2      \n\t"
+                "movaps     %%xmm0, %%xmm1      \n\t"
+                "unpcklps   %%xmm2, %%xmm0      \n\t"
+                "unpckhps   %%xmm2, %%xmm1      \n\t"
+                "addps      %%xmm1, %%xmm0      \n\t"
+                "movhlps    %%xmm0, %%xmm1      \n\t"
+                "addps      %%xmm1, %%xmm0      \n\t"
+                "movlps     %%xmm0, (%0)        \n\t"
+                "add        %3,     %1          \n\t"
+                "add        $8,     %0          \n\t"
+                "sub        $1, %%ecx           \n\t"
+                "jnz        1b                  \n\t"
+                :"+r"(dst), "+r"(src), "+c"(loops)
+                :"r"((long)stride), "r"(coeff)
+                :"memory", "xmm0", "xmm1", "xmm2",
+                 "xmm3", "xmm4", "xmm5", "xmm6", "xmm7"
+            );
+        }
+#endif //ARCH_X86
+        for (; n < frames; n++)
         {
             for (int i=0; i < channels_out; i++)
             {
@@ -52,9 +52,9 @@ static inline float clipcheck(float f) {
 }
 
 /*
- All toFloat variants require 16 byte aligned input and output buffers on x86
- The SSE code processes 16 bytes at a time and leaves any remainder for the C
- - there is no remainder in practice */
+ The SSE code uses unaligned loads and stores throughout, so any buffer
+ alignment takes the SSE path. It processes 16 samples at a time and leaves
+ any remainder for the C */
 
 static int toFloat8(float *out, uchar *in, int len)
 {
@@ -76,7 +76,7 @@ static int toFloat8(float *out, uchar *in, int len)
             "punpckldq  %%xmm0, %%xmm0      \n\t"
             "punpckldq  %%xmm7, %%xmm7      \n\t"
             "1:                             \n\t"
-            "movdqa     (%1), %%xmm1        \n\t"
+            "movdqu     (%1), %%xmm1        \n\t"
             "xorpd      %%xmm2, %%xmm2      \n\t"
             "xorpd      %%xmm3, %%xmm3      \n\t"
             "psubb      %%xmm0, %%xmm1      \n\t"
@@ -98,19 +98,20 @@ static int toFloat8(float *out, uchar *in, int len)
             "mulps      %%xmm7, %%xmm4      \n\t"
             "cvtdq2ps   %%xmm6, %%xmm6      \n\t"
             "mulps      %%xmm7, %%xmm5      \n\t"
-            "movaps     %%xmm4, (%0)        \n\t"
+            "movups     %%xmm4, (%0)        \n\t"
             "cvtdq2ps   %%xmm1, %%xmm1      \n\t"
             "mulps      %%xmm7, %%xmm6      \n\t"
-            "movaps     %%xmm5, 16(%0)      \n\t"
+            "movups     %%xmm5, 16(%0)      \n\t"
             "mulps      %%xmm7, %%xmm1      \n\t"
-            "movaps     %%xmm6, 32(%0)      \n\t"
+            "movups     %%xmm6, 32(%0)      \n\t"
             "add        $16,    %1          \n\t"
-            "movaps     %%xmm1, 48(%0)      \n\t"
+            "movups     %%xmm1, 48(%0)      \n\t"
             "add        $64,    %0          \n\t"
             "sub        $1, %%ecx           \n\t"
             "jnz        1b                  \n\t"
             :"+r"(out),"+r"(in)
             :"c"(loops), "r"(a), "r"(f)
+            :"xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7"
         );
     }
 #endif //ARCH_x86
@@ -129,7 +130,7 @@ static int fromFloat8(uchar *out, float *in, int len)
     float f = (1<<7) - 1;
 
 #if ARCH_X86
-    if (sse_check() && len >= 16 && ((unsigned long)out & 0xf) == 0)
+    if (sse_check() && len >= 16)
     {
         int loops = len >> 4;
         i = loops << 4;
@@ -166,6 +167,7 @@ static int fromFloat8(uchar *out, float *in, int len)
             "jnz        1b                  \n\t"
             :"+r"(out),"+r"(in)
             :"c"(loops), "r"(a), "r"(f)
+            :"xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm7"
         );
     }
 #endif //ARCH_x86
@@ -191,10 +193,10 @@ static int toFloat16(float *out, short *in, int len)
             "punpckldq  %%xmm7, %%xmm7      \n\t"
             "1:                             \n\t"
             "xorpd      %%xmm2, %%xmm2      \n\t"
-            "movdqa     (%1),   %%xmm1      \n\t"
+            "movdqu     (%1),   %%xmm1      \n\t"
             "xorpd      %%xmm3, %%xmm3      \n\t"
             "punpcklwd  %%xmm1, %%xmm2      \n\t"
-            "movdqa     16(%1), %%xmm4      \n\t"
+            "movdqu     16(%1), %%xmm4      \n\t"
             "punpckhwd  %%xmm1, %%xmm3      \n\t"
             "psrad      $16,    %%xmm2      \n\t"
             "punpcklwd  %%xmm4, %%xmm5      \n\t"
@@ -207,19 +209,20 @@ static int toFloat16(float *out, short *in, int len)
             "psrad      $16,    %%xmm6      \n\t"
             "mulps      %%xmm7, %%xmm3      \n\t"
             "cvtdq2ps   %%xmm5, %%xmm5      \n\t"
-            "movaps     %%xmm2, (%0)        \n\t"
+            "movups     %%xmm2, (%0)        \n\t"
             "cvtdq2ps   %%xmm6, %%xmm6      \n\t"
             "mulps      %%xmm7, %%xmm5      \n\t"
-            "movaps     %%xmm3, 16(%0)      \n\t"
+            "movups     %%xmm3, 16(%0)      \n\t"
             "mulps      %%xmm7, %%xmm6      \n\t"
-            "movaps     %%xmm5, 32(%0)      \n\t"
+            "movups     %%xmm5, 32(%0)      \n\t"
             "add        $32, %1             \n\t"
-            "movaps     %%xmm6, 48(%0)      \n\t"
+            "movups     %%xmm6, 48(%0)      \n\t"
             "add        $64, %0             \n\t"
             "sub        $1, %%ecx           \n\t"
             "jnz        1b                  \n\t"
             :"+r"(out),"+r"(in)
             :"c"(loops), "r"(f)
+            :"xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7"
         );
     }
 #endif //ARCH_x86
@@ -234,7 +237,7 @@ static int fromFloat16(short *out, float *in, int len)
     float f = (1<<15) - 1;
 
 #if ARCH_X86
-    if (sse_check() && len >= 16 && ((unsigned long)out & 0xf) == 0)
+    if (sse_check() && len >= 16)
     {
         int loops = len >> 4;
         i = loops << 4;
@@ -266,6 +269,7 @@ static int fromFloat16(short *out, float *in, int len)
             "jnz        1b                  \n\t"
             :"+r"(out),"+r"(in)
             :"c"(loops), "r"(f)
+            :"xmm1", "xmm2", "xmm3", "xmm4", "xmm7"
         );
     }
 #endif //ARCH_x86
@@ -296,32 +300,33 @@ static int toFloat32(AudioFormat format, float *out, int *in, int len)
             "movd       %4, %%xmm6          \n\t"
             "punpckldq  %%xmm7, %%xmm7      \n\t"
             "1:                             \n\t"
-            "movdqa     (%1),   %%xmm1      \n\t"
-            "movdqa     16(%1), %%xmm2      \n\t"
+            "movdqu     (%1),   %%xmm1      \n\t"
+            "movdqu     16(%1), %%xmm2      \n\t"
             "psrad      %%xmm6, %%xmm1      \n\t"
-            "movdqa     32(%1), %%xmm3      \n\t"
+            "movdqu     32(%1), %%xmm3      \n\t"
             "cvtdq2ps   %%xmm1, %%xmm1      \n\t"
             "psrad      %%xmm6, %%xmm2      \n\t"
-            "movdqa     48(%1), %%xmm4      \n\t"
+            "movdqu     48(%1), %%xmm4      \n\t"
             "cvtdq2ps   %%xmm2, %%xmm2      \n\t"
             "psrad      %%xmm6, %%xmm3      \n\t"
             "mulps      %%xmm7, %%xmm1      \n\t"
             "psrad      %%xmm6, %%xmm4      \n\t"
             "cvtdq2ps   %%xmm3, %%xmm3      \n\t"
-            "movaps     %%xmm1, (%0)        \n\t"
+            "movups     %%xmm1, (%0)        \n\t"
             "mulps      %%xmm7, %%xmm2      \n\t"
             "cvtdq2ps   %%xmm4, %%xmm4      \n\t"
-            "movaps     %%xmm2, 16(%0)      \n\t"
+            "movups     %%xmm2, 16(%0)      \n\t"
             "mulps      %%xmm7, %%xmm3      \n\t"
             "mulps      %%xmm7, %%xmm4      \n\t"
-            "movaps     %%xmm3, 32(%0)      \n\t"
+            "movups     %%xmm3, 32(%0)      \n\t"
             "add        $64,    %1          \n\t"
-            "movaps     %%xmm4, 48(%0)      \n\t"
+            "movups     %%xmm4, 48(%0)      \n\t"
             "add        $64,    %0          \n\t"
             "sub        $1, %%ecx           \n\t"
             "jnz        1b                  \n\t"
             :"+r"(out),"+r"(in)
             :"c"(loops), "r"(f), "r"(shift)
+            :"xmm1", "xmm2", "xmm3", "xmm4", "xmm6", "xmm7"
         );
     }
 #endif //ARCH_x86
@@ -341,7 +346,7 @@ static int fromFloat32(AudioFormat format, int *out, float *in, int len)
         shift = 0;
 
 #if ARCH_X86
-    if (sse_check() && len >= 16 && ((unsigned long)out & 0xf) == 0)
+    if (sse_check() && len >= 16)
     {
         float o = 1, mo = -1;
         int loops = len >> 4;
@@ -393,6 +398,7 @@ static int fromFloat32(AudioFormat format, int *out, float *in, int len)
             "jnz        1b                  \n\t"
             :"+r"(out), "+r"(in)
             :"c"(loops), "r"(f), "m"(o), "m"(mo), "r"(shift)
+            :"xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7"
         );
     }
 #endif //ARCH_x86
@@ -406,7 +412,7 @@ static int fromFloatFLT(float *out, float *in, int len)
     int i = 0;
 
 #if ARCH_X86
-    if (sse_check() && len >= 16 && ((unsigned long)in & 0xf) == 0)
+    if (sse_check() && len >= 16)
     {
         int loops = len >> 4;
         float o = 1, mo = -1;
@@ -442,6 +448,7 @@ static int fromFloatFLT(float *out, float *in, int len)
             "jnz        1b                  \n\t"
             :"+r"(out), "+r"(in)
             :"c"(loops), "m"(o), "m"(mo)
+            :"xmm1", "xmm2", "xmm3", "xmm4", "xmm6", "xmm7"
         );
     }
 #endif //ARCH_x86
@@ -527,7 +534,39 @@ void AudioOutputUtil::MonoToStereo(void *dst, void *src, int samples)
 {
     float *d = (float *)dst;
     float *s = (float *)src;
-    for (int i = 0; i < samples; i++)
+    int i = 0;
+
+#if ARCH_X86
+    if (sse_check() && samples >= 8)
+    {
+        int loops = samples >> 3;
+        i = loops << 3;
+
+        __asm__ volatile (
+            "1:                             \n\t"
+            "movups     (%1), %%xmm0        \n\t"
+            "movups     16(%1), %%xmm2      \n\t"
+            "movaps     %%xmm0, %%xmm1      \n\t"
+            "movaps     %%xmm2, %%xmm3      \n\t"
+            "unpcklps   %%xmm0, %%xmm0      \n\t"
+            "unpckhps   %%xmm1, %%xmm1      \n\t"
+            "unpcklps   %%xmm2, %%xmm2      \n\t"
+            "unpckhps   %%xmm3, %%xmm3      \n\t"
+            "movups     %%xmm0, (%0)        \n\t"
+            "movups     %%xmm1, 16(%0)      \n\t"
+            "movups     %%xmm2, 32(%0)      \n\t"
+            "movups     %%xmm3, 48(%0)      \n\t"
+            "add        $32,    %1          \n\t"
+            "add        $64,    %0          \n\t"
+            "sub        $1, %%ecx           \n\t"
+            "jnz        1b                  \n\t"
+            :"+r"(d), "+r"(s), "+c"(loops)
+            :
+            :"memory", "xmm0", "xmm1", "xmm2", "xmm3"
+        );
+    }
+#endif //ARCH_X86
+    for (; i < samples; i++)
     {
         *d++ = *s;
         *d++ = *s++;
@@ -590,6 +629,7 @@ void AudioOutputUtil::AdjustVolume(void *buf, int len, int volume,
             "jnz        1b                  \n\t"
             :"+r"(fptr)
             :"c"(loops),"m"(g)
+            :"xmm0", "xmm1", "xmm2", "xmm3", "xmm4"
         );
     }
 #endif //ARCH_X86
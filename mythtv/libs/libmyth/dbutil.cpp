@@ -89,6 +89,38 @@ bool DBUtil::IsNewDatabase(void)
             (size == 0));
 }
 
+/** \fn DBUtil::IsTransactional(const QString&)
+ *  \brief Returns true if the storage engine of the table supports
+ *         transactions.
+ *
+ *   ROLLBACK does nothing for a MyISAM table, so callers that fall back
+ *   on a failed transaction need to know whether the partial changes
+ *   are still there. Returns false if the engine can not be determined.
+ */
+bool DBUtil::IsTransactional(const QString &table)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+    if (!query.isConnected())
+        return false;
+
+    query.prepare(
+        "SELECT INFORMATION_SCHEMA.ENGINES.TRANSACTIONS "
+        "  FROM INFORMATION_SCHEMA.TABLES, INFORMATION_SCHEMA.ENGINES "
+        " WHERE INFORMATION_SCHEMA.TABLES.TABLE_SCHEMA = DATABASE() "
+        "   AND INFORMATION_SCHEMA.TABLES.TABLE_NAME = :TABLE "
+        "   AND INFORMATION_SCHEMA.TABLES.ENGINE = "
+        "       INFORMATION_SCHEMA.ENGINES.ENGINE");
+    query.bindValue(":TABLE", table);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("DBUtil::IsTransactional", query);
+        return false;
+    }
+
+    return query.next() && query.value(0).toString().toUpper() == "YES";
+}
+
 /** \fn DBUtil::IsBackupInProgress(void)
  *  \brief Test to see if a DB backup is in progress
  *
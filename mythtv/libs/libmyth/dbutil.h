@@ -44,6 +44,7 @@ class MPUBLIC DBUtil
     static bool IsNewDatabase(void);
     static bool IsBackupInProgress(void);
     static int  CountClients(void);
+    static bool IsTransactional(const QString &table);
 
     static bool lockSchema(MSqlQuery &);
     static void unlockSchema(MSqlQuery &);
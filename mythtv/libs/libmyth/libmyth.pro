@@ -32,6 +32,7 @@ HEADERS += mythhttppool.h mythhttphandler.h
 HEADERS += remoteutil.h
 HEADERS += rawsettingseditor.h    autodeletedeque.h
 HEADERS += programinfo.h          programinfoupdater.h
+HEADERS += programlistcodec.h
 HEADERS += programtypes.h         recordingtypes.h
 HEADERS += mythrssmanager.h       netgrabbermanager.h
 HEADERS += rssparse.h             netutils.h
@@ -61,6 +62,7 @@ SOURCES += mythhttppool.cpp mythhttphandler.cpp
 SOURCES += remoteutil.cpp
 SOURCES += rawsettingseditor.cpp
 SOURCES += programinfo.cpp        programinfoupdater.cpp
+SOURCES += programlistcodec.cpp
 SOURCES += programtypes.cpp       recordingtypes.cpp
 SOURCES += mythrssmanager.cpp     netgrabbermanager.cpp
 SOURCES += rssparse.cpp           netutils.cpp
@@ -112,6 +114,7 @@ inc.files += mythconfigdialogs.h mythconfiggroups.h
 inc.files += mythterminal.h mythdeque.h mythuifilebrowser.h
 inc.files += mythhttppool.h       remoteutil.h
 inc.files += programinfo.h        autodeletedeque.h
+inc.files += programlistcodec.h
 inc.files += programtypes.h       recordingtypes.h
 inc.files += mythrssmanager.h     netgrabbermanager.h
 inc.files += rssparse.h           netutils.h
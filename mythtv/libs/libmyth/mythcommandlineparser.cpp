@@ -828,7 +828,9 @@ QString MythCommandLineParser::GetHelpString(bool with_header) const
     if (parseTypes & kCLPTestSchedule)
     {
         msg << "--testsched                    "
-            << "Test run scheduler (ignore existing schedule)" << endl;
+            << "Test run scheduler (ignore existing schedule)" << endl
+            << "                               "
+            << "and print the time taken by each phase" << endl;
     }
 
     if (parseTypes & kCLPReschedule)
@@ -30,6 +30,7 @@ using namespace std;
 #include "mythverbose.h"
 #include "storagegroup.h"
 #include "programinfoupdater.h"
+#include "programlistcodec.h"
 
 #define LOC      QString("ProgramInfo(%1): ").arg(GetBasename())
 #define LOC_WARN QString("ProgramInfo(%1), Warning: ").arg(GetBasename())
@@ -2941,6 +2942,277 @@ void ProgramInfo::SaveMarkupFlag(MarkTypes type) const
     SaveMarkupMap(flagMap, type);
 }
 
+/// Returns true if recording seek tables are stored in recordedseekblob
+/// instead of one recordedseek row per keyframe.
+static bool use_seek_blob(void)
+{
+    return gCoreContext->GetNumSetting("SeekTableBlobStorage", 0);
+}
+
+static inline void pmap_put_varint(QByteArray &buf, uint64_t val)
+{
+    while (val >= 0x80)
+    {
+        buf.append((char)((val & 0x7f) | 0x80));
+        val >>= 7;
+    }
+    buf.append((char)val);
+}
+
+static inline bool pmap_get_varint(
+    const QByteArray &buf, int &pos, uint64_t &val)
+{
+    val = 0;
+    for (uint shift = 0; shift < 64; shift += 7)
+    {
+        if (pos >= buf.size())
+            return false;
+        unsigned char c = buf[pos++];
+        val |= ((uint64_t)(c & 0x7f)) << shift;
+        if (!(c & 0x80))
+            return true;
+    }
+    return false;
+}
+
+/** \brief Encodes a position map as one segment of a recordedseekblob.
+ *
+ *   A segment is the number of entries followed by the frame and the
+ *   offset of each entry as varints. Frames are delta coded against the
+ *   previous frame, offsets are zigzag delta coded as they may go back
+ *   when a map is rebuilt. Segments are self contained so a recorder
+ *   can append new keyframes as another segment.
+ */
+static QByteArray pmap_encode(const frm_pos_map_t &posMap)
+{
+    QByteArray buf;
+    buf.reserve(posMap.size() * 4 + 8);
+
+    pmap_put_varint(buf, posMap.size());
+
+    uint64_t prev_frame  = 0;
+    int64_t  prev_offset = 0;
+    frm_pos_map_t::const_iterator it = posMap.begin();
+    for (; it != posMap.end(); ++it)
+    {
+        int64_t delta = (int64_t)*it - prev_offset;
+        pmap_put_varint(buf, it.key() - prev_frame);
+        pmap_put_varint(buf, (((uint64_t)delta) << 1) ^
+                             ((uint64_t)(delta >> 63)));
+        prev_frame  = it.key();
+        prev_offset = *it;
+    }
+
+    return buf;
+}
+
+/// Decodes the segments in buf into posMap, entries in later segments
+/// replace those of earlier ones.
+static bool pmap_decode(const QByteArray &buf, frm_pos_map_t &posMap)
+{
+    int pos = 0;
+    while (pos < buf.size())
+    {
+        uint64_t count;
+        if (!pmap_get_varint(buf, pos, count))
+            return false;
+
+        uint64_t frame  = 0;
+        int64_t  offset = 0;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint64_t dframe, doffset;
+            if (!pmap_get_varint(buf, pos, dframe) ||
+                !pmap_get_varint(buf, pos, doffset))
+            {
+                return false;
+            }
+            frame  += dframe;
+            offset += (int64_t)(doffset >> 1) ^ -((int64_t)(doffset & 1));
+            posMap[frame] = offset;
+        }
+    }
+    return true;
+}
+
+/** \brief Locks the seek tables for an update of a position map on the
+ *         connection of query.
+ *
+ *   With autocommit off the update is also a transaction on InnoDB
+ *   tables. On MyISAM tables the lock alone keeps other connections
+ *   from seeing a map half written, or from picking the same segment.
+ */
+static bool pmap_lock(MSqlQuery &query)
+{
+    if (query.exec("SET autocommit = 0") &&
+        query.exec("LOCK TABLES recordedseek WRITE, recordedseekblob WRITE"))
+    {
+        return true;
+    }
+
+    MythDB::DBError("position map lock", query);
+    query.exec("SET autocommit = 1");
+    return false;
+}
+
+/// Commits the update if ok is true, otherwise rolls it back, and
+/// unlocks the seek tables. Returns true if the update was committed.
+static bool pmap_unlock(MSqlQuery &query, bool ok)
+{
+    if (ok && !query.exec("COMMIT"))
+    {
+        MythDB::DBError("position map commit", query);
+        ok = false;
+    }
+    if (!ok)
+        query.exec("ROLLBACK");
+
+    if (!query.exec("UNLOCK TABLES") || !query.exec("SET autocommit = 1"))
+        MythDB::DBError("position map unlock", query);
+
+    return ok;
+}
+
+/// Reads the recordedseek rows and then the recordedseekblob segments of
+/// a recording into posMap. Returns false on a query error or if a
+/// segment is truncated.
+static bool pmap_load(
+    MSqlQuery &query, uint chanid, const QDateTime &recstartts,
+    MarkTypes type, frm_pos_map_t &posMap)
+{
+    query.prepare("SELECT mark, offset FROM recordedseek"
+                  " WHERE chanid = :CHANID"
+                  " AND starttime = :STARTTIME"
+                  " AND type = :TYPE ;");
+    query.bindValue(":CHANID",    chanid);
+    query.bindValue(":STARTTIME", recstartts);
+    query.bindValue(":TYPE",      type);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("position map load", query);
+        return false;
+    }
+
+    while (query.next())
+        posMap[query.value(0).toULongLong()] = query.value(1).toULongLong();
+
+    // Maps saved with SeekTableBlobStorage enabled, these take precedence
+    // over any rows left from before the setting was changed.
+    query.prepare("SELECT data FROM recordedseekblob"
+                  " WHERE chanid = :CHANID"
+                  " AND starttime = :STARTTIME"
+                  " AND type = :TYPE"
+                  " ORDER BY segment ;");
+    query.bindValue(":CHANID",    chanid);
+    query.bindValue(":STARTTIME", recstartts);
+    query.bindValue(":TYPE",      type);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("position map blob load", query);
+        return false;
+    }
+
+    bool ok = true;
+    while (query.next())
+        ok &= pmap_decode(query.value(0).toByteArray(), posMap);
+
+    return ok;
+}
+
+/// Adds posMap as the given recordedseekblob segment of a recording.
+static bool pmap_insert_segment(
+    MSqlQuery &query, uint chanid, const QDateTime &recstartts,
+    MarkTypes type, uint segment, const frm_pos_map_t &posMap)
+{
+    query.prepare(
+        "INSERT INTO recordedseekblob "
+        "    (chanid, starttime, type, segment, data) "
+        "VALUES ( :CHANID, :STARTTIME, :TYPE, :SEGMENT, :DATA )");
+    query.bindValue(":CHANID",    chanid);
+    query.bindValue(":STARTTIME", recstartts);
+    query.bindValue(":TYPE",      type);
+    query.bindValue(":SEGMENT",   segment);
+    query.bindValue(":DATA",      pmap_encode(posMap));
+
+    if (!query.exec())
+    {
+        MythDB::DBError("position map blob save", query);
+        return false;
+    }
+    return true;
+}
+
+/** \brief Replaces the stored position map of a recording, rows and
+ *         segments alike, with posMap as a single segment.
+ *
+ *   The seek tables must be locked with pmap_lock().
+ */
+static bool pmap_rewrite(
+    MSqlQuery &query, uint chanid, const QDateTime &recstartts,
+    MarkTypes type, const frm_pos_map_t &posMap)
+{
+    static const char *tables[] = { "recordedseek", "recordedseekblob" };
+
+    for (uint i = 0; i < sizeof(tables) / sizeof(char*); i++)
+    {
+        query.prepare(QString("DELETE FROM %1"
+                              " WHERE chanid = :CHANID"
+                              " AND starttime = :STARTTIME"
+                              " AND type = :TYPE ;").arg(tables[i]));
+        query.bindValue(":CHANID",    chanid);
+        query.bindValue(":STARTTIME", recstartts);
+        query.bindValue(":TYPE",      type);
+
+        if (!query.exec())
+        {
+            MythDB::DBError("position map clear", query);
+            return false;
+        }
+    }
+
+    return pmap_insert_segment(query, chanid, recstartts, type, 0, posMap);
+}
+
+/** \brief Appends posMap as a new recordedseekblob segment after the
+ *         stored ones.
+ *
+ *   Appending only writes the new entries instead of rewriting the
+ *   whole map. The segment number is picked under the lock, so that
+ *   concurrent writers each get their own.
+ */
+static bool pmap_append(
+    uint chanid, const QDateTime &recstartts, MarkTypes type,
+    const frm_pos_map_t &posMap)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+    if (!pmap_lock(query))
+        return false;
+
+    query.prepare(
+        "SELECT MAX(segment) FROM recordedseekblob"
+        " WHERE chanid = :CHANID"
+        " AND starttime = :STARTTIME"
+        " AND type = :TYPE ;");
+    query.bindValue(":CHANID",    chanid);
+    query.bindValue(":STARTTIME", recstartts);
+    query.bindValue(":TYPE",      type);
+
+    bool ok = query.exec();
+    if (!ok)
+        MythDB::DBError("position map blob segment", query);
+
+    uint segment = 0;
+    if (ok && query.next() && !query.value(0).isNull())
+        segment = query.value(0).toUInt() + 1;
+
+    ok = ok && pmap_insert_segment(
+        query, chanid, recstartts, type, segment, posMap);
+
+    return pmap_unlock(query, ok);
+}
+
 void ProgramInfo::QueryPositionMap(
     frm_pos_map_t &posMap, MarkTypes type) const
 {
@@ -2955,26 +3227,20 @@ void ProgramInfo::QueryPositionMap(
     posMap.clear();
     MSqlQuery query(MSqlQuery::InitCon());
 
-    if (IsVideo())
-    {
-        query.prepare("SELECT mark, offset FROM filemarkup"
-                      " WHERE filename = :PATH"
-                      " AND type = :TYPE ;");
-        query.bindValue(":PATH", StorageGroup::GetRelativePathname(pathname));
-    }
-    else if (IsRecording())
-    {
-        query.prepare("SELECT mark, offset FROM recordedseek"
-                      " WHERE chanid = :CHANID"
-                      " AND starttime = :STARTTIME"
-                      " AND type = :TYPE ;");
-        query.bindValue(":CHANID", chanid);
-        query.bindValue(":STARTTIME", recstartts);
-    }
-    else
+    if (IsRecording())
     {
+        if (!pmap_load(query, chanid, recstartts, type, posMap))
+            VERBOSE(VB_IMPORTANT, LOC_ERR + "Failed to load the position map");
         return;
     }
+
+    if (!IsVideo())
+        return;
+
+    query.prepare("SELECT mark, offset FROM filemarkup"
+                  " WHERE filename = :PATH"
+                  " AND type = :TYPE ;");
+    query.bindValue(":PATH", StorageGroup::GetRelativePathname(pathname));
     query.bindValue(":TYPE", type);
 
     if (!query.exec())
@@ -3023,6 +3289,20 @@ void ProgramInfo::ClearPositionMap(MarkTypes type) const
 
     if (!query.exec())
         MythDB::DBError("clear position map", query);
+
+    if (!IsRecording())
+        return;
+
+    query.prepare("DELETE FROM recordedseekblob"
+                  " WHERE chanid = :CHANID"
+                  " AND starttime = :STARTTIME"
+                  " AND type = :TYPE ;");
+    query.bindValue(":CHANID", chanid);
+    query.bindValue(":STARTTIME", recstartts);
+    query.bindValue(":TYPE", type);
+
+    if (!query.exec())
+        MythDB::DBError("clear position map blob", query);
 }
 
 void ProgramInfo::SavePositionMap(
@@ -3073,6 +3353,49 @@ void ProgramInfo::SavePositionMap(
         return;
     }
 
+    if (IsRecording() && use_seek_blob())
+    {
+        MSqlQuery query(MSqlQuery::InitCon());
+        if (!pmap_lock(query))
+            return;
+
+        // Rows and segments are all replaced by newMap, so a map that
+        // fails to load must be kept rather than saved without its tail.
+        frm_pos_map_t newMap;
+        if (((min_frame >= 0) || (max_frame >= 0)) &&
+            !pmap_load(query, chanid, recstartts, type, newMap))
+        {
+            VERBOSE(VB_IMPORTANT, LOC_ERR + "Failed to load the position "
+                    "map, keeping the stored one");
+            pmap_unlock(query, false);
+            return;
+        }
+
+        frm_pos_map_t::iterator nit = newMap.begin();
+        if (min_frame >= 0)
+            nit = newMap.lowerBound(min_frame);
+        while (nit != newMap.end() &&
+               ((max_frame < 0) || (nit.key() <= (uint64_t)max_frame)))
+        {
+            nit = newMap.erase(nit);
+        }
+
+        frm_pos_map_t::const_iterator it = posMap.begin();
+        for (; it != posMap.end(); ++it)
+        {
+            uint64_t frame = it.key();
+            if ((min_frame >= 0) && (frame < (uint64_t)min_frame))
+                continue;
+            if ((max_frame >= 0) && (frame > (uint64_t)max_frame))
+                continue;
+            newMap[frame] = *it;
+        }
+
+        pmap_unlock(query,
+                    pmap_rewrite(query, chanid, recstartts, type, newMap));
+        return;
+    }
+
     MSqlQuery query(MSqlQuery::InitCon());
     QString comp;
 
@@ -3174,6 +3497,13 @@ void ProgramInfo::SavePositionMapDelta(
         return;
     }
 
+    if (IsRecording() && use_seek_blob())
+    {
+        if (!posMap.empty())
+            pmap_append(chanid, recstartts, type, posMap);
+        return;
+    }
+
     MSqlQuery query(MSqlQuery::InitCon());
 
     if (IsVideo())
@@ -3216,6 +3546,55 @@ void ProgramInfo::SavePositionMapDelta(
     }
 }
 
+/** \fn ProgramInfo::CompactPositionMap(void) const
+ *  \brief Merges the recordedseekblob segments SavePositionMapDelta()
+ *         appended while recording into a single one.
+ *
+ *   Called once the recording has ended. A map with a segment that
+ *   fails to decode is left as it is.
+ */
+void ProgramInfo::CompactPositionMap(void) const
+{
+    if (positionMapDBReplacement || !IsRecording())
+        return;
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT type FROM recordedseekblob"
+                  " WHERE chanid = :CHANID"
+                  " AND starttime = :STARTTIME"
+                  " GROUP BY type"
+                  " HAVING COUNT(*) > 1 ;");
+    query.bindValue(":CHANID", chanid);
+    query.bindValue(":STARTTIME", recstartts);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("position map compact", query);
+        return;
+    }
+
+    QList<MarkTypes> types;
+    while (query.next())
+        types.push_back((MarkTypes)query.value(0).toInt());
+
+    for (int i = 0; i < types.size(); i++)
+    {
+        if (!pmap_lock(query))
+            return;
+
+        frm_pos_map_t posMap;
+        bool ok = pmap_load(query, chanid, recstartts, types[i], posMap);
+        if (!ok)
+        {
+            VERBOSE(VB_IMPORTANT, LOC_ERR + "Failed to load the position "
+                    "map, not compacting it");
+        }
+
+        ok = ok && pmap_rewrite(query, chanid, recstartts, types[i], posMap);
+        pmap_unlock(query, ok);
+    }
+}
+
 /// \brief Store aspect ratio of a frame in the recordedmark table
 /// \note  All frames until the next one with a stored aspect ratio
 ///        are assumed to have the same aspect ratio
@@ -3993,8 +4372,10 @@ QStringList ProgramInfo::LoadFromScheduler(
         (tmptable.isEmpty()) ?
         QString("QUERY_GETALLPENDING") :
         QString("QUERY_GETALLPENDING %1 %2").arg(tmptable).arg(recordid));
+    ProgramListCodec::Request(slist);
 
-    if (!gCoreContext->SendReceiveStringList(slist) || slist.size() < 2)
+    if (!gCoreContext->SendReceiveStringList(slist) || slist.size() < 2 ||
+        !ProgramListCodec::Decode(slist, 2))
     {
         VERBOSE(VB_IMPORTANT,
                 "LoadFromScheduler(): Error querying master.");
@@ -24,6 +24,7 @@
    mythtv/bindings/perl/MythTV.pm
    mythtv/bindings/perl/MythTV/Program.pm
    mythtv/bindings/python/MythTV/MythData.py
+   mythtv/libs/libmyth/programlistcodec.cpp
 */
 #define NUMPROGRAMLINES 41
 
@@ -447,6 +448,7 @@ class MPUBLIC ProgramInfo
     void SetHostname(      const QString &host)     { hostname     = host;  }
     void SetStorageGroup(  const QString &group)    { storagegroup = group; }
     void SetFilesize(      uint64_t       sz)       { filesize     = sz;    }
+    void SetProgramFlags(  uint32_t    flags)       { programflags = flags; }
     void SetSeriesID(      const QString &id)       { seriesid     = id;    }
     void SetProgramID(     const QString &id)       { programid    = id;    }
     void SetCategoryType(  const QString &type)     { catType      = type;  }
@@ -547,6 +549,7 @@ class MPUBLIC ProgramInfo
     void SavePositionMap(frm_pos_map_t &, MarkTypes type,
                          int64_t min_frm = -1, int64_t max_frm = -1) const;
     void SavePositionMapDelta(frm_pos_map_t &, MarkTypes type) const;
+    void CompactPositionMap(void) const;
 
     /// Sends event out that the ProgramInfo should be reloaded.
     void SendUpdateEvent(void);
@@ -0,0 +1,290 @@
+// ANSI C headers
+#include <stdint.h>
+
+// Qt headers
+#include <QByteArray>
+#include <QHash>
+#include <QTime>
+
+// MythTV headers
+#include "programlistcodec.h"
+#include "programinfo.h"
+#include "mythverbose.h"
+
+#define LOC     QString("ProgramListCodec: ")
+#define LOC_ERR QString("ProgramListCodec, Error: ")
+
+const QString ProgramListCodec::kToken   = "COMPACT_PROGRAMINFO";
+const uint    ProgramListCodec::kVersion = 1;
+
+/// Payloads smaller than this are not worth compressing
+static const int kCompressThreshold = 1024;
+
+/// Set in the flags entry when the payload is zlib compressed
+static const uint kFlagZlib = 0x1;
+
+/// Fields of ProgramInfo::ToStringList() which are integers. Any other
+/// field, or an integer field whose text does not round trip through
+/// QString::number(), is sent as a string.
+static const bool kIntField[NUMPROGRAMLINES] =
+{
+    false, false, false, false, true,  // 0-4   title .. chanid
+    false, false, false, false, true,  // 5-9   chanstr .. filesize
+    true,  true,  true,  false, true,  // 10-14 startts .. sourceid
+    true,  true,  true,  true,  true,  // 15-19 cardid .. recordid
+    true,  true,  true,  true,  true,  // 20-24 rectype .. recendts
+    true,  false, false, false, false, // 25-29 programflags .. programid
+    true,  false, false, false, true,  // 30-34 lastmodified .. recpriority2
+    true,  false, true,  true,  true,  // 35-39 parentid .. subtitletype
+    true,                              // 40    year
+};
+
+static inline void put_varint(QByteArray &buf, uint64_t val)
+{
+    while (val >= 0x80)
+    {
+        buf.append((char)((val & 0x7f) | 0x80));
+        val >>= 7;
+    }
+    buf.append((char)val);
+}
+
+static inline bool get_varint(const QByteArray &buf, int &pos, uint64_t &val)
+{
+    val = 0;
+    for (uint shift = 0; shift < 64; shift += 7)
+    {
+        if (pos >= buf.size())
+            return false;
+        unsigned char c = buf[pos++];
+        val |= ((uint64_t)(c & 0x7f)) << shift;
+        if (!(c & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static inline uint64_t zigzag(int64_t val)
+{
+    return (((uint64_t)val) << 1) ^ ((uint64_t)(val >> 63));
+}
+
+static inline int64_t unzigzag(uint64_t val)
+{
+    return (int64_t)(val >> 1) ^ -((int64_t)(val & 1));
+}
+
+/// Appends Request() to a command so the backend may reply compactly.
+void ProgramListCodec::Request(QStringList &request)
+{
+    request << QString("%1 %2").arg(kToken).arg(kVersion);
+}
+
+/// Returns true if the command was sent with Request() appended.
+bool ProgramListCodec::IsRequested(const QStringList &request)
+{
+    QString want = QString("%1 %2").arg(kToken).arg(kVersion);
+    for (int i = 1; i < request.size(); i++)
+    {
+        if (request[i] == want)
+            return true;
+    }
+    return false;
+}
+
+/** \fn ProgramListCodec::Encode(QStringList&,uint,uint)
+ *  \brief Replaces count serialized programs starting at offset with
+ *         the compact encoding.
+ *
+ *   The run is replaced by five entries: kToken, the version, the
+ *   flags, the program count and the base64 encoded payload.
+ *
+ *  \return false if the list does not hold count programs at offset,
+ *          the list is left untouched in that case.
+ */
+bool ProgramListCodec::Encode(QStringList &list, uint offset, uint count)
+{
+    uint end = offset + count * NUMPROGRAMLINES;
+    if (!count || end > (uint)list.size())
+        return false;
+
+    QTime timer;
+    timer.start();
+
+    QByteArray raw;
+    raw.reserve(count * 64);
+
+    QHash<QString,uint> strings;
+    int64_t prev[NUMPROGRAMLINES];
+    for (uint i = 0; i < NUMPROGRAMLINES; i++)
+        prev[i] = 0;
+
+    uint plain_bytes = 0;
+    for (uint i = offset; i < end; i++)
+    {
+        const QString &str = list[i];
+        uint field = (i - offset) % NUMPROGRAMLINES;
+
+        if (VERBOSE_LEVEL_CHECK(VB_NETWORK|VB_EXTRA))
+            plain_bytes += str.toUtf8().size() + 5; // 5 for "[]:[]"
+
+        // Integers are tagged with a clear low bit and delta coded,
+        // string table references are tagged with a set low bit.
+        if (kIntField[field])
+        {
+            bool ok;
+            int64_t val = str.toLongLong(&ok);
+            uint64_t delta = zigzag(val - prev[field]);
+            if (ok && !(delta >> 63) && QString::number(val) == str)
+            {
+                put_varint(raw, delta << 1);
+                prev[field] = val;
+                continue;
+            }
+        }
+
+        QHash<QString,uint>::const_iterator it = strings.find(str);
+        if (it != strings.end())
+        {
+            put_varint(raw, ((uint64_t)*it << 1) | 1);
+            continue;
+        }
+
+        // A reference to the next free index defines a new string
+        uint idx = strings.size();
+        strings[str] = idx;
+        QByteArray utf8 = str.toUtf8();
+        put_varint(raw, ((uint64_t)idx << 1) | 1);
+        put_varint(raw, utf8.size());
+        raw.append(utf8);
+    }
+
+    uint flags = 0;
+    QByteArray payload = raw;
+    if (raw.size() >= kCompressThreshold)
+    {
+        QByteArray compressed = qCompress(raw);
+        if (compressed.size() < raw.size())
+        {
+            payload = compressed;
+            flags |= kFlagZlib;
+        }
+    }
+
+    QStringList encoded;
+    encoded << kToken
+            << QString::number(kVersion)
+            << QString::number(flags)
+            << QString::number(count)
+            << QString(payload.toBase64());
+
+    list = list.mid(0, offset) + encoded + list.mid(end);
+
+    if (VERBOSE_LEVEL_CHECK(VB_NETWORK|VB_EXTRA))
+    {
+        VERBOSE(VB_NETWORK|VB_EXTRA, LOC +
+                QString("Encoded %1 programs in %2 ms: %3 strings "
+                        "(%4 bytes) as %5 bytes, %6 unique strings%7")
+                .arg(count).arg(timer.elapsed())
+                .arg(count * NUMPROGRAMLINES).arg(plain_bytes)
+                .arg(encoded.back().size()).arg(strings.size())
+                .arg((flags & kFlagZlib) ? ", zlib" : ""));
+    }
+
+    return true;
+}
+
+/** \fn ProgramListCodec::Decode(QStringList&,uint)
+ *  \brief Expands a compact encoding at offset back into serialized
+ *         programs.
+ *
+ *   Strings from the string table are implicitly shared between the
+ *   programs that use them. A list that is not encoded is left as is.
+ *
+ *  \return false if the encoding at offset is invalid or of an
+ *          unsupported version.
+ */
+bool ProgramListCodec::Decode(QStringList &list, uint offset)
+{
+    if (!IsEncoded(list, offset))
+        return true;
+
+    if (offset + 5 > (uint)list.size())
+    {
+        VERBOSE(VB_IMPORTANT, LOC_ERR + "Truncated header");
+        return false;
+    }
+
+    QTime timer;
+    timer.start();
+
+    uint version = list[offset + 1].toUInt();
+    uint flags   = list[offset + 2].toUInt();
+    uint count   = list[offset + 3].toUInt();
+
+    if (version != kVersion)
+    {
+        VERBOSE(VB_IMPORTANT, LOC_ERR +
+                QString("Unsupported version %1").arg(version));
+        return false;
+    }
+
+    QByteArray raw = QByteArray::fromBase64(list[offset + 4].toLatin1());
+    if (flags & kFlagZlib)
+        raw = qUncompress(raw);
+
+    QStringList decoded;
+
+    QStringList strings;
+    int64_t prev[NUMPROGRAMLINES];
+    for (uint i = 0; i < NUMPROGRAMLINES; i++)
+        prev[i] = 0;
+
+    int pos = 0;
+    for (uint i = 0; i < count * NUMPROGRAMLINES; i++)
+    {
+        uint field = i % NUMPROGRAMLINES;
+
+        uint64_t tag;
+        if (!get_varint(raw, pos, tag))
+        {
+            VERBOSE(VB_IMPORTANT, LOC_ERR + "Truncated payload");
+            return false;
+        }
+
+        if (!(tag & 1))
+        {
+            int64_t val = prev[field] + unzigzag(tag >> 1);
+            decoded << QString::number(val);
+            prev[field] = val;
+            continue;
+        }
+
+        uint64_t idx = tag >> 1;
+        if (idx < (uint64_t)strings.size())
+        {
+            decoded << strings[idx];
+            continue;
+        }
+
+        uint64_t len;
+        if ((idx != (uint64_t)strings.size()) ||
+            !get_varint(raw, pos, len) || (len > (uint64_t)(raw.size() - pos)))
+        {
+            VERBOSE(VB_IMPORTANT, LOC_ERR + "Invalid string reference");
+            return false;
+        }
+
+        strings << QString::fromUtf8(raw.constData() + pos, len);
+        pos += len;
+        decoded << strings.back();
+    }
+
+    list = list.mid(0, offset) + decoded + list.mid(offset + 5);
+
+    VERBOSE(VB_NETWORK|VB_EXTRA, LOC +
+            QString("Decoded %1 programs from %2 bytes in %3 ms")
+            .arg(count).arg(raw.size()).arg(timer.elapsed()));
+
+    return true;
+}
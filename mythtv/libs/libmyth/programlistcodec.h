@@ -0,0 +1,43 @@
+#ifndef _PROGRAM_LIST_CODEC_H_
+#define _PROGRAM_LIST_CODEC_H_
+
+// Qt headers
+#include <QStringList>
+
+// MythTV headers
+#include "mythexp.h"
+
+/** \class ProgramListCodec
+ *  \brief Compact encoding for a run of serialized ProgramInfo in a
+ *         protocol reply.
+ *
+ *   ProgramInfo::ToStringList() produces NUMPROGRAMLINES strings per
+ *   program. For replies carrying thousands of programs this codec
+ *   replaces that run with a single binary payload. Integer fields are
+ *   sent as varints, delta coded against the previous program, and all
+ *   other fields go through a string table so repeated titles, channels
+ *   and hostnames are only sent once. Large payloads are zlib compressed.
+ *
+ *   A client asks for it by appending Request() to its command, and the
+ *   backend only encodes a reply when IsRequested() is true. Decode()
+ *   restores the string list layout, so existing parsers are unchanged.
+ */
+class MPUBLIC ProgramListCodec
+{
+  public:
+    static void Request(QStringList &request);
+    static bool IsRequested(const QStringList &request);
+
+    static bool Encode(QStringList &list, uint offset, uint count);
+    static bool Decode(QStringList &list, uint offset);
+
+    static bool IsEncoded(const QStringList &list, uint offset)
+    {
+        return (offset < (uint)list.size()) && (list[offset] == kToken);
+    }
+
+    static const QString kToken;
+    static const uint    kVersion;
+};
+
+#endif // _PROGRAM_LIST_CODEC_H_
@@ -6,6 +6,7 @@
 
 #include "remoteutil.h"
 #include "programinfo.h"
+#include "programlistcodec.h"
 #include "mythcorecontext.h"
 #include "decodeencode.h"
 #include "storagegroup.h"
@@ -20,6 +21,7 @@ vector<ProgramInfo *> *RemoteGetRecordedList(bool deltype)
         str += "Play";
 
     QStringList strlist(str);
+    ProgramListCodec::Request(strlist);
 
     vector<ProgramInfo *> *info = new vector<ProgramInfo *>;
 
@@ -184,6 +186,7 @@ bool RemoteUndeleteRecording(uint chanid, const QDateTime &recstartts)
 void RemoteGetAllScheduledRecordings(vector<ProgramInfo *> &scheduledlist)
 {
     QStringList strList(QString("QUERY_GETALLSCHEDULED"));
+    ProgramListCodec::Request(strList);
     RemoteGetRecordingList(scheduledlist, strList);
 }
 
@@ -199,6 +202,9 @@ uint RemoteGetRecordingList(
     if (!gCoreContext->SendReceiveStringList(strList))
         return 0;
 
+    if (!ProgramListCodec::Decode(strList, 1))
+        return 0;
+
     int numrecordings = strList[0].toInt();
     if (numrecordings <= 0)
         return 0;
@@ -594,6 +600,7 @@ vector<ProgramInfo *> *RemoteGetCurrentlyRecordingList(void)
     QString str = "QUERY_RECORDINGS ";
     str += "Recording";
     QStringList strlist( str );
+    ProgramListCodec::Request(strlist);
 
     vector<ProgramInfo *> *reclist = new vector<ProgramInfo *>;
     vector<ProgramInfo *> *info = new vector<ProgramInfo *>;
@@ -14,6 +14,15 @@
 #include <sys/types.h>  // for fnctl
 #include <fcntl.h>      // for fnctl
 #include <errno.h>      // for checking errno
+#include <string.h>     // for memset
+
+#if HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>  // for epoll_create, epoll_ctl, epoll_wait
+#endif
+#if HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h> // for eventfd
+#include <stdint.h>      // for uint64_t
+#endif
 
 #ifndef O_NONBLOCK
 #define O_NONBLOCK 0 /* not actually supported in MINGW */
@@ -33,9 +42,11 @@
 static void setup_pipe(int mypipe[2], long flags[2]);
 
 const uint MythSocketThread::kShortWait = 100;
+const int  MythSocketThread::kMaxEpollEvents = 64;
 
 MythSocketThread::MythSocketThread()
-    : QThread(), m_readyread_run(false)
+    : QThread(), m_readyread_run(false),
+      m_readyread_eventfd(-1), m_epoll_fd(-1)
 {
     for (int i = 0; i < 2; i++)
     {
@@ -74,6 +85,18 @@ void MythSocketThread::CloseReadyReadPipe(void) const
             m_readyread_pipe_flags[i] = 0;
         }
     }
+
+    if (m_readyread_eventfd >= 0)
+    {
+        ::close(m_readyread_eventfd);
+        m_readyread_eventfd = -1;
+    }
+
+    if (m_epoll_fd >= 0)
+    {
+        ::close(m_epoll_fd);
+        m_epoll_fd = -1;
+    }
 }
 
 void MythSocketThread::StartReadyReadThread(void)
@@ -82,7 +105,8 @@ void MythSocketThread::StartReadyReadThread(void)
     if (!m_readyread_run)
     {
         atexit(ShutdownRRT);
-        setup_pipe(m_readyread_pipe, m_readyread_pipe_flags);
+        if (!SetupEpoll())
+            setup_pipe(m_readyread_pipe, m_readyread_pipe_flags);
         m_readyread_run = true;
         start();
         m_readyread_started_wait.wait(&m_readyread_lock);
@@ -126,6 +150,22 @@ void MythSocketThread::WakeReadyReadThread(void) const
     QMutexLocker locker(&m_readyread_lock);
     m_readyread_wait.wakeAll();
 
+#if HAVE_SYS_EVENTFD_H
+    if (m_readyread_eventfd >= 0)
+    {
+        uint64_t val = 1;
+        ssize_t wret = -1;
+        while (wret < 0)
+        {
+            wret = ::write(m_readyread_eventfd, &val, sizeof(val));
+            // EAGAIN means the counter is saturated, so a wakeup is pending
+            if ((wret < 0) && (EINTR != errno))
+                break;
+        }
+        return;
+    }
+#endif
+
     if (m_readyread_pipe[1] < 0)
         return;
 
@@ -175,6 +215,25 @@ void MythSocketThread::ProcessAddRemoveQueues(void)
 
         if (m_readyread_list.removeAll(sock))
             m_readyread_downref_list.push_back(sock);
+
+#if HAVE_SYS_EPOLL_H
+        QMap<MythSocket*,EpollEntry>::iterator eit =
+            m_epoll_entries.find(sock);
+        if (eit == m_epoll_entries.end())
+            continue;
+
+        // Only deregister if the descriptor still belongs to this socket,
+        // a closed descriptor is dropped from the epoll set by the kernel
+        // and its number may already have been reused by another socket.
+        if ((*eit).fd >= 0 && (*eit).fd == sock->socket())
+        {
+            struct epoll_event ev;
+            memset(&ev, 0, sizeof(ev));
+            epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, (*eit).fd, &ev);
+        }
+        m_epoll_entries.erase(eit);
+        m_epoll_disarmed.removeAll(sock);
+#endif
     }
 
     while (!m_readyread_addlist.empty())
@@ -182,10 +241,45 @@ void MythSocketThread::ProcessAddRemoveQueues(void)
         MythSocket *sock = m_readyread_addlist.front();
         m_readyread_addlist.pop_front();
         m_readyread_list.push_back(sock);
+
+        if (m_epoll_fd >= 0 && !m_epoll_entries.contains(sock))
+        {
+            m_epoll_entries[sock] = EpollEntry();
+            m_epoll_disarmed.push_back(sock);
+        }
     }
 }
 
+uint MythSocketThread::ProcessDownRefList(void)
+{
+    if (m_readyread_downref_list.empty())
+        return 0;
+
+    VERBOSE(VB_SOCKET|VB_EXTRA, "Deleting stale sockets");
+
+    QTime tm = QTime::currentTime();
+    QList<MythSocket*>::const_iterator it = m_readyread_downref_list.begin();
+    for (; it != m_readyread_downref_list.end(); ++it)
+        (*it)->DownRef();
+    m_readyread_downref_list.clear();
+
+    return tm.elapsed();
+}
+
 void MythSocketThread::run(void)
+{
+#if HAVE_SYS_EPOLL_H
+    if (m_epoll_fd >= 0)
+    {
+        RunEpoll();
+        return;
+    }
+#endif
+
+    RunSelect();
+}
+
+void MythSocketThread::RunSelect(void)
 {
     VERBOSE(VB_SOCKET, "MythSocketThread: readyread thread start");
 
@@ -316,20 +410,7 @@ void MythSocketThread::run(void)
         // Actually read some data! This is a form of co-operative
         // multitasking so the ready read handlers should be quick..
 
-        uint downref_tm = 0;
-        if (!m_readyread_downref_list.empty())
-        {
-            VERBOSE(VB_SOCKET|VB_EXTRA, "Deleting stale sockets");
-
-            QTime tm = QTime::currentTime();
-            for (it = m_readyread_downref_list.begin();
-                 it != m_readyread_downref_list.end(); ++it)
-            {
-                (*it)->DownRef();
-            }
-            m_readyread_downref_list.clear();
-            downref_tm = tm.elapsed();
-        }
+        uint downref_tm = ProcessDownRefList();
 
         VERBOSE(VB_SOCKET|VB_EXTRA, "Processing ready reads");
 
@@ -375,6 +456,322 @@ void MythSocketThread::run(void)
     VERBOSE(VB_SOCKET, "MythSocketThread: readyread thread exit");
 }
 
+#if HAVE_SYS_EPOLL_H
+
+/** \fn MythSocketThread::SetupEpoll(void)
+ *  \brief Creates the epoll set and its wakeup descriptor.
+ *
+ *   The wakeup descriptor is an eventfd where available and the
+ *   readyread pipe otherwise. It is registered with a NULL data pointer
+ *   so RunEpoll() can tell it apart from the sockets.
+ *
+ *  \return false if epoll can not be used, run() then uses select().
+ */
+bool MythSocketThread::SetupEpoll(void)
+{
+    m_epoll_fd = epoll_create(kMaxEpollEvents);
+    if (m_epoll_fd < 0)
+    {
+        VERBOSE(VB_IMPORTANT, "MythSocketThread: epoll_create failed, "
+                "falling back to select" + ENO);
+        return false;
+    }
+
+    int wake_fd = -1;
+#if HAVE_SYS_EVENTFD_H
+    m_readyread_eventfd = eventfd(0, 0);
+    if (m_readyread_eventfd >= 0)
+    {
+        long flags = fcntl(m_readyread_eventfd, F_GETFL);
+        if (flags < 0 ||
+            fcntl(m_readyread_eventfd, F_SETFL, flags|O_NONBLOCK) < 0)
+        {
+            ::close(m_readyread_eventfd);
+            m_readyread_eventfd = -1;
+        }
+    }
+    wake_fd = m_readyread_eventfd;
+#endif
+
+    if (wake_fd < 0)
+    {
+        setup_pipe(m_readyread_pipe, m_readyread_pipe_flags);
+        if (m_readyread_pipe_flags[0] & O_NONBLOCK)
+            wake_fd = m_readyread_pipe[0];
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+
+    if (wake_fd < 0 || epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev) < 0)
+    {
+        VERBOSE(VB_IMPORTANT, "MythSocketThread: Failed to register "
+                "wakeup descriptor, falling back to select" + ENO);
+        CloseReadyReadPipe();
+        return false;
+    }
+
+    VERBOSE(VB_SOCKET, QString("MythSocketThread: using epoll, woken by %1")
+            .arg((m_readyread_eventfd >= 0) ? "eventfd" : "pipe"));
+
+    return true;
+}
+
+/** \fn MythSocketThread::EpollArm(MythSocket*,EpollEntry&)
+ *  \brief Requests one readiness notification for the socket.
+ *
+ *   Registrations are level triggered and one-shot: the kernel reports
+ *   a readable socket once and then stays quiet until it is re-armed.
+ *   Re-arming re-checks readiness, so data left unread from a previous
+ *   notification is reported again right away.
+ *
+ *   Must be called with the socket locked.
+ */
+bool MythSocketThread::EpollArm(MythSocket *sock, EpollEntry &entry)
+{
+    int fd = sock->socket();
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.ptr = sock;
+
+    // A new descriptor needs to be added, the old one is either still
+    // registered to us or was dropped from the set when it was closed.
+    int op = (entry.fd == fd) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    int ret = epoll_ctl(m_epoll_fd, op, fd, &ev);
+    if (ret < 0 && op == EPOLL_CTL_MOD && ENOENT == errno)
+        ret = epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+    else if (ret < 0 && op == EPOLL_CTL_ADD && EEXIST == errno)
+        ret = epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+
+    if (ret < 0)
+    {
+        VERBOSE(VB_SOCKET, SLOC(sock) + "epoll_ctl failed" + ENO);
+        return false;
+    }
+
+    entry.fd    = fd;
+    entry.armed = true;
+    return true;
+}
+
+/** \fn MythSocketThread::EpollArmSockets(bool)
+ *  \brief Re-arms the sockets that have no notification pending.
+ *
+ *   Only sockets that have fired since they were last armed are visited.
+ *   A socket stays disarmed while it is locked by another thread or
+ *   while its last readyRead() notification has not been consumed yet.
+ *
+ *  \param sweep Also check armed sockets for a changed descriptor, this
+ *                catches sockets that were closed and reconnected.
+ *  \return true if a disarmed socket is waiting on another thread,
+ *          in which case the caller should not sleep indefinitely.
+ */
+bool MythSocketThread::EpollArmSockets(bool sweep)
+{
+    if (sweep)
+    {
+        QMap<MythSocket*,EpollEntry>::iterator eit = m_epoll_entries.begin();
+        for (; eit != m_epoll_entries.end(); ++eit)
+        {
+            if ((*eit).armed && eit.key()->socket() != (*eit).fd)
+            {
+                (*eit).armed = false;
+                m_epoll_disarmed.push_back(eit.key());
+            }
+        }
+    }
+
+    bool waiting = false;
+    QList<MythSocket*>::iterator it = m_epoll_disarmed.begin();
+    while (it != m_epoll_disarmed.end())
+    {
+        MythSocket *sock = *it;
+        QMap<MythSocket*,EpollEntry>::iterator eit = m_epoll_entries.find(sock);
+        if (eit == m_epoll_entries.end() || (*eit).armed)
+        {
+            it = m_epoll_disarmed.erase(it);
+            continue;
+        }
+
+        if (!sock->TryLock(false))
+        {
+            waiting = true;
+            ++it;
+            continue;
+        }
+
+        bool armed = false;
+        if (sock->socket() >= 0 && sock->state() == MythSocket::Connected)
+        {
+            if (sock->m_notifyread)
+                waiting = true;
+            else
+                armed = EpollArm(sock, *eit);
+        }
+        sock->Unlock(false);
+
+        if (armed)
+            it = m_epoll_disarmed.erase(it);
+        else
+            ++it;
+    }
+
+    return waiting;
+}
+
+/** \fn MythSocketThread::RunEpoll(void)
+ *  \brief Event loop used when epoll is available.
+ *
+ *   Unlike RunSelect() this does not rebuild and scan a descriptor set
+ *   on every wakeup, the cost of each pass depends on the number of
+ *   sockets that became readable rather than on the number of sockets.
+ */
+void MythSocketThread::RunEpoll(void)
+{
+    VERBOSE(VB_SOCKET, "MythSocketThread: readyread thread start (epoll)");
+
+    struct epoll_event events[kMaxEpollEvents];
+    QList<MythSocket*> ready;
+    bool sweep = true;
+
+    QMutexLocker locker(&m_readyread_lock);
+    m_readyread_started_wait.wakeAll();
+    while (m_readyread_run)
+    {
+        ProcessAddRemoveQueues();
+
+        bool waiting = EpollArmSockets(sweep);
+        sweep = false;
+
+        // When a socket is waiting for another thread to lock or read it
+        // we poll, since MythSocket::readBlock() does not wake us up..
+        m_readyread_lock.unlock();
+        VERBOSE(VB_SOCKET|VB_EXTRA, "Waiting on epoll..");
+        int rval = epoll_wait(m_epoll_fd, events, kMaxEpollEvents,
+                              waiting ? (int)kShortWait : -1);
+        VERBOSE(VB_SOCKET|VB_EXTRA, "Got data on epoll");
+        m_readyread_lock.lock();
+
+        if (rval < 0)
+        {
+            if (EINTR != errno)
+            {
+                VERBOSE(VB_SOCKET,
+                        "MythSocketThread: epoll_wait returned error" + ENO);
+                m_readyread_wait.wait(&m_readyread_lock, kShortWait);
+            }
+            continue;
+        }
+
+        ready.clear();
+        for (int i = 0; i < rval; i++)
+        {
+            MythSocket *sock = (MythSocket*) events[i].data.ptr;
+            if (!sock)
+            {
+                // Drain the wakeup descriptor, the event itself has been
+                // taken care of at the top of the loop.
+                char dummy[128];
+                int wake_fd = (m_readyread_eventfd >= 0) ?
+                    m_readyread_eventfd : m_readyread_pipe[0];
+                if (::read(wake_fd, dummy, sizeof(dummy)) < 0)
+                {
+                    VERBOSE(VB_SOCKET|VB_EXTRA,
+                            "Strange.. failed to read event descriptor");
+                }
+                sweep = true;
+                continue;
+            }
+
+            QMap<MythSocket*,EpollEntry>::iterator eit =
+                m_epoll_entries.find(sock);
+            if (eit == m_epoll_entries.end())
+                continue;
+
+            (*eit).armed = false;
+            m_epoll_disarmed.push_back(sock);
+            ready.push_back(sock);
+        }
+
+        // ReadyToBeRead allows calls back into the socket so we need
+        // to release the lock for a little while.
+        // Sockets are only downref'd by this thread so those in ready
+        // remain valid until the next call to ProcessDownRefList().
+        m_readyread_lock.unlock();
+
+        uint downref_tm = ProcessDownRefList();
+
+        VERBOSE(VB_SOCKET|VB_EXTRA, "Processing ready reads");
+
+        QMap<uint,uint> timers;
+        QTime tm = QTime::currentTime();
+        QList<MythSocket*>::const_iterator it = ready.begin();
+        for (; it != ready.end() && m_readyread_run; ++it)
+        {
+            // if the socket is locked it will be re-armed once it is
+            // unlocked, and the kernel will report it again then.
+            if (!(*it)->TryLock(false))
+                continue;
+
+            int socket = (*it)->socket();
+
+            if (socket >= 0 && (*it)->state() == MythSocket::Connected)
+            {
+                QTime rrtm = QTime::currentTime();
+                ReadyToBeRead(*it);
+                timers[socket] = rrtm.elapsed();
+            }
+            (*it)->Unlock(false);
+        }
+
+        if (VERBOSE_LEVEL_CHECK(VB_SOCKET|VB_EXTRA))
+        {
+            QString rep = QString("Total read time: %1ms, on sockets")
+                .arg(tm.elapsed());
+            QMap<uint,uint>::const_iterator it = timers.begin();
+            for (; it != timers.end(); ++it)
+                rep += QString(" {%1,%2ms}").arg(it.key()).arg(*it);
+            if (downref_tm)
+                rep += QString(" {downref, %1ms}").arg(downref_tm);
+
+            VERBOSE(VB_SOCKET|VB_EXTRA, QString("MythSocketThread: ") + rep);
+        }
+
+        m_readyread_lock.lock();
+        VERBOSE(VB_SOCKET|VB_EXTRA, "Reacquired ready read lock");
+    }
+
+    VERBOSE(VB_SOCKET, "MythSocketThread: readyread thread exit");
+}
+
+#else // if !HAVE_SYS_EPOLL_H
+
+bool MythSocketThread::SetupEpoll(void)
+{
+    return false;
+}
+
+bool MythSocketThread::EpollArm(MythSocket*, EpollEntry&)
+{
+    return false;
+}
+
+bool MythSocketThread::EpollArmSockets(bool)
+{
+    return false;
+}
+
+void MythSocketThread::RunEpoll(void)
+{
+    RunSelect();
+}
+
+#endif // !HAVE_SYS_EPOLL_H
+
 #ifdef USING_MINGW
 static void setup_pipe(int[2], long[2]) {}
 #else
@@ -5,6 +5,7 @@
 #include <QThread>
 #include <QMutex>
 #include <QList>
+#include <QMap>
 
 class MythSocket;
 class MythSocketThread : public QThread
@@ -22,7 +23,21 @@ class MythSocketThread : public QThread
     void RemoveFromReadyRead(MythSocket *sock);
 
   private:
+    class EpollEntry
+    {
+      public:
+        EpollEntry() : fd(-1), armed(false) { }
+        int  fd;    ///< descriptor registered with epoll, or -1
+        bool armed; ///< one-shot read notification is pending in kernel
+    };
+
+    void RunSelect(void);
+    void RunEpoll(void);
+    bool SetupEpoll(void);
+    bool EpollArm(MythSocket *sock, EpollEntry &entry);
+    bool EpollArmSockets(bool sweep);
     void ProcessAddRemoveQueues(void);
+    uint ProcessDownRefList(void);
     void ReadyToBeRead(MythSocket *sock);
     void CloseReadyReadPipe(void) const;
 
@@ -33,13 +48,19 @@ class MythSocketThread : public QThread
 
     mutable int            m_readyread_pipe[2];
     mutable long           m_readyread_pipe_flags[2];
+    mutable int            m_readyread_eventfd;
+    mutable int            m_epoll_fd;
 
     QList<MythSocket*> m_readyread_list;
     QList<MythSocket*> m_readyread_dellist;
     QList<MythSocket*> m_readyread_addlist;
     QList<MythSocket*> m_readyread_downref_list;
 
+    QMap<MythSocket*,EpollEntry> m_epoll_entries;
+    QList<MythSocket*>           m_epoll_disarmed;
+
     static const uint kShortWait;
+    static const int  kMaxEpollEvents;
 };
 
 #endif // _MYTH_SOCKET_THREAD_H_
@@ -22,6 +22,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <complex>
 #include <cmath>
 #include <vector>
+#include "mythconfig.h"
+#if ARCH_X86
+#include "libmyth/audio/audiooutpututil.h"
+#endif
 #ifdef USE_FFTW3
 #include "fftw3.h"
 #else
@@ -43,6 +47,184 @@ static const float PI = 3.141592654;
 static const float epsilon = 0.000001;
 static const float center_level = 0.5*sqrt(0.5);
 
+// SSE versions of the per-sample loops; each handles multiples of 4 samples
+// and returns how many it did, the caller does the remainder in C
+#if ARCH_X86
+// out[k] = in[k] * wnd[k], or out[k] += in[k] * wnd[k] if accumulate is set;
+// with complex input only the real parts in[2k] are used
+static unsigned sse_window(float *out, const float *in, const float *wnd,
+                           unsigned n, bool accumulate, bool complex_in=false) {
+    int loops = n >> 2;
+    if (!AudioOutputUtil::has_hardware_fpu() || !loops)
+        return 0;
+    // the old output is masked rather than multiplied, so that whatever
+    // an uninitialised buffer holds cannot leak into the result
+    int keep = accumulate ? -1 : 0;
+    if (complex_in) {
+        __asm__ volatile (
+            "movss      %4, %%xmm7          \n\t"
+            "shufps     $0, %%xmm7, %%xmm7  \n\t"
+            "1:                             \n\t"
+            "movups     (%1), %%xmm0        \n\t"
+            "movups     16(%1), %%xmm1      \n\t"
+            "movups     (%2), %%xmm2        \n\t"
+            "movups     (%0), %%xmm3        \n\t"
+            "shufps     $0x88, %%xmm1, %%xmm0   \n\t"
+            "andps      %%xmm7, %%xmm3      \n\t"
+            "mulps      %%xmm2, %%xmm0      \n\t"
+            "addps      %%xmm3, %%xmm0      \n\t"
+            "movups     %%xmm0, (%0)        \n\t"
+            "add        $16, %0             \n\t"
+            "add        $32, %1             \n\t"
+            "add        $16, %2             \n\t"
+            "sub        $1, %%ecx           \n\t"
+            "jnz        1b                  \n\t"
+            :"+r"(out), "+r"(in), "+r"(wnd), "+c"(loops)
+            :"m"(keep)
+            :"memory", "xmm0", "xmm1", "xmm2", "xmm3", "xmm7"
+        );
+    } else {
+        __asm__ volatile (
+            "movss      %4, %%xmm7          \n\t"
+            "shufps     $0, %%xmm7, %%xmm7  \n\t"
+            "1:                             \n\t"
+            "movups     (%1), %%xmm0        \n\t"
+            "movups     (%2), %%xmm2        \n\t"
+            "movups     (%0), %%xmm3        \n\t"
+            "andps      %%xmm7, %%xmm3      \n\t"
+            "mulps      %%xmm2, %%xmm0      \n\t"
+            "addps      %%xmm3, %%xmm0      \n\t"
+            "movups     %%xmm0, (%0)        \n\t"
+            "add        $16, %0             \n\t"
+            "add        $16, %1             \n\t"
+            "add        $16, %2             \n\t"
+            "sub        $1, %%ecx           \n\t"
+            "jnz        1b                  \n\t"
+            :"+r"(out), "+r"(in), "+r"(wnd), "+c"(loops)
+            :"m"(keep)
+            :"memory", "xmm0", "xmm2", "xmm3", "xmm7"
+        );
+    }
+    return n & ~3;
+}
+
+// out[2f+i] = in[2f+i] * flt[f], i.e. complex bins scaled by a real filter
+static unsigned sse_filter(float *out, const float *in, const float *flt, unsigned n) {
+    int loops = n >> 2;
+    if (!AudioOutputUtil::has_hardware_fpu() || !loops)
+        return 0;
+    __asm__ volatile (
+        "1:                             \n\t"
+        "movups     (%2), %%xmm2        \n\t"
+        "movups     (%1), %%xmm0        \n\t"
+        "movaps     %%xmm2, %%xmm3      \n\t"
+        "movups     16(%1), %%xmm1      \n\t"
+        "unpcklps   %%xmm2, %%xmm2      \n\t"
+        "unpckhps   %%xmm3, %%xmm3      \n\t"
+        "mulps      %%xmm2, %%xmm0      \n\t"
+        "mulps      %%xmm3, %%xmm1      \n\t"
+        "movups     %%xmm0, (%0)        \n\t"
+        "movups     %%xmm1, 16(%0)      \n\t"
+        "add        $32, %0             \n\t"
+        "add        $32, %1             \n\t"
+        "add        $16, %2             \n\t"
+        "sub        $1, %%ecx           \n\t"
+        "jnz        1b                  \n\t"
+        :"+r"(out), "+r"(in), "+r"(flt), "+c"(loops)
+        :
+        :"memory", "xmm0", "xmm1", "xmm2", "xmm3"
+    );
+    return n & ~3;
+}
+
+// amp[f] = |cf[f]|, the amplitude of each complex bin
+static unsigned sse_amplitude(float *amp, const float *cf, unsigned n) {
+    int loops = n >> 2;
+    if (!AudioOutputUtil::has_hardware_fpu() || !loops)
+        return 0;
+    __asm__ volatile (
+        "1:                             \n\t"
+        "movups     (%1), %%xmm0        \n\t"
+        "movups     16(%1), %%xmm1      \n\t"
+        "mulps      %%xmm0, %%xmm0      \n\t"
+        "mulps      %%xmm1, %%xmm1      \n\t"
+        "movaps     %%xmm0, %%xmm2      \n\t"
+        "shufps     $0x88, %%xmm1, %%xmm0   \n\t"
+        "shufps     $0xdd, %%xmm1, %%xmm2   \n\t"
+        "addps      %%xmm2, %%xmm0      \n\t"
+        "sqrtps     %%xmm0, %%xmm0      \n\t"
+        "movups     %%xmm0, (%0)        \n\t"
+        "add        $16, %0             \n\t"
+        "add        $32, %1             \n\t"
+        "sub        $1, %%ecx           \n\t"
+        "jnz        1b                  \n\t"
+        :"+r"(amp), "+r"(cf), "+c"(loops)
+        :
+        :"memory", "xmm0", "xmm1", "xmm2"
+    );
+    return n & ~3;
+}
+
+// out[k] = a[k] + b[k]
+static unsigned sse_add(float *out, const float *a, const float *b, unsigned n) {
+    int loops = n >> 2;
+    if (!AudioOutputUtil::has_hardware_fpu() || !loops)
+        return 0;
+    __asm__ volatile (
+        "1:                             \n\t"
+        "movups     (%1), %%xmm0        \n\t"
+        "movups     (%2), %%xmm1        \n\t"
+        "addps      %%xmm1, %%xmm0      \n\t"
+        "movups     %%xmm0, (%0)        \n\t"
+        "add        $16, %0             \n\t"
+        "add        $16, %1             \n\t"
+        "add        $16, %2             \n\t"
+        "sub        $1, %%ecx           \n\t"
+        "jnz        1b                  \n\t"
+        :"+r"(out), "+r"(a), "+r"(b), "+c"(loops)
+        :
+        :"memory", "xmm0", "xmm1"
+    );
+    return n & ~3;
+}
+
+// out[f] = in[f] * rot, complex bins rotated by a unit vector; does 2 bins
+// at a time, so returns a multiple of 2
+static unsigned sse_rotate(float *out, const float *in, cfloat rot, unsigned n) {
+    int loops = n >> 1;
+    if (!AudioOutputUtil::has_hardware_fpu() || !loops)
+        return 0;
+    float coeff[8] = { rot.real(), rot.real(), rot.real(), rot.real(),
+                       -rot.imag(), rot.imag(), -rot.imag(), rot.imag() };
+    __asm__ volatile (
+        "movups     (%3), %%xmm6        \n\t"
+        "movups     16(%3), %%xmm7      \n\t"
+        "1:                             \n\t"
+        "movups     (%1), %%xmm0        \n\t"
+        "movaps     %%xmm0, %%xmm1      \n\t"
+        "shufps     $0xb1, %%xmm1, %%xmm1   \n\t"
+        "mulps      %%xmm6, %%xmm0      \n\t"
+        "mulps      %%xmm7, %%xmm1      \n\t"
+        "addps      %%xmm1, %%xmm0      \n\t"
+        "movups     %%xmm0, (%0)        \n\t"
+        "add        $16, %0             \n\t"
+        "add        $16, %1             \n\t"
+        "sub        $1, %%ecx           \n\t"
+        "jnz        1b                  \n\t"
+        :"+r"(out), "+r"(in), "+c"(loops)
+        :"r"(coeff)
+        :"memory", "xmm0", "xmm1", "xmm6", "xmm7"
+    );
+    return n & ~1;
+}
+#else
+static unsigned sse_window(float*, const float*, const float*, unsigned, bool, bool=false) { return 0; }
+static unsigned sse_filter(float*, const float*, const float*, unsigned) { return 0; }
+static unsigned sse_amplitude(float*, const float*, unsigned) { return 0; }
+static unsigned sse_add(float*, const float*, const float*, unsigned) { return 0; }
+static unsigned sse_rotate(float*, const float*, cfloat, unsigned) { return 0; }
+#endif
+
 // private implementation of the surround decoder
 class decoder_impl {
 public:
@@ -81,6 +263,10 @@ public:
         surR.resize(N);
         surL.resize(N);
         trueavg.resize(N);
+        ampsL.resize(N);
+        ampsR.resize(N);
+        gainL.resize(N);
+        gainR.resize(N);
         xfs.resize(N);
         yfs.resize(N);
         inbuf[0].resize(N);
@@ -204,6 +390,8 @@ public:
         const float modes[4][2] = {{0,0},{0,PI},{PI,0},{-PI/2,PI/2}};
         phase_offsetL = modes[mode][0];
         phase_offsetR = modes[mode][1];
+        rotL = polar(1,phase_offsetL);
+        rotR = polar(1,phase_offsetR);
     }
 
     // what steering mode should be chosen
@@ -244,13 +432,19 @@ private:
             float* pRt = &rt[0];
             float* pIn0 = input1[0];
             float* pIn1 = input1[1];
-            for (unsigned k=0;k<halfN;k++) {
+            unsigned k = sse_window(pLt,pIn0,pWnd,halfN,false);
+            sse_window(pRt,pIn1,pWnd,halfN,false);
+            pLt += k; pRt += k; pIn0 += k; pIn1 += k; pWnd += k;
+            for (;k<halfN;k++) {
                 *pLt++ = *pIn0++ * *pWnd;
                 *pRt++ = *pIn1++ * *pWnd++;
             }
             pIn0 = input2[0];
             pIn1 = input2[1];
-            for (unsigned k=0;k<halfN;k++) {
+            k = sse_window(pLt,pIn0,pWnd,halfN,false);
+            sse_window(pRt,pIn1,pWnd,halfN,false);
+            pLt += k; pRt += k; pIn0 += k; pIn1 += k; pWnd += k;
+            for (;k<halfN;k++) {
                 *pLt++ = *pIn0++ * *pWnd;
                 *pRt++ = *pIn1++ * *pWnd++;
             }
@@ -269,19 +463,24 @@ private:
 
         // 2. compare amplitude and phase of each DFT bin and produce the X/Y coordinates in the sound field
         //    but dont do DC or N/2 component
-        for (unsigned f=0;f<halfN;f++) {           
-            // get left/right amplitudes/phases
-            float ampL = amplitude(dftL[f]), ampR = amplitude(dftR[f]);
-            float phaseL = phase(dftL[f]), phaseR = phase(dftR[f]);
+        unsigned f = sse_amplitude(&ampsL[0],&dftL[0][0],halfN);
+        sse_amplitude(&ampsR[0],&dftR[0][0],halfN);
+        for (;f<halfN;f++) {
+            ampsL[f] = amplitude(dftL[f]);
+            ampsR[f] = amplitude(dftR[f]);
+        }
+        for (f=0;f<halfN;f++) {           
+            // get left/right amplitudes
+            float ampL = ampsL[f], ampR = ampsR[f];
 //          if (ampL+ampR < epsilon)
 //              continue;       
 
-            // calculate the amplitude/phase difference
+            // calculate the amplitude/phase difference; the phase difference
+            // wrapped to [-PI,PI] is the phase of L*conj(R), one atan2 not two
+            // (it is 0 if a side is silent, where the steering ignores it)
             float ampDiff = clamp((ampL+ampR < epsilon) ? 0 : (ampR-ampL) / (ampR+ampL));
-            float phaseDiff = phaseL - phaseR;
-            if (phaseDiff < -PI) phaseDiff += 2*PI;
-            if (phaseDiff > PI) phaseDiff -= 2*PI;
-            phaseDiff = abs(phaseDiff);
+            float phaseDiff = abs(atan2(dftL[f][1]*dftR[f][0] - dftL[f][0]*dftR[f][1],
+                                        dftL[f][0]*dftR[f][0] + dftL[f][1]*dftR[f][1]));
 
             if (linear_steering) {
                 // --- this is the fancy new linear mode ---
@@ -314,13 +513,6 @@ private:
             } else {
                 // --- this is the old & simple steering mode ---
 
-                // calculate the amplitude/phase difference
-                float ampDiff = clamp((ampL+ampR < epsilon) ? 0 : (ampR-ampL) / (ampR+ampL));
-                float phaseDiff = phaseL - phaseR;
-                if (phaseDiff < -PI) phaseDiff += 2*PI;
-                if (phaseDiff > PI) phaseDiff -= 2*PI;
-                phaseDiff = abs(phaseDiff);
-
                 // determine sound field x-position
                 xfs[f] = ampDiff;
 
@@ -357,13 +549,41 @@ private:
                     filter[c][f] = (1-adaption_rate)*filter[c][f] + adaption_rate*volume[c];
             }
 
-            // ... and build the signal which we want to position
-            frontL[f] = polar(ampL+ampR,phaseL);
-            frontR[f] = polar(ampL+ampR,phaseR);
-            avg[f] = frontL[f] + frontR[f];
-            surL[f] = polar(ampL+ampR,phaseL+phase_offsetL);
-            surR[f] = polar(ampL+ampR,phaseR+phase_offsetR);
-            trueavg[f] = cfloat(dftL[f][0] + dftR[f][0], dftL[f][1] + dftR[f][1]);
+            // polar(ampL+ampR,phaseL) is the left bin scaled by these
+            gainL[f] = ampL > 0 ? (ampL+ampR)/ampL : 0;
+            gainR[f] = ampR > 0 ? (ampL+ampR)/ampR : 0;
+        }
+
+        // ... and build the signal which we want to position
+        {
+            float* pFrontL = (float*)&frontL[0];
+            float* pFrontR = (float*)&frontR[0];
+            f = sse_filter(pFrontL,&dftL[0][0],&gainL[0],halfN);
+            sse_filter(pFrontR,&dftR[0][0],&gainR[0],halfN);
+            for (;f<halfN;f++) {
+                frontL[f] = cfloat(dftL[f][0]*gainL[f], dftL[f][1]*gainL[f]);
+                frontR[f] = cfloat(dftR[f][0]*gainR[f], dftR[f][1]*gainR[f]);
+            }
+            // a silent bin has no phase, take it as 0 like atan2 does
+            for (f=0;f<halfN;f++) {
+                if (ampsL[f] <= 0)
+                    frontL[f] = cfloat(ampsL[f]+ampsR[f],0);
+                if (ampsR[f] <= 0)
+                    frontR[f] = cfloat(ampsL[f]+ampsR[f],0);
+            }
+
+            f = sse_add((float*)&avg[0],pFrontL,pFrontR,halfN*2) / 2;
+            for (;f<halfN;f++)
+                avg[f] = frontL[f] + frontR[f];
+            f = sse_rotate((float*)&surL[0],pFrontL,rotL,halfN);
+            for (;f<halfN;f++)
+                surL[f] = frontL[f] * rotL;
+            f = sse_rotate((float*)&surR[0],pFrontR,rotR,halfN);
+            for (;f<halfN;f++)
+                surR[f] = frontR[f] * rotR;
+            f = sse_add((float*)&trueavg[0],&dftL[0][0],&dftR[0][0],halfN*2) / 2;
+            for (;f<halfN;f++)
+                trueavg[f] = cfloat(dftL[f][0] + dftR[f][0], dftL[f][1] + dftR[f][1]);
         }
 
         // 4. distribute the unfiltered reference signals over the channels
@@ -426,8 +646,8 @@ private:
     // filter the complex source signal and add it to target
     void apply_filter(cfloat *signal, float *flt, float *target) {
         // filter the signal
-        unsigned f;
-        for (f=0;f<=halfN;f++) {
+        unsigned f = sse_filter(&src[0][0],(float*)signal,flt,halfN+1);
+        for (;f<=halfN;f++) {
             src[f][0] = signal[f].real() * flt[f];
             src[f][1] = signal[f].imag() * flt[f];
         }
@@ -442,7 +662,10 @@ private:
         float* pWnd2 = &wnd[halfN];
         float* pDst2 = &dst[halfN];
         // add the result to target, windowed
-        for (unsigned int k=0;k<halfN;k++)
+        unsigned int k = sse_window(pT1,pDst1,pWnd1,halfN,true);
+        sse_window(pT2,pDst2,pWnd2,halfN,false);
+        pT1 += k; pWnd1 += k; pDst1 += k; pT2 += k; pWnd2 += k; pDst2 += k;
+        for (;k<halfN;k++)
         {
             // 1st part is overlap add
             *pT1++ += *pWnd1++ * *pDst1++;
@@ -465,7 +688,10 @@ private:
         float* pWnd2 = &wnd[halfN];
         float* pDst2 = &src[halfN][0];
         // add the result to target, windowed
-        for (unsigned int k=0;k<halfN;k++)
+        unsigned int k = sse_window(pT1,pDst1,pWnd1,halfN,true,true);
+        sse_window(pT2,pDst2,pWnd2,halfN,false,true);
+        pT1 += k; pWnd1 += k; pDst1 += 2*k; pT2 += k; pWnd2 += k; pDst2 += 2*k;
+        for (;k<halfN;k++)
         {
             // 1st part is overlap add
             *pT1++ += *pWnd1++ * *pDst1; pDst1 += 2;
@@ -532,6 +758,8 @@ private:
     // buffers
     std::vector<cfloat> frontL,frontR,avg,surL,surR; // the signal (phase-corrected) in the frequency domain
     std::vector<cfloat> trueavg;       // for lfe generation
+    std::vector<float> ampsL,ampsR;    // the amplitude of each frequency bin
+    std::vector<float> gainL,gainR;    // scale each bin to the combined amplitude
     std::vector<float> xfs,yfs;        // the feature space positions for each frequency bin
     std::vector<float> wnd;            // the window function, precalculated
     std::vector<float> filter[6];      // a frequency filter for each output channel
@@ -542,6 +770,7 @@ private:
     float surround_balance;            // the xfs balance that follows from the coeffs
     float surround_level;              // gain for the surround channels (follows from the coeffs
     float phase_offsetL, phase_offsetR;// phase shifts to be applied to the rear channels
+    cfloat rotL, rotR;                 // the same phase shifts as unit vectors
     float front_separation;            // front stereo separation
     float rear_separation;             // rear stereo separation
     bool linear_steering;              // whether the steering should be linear or not
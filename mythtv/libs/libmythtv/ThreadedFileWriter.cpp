@@ -3,6 +3,10 @@
 #include <cstdlib>
 #include <cerrno>
 
+// C++ headers
+#include <algorithm>
+using namespace std;
+
 // Unix C headers
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -17,7 +21,13 @@
 #include "ThreadedFileWriter.h"
 #include "compat.h"
 #include "mythverbose.h"
-#include "mythconfig.h" // gives us HAVE_POSIX_FADVISE
+#include "mythtimer.h"
+#include "mythconfig.h" // gives us HAVE_POSIX_FADVISE, HAVE_AIO_WRITE
+
+#if HAVE_AIO_WRITE && defined(O_DIRECT)
+#define USING_TFW_AIO 1
+#include <aio.h>
+#endif
 
 #if HAVE_POSIX_FADVISE < 1
 static int posix_fadvise(int, off_t, off_t, int) { return 0; }
@@ -34,6 +44,11 @@ const uint ThreadedFileWriter::TFW_DEF_BUF_SIZE   = 2*1024*1024;
 const uint ThreadedFileWriter::TFW_MAX_WRITE_SIZE = TFW_DEF_BUF_SIZE / 4;
 const uint ThreadedFileWriter::TFW_MIN_WRITE_SIZE = TFW_DEF_BUF_SIZE / 32;
 
+/// Offset, length and memory alignment required for O_DIRECT writes
+static const uint kDirectIOAlign = 4096;
+/// Number of writes the direct I/O engine keeps in flight
+static const uint kDirectIOSlots = 4;
+
 /** \class ThreadedFileWriter
  *  \brief This class supports the writing of recordings to disk.
  *
@@ -101,6 +116,263 @@ static uint safe_write(int fd, const void *data, uint sz, bool &ok)
     return tot;
 }
 
+/** \class TFWAIOQueue
+ *  \brief Direct I/O write engine used by ThreadedFileWriter.
+ *
+ *   Data is copied into page aligned slot buffers and written with
+ *   POSIX AIO to a file descriptor opened with O_DIRECT, so the data
+ *   does not pass through the page cache and up to kDirectIOSlots
+ *   writes are in flight at once. O_DIRECT requires block aligned
+ *   writes, so the last partial block is kept in a tail buffer and
+ *   written again, completed, as part of the next aligned write.
+ *
+ *   A direct write that fails for any reason but a full disk or file
+ *   size limit is retried through the page cache, and DirectFailed()
+ *   tells the caller to stop using direct writes.
+ *
+ *   This class is not thread-safe, ThreadedFileWriter only uses it
+ *   from DiskLoop() or while holding its buffer lock when DiskLoop()
+ *   is not writing.
+ */
+class TFWAIOQueue
+{
+  public:
+    TFWAIOQueue(int _fd, long long offset, uint max_write_size);
+    ~TFWAIOQueue();
+
+    bool IsOK(void) const { return ok; }
+    bool DirectFailed(void) const { return direct_failed; }
+    bool Write(const char *data, uint size);
+    bool Drain(bool write_tail);
+    /// Offset of the end of the data handed to Write()
+    long long EndOffset(void) const { return tail_off + tail_len; }
+    QString GetStats(void) const;
+
+  private:
+    bool Reap(uint slot);
+    bool WriteBuffered(const char *data, uint size, long long offset);
+
+    typedef struct
+    {
+#ifdef USING_TFW_AIO
+        struct aiocb cb;
+#endif
+        char      *buf;
+        bool       busy;
+        MythTimer  timer;
+    } Slot;
+
+    int        fd;
+    bool       ok;
+    bool       direct_failed;
+    uint       slot_size;
+    Slot       slots[kDirectIOSlots];
+    uint       next_slot;
+    uint       in_flight;
+
+    char      *tail;     ///< partial block not yet written with O_DIRECT
+    uint       tail_len;
+    long long  tail_off; ///< block aligned file offset of tail
+
+    // statistics
+    long long  write_cnt;
+    long long  latency_tot;
+    int        latency_max;
+    long long  depth_tot;
+    uint       depth_max;
+};
+
+TFWAIOQueue::TFWAIOQueue(int _fd, long long offset, uint max_write_size) :
+    fd(_fd), ok(true), direct_failed(false),
+    slot_size(max_write_size + kDirectIOAlign),
+    next_slot(0), in_flight(0),
+    tail(NULL), tail_len(0), tail_off(offset),
+    write_cnt(0), latency_tot(0), latency_max(0),
+    depth_tot(0), depth_max(0)
+{
+    void *ptr = NULL;
+    if (posix_memalign(&ptr, kDirectIOAlign, kDirectIOAlign))
+        ok = false;
+    tail = (char*) ptr;
+
+    for (uint i = 0; i < kDirectIOSlots; i++)
+    {
+        ptr = NULL;
+        if (posix_memalign(&ptr, kDirectIOAlign, slot_size))
+            ok = false;
+        slots[i].buf  = (char*) ptr;
+        slots[i].busy = false;
+    }
+}
+
+TFWAIOQueue::~TFWAIOQueue()
+{
+    Drain(true);
+
+    for (uint i = 0; i < kDirectIOSlots; i++)
+        free(slots[i].buf);
+    free(tail);
+}
+
+/** \fn TFWAIOQueue::Write(const char*,uint)
+ *  \brief Queues up to max_write_size bytes for writing.
+ *
+ *   This only blocks when all slots are in flight, in which case
+ *   it waits for the oldest write to complete.
+ *
+ *  \return false on a write error, errno is set to the error.
+ */
+bool TFWAIOQueue::Write(const char *data, uint size)
+{
+    Slot &slot = slots[next_slot];
+    if (slot.busy && !Reap(next_slot))
+        return false;
+
+    memcpy(slot.buf, tail, tail_len);
+    memcpy(slot.buf + tail_len, data, size);
+
+    uint total   = tail_len + size;
+    uint aligned = total & ~(kDirectIOAlign - 1);
+    uint rest    = total - aligned;
+
+    memcpy(tail, slot.buf + aligned, rest);
+    tail_len = rest;
+
+    if (!aligned)
+        return true;
+
+#ifdef USING_TFW_AIO
+    memset(&slot.cb, 0, sizeof(slot.cb));
+    slot.cb.aio_fildes = fd;
+    slot.cb.aio_buf    = slot.buf;
+    slot.cb.aio_nbytes = aligned;
+    slot.cb.aio_offset = tail_off;
+    slot.cb.aio_sigevent.sigev_notify = SIGEV_NONE;
+
+    if (aio_write(&slot.cb) < 0)
+        return false;
+#endif
+
+    tail_off += aligned;
+    slot.busy = true;
+    slot.timer.start();
+    next_slot = (next_slot + 1) % kDirectIOSlots;
+
+    in_flight++;
+    depth_tot += in_flight;
+    depth_max  = max(depth_max, in_flight);
+
+    return true;
+}
+
+/** \fn TFWAIOQueue::Reap(uint)
+ *  \brief Waits for the write in a slot to complete.
+ *  \return false on a write error, errno is set to the error.
+ */
+bool TFWAIOQueue::Reap(uint i)
+{
+    Slot &slot = slots[i];
+    if (!slot.busy)
+        return true;
+
+    bool write_ok = true;
+#ifdef USING_TFW_AIO
+    const struct aiocb *list[1] = { &slot.cb };
+    int err;
+    while ((err = aio_error(&slot.cb)) == EINPROGRESS)
+        aio_suspend(list, 1, NULL);
+
+    ssize_t ret = aio_return(&slot.cb);
+    if (err && ENOSPC != err && EFBIG != err)
+    {
+        errno = err;
+        VERBOSE(VB_IMPORTANT, LOC_ERR +
+                QString("Direct write of %1 bytes at offset %2 failed, "
+                        "writing it through the page cache")
+                .arg(slot.cb.aio_nbytes).arg(slot.cb.aio_offset) + ENO);
+        direct_failed = true;
+        write_ok = WriteBuffered(slot.buf, slot.cb.aio_nbytes,
+                                 slot.cb.aio_offset);
+    }
+    else if (err)
+    {
+        errno = err;
+        write_ok = false;
+    }
+    else if (ret != (ssize_t) slot.cb.aio_nbytes)
+    {
+        // Short O_DIRECT writes to regular files mean we are out of space
+        errno = ENOSPC;
+        write_ok = false;
+    }
+#endif
+
+    int latency = slot.timer.elapsed();
+    slot.busy = false;
+    in_flight--;
+
+    write_cnt++;
+    latency_tot += latency;
+    latency_max  = max(latency_max, latency);
+
+    return write_ok;
+}
+
+/** \fn TFWAIOQueue::Drain(bool)
+ *  \brief Waits for all writes in flight to complete, and optionally
+ *         writes the partial tail block through the page cache so
+ *         the file contains all the data given to Write().
+ */
+bool TFWAIOQueue::Drain(bool write_tail)
+{
+    bool write_ok = true;
+    for (uint i = 0; i < kDirectIOSlots; i++)
+    {
+        uint slot = (next_slot + i) % kDirectIOSlots;
+        write_ok &= Reap(slot);
+    }
+
+    if (!write_tail || !tail_len || !write_ok)
+        return write_ok;
+
+    return WriteBuffered(tail, tail_len, tail_off);
+}
+
+/** \fn TFWAIOQueue::WriteBuffered(const char*,uint,long long)
+ *  \brief Writes data at an offset through the page cache, for data
+ *         that can not be written with O_DIRECT.
+ *  \return false on a write error, errno is set to the error.
+ */
+bool TFWAIOQueue::WriteBuffered(const char *data, uint size, long long offset)
+{
+    bool write_ok = true;
+#ifdef USING_TFW_AIO
+    int flags = fcntl(fd, F_GETFL);
+    fcntl(fd, F_SETFL, flags & ~O_DIRECT);
+    ssize_t ret = pwrite(fd, data, size, offset);
+    if (ret >= 0 && ret != (ssize_t) size)
+        errno = ENOSPC;
+    write_ok = (ret == (ssize_t) size);
+    int err = errno;
+    fcntl(fd, F_SETFL, flags);
+    errno = err;
+#endif
+
+    return write_ok;
+}
+
+QString TFWAIOQueue::GetStats(void) const
+{
+    if (!write_cnt)
+        return "no direct writes";
+
+    return QString("%1 direct writes, latency avg %2 ms max %3 ms, "
+                   "queue depth avg %4 max %5")
+        .arg(write_cnt)
+        .arg((double) latency_tot / write_cnt, 0, 'f', 1).arg(latency_max)
+        .arg((double) depth_tot / write_cnt, 0, 'f', 1).arg(depth_max);
+}
+
 /** \fn ThreadedFileWriter::boot_writer(void*)
  *  \brief Thunk that runs ThreadedFileWriter::DiskLoop(void)
  */
@@ -141,7 +413,10 @@ ThreadedFileWriter::ThreadedFileWriter(const QString &fname,
     rpos(0),                             wpos(0),
     written(0),
     // buffer
-    buf(NULL),                           tfw_buf_size(0)
+    buf(NULL),                           tfw_buf_size(0),
+    // direct I/O
+    write_mode(kWriteBuffered),          aio(NULL),
+    disk_busy(false)
 {
     filename.detach();
 }
@@ -221,6 +496,16 @@ ThreadedFileWriter::~ThreadedFileWriter()
 
         bufferHasData.wakeAll();
         pthread_join(writer, NULL);
+
+        if (aio)
+        {
+            aio->Drain(true);
+            VERBOSE(VB_RECORD|VB_FILE, LOC + QString("'%1': %2")
+                    .arg(filename).arg(aio->GetStats()));
+            delete aio;
+            aio = NULL;
+        }
+
         close(fd);
         fd = -1;
     }
@@ -342,6 +627,10 @@ long long ThreadedFileWriter::Seek(long long pos, int whence)
 {
     Flush();
 
+    // Writes after a seek are not block aligned, so use write() again
+    if (kWriteBuffered != write_mode)
+        SetWriteMode(kWriteBuffered);
+
     return lseek(fd, pos, whence);
 }
 
@@ -358,6 +647,123 @@ void ThreadedFileWriter::Flush(void)
             VERBOSE(VB_IMPORTANT, LOC + "Taking a long time to flush..");
     }
     flush = false;
+
+    // DiskLoop() is idle while the buffer is empty and we hold the lock
+    if (aio && !ignore_writes && !aio->Drain(true))
+    {
+        VERBOSE(VB_IMPORTANT, LOC_ERR + "Flush(): Direct write failed" + ENO);
+    }
+}
+
+/** \fn ThreadedFileWriter::SetWriteMode(WriteMode)
+ *  \brief Selects how the buffer is written to disk.
+ *
+ *   kWriteDirectAIO opens the file for O_DIRECT and keeps several
+ *   POSIX AIO writes in flight, bypassing the page cache. This is
+ *   meant for recordings nobody is watching, and can only be
+ *   enabled while the file position is block aligned, i.e. before
+ *   anything has been written.
+ *
+ *   Data still in the buffer is written in the new mode, so this
+ *   does not wait for the buffer to empty.
+ *
+ *  \return true if the requested mode is in effect.
+ */
+bool ThreadedFileWriter::SetWriteMode(WriteMode mode)
+{
+    if (fd < 0)
+        return false;
+
+    QMutexLocker locker(&buflock);
+
+    // DiskLoop() writes without holding buflock, wait for that write;
+    // it can not start another one until we release the lock.
+    while (disk_busy)
+        bufferWroteData.wait(&buflock);
+
+    return SetWriteModePriv(mode);
+}
+
+/** \fn ThreadedFileWriter::SetWriteModePriv(WriteMode)
+ *  \brief Switches the write mode, buflock must be held and
+ *         DiskLoop() must not be writing.
+ */
+bool ThreadedFileWriter::SetWriteModePriv(WriteMode mode)
+{
+    if (mode == write_mode)
+        return true;
+
+    if (kWriteBuffered == mode)
+    {
+        if (!ignore_writes && !aio->Drain(true))
+        {
+            VERBOSE(VB_IMPORTANT, LOC_ERR +
+                    QString("Direct write to '%1' failed").arg(filename) + ENO);
+        }
+
+        long long end = aio->EndOffset();
+        VERBOSE(VB_RECORD|VB_FILE, LOC + QString("'%1': %2")
+                .arg(filename).arg(aio->GetStats()));
+        delete aio;
+        aio = NULL;
+
+#ifdef USING_TFW_AIO
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+#endif
+        lseek(fd, end, SEEK_SET);
+        write_mode = kWriteBuffered;
+        return true;
+    }
+
+#ifdef USING_TFW_AIO
+    long long pos = lseek(fd, 0, SEEK_CUR);
+    if (pos < 0 || (pos % kDirectIOAlign))
+    {
+        VERBOSE(VB_IMPORTANT, LOC_ERR + QString(
+                    "Can not use direct writes for '%1' at offset %2")
+                .arg(filename).arg(pos));
+        return false;
+    }
+
+    int flags = fcntl(fd, F_GETFL);
+    if (fcntl(fd, F_SETFL, flags | O_DIRECT) < 0)
+    {
+        VERBOSE(VB_IMPORTANT, LOC_ERR + QString(
+                    "Filesystem of '%1' does not support direct writes")
+                .arg(filename) + ENO);
+        return false;
+    }
+
+    aio = new TFWAIOQueue(fd, pos, TFW_MAX_WRITE_SIZE);
+    if (!aio->IsOK())
+    {
+        VERBOSE(VB_IMPORTANT, LOC_ERR +
+                "Could not allocate direct write buffers");
+        delete aio;
+        aio = NULL;
+        fcntl(fd, F_SETFL, flags);
+        return false;
+    }
+
+    VERBOSE(VB_RECORD, LOC + QString("Using direct writes for '%1'")
+            .arg(filename));
+    write_mode = mode;
+    return true;
+#else
+    VERBOSE(VB_IMPORTANT, LOC_ERR +
+            "Direct writes are not supported on this platform");
+    return false;
+#endif
+}
+
+/** \fn ThreadedFileWriter::GetWriteStats(void) const
+ *  \brief Returns write latency and queue depth statistics
+ *         for the direct write engine.
+ */
+QString ThreadedFileWriter::GetWriteStats(void) const
+{
+    QMutexLocker locker(&buflock);
+    return (aio) ? aio->GetStats() : QString("buffered writes");
 }
 
 /** \brief Flush data written to the file descriptor to disk.
@@ -480,6 +886,8 @@ void ThreadedFileWriter::DiskLoop(void)
             continue;
         }
         uint trpos = rpos;
+        TFWAIOQueue *taio = aio;
+        disk_busy = true;
         buflock.unlock();
 
         /* cap the max. write size. Prevents the situation where 90% of the
@@ -488,9 +896,25 @@ void ThreadedFileWriter::DiskLoop(void)
            the 10% that was free... */
         size = (size > TFW_MAX_WRITE_SIZE) ? TFW_MAX_WRITE_SIZE : size;
 
-        bool write_ok;
+        bool write_ok = true;
         if (ignore_writes)
             ;
+        else if (taio)
+        {
+            // The data is copied, so size does not change on failure;
+            // we stop writing altogether on errors anyway.
+            if ((trpos + size) > tfw_buf_size)
+            {
+                int first_chunk_size  = tfw_buf_size - trpos;
+                int second_chunk_size = size - first_chunk_size;
+                write_ok = taio->Write(buf + trpos, first_chunk_size) &&
+                    taio->Write(buf, second_chunk_size);
+            }
+            else
+            {
+                write_ok = taio->Write(buf + trpos, size);
+            }
+        }
         else if ((trpos + size) > tfw_buf_size)
         {
             int first_chunk_size  = tfw_buf_size - trpos;
@@ -532,6 +956,15 @@ void ThreadedFileWriter::DiskLoop(void)
             VERBOSE(VB_IMPORTANT, msg.arg(filename));
             ignore_writes = true;
         }
+        else if (!ignore_writes && !write_ok && taio)
+        {
+            // Failed even through the page cache, see TFWAIOQueue::Reap()
+            VERBOSE(VB_IMPORTANT, LOC_ERR +
+                    QString("Writing '%1' failed, "
+                            "no further writing will be done.")
+                    .arg(filename) + ENO);
+            ignore_writes = true;
+        }
 
         if (written <= tfw_min_write_size)
         {
@@ -549,6 +982,16 @@ void ThreadedFileWriter::DiskLoop(void)
                     "rpos was changed from under the DiskLoop() function.");
         }
         m_file_wpos += size;
+
+        if (taio && taio->DirectFailed() && !ignore_writes)
+        {
+            VERBOSE(VB_IMPORTANT, LOC + QString(
+                        "Falling back to buffered writes for '%1'")
+                    .arg(filename));
+            SetWriteModePriv(kWriteBuffered);
+        }
+
+        disk_busy = false;
         buflock.unlock();
 
         bufferWroteData.wakeAll();
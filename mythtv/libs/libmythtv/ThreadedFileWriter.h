@@ -9,9 +9,17 @@
 #include <pthread.h>
 #include <stdint.h>
 
+class TFWAIOQueue;
+
 class ThreadedFileWriter
 {
   public:
+    typedef enum
+    {
+        kWriteBuffered  = 0, ///< write() through the page cache
+        kWriteDirectAIO = 1, ///< O_DIRECT writes, several in flight
+    } WriteMode;
+
     ThreadedFileWriter(const QString &fname, int flags, mode_t mode);
     ~ThreadedFileWriter();
 
@@ -29,6 +37,10 @@ class ThreadedFileWriter
     void Sync(void);
     void Flush(void);
 
+    bool SetWriteMode(WriteMode mode);
+    WriteMode GetWriteMode(void) const { return write_mode; }
+    QString GetWriteStats(void) const;
+
   protected:
     static void *boot_writer(void *);
     void DiskLoop(void);
@@ -39,6 +51,8 @@ class ThreadedFileWriter
     uint BufUsedPriv(void) const;
     uint BufFreePriv(void) const;
 
+    bool SetWriteModePriv(WriteMode mode);
+
   private:
     // file info
     QString         filename;
@@ -66,6 +80,11 @@ class ThreadedFileWriter
     char           *buf;
     unsigned long   tfw_buf_size;
 
+    // direct I/O write engine, protected by buflock outside DiskLoop()
+    WriteMode       write_mode;
+    TFWAIOQueue    *aio;
+    bool            disk_busy; ///< DiskLoop() is writing without buflock
+
     // threads
     pthread_t       writer;
     pthread_t       syncer;
@@ -1290,6 +1290,10 @@ void AvFormatDecoder::InitVideoCodec(AVStream *stream, AVCodecContext *enc,
 
         enc->flags2 |= CODEC_FLAG2_FAST;
 
+        // Only effective if libavcodec was configured with --enable-gray
+        if (special_decode & kAVSpecialDecode_LumaOnly)
+            enc->flags |= CODEC_FLAG_GRAY;
+
         if ((CODEC_ID_MPEG2VIDEO == codec->id) ||
             (CODEC_ID_MPEG1VIDEO == codec->id))
         {
@@ -1316,6 +1320,12 @@ void AvFormatDecoder::InitVideoCodec(AVStream *stream, AVCodecContext *enc,
         {
             enc->skip_idct = AVDISCARD_ALL;
         }
+        else if (special_decode & kAVSpecialDecode_FastNonRef)
+        {
+            // Non-reference frames are motion compensated only. Every
+            // profile that allows this also skips the loop filter.
+            enc->skip_idct = AVDISCARD_NONREF;
+        }
     }
 
     if (selectedStream)
@@ -362,6 +362,32 @@ bool CommBreakMap::DoSkipCommercials(uint64_t &jumpToFrame,
     return true;
 }
 
+/** \fn CommBreakMap::GetNextSkipTarget(uint64_t&,uint64_t,double)
+ *  \brief Provides the frame a skip over the next commercial break
+ *         would land on, returns false if there is no break ahead.
+ */
+bool CommBreakMap::GetNextSkipTarget(uint64_t &jumpToFrame,
+                                     uint64_t framesPlayed,
+                                     double video_frame_rate)
+{
+    QMutexLocker locker(&commBreakMapLock);
+    if (!hascommbreaktable)
+        return false;
+
+    frm_dir_map_t::const_iterator it = commBreakMap.begin();
+    for (; it != commBreakMap.end(); ++it)
+    {
+        if (it.key() <= framesPlayed || *it != MARK_COMM_END)
+            continue;
+
+        uint64_t rewind = (uint64_t)(commrewindamount * video_frame_rate);
+        jumpToFrame = (it.key() > rewind) ? it.key() - rewind : 0;
+        return true;
+    }
+
+    return false;
+}
+
 void CommBreakMap::MergeShortCommercials(double video_frame_rate)
 {
     double maxMerge = maxShortMerge * video_frame_rate;
@@ -33,6 +33,8 @@ class CommBreakMap
     bool DoSkipCommercials(uint64_t &jumpToFrame, uint64_t framesPlayed,
                            double video_frame_rate, uint64_t totalFrames,
                            QString &comm_msg);
+    bool GetNextSkipTarget(uint64_t &jumpToFrame, uint64_t framesPlayed,
+                           double video_frame_rate);
 
   private:
     void MergeShortCommercials(double video_frame_rate);
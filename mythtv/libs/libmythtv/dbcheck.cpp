@@ -20,7 +20,7 @@ using namespace std;
    mythtv/bindings/perl/MythTV.pm
 */
 /// This is the DB schema version expected by the running MythTV instance.
-const QString currentDatabaseVersion = "1264";
+const QString currentDatabaseVersion = "1265";
 
 static bool UpdateDBVersionNumber(const QString &newnumber, QString &dbver);
 static bool performActualUpdate(
@@ -5502,6 +5502,23 @@ NULL
             return false;
     }
 
+    if (dbver == "1264")
+    {
+        const char *updates[] = {
+"CREATE TABLE recordedseekblob ("
+"  chanid INT(10) UNSIGNED NOT NULL DEFAULT '0',"
+"  starttime DATETIME NOT NULL DEFAULT '0000-00-00 00:00:00',"
+"  type TINYINT(4) NOT NULL DEFAULT '0',"
+"  segment INT(10) UNSIGNED NOT NULL DEFAULT '0',"
+"  data LONGBLOB NOT NULL,"
+"  PRIMARY KEY (chanid, starttime, type, segment)"
+");",
+NULL
+};
+        if (!performActualUpdate(updates, "1265", dbver))
+            return false;
+    }
+
     return true;
 }
 
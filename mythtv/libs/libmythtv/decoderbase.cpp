@@ -523,6 +523,34 @@ long long DecoderBase::GetKey(const PosMapEntry &e) const
     return (hasKeyFrameAdjustTable) ? e.adjFrame :(e.index - indexOffset) * kf;
 }
 
+/** \fn DecoderBase::GetSeekPosition(long long)
+ *  \brief Returns the stream position a seek to desiredFrame will start
+ *         reading from, or -1 if the position map does not tell.
+ *
+ *   This picks the same keyframe as DoRewindSeek() and
+ *   DoFastForwardSeek(), but never syncs the position map.
+ */
+long long DecoderBase::GetSeekPosition(long long desiredFrame)
+{
+    if (ringBuffer->IsDisc() || desiredFrame < 0 ||
+        desiredFrame > GetLastFrameInPosMap())
+    {
+        return -1;
+    }
+
+    int pre_idx, post_idx;
+    FindPosition(desiredFrame, hasKeyFrameAdjustTable, pre_idx, post_idx);
+
+    bool rewind  = desiredFrame + 1 < framesPlayed;
+    uint pos_idx = (rewind || exactseeks) ?
+        min(pre_idx, post_idx) : max(pre_idx, post_idx);
+
+    QMutexLocker locker(&m_positionMapLock);
+    if (pos_idx >= m_positionMap.size())
+        return -1;
+    return m_positionMap[pos_idx].pos;
+}
+
 bool DecoderBase::DoRewindSeek(long long desiredFrame)
 {
     if (ringBuffer->IsDVD())
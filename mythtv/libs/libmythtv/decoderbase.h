@@ -150,6 +150,7 @@ class DecoderBase
 
     virtual bool FindPosition(long long desired_value, bool search_adjusted,
                               int &lower_bound, int &upper_bound);
+    long long GetSeekPosition(long long desiredFrame);
 
     uint64_t SavePositionMapDelta(uint64_t first_frame, uint64_t last_frame);
     virtual void SeekReset(long long newkey, uint skipFrames,
@@ -678,6 +678,19 @@ bool DeleteMap::TrackerWantsToJump(uint64_t frame, uint64_t total, uint64_t &to)
     return true;
 }
 
+/**
+ * \brief Provides the frame number the tracker will jump to at the next
+ *        cut point start, returns false if there is no such jump.
+ */
+bool DeleteMap::TrackerNextJump(uint64_t total, uint64_t &to)
+{
+    if (IsEmpty() || m_nextCutStart >= total)
+        return false;
+
+    to = GetNearestMark(m_nextCutStart, total, true);
+    return to < total;
+}
+
 /**
  * \brief Returns the number of the last frame in the video that is not in a
  *        cut sequence.
@@ -49,6 +49,7 @@ class DeleteMap
 
     void TrackerReset(uint64_t frame, uint64_t total);
     bool TrackerWantsToJump(uint64_t frame, uint64_t total, uint64_t &to);
+    bool TrackerNextJump(uint64_t total, uint64_t &to);
 
   private:
     void Add(uint64_t frame, MarkTypes type);
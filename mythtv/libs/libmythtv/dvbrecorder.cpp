@@ -331,6 +331,8 @@ void DVBRecorder::StartRecording(void)
     _continuity_error_count = 0;
     _stream_overflow_count = 0;
 
+    _stream_data->ResetTSStats();
+
     _request_recording = true;
     _recording = true;
 
@@ -377,6 +379,11 @@ void DVBRecorder::StartRecording(void)
     _stream_data->RemoveWritingListener(this);
     _stream_data->RemoveAVListener(this);
 
+    TSStats stats = _stream_data->GetTSStats();
+    VERBOSE(VB_RECORD, LOC + QString("Stream resynced %1 times, "
+                                     "skipping %2 bytes")
+            .arg(stats.ResyncCount()).arg(stats.ResyncBytes()));
+
     Close();
 
     FinishRecording();
@@ -19,7 +19,8 @@ const uint EITCache::kVersionMax = 31;
 
 EITCache::EITCache()
     : accessCnt(0), hitCnt(0),   tblChgCnt(0),   verChgCnt(0),
-      entryCnt(0), pruneCnt(0), prunedHitCnt(0), wrongChannelHitCnt(0)
+      entryCnt(0), pruneCnt(0), prunedHitCnt(0), wrongChannelHitCnt(0),
+      sectionAccessCnt(0), sectionHitCnt(0)
 {
     // 24 hours ago
     lastPruneTime = QDateTime::currentDateTime().toUTC().toTime_t() - 86400;
@@ -40,6 +41,8 @@ void EITCache::ResetStatistics(void)
     pruneCnt  = 0;
     prunedHitCnt = 0;
     wrongChannelHitCnt = 0;
+    sectionAccessCnt = 0;
+    sectionHitCnt = 0;
 }
 
 QString EITCache::GetStatistics(void) const
@@ -53,7 +56,21 @@ QString EITCache::GetStatistics(void) const
         .arg(accessCnt).arg(hitCnt).arg(tblChgCnt).arg(verChgCnt)
         .arg(entryCnt).arg(pruneCnt).arg(prunedHitCnt)
         .arg(wrongChannelHitCnt)
-        .arg((hitCnt+prunedHitCnt+wrongChannelHitCnt)/(double)accessCnt);
+        .arg((hitCnt+prunedHitCnt+wrongChannelHitCnt)/(double)accessCnt) +
+        QString(" Sections: %1, Section Hits: %2, Section Hit Ratio %3.")
+        .arg(sectionAccessCnt).arg(sectionHitCnt)
+        .arg(sectionHitCnt/(double)(sectionAccessCnt ? sectionAccessCnt : 1));
+}
+
+/** \fn EITCache::AddSectionStatistics(uint,uint)
+ *  \brief Adds the counts of the EIT section filter of a stream, see
+ *         DVBStreamData::IsKnownSection().
+ */
+void EITCache::AddSectionStatistics(uint accesses, uint hits)
+{
+    QMutexLocker locker(&eventMapLock);
+    sectionAccessCnt += accesses;
+    sectionHitCnt    += hits;
 }
 
 static inline uint64_t construct_sig(uint tableid, uint version,
@@ -33,6 +33,7 @@ class EITCache
 
     void ResetStatistics(void);
     QString GetStatistics(void) const;
+    void AddSectionStatistics(uint accesses, uint hits);
 
   private:
     event_map_t * LoadChannel(uint chanid);
@@ -53,6 +54,8 @@ class EITCache
     uint        pruneCnt;
     uint        prunedHitCnt;
     uint        wrongChannelHitCnt;
+    uint        sectionAccessCnt;
+    uint        sectionHitCnt;
 
     static const uint kVersionMax;
 
@@ -12,6 +12,7 @@ using namespace std;
 #include "eitfixup.h"
 #include "eitcache.h"
 #include "mythdb.h"
+#include "dbutil.h"
 #include "atsctables.h"
 #include "dvbtables.h"
 #include "premieretables.h"
@@ -27,7 +28,7 @@ using namespace std;
               (_result) )
 #endif
 
-const uint EITHelper::kChunkSize = 20;
+const uint EITHelper::kChunkSize = 1000;
 EITCache *EITHelper::eitcache = new EITCache();
 
 static uint get_chan_id_from_db(uint sourceid,
@@ -43,7 +44,8 @@ static int calc_eit_utc_offset(void);
 EITHelper::EITHelper() :
     eitfixup(new EITFixUp()),
     gps_offset(-1 * GPS_LEAP_SECONDS),          utc_offset(0),
-    sourceid(0)
+    sourceid(0),
+    transactional(DBUtil::IsTransactional("program"))
 {
     init_fixup(fixup);
 
@@ -78,6 +80,12 @@ uint EITHelper::GetListSize(void) const
 /** \fn EITHelper::ProcessEvents(void)
  *  \brief Inserts events in EIT list.
  *
+ *   Takes up to kChunkSize events off the list and writes them with
+ *   DBEvent::BulkUpdateDB() in a single transaction. If that fails the
+ *   transaction is rolled back and the events are written one at a time.
+ *   A MyISAM program table can not roll back, so there the events are
+ *   written one at a time over whatever the bulk update left behind.
+ *
  *  \return Returns number of events inserted into DB.
  */
 uint EITHelper::ProcessEvents(void)
@@ -88,20 +96,55 @@ uint EITHelper::ProcessEvents(void)
     if (!db_events.size())
         return 0;
 
-    MSqlQuery query(MSqlQuery::InitCon());
-    for (uint i = 0; (i < kChunkSize) && (i < db_events.size()); i++)
+    QTime timer;
+    timer.start();
+
+    vector<DBEventEIT*> events;
+    while (events.size() < kChunkSize && db_events.size())
+        events.push_back(db_events.dequeue());
+
+    eitList_lock.unlock();
+
+    QMap<uint, vector<const DBEvent*> > chan_events;
+    for (uint i = 0; i < events.size(); i++)
     {
-        DBEventEIT *event = db_events.dequeue();
-        eitList_lock.unlock();
+        eitfixup->Fix(*events[i]);
+        chan_events[events[i]->chanid].push_back(events[i]);
+    }
 
-        eitfixup->Fix(*event);
+    MSqlQuery query(MSqlQuery::InitCon());
 
-        insertCount += event->UpdateDB(query, 1000);
+    bool ok = !transactional || query.exec("START TRANSACTION");
+    QMap<uint, vector<const DBEvent*> >::const_iterator it;
+    for (it = chan_events.begin(); ok && it != chan_events.end(); ++it)
+    {
+        uint count = 0;
+        ok = DBEvent::BulkUpdateDB(query, it.key(), *it, 1000, count);
+        insertCount += count;
+    }
+    ok = ok && (!transactional || query.exec("COMMIT"));
 
-        delete event;
-        eitList_lock.lock();
+    if (!ok)
+    {
+        VERBOSE(VB_IMPORTANT, LOC_ERR + "Bulk update failed, "
+                "writing events one at a time");
+        if (transactional)
+            query.exec("ROLLBACK");
+
+        insertCount = 0;
+        for (uint i = 0; i < events.size(); i++)
+            insertCount += events[i]->UpdateDB(query, 1000);
     }
 
+    for (uint i = 0; i < events.size(); i++)
+        delete events[i];
+
+    eitList_lock.lock();
+
+    int elapsed = max(timer.elapsed(), 1);
+    QString rate = QString(" in %1 ms (%2 events/s)").arg(elapsed)
+        .arg(events.size() * 1000 / elapsed);
+
     if (!insertCount)
         return 0;
 
@@ -111,11 +154,13 @@ uint EITHelper::ProcessEvents(void)
                 QString("Added %1 events -- complete(%2) "
                         "incomplete(%3) unmatched(%4)")
                 .arg(insertCount).arg(db_events.size())
-                .arg(incomplete_events.size()).arg(unmatched_etts.size()));
+                .arg(incomplete_events.size()).arg(unmatched_etts.size()) +
+                rate);
     }
     else
     {
-        VERBOSE(VB_EIT, LOC + QString("Added %1 events").arg(insertCount));
+        VERBOSE(VB_EIT, LOC + QString("Added %1 events").arg(insertCount) +
+                rate);
     }
 
     return insertCount;
@@ -607,6 +652,11 @@ void EITHelper::WriteEITCache(void)
     eitcache->WriteToDB();
 }
 
+void EITHelper::AddSectionStatistics(uint accesses, uint hits)
+{
+    eitcache->AddSectionStatistics(accesses, hits);
+}
+
 //////////////////////////////////////////////////////////////////////
 // private methods and functions below this line                    //
 //////////////////////////////////////////////////////////////////////
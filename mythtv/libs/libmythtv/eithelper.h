@@ -88,6 +88,7 @@ class EITHelper
     // EIT cache handling
     void PruneEITCache(uint timestamp);
     void WriteEITCache(void);
+    void AddSectionStatistics(uint accesses, uint hits);
 
   private:
     uint GetChanID(uint atsc_major, uint atsc_minor);
@@ -107,6 +108,8 @@ class EITHelper
     int                     gps_offset;
     int                     utc_offset;
     uint                    sourceid;
+    /// true if the program table can roll back a failed bulk update
+    bool                    transactional;
     QMap<uint64_t,uint>     fixup;
     ATSCSRCToEvents         incomplete_events;
     ATSCSRCToETTs           unmatched_etts;
@@ -115,7 +118,7 @@ class EITHelper
 
     QMap<uint,uint>         languagePreferences;
 
-    /// Maximum number of DB inserts per ProcessEvents call.
+    /// Maximum number of events written per ProcessEvents call.
     static const uint kChunkSize;
 };
 
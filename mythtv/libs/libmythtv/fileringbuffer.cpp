@@ -732,6 +732,24 @@ long long FileRingBuffer::Seek(long long pos, int whence, bool has_lock)
     }
 #endif
 
+    // Serve the seek from data the read ahead thread prefetched
+    // for it, if there is any.
+    if (readaheadrunning && (SEEK_SET == whence || SEEK_CUR == whence) &&
+        UsePrefetched(new_pos))
+    {
+        ignorereadpos = -1;
+        readAdjust = 0;
+
+        poslock.unlock();
+
+        generalWait.wakeAll();
+
+        if (!has_lock)
+            rwlock.unlock();
+
+        return new_pos;
+    }
+
     // Here we perform a normal seek. When successful we
     // need to call ResetReadAhead(). A reset means we will
     // need to refill the buffer, which takes some time.
@@ -51,6 +51,18 @@ struct VideoFilter_
     VideoFrameType outpixfmt;
     char *opts;
     FilterInfo *info;
+
+    /*
+     * Optional, NULL unless the filter can process a frame in row slices.
+     * prepare (may be NULL) is called once per frame before the slices and
+     * returns 0 if this frame has to be filtered as a single slice.
+     * filter_slice filters rows [first_row, last_row) of the frame, the
+     * slices of a frame may be filtered concurrently.
+     * Kept last so the members above stay where older filters expect them.
+     */
+    int (*prepare)(struct VideoFilter_ *, VideoFrame *, int);
+    int (*filter_slice)(struct VideoFilter_ *, VideoFrame *, int field,
+                        int first_row, int last_row);
 };
 
 #define FILT_NULL {NULL,NULL,NULL,NULL,NULL}
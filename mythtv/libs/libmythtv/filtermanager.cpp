@@ -10,16 +10,23 @@
 // Qt headers
 #include <QDir>
 #include <QStringList>
+#include <QThreadPool>
+#include <QRunnable>
 
 // MythTV headers
 #include "mythcontext.h"
 #include "filtermanager.h"
+#include "playbacktelemetry.h"
 #include "mythdirs.h"
 
 #define LOC QString("FilterManager: ")
 #define LOC_WARN QString("FilterManager, Warning: ")
 #define LOC_ERR QString("FilterManager, Error: ")
 
+/// Slices start on a multiple of this many rows, so that chroma rows of
+/// subsampled formats and the field parity of deinterlacers line up.
+static const int kSliceAlign = 16;
+
 static const char *FmtToString(VideoFrameType ft)
 {
     switch(ft)
@@ -39,8 +46,52 @@ static const char *FmtToString(VideoFrameType ft)
     }
 }
 
+class FilterSlice : public QRunnable
+{
+  public:
+    FilterSlice(FilterChain *c, VideoFilter *f, VideoFrame *fr,
+                int fld, int first, int last) :
+        chain(c), filter(f), frame(fr), field(fld),
+        first_row(first), last_row(last)
+    {
+    }
+
+    void run(void)
+    {
+        filter->filter_slice(filter, frame, field, first_row, last_row);
+        chain->SliceDone();
+    }
+
+  private:
+    FilterChain *chain;
+    VideoFilter *filter;
+    VideoFrame  *frame;
+    int          field;
+    int          first_row;
+    int          last_row;
+};
+
+FilterChain::FilterChain(int max_threads) :
+    processTime(0), pool(NULL), slices(1), slicesPending(0)
+{
+    if (max_threads > 1)
+    {
+        pool = new QThreadPool();
+        pool->setMaxThreadCount(max_threads - 1);
+        pool->setExpiryTimeout(-1);
+        slices = max_threads;
+    }
+}
+
 FilterChain::~FilterChain()
 {
+    if (pool)
+    {
+        pool->waitForDone();
+        delete pool;
+        pool = NULL;
+    }
+
     vector<VideoFilter*>::iterator it = filters.begin();
     for (; it != filters.end(); ++it)
     {
@@ -60,9 +111,64 @@ void FilterChain::ProcessFrame(VideoFrame *frame, FrameScanType scan)
     if (!frame)
         return;
 
+    int field = (kScan_Intr2ndField == scan);
+    int64_t start = PlaybackTelemetry::Now();
+
     vector<VideoFilter*>::iterator it = filters.begin();
     for (; it != filters.end(); ++it)
-        (*it)->filter(*it, frame, kScan_Intr2ndField == scan);
+    {
+        if (pool && (*it)->filter_slice)
+            ProcessSlices(*it, frame, field);
+        else
+            (*it)->filter(*it, frame, field);
+    }
+
+    processTime = (int)(PlaybackTelemetry::Now() - start);
+}
+
+/** \fn FilterChain::ProcessSlices(VideoFilter*,VideoFrame*,int)
+ *  \brief Runs filter_slice over horizontal slices of the frame.
+ *
+ *   The first slice is run on the calling thread, the others on the
+ *   pool. Returns once every slice is done. The frame is run as a single
+ *   slice if the filter's prepare function asks for it, or if the frame
+ *   is too short to be worth splitting.
+ */
+void FilterChain::ProcessSlices(VideoFilter *f, VideoFrame *frame, int field)
+{
+    int ret = f->prepare ? f->prepare(f, frame, field) : 1;
+    if (ret < 0)
+        return;
+
+    int rows = (frame->height / slices) & ~(kSliceAlign - 1);
+    if (!ret || rows < kSliceAlign)
+    {
+        f->filter_slice(f, frame, field, 0, frame->height);
+        return;
+    }
+
+    slicesLock.lock();
+    slicesPending = slices - 1;
+    slicesLock.unlock();
+
+    for (int i = 1; i < slices; i++)
+    {
+        int last = (i == slices - 1) ? frame->height : (i + 1) * rows;
+        pool->start(new FilterSlice(this, f, frame, field, i * rows, last));
+    }
+
+    f->filter_slice(f, frame, field, 0, rows);
+
+    QMutexLocker locker(&slicesLock);
+    while (slicesPending)
+        slicesDone.wait(&slicesLock);
+}
+
+void FilterChain::SliceDone(void)
+{
+    QMutexLocker locker(&slicesLock);
+    if (!--slicesPending)
+        slicesDone.wakeAll();
 }
 
 FilterManager::FilterManager()
@@ -204,7 +310,7 @@ FilterChain *FilterManager::LoadFilters(QString Filters,
         return NULL;
 
     vector<const FilterInfo*> FiltInfoChain;
-    FilterChain *FiltChain = new FilterChain;
+    FilterChain *FiltChain = new FilterChain(max_threads);
     vector<FmtConv*> FmtList;
     const FilterInfo *FI;
     const FilterInfo *FI2;
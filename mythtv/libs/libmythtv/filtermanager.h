@@ -13,24 +13,50 @@ using namespace std;
 
 // Qt headers
 #include <QString>
+#include <QMutex>
+#include <QWaitCondition>
+
+class QThreadPool;
 
 typedef map<QString,void*>       library_map_t;
 typedef map<QString,FilterInfo*> filter_map_t;
 
 #include "videoouttypes.h"
 
+/** \class FilterChain
+ *  \brief Runs a list of filters over each frame.
+ *
+ *   Filters which provide filter_slice are run as horizontal slices on
+ *   a pool of max_threads - 1 worker threads plus the calling thread.
+ *   The workers are kept for the lifetime of the chain.
+ */
 class FilterChain
 {
+    friend class FilterSlice;
+
   public:
-    FilterChain() { }
+    FilterChain(int max_threads = 1);
     virtual ~FilterChain();
 
     void ProcessFrame(VideoFrame *Frame, FrameScanType scan = kScan_Ignore);
 
     void Append(VideoFilter *f) { filters.push_back(f); }
 
+    /// \brief Returns the time the last ProcessFrame() took, in usecs.
+    int GetProcessTime(void) const { return processTime; }
+
   private:
+    void ProcessSlices(VideoFilter *f, VideoFrame *frame, int field);
+    void SliceDone(void);
+
     vector<VideoFilter*> filters;
+    int            processTime;
+
+    QThreadPool   *pool;
+    int            slices;
+    QMutex         slicesLock;
+    QWaitCondition slicesDone;
+    int            slicesPending;
 };
 
 class FilterManager
@@ -278,6 +278,8 @@ void HDHRRecorder::StartRecording(void)
         return;
     }
 
+    _stream_data->ResetTSStats();
+
     _request_recording = true;
     _recording = true;
 
@@ -322,6 +324,11 @@ void HDHRRecorder::StartRecording(void)
     _stream_data->RemoveWritingListener(this);
     _stream_data->RemoveAVListener(this);
 
+    TSStats stats = _stream_data->GetTSStats();
+    VERBOSE(VB_RECORD, LOC + QString("Stream resynced %1 times, "
+                                     "skipping %2 bytes")
+            .arg(stats.ResyncCount()).arg(stats.ResyncBytes()));
+
     Close();
 
     FinishRecording();
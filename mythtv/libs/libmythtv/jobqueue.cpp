@@ -2178,6 +2178,11 @@ void JobQueue::DoFlagCommercialsThread(int jobID)
         }
     }
 
+    // The recording lists show the recording as being flagged until
+    // they hear that it is not
+    if (priority <= LP_WARNING)
+        program_info->SendUpdateEvent();
+
     msg = tr("Commercial Detection %1", "Job ID")
         .arg(StatusText(GetJobStatus(jobID)));
 
@@ -1,3 +1,10 @@
+#include <stdint.h>
+
+#include <vector>
+using namespace std;
+
+#include <QMutex>
+#include <QMap>
 
 #include "atsc_huffman.h"
 
@@ -34,116 +41,224 @@ static inline int huffman1_get_root(uint input, const unsigned char *table)
     return (table[input * 2] << 8) | table[(input * 2) + 1];
 }
 
-/* Returns the bit number bit from string test[] */
-static inline bool huffman1_get_bit(const unsigned char *src, uint bit)
+/* Returns width bits (up to 17) starting at bit number bit of src[],
+ * padded with zeros past the end of src[] */
+static inline uint huffman_get_bits(const unsigned char *src, uint size,
+                                    uint bit, uint width)
 {
-    return (src[(bit - (bit & 0x7)) >> 3] >> (7 - (bit & 0x7))) & 0x01;
+    uint value = 0;
+    for (uint byte = bit >> 3, i = 0; i < 3; byte++, i++)
+        value = (value << 8) | ((byte < size) ? src[byte] : 0);
+    return (value >> (24 - (bit & 0x7) - width)) & ((1 << width) - 1);
 }
 
-QString atsc_huffman1_to_string(const unsigned char *compressed,
-                                uint size, uint table_index)
+/// Entry of a Huffman1Decoder state which ends a character
+static const uint16_t kHuffman1Leaf = 0x8000;
+
+/** \class Huffman1Decoder
+ *  \brief Decodes 8 bits at a time of a text compressed with ATSC_C5
+ *         or ATSC_C7, instead of walking the tree one bit at a time.
+ *
+ *   A state stands for a node of the tree of the previous character.
+ *   Its entry for the next 8 bits is either the state after those bits,
+ *   or kHuffman1Leaf | (bits used) << 8 | character.
+ */
+class Huffman1Decoder
 {
-    QString retval = "";
+  public:
+    Huffman1Decoder(const unsigned char *table);
 
-    const unsigned char *table = atsc_tables[table_index];
-    int totalbits = size * 8;
-    int bit = 0;
-    int root = huffman1_get_root(0, table);
-    int node = 0;
-    bool thebit;
-    unsigned char val;
+    uint Root(uint ch) const { return roots[ch]; }
+    uint16_t Lookup(uint state, uint bits) const
+        { return states[(state << 8) | bits]; }
 
-    while (bit < totalbits)
-    {
-        thebit = huffman1_get_bit(compressed, bit);
-        val = (thebit) ? table[root + (node*2) + 1] : table[root + (node*2)];
+  private:
+    uint AddState(uint root, uint node);
 
-        if (val & 0x80)
+    const unsigned char *table;
+    QMap<uint, uint>     state_index;
+    vector<uint16_t>     states;
+    uint                 roots[128];
+};
+
+Huffman1Decoder::Huffman1Decoder(const unsigned char *_table) :
+    table(_table)
+{
+    for (uint ch = 0; ch < 128; ch++)
+        roots[ch] = AddState(huffman1_get_root(ch, table), 0);
+    state_index.clear();
+}
+
+/// Returns the state for node of the tree at root, adding it and the
+/// states following it if they do not exist yet.
+uint Huffman1Decoder::AddState(uint root, uint node)
+{
+    uint key = (root << 7) | node;
+    QMap<uint, uint>::const_iterator it = state_index.find(key);
+    if (it != state_index.end())
+        return *it;
+
+    uint state = states.size() >> 8;
+    state_index[key] = state;
+    states.resize(states.size() + 256, 0);
+
+    for (uint bits = 0; bits < 256; bits++)
+    {
+        uint cur = node;
+        uint16_t entry = 0;
+        for (uint i = 0; i < 8 && !entry; i++)
         {
-            /* Got a Null Character so return */
-            if ((val & 0x7F) == 0)
-            {
-                return retval;
-            }
-            /* Escape character so next character is uncompressed */
-            if ((val & 0x7F) == 27)
-            {
-                unsigned char val2 = 0;
-                for (int i = 0 ; i < 7 ; i++)
-                {
-                    val2 |=
-                        huffman1_get_bit(compressed, bit + i + 2) << (6 - i);
-                }
-                retval += QChar(val2);
-                bit += 8;
-                root = huffman1_get_root(val2, table);
-            }
-            /* Standard Character */
+            unsigned char val =
+                table[root + (cur * 2) + ((bits >> (7 - i)) & 0x01)];
+            if (val & 0x80)
+                entry = kHuffman1Leaf | ((i + 1) << 8) | (val & 0x7F);
             else
-            {
-                root = huffman1_get_root(val & 0x7F, table);
-                retval += QChar(val & 0x7F);
-            }
-            node = 0;
+                cur = val;
         }
-        else
-            node = val;
-        bit++;
+
+        if (!entry)
+            entry = AddState(root, cur);
+        states[(state << 8) | bits] = entry;
     }
-    /* If you get here something went wrong so just return a blank string */
-    return QString("");
+
+    return state;
 }
 
-static inline int huffman2_get_bit(unsigned char &bitpos,
-                                   const unsigned char **bufptr)
+/** \class Huffman2Decoder
+ *  \brief Finds the code at the start of the next max_size - 1 bits with
+ *         a single lookup, instead of trying each length in turn.
+ *
+ *   An entry is 0 if no code matches, or length << 8 | character.
+ */
+class Huffman2Decoder
 {
-   int ret = ((**bufptr & bitpos) != 0);
-   bitpos >>= 1;
-   if (!bitpos)
-   {
-       bitpos = 0x80;
-       (*bufptr)++;
-   }
-   return ret;
-}
+  public:
+    Huffman2Decoder(const struct huffman_table *table,
+                    const unsigned char *lookup,
+                    uint min_size, uint max_size);
+
+    uint Width(void) const { return width; }
+    uint16_t Lookup(uint bits) const { return codes[bits]; }
+
+  private:
+    uint             width;
+    vector<uint16_t> codes;
+};
 
-static inline void huffman2_set_pos(unsigned char &bitpos,
-                                    const unsigned char **bufptr,
-                                    const unsigned char *buffer,
-                                    uint pos)
+Huffman2Decoder::Huffman2Decoder(const struct huffman_table *table,
+                                 const unsigned char *lookup,
+                                 uint min_size, uint max_size) :
+    width(max_size - 1), codes(1 << (max_size - 1), 0)
 {
-    *bufptr = buffer + (pos >> 3);
-    bitpos  = 0x80 >> (pos & 0x7);
+    for (uint bits = 0; bits < codes.size(); bits++)
+    {
+        for (uint cur_size = min_size; cur_size < max_size; cur_size++)
+        {
+            uint key = lookup[bits >> (width - cur_size)];
+            if (key && (table[key].number_of_bits == cur_size))
+            {
+                codes[bits] = (cur_size << 8) | table[key].character;
+                break;
+            }
+        }
+    }
 }
 
-QString atsc_huffman2_to_string(const unsigned char *compressed,
-                                uint length, uint table)
+static QMutex           huffman_lock;
+static Huffman1Decoder *huffman1_decoder[3] = { NULL, NULL, NULL };
+static Huffman2Decoder *huffman2_decoder[2] = { NULL, NULL };
+
+/// Returns the decoder for ATSC_C5 or ATSC_C7, building it on first use.
+static const Huffman1Decoder &huffman1_get_decoder(uint table_index)
 {
-    QString decompressed = "";
+    QMutexLocker locker(&huffman_lock);
+
+    if (!huffman1_decoder[table_index])
+    {
+        huffman1_decoder[table_index] =
+            new Huffman1Decoder(atsc_tables[table_index]);
+    }
 
-    unsigned char        bitpos;
-    const unsigned char *bufptr;
-    huffman2_set_pos(bitpos, &bufptr, compressed, 0);
+    return *huffman1_decoder[table_index];
+}
+
+/// Returns the decoder for Table128 or Table255, building it on first use.
+static const Huffman2Decoder &huffman2_get_decoder(uint table)
+{
+    QMutexLocker locker(&huffman_lock);
 
-    // Determine which huffman table to use
-    struct huffman_table *ptrTable;
-    const unsigned char  *lookup;
-    uint                  min_size;
-    uint                  max_size;
     if (table == 1)
     {
-        ptrTable = Table128;
-        lookup   = Huff2Lookup128;
-        min_size = 3;
-        max_size = 12;
+        if (!huffman2_decoder[0])
+            huffman2_decoder[0] =
+                new Huffman2Decoder(Table128, Huff2Lookup128, 3, 12);
+        return *huffman2_decoder[0];
     }
-    else
+
+    if (!huffman2_decoder[1])
+        huffman2_decoder[1] =
+            new Huffman2Decoder(Table255, Huff2Lookup256, 2, 14);
+    return *huffman2_decoder[1];
+}
+
+QString atsc_huffman1_to_string(const unsigned char *compressed,
+                                uint size, uint table_index)
+{
+    QString retval = "";
+
+    const Huffman1Decoder &decoder = huffman1_get_decoder(table_index);
+    uint totalbits = size * 8;
+    uint bit = 0;
+    uint state = decoder.Root(0);
+
+    while (bit < totalbits)
     {
-        ptrTable = Table255;
-        lookup   = Huff2Lookup256;
-        min_size = 2;
-        max_size = 14;
+        uint16_t entry = decoder.Lookup(
+            state, huffman_get_bits(compressed, size, bit, 8));
+
+        if (!(entry & kHuffman1Leaf))
+        {
+            state = entry;
+            bit += 8;
+            continue;
+        }
+
+        bit += (entry >> 8) & 0xF;
+        if (bit > totalbits)
+            break;
+
+        unsigned char val = entry & 0x7F;
+        /* Got a Null Character so return */
+        if (val == 0)
+        {
+            return retval;
+        }
+        /* Escape character so next character is uncompressed */
+        if (val == 27)
+        {
+            unsigned char val2 =
+                huffman_get_bits(compressed, size, bit + 1, 7);
+            retval += QChar(val2);
+            bit += 8;
+            state = decoder.Root(val2);
+        }
+        /* Standard Character */
+        else
+        {
+            state = decoder.Root(val);
+            retval += QChar(val);
+        }
     }
+    /* If you get here something went wrong so just return a blank string */
+    return QString("");
+}
+
+QString atsc_huffman2_to_string(const unsigned char *compressed,
+                                uint length, uint table)
+{
+    QString decompressed = "";
+
+    const Huffman2Decoder &decoder = huffman2_get_decoder(table);
 
     // walk thru all the bits in the byte array, finding each sequence in the
     // list and decoding it to a character.
@@ -152,27 +267,18 @@ QString atsc_huffman2_to_string(const unsigned char *compressed,
 
     while (current_bit + 3 < total_bits)
     {
-        uint cur_size = 0;
-        uint bits     = 0;
-
-        for (; cur_size < min_size; cur_size++)
-            bits = (bits << 1) | huffman2_get_bit(bitpos, &bufptr);
+        uint16_t entry = decoder.Lookup(huffman_get_bits(
+            compressed, length, current_bit, decoder.Width()));
 
-        while (cur_size < max_size)
+        if (!entry)
         {
-            uint key = lookup[bits];
-            if (key && (ptrTable[key].number_of_bits == cur_size))
-            {
-                decompressed += ptrTable[key].character;
-                current_bit += cur_size;
-                break;
-            }
-            bits = (bits << 1) | huffman2_get_bit(bitpos, &bufptr);
-            cur_size++;
+            current_bit++;
+            continue;
         }
 
-        if (cur_size == max_size)
-            huffman2_set_pos(bitpos, &bufptr, compressed, ++current_bit);
+        unsigned char character = entry & 0xFF;
+        decompressed += character;
+        current_bit += entry >> 8;
     }
 
     return decompressed;
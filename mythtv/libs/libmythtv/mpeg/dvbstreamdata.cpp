@@ -14,13 +14,21 @@ using namespace std;
 #define MCA_EIT_TSID 136
 #define MCA_EIT_PID 1018
 
+/// Upper limit of DVBStreamData::_eit_known_sections, it is emptied
+/// when this is reached to drop the sections of old versions.
+static const int kMaxKnownEITSections = 256 * 1024;
+/// Section counts between updates of the EITCache statistics.
+static const uint kKnownEITStatsInterval = 4096;
+
 // service_id is synonymous with the MPEG program number in the PMT.
 DVBStreamData::DVBStreamData(uint desired_netid,  uint desired_tsid,
                              int desired_program, bool cacheTables)
     : MPEGStreamData(desired_program, cacheTables),
       _desired_netid(desired_netid), _desired_tsid(desired_tsid),
       _dvb_eit_dishnet_long(false),
-      _nit_version(-2), _nito_version(-2)
+      _nit_version(-2),
+      _eit_known_accesses(0), _eit_known_hits(0),
+      _nito_version(-2)
 {
     SetVersionNIT(-1,0);
     SetVersionNITo(-1,0);
@@ -176,6 +184,66 @@ bool DVBStreamData::IsRedundant(uint pid, const PSIPTable &psip) const
     return false;
 }
 
+static inline uint64_t known_section_key(const PSIPTable &psip)
+{
+    return (((uint64_t) psip.TableID())          << 56) |
+           (((uint64_t) psip.TableIDExtension()) << 40) |
+           (((uint64_t) psip.Section())          << 32) |
+           psip.CRC();
+}
+
+/** \fn DVBStreamData::IsKnownSection(uint, const PSIPTable&)
+ *  \brief Returns true if this is a repeat of an EIT section which
+ *         has already been handled.
+ *
+ *   EIT carousels repeat every few seconds, most of the sections reaching
+ *   IsRedundant() have been decoded before but are not caught there when
+ *   the version of the table was changed by another transport's EIT with
+ *   the same service id. This only compares the table id, service id,
+ *   section number, version and CRC in the section header and trailer,
+ *   so it is done before the CRC is checked and the section is decoded.
+ */
+bool DVBStreamData::IsKnownSection(uint /*pid*/, const PSIPTable &psip)
+{
+    if (!DVBEventInformationTable::IsEIT(psip.TableID()) || !psip.HasCRC())
+        return false;
+
+    QHash<uint64_t, int>::const_iterator it =
+        _eit_known_sections.find(known_section_key(psip));
+    bool known = (it != _eit_known_sections.end()) &&
+                 (*it == (int) psip.Version());
+
+    _eit_known_accesses++;
+    _eit_known_hits += (known) ? 1 : 0;
+
+    if (_eit_known_accesses >= kKnownEITStatsInterval)
+    {
+        QMutexLocker locker(&_listener_lock);
+        if (_eit_helper)
+        {
+            _eit_helper->AddSectionStatistics(
+                _eit_known_accesses, _eit_known_hits);
+        }
+        _eit_known_accesses = 0;
+        _eit_known_hits     = 0;
+    }
+
+    return known;
+}
+
+/// \brief Remembers an EIT section which passed all checks for
+///        IsKnownSection().
+void DVBStreamData::AddKnownEITSection(const PSIPTable &psip)
+{
+    if (!psip.HasCRC())
+        return;
+
+    if (_eit_known_sections.size() >= kMaxKnownEITSections)
+        _eit_known_sections.clear();
+
+    _eit_known_sections[known_section_key(psip)] = psip.Version();
+}
+
 void DVBStreamData::Reset(uint desired_netid, uint desired_tsid,
                           int desired_serviceid)
 {
@@ -189,6 +257,7 @@ void DVBStreamData::Reset(uint desired_netid, uint desired_tsid,
     _sdt_section_seen.clear();
     _eit_version.clear();
     _eit_section_seen.clear();
+    _eit_known_sections.clear();
     _cit_version.clear();
     _cit_section_seen.clear();
 
@@ -367,6 +436,7 @@ bool DVBStreamData::HandleTables(uint pid, const PSIPTable &psip)
         uint service_id = psip.TableIDExtension();
         SetVersionEIT(psip.TableID(), service_id, psip.Version(),  psip.LastSection());
         SetEITSectionSeen(psip.TableID(), service_id, psip.Section());
+        AddKnownEITSection(psip);
 
         DVBEventInformationTable eit(psip);
         for (uint i = 0; i < _dvb_eit_listeners.size(); i++)
@@ -3,6 +3,8 @@
 #ifndef DVBSTREAMDATA_H_
 #define DVBSTREAMDATA_H_
 
+#include <QHash>
+
 #include "mpegstreamdata.h"
 
 typedef NetworkInformationTable* nit_ptr_t;
@@ -38,6 +40,7 @@ class DVBStreamData : virtual public MPEGStreamData
     // Table processing
     bool HandleTables(uint pid, const PSIPTable&);
     bool IsRedundant(uint pid, const PSIPTable&) const;
+    bool IsKnownSection(uint pid, const PSIPTable&);
     void ProcessSDT(uint tsid, const ServiceDescriptionTable*);
 
     // EIT info/processing
@@ -166,6 +169,7 @@ class DVBStreamData : virtual public MPEGStreamData
 
     void SetEITSectionSeen(uint tableid, uint serviceid, uint section);
     bool EITSectionSeen(uint tableid, uint serviceid, uint section) const;
+    void AddKnownEITSection(const PSIPTable&);
 
     void SetBATSectionSeen(uint bid, uint section);
     bool BATSectionSeen(uint bid, uint section) const;
@@ -229,6 +233,11 @@ class DVBStreamData : virtual public MPEGStreamData
     sections_map_t            _sdt_section_seen;
     QMap<uint, int>           _eit_version;
     sections_map_t            _eit_section_seen;
+    /// Version of each EIT section handled, by table, service,
+    /// section number and CRC, see IsKnownSection()
+    QHash<uint64_t, int>      _eit_known_sections;
+    uint                      _eit_known_accesses;
+    uint                      _eit_known_hits;
     // Premiere private ContentInformationTable
     QMap<uint, int>           _cit_version;
     sections_map_t            _cit_section_seen;
@@ -1,3 +1,11 @@
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+using namespace std;
+
+#include <QMutex>
+
 #include "freesat_huffman.h"
 
 struct fsattab {
@@ -12,39 +20,140 @@ struct fsattab {
 
 #include "freesat_tables.h"
 
-QString freesat_huffman_to_string(const unsigned char *src, uint size)
+/// Entry of a FreesatDecoder node which ends a code
+static const uint16_t kFsatLeaf = 0x8000;
+
+/** \class FreesatDecoder
+ *  \brief Multi-bit lookup tables for one of the Freesat Huffman tables.
+ *
+ *   Each node decodes the next 8 bits of the input. The first 128 nodes
+ *   are the roots for the previous character, codes longer than 8 bits
+ *   continue in further nodes. An entry is 0 if no code matches, the
+ *   next node, or kFsatLeaf | (bits used in this node) << 8 | character.
+ *
+ *   The tables are built so the result is the first entry of fsat_table
+ *   which matches, as with a linear search of the table.
+ */
+class FreesatDecoder
 {
-    struct fsattab *fsat_table;
-    unsigned int *fsat_index;
+  public:
+    FreesatDecoder(const fsattab *table, const unsigned int *index);
 
-    if (src[1] == 1 || src[1] == 2)
+    uint16_t Lookup(uint node, uint bits) const
+        { return nodes[(node << 8) | bits]; }
+
+  private:
+    void Fill(uint node, const vector<const fsattab*> &codes, uint depth);
+
+    vector<uint16_t> nodes;
+};
+
+FreesatDecoder::FreesatDecoder(const fsattab *table,
+                               const unsigned int *index) :
+    nodes(128 << 8, 0)
+{
+    for (uint ch = 0; ch < 128; ch++)
     {
-        if (src[1] == 1)
+        vector<const fsattab*> codes;
+        for (uint j = index[ch]; j < index[ch + 1]; j++)
+            codes.push_back(&table[j]);
+        Fill(ch, codes, 0);
+    }
+}
+
+/// Fills in node for the codes which start with the depth bits that lead
+/// to it, in table order.
+void FreesatDecoder::Fill(uint node, const vector<const fsattab*> &codes,
+                          uint depth)
+{
+    for (uint bits = 0; bits < 256; bits++)
+    {
+        vector<const fsattab*> matching;
+        for (uint i = 0; i < codes.size(); i++)
         {
-            fsat_table = fsat_table_1;
-            fsat_index = fsat_index_1;
-        } else {
-            fsat_table = fsat_table_2;
-            fsat_index = fsat_index_2;
+            // A code that ended before this node would be a prefix of the
+            // one that led here, which a Huffman table never has; it also
+            // must not shift by 32 or more below
+            if (codes[i]->bits <= 0 || (uint)codes[i]->bits <= depth ||
+                depth >= 32)
+            {
+                continue;
+            }
+
+            uint n = min((uint)codes[i]->bits - depth, 8U);
+            if (((codes[i]->value << depth) >> (32 - n)) == (bits >> (8 - n)))
+                matching.push_back(codes[i]);
         }
-        QByteArray uncompressed(size * 3, '\0');
-        int p = 0;
-        unsigned value = 0, byte = 2, bit = 0;
-        while (byte < 6 && byte < size)
+
+        if (matching.empty())
+            continue;
+
+        // The first match is certain once all its bits are known
+        if ((uint)matching[0]->bits <= depth + 8)
         {
-            value |= src[byte] << ((5-byte) * 8);
-            byte++;
+            nodes[(node << 8) | bits] = kFsatLeaf |
+                ((matching[0]->bits - depth) << 8) |
+                (uint8_t)matching[0]->next;
+            continue;
         }
+
+        uint child = nodes.size() >> 8;
+        nodes[(node << 8) | bits] = child;
+        nodes.resize(nodes.size() + 256, 0);
+        Fill(child, matching, depth + 8);
+    }
+}
+
+static QMutex          fsat_lock;
+static FreesatDecoder *fsat_decoder[2] = { NULL, NULL };
+
+/// Returns the decoder for table 1 or 2, building it on first use.
+static const FreesatDecoder &get_decoder(uint table)
+{
+    QMutexLocker locker(&fsat_lock);
+
+    if (!fsat_decoder[table - 1])
+    {
+        if (table == 1)
+            fsat_decoder[0] = new FreesatDecoder(fsat_table_1, fsat_index_1);
+        else
+            fsat_decoder[1] = new FreesatDecoder(fsat_table_2, fsat_index_2);
+    }
+
+    return *fsat_decoder[table - 1];
+}
+
+/// Returns 32 bits of the compressed data, starting at bit pos after the
+/// two header bytes, padded with zeros at the end.
+static inline uint32_t get_bits(const unsigned char *src, uint size, uint pos)
+{
+    uint64_t value = 0;
+    for (uint byte = 2 + (pos >> 3), i = 0; i < 5; byte++, i++)
+        value = (value << 8) | ((byte < size) ? src[byte] : 0);
+    return (uint32_t)(value >> (8 - (pos & 7)));
+}
+
+QString freesat_huffman_to_string(const unsigned char *src, uint size)
+{
+    if (src[1] == 1 || src[1] == 2)
+    {
+        const FreesatDecoder &decoder = get_decoder(src[1]);
+
+        QByteArray uncompressed(size * 3, '\0');
+        int p = 0;
+        uint pos = 0;
+        // Decode until all the data has been shifted out of a 32 bit
+        // window, or at least 32 bits for short strings.
+        uint end = (size + 4 - max(2U, min(6U, size))) * 8;
         char lastch = START;
 
         do
         {
-            bool found = false;
+            uint32_t value = get_bits(src, size, pos);
             unsigned bitShift = 0;
             char nextCh = STOP;
             if (lastch == ESCAPE)
             {
-                found = true;
                 // Encoded in the next 8 bits.
                 // Terminated by the first ASCII character.
                 nextCh = (value >> 24) & 0xff;
@@ -58,55 +167,35 @@ QString freesat_huffman_to_string(const unsigned char *src, uint size)
             }
             else
             {
-                unsigned indx = (unsigned)lastch;
-                for (unsigned j = fsat_index[indx]; j < fsat_index[indx+1]; j++)
+                uint node = (uint8_t)lastch;
+                uint16_t entry = decoder.Lookup(node, value >> 24);
+                while (entry && !(entry & kFsatLeaf))
                 {
-                    unsigned mask = 0, maskbit = 0x80000000;
-                    for (short kk = 0; kk < fsat_table[j].bits; kk++)
-                    {
-                        mask |= maskbit;
-                        maskbit >>= 1;
-                    }
-                    if ((value & mask) == fsat_table[j].value)
-                    {
-                        nextCh = fsat_table[j].next;
-                        bitShift = fsat_table[j].bits;
-                        found = true;
-                        lastch = nextCh;
-                        break;
-                    }
+                    bitShift += 8;
+                    entry = decoder.Lookup(entry, (value << bitShift) >> 24);
                 }
-            }
-            if (found)
-            {
-                if (nextCh != STOP && nextCh != ESCAPE)
-                {
-                    if (p >= uncompressed.count())
-                        uncompressed.resize(p+10);
-                    uncompressed[p++] = nextCh;
-                }
-                // Shift up by the number of bits.
-                for (unsigned b = 0; b < bitShift; b++)
+
+                if (!entry)
                 {
-                    value = (value << 1) & 0xfffffffe;
-                    if (byte < size)
-                        value |= (src[byte] >> (7-bit)) & 1;
-                    if (bit == 7)
-                    {
-                        bit = 0;
-                        byte++;
-                    }
-                    else bit++;
+                    // Entry missing in table.
+                    QString result = QString::fromUtf8(uncompressed, p);
+                    result.append("...");
+                    return result;
                 }
+
+                bitShift += (entry >> 8) & 0xf;
+                nextCh = entry & 0xff;
+                lastch = nextCh;
             }
-            else
+
+            if (nextCh != STOP && nextCh != ESCAPE)
             {
-                // Entry missing in table.
-                QString result = QString::fromUtf8(uncompressed, p);
-                result.append("...");
-                return result;
+                if (p >= uncompressed.count())
+                    uncompressed.resize(p+10);
+                uncompressed[p++] = nextCh;
             }
-        } while (lastch != STOP && byte < size+4);
+            pos += bitShift;
+        } while (lastch != STOP && pos < end);
 
         return QString::fromUtf8(uncompressed, p);
     }
@@ -11,6 +11,7 @@ using namespace std;
 #include <QString>
 
 // MythTV headers
+#include "mythconfig.h"
 #include "mpegstreamdata.h"
 #include "mpegtables.h"
 #include "ringbuffer.h"
@@ -19,6 +20,14 @@ using namespace std;
 #include "atscstreamdata.h"
 #include "atsctables.h"
 
+#if HAVE_MMX
+// avlib/ffmpeg headers
+extern "C" {
+#include "libavcodec/avcodec.h"        // FF_MM_SSE2
+}
+extern "C" int mm_support(void);    // in libavcodec/x86/cpuid.c
+#endif
+
 //#define DEBUG_MPEG_RADIO // uncomment to strip video streams from TS stream
 
 void init_sections(sections_t &sect, uint last_section)
@@ -47,6 +56,76 @@ const unsigned char MPEGStreamData::bit_sel[8] =
     0x1, 0x2, 0x4, 0x8, 0x10, 0x20, 0x40, 0x80,
 };
 
+/// Number of sync bytes, TSPacket::SIZE apart, ResyncStream() looks for
+const int MPEGStreamData::kResyncSyncBytes = 3;
+
+#if ARCH_X86
+static int has_sse2 = -1;
+
+// Check for SSE2 support on x86 / x86_64
+static inline bool sse2_check(void)
+{
+#if HAVE_MMX
+    if (has_sse2 == -1)
+        has_sse2 = (mm_support() & FF_MM_SSE2) ? 1 : 0;
+    return (bool)has_sse2;
+#else
+    return false;
+#endif
+}
+
+static const unsigned char sync_bytes16[16] __attribute__ ((aligned (16))) =
+{
+    SYNC_BYTE, SYNC_BYTE, SYNC_BYTE, SYNC_BYTE,
+    SYNC_BYTE, SYNC_BYTE, SYNC_BYTE, SYNC_BYTE,
+    SYNC_BYTE, SYNC_BYTE, SYNC_BYTE, SYNC_BYTE,
+    SYNC_BYTE, SYNC_BYTE, SYNC_BYTE, SYNC_BYTE,
+};
+
+typedef unsigned char sse2_block[16];
+
+/** \brief Returns a bitmask with bit i set iff both buf[i] and
+ *         buf[i + TSPacket::SIZE] are sync bytes, for i in [0,16).
+ *
+ *   The bytes read are passed as memory operands, so the compiler
+ *   completes any stores to them before the asm runs.
+ */
+static inline uint sync_pair_mask_sse2(const unsigned char *buf)
+{
+    uint mask;
+    __asm__ (
+        "movdqa     %3, %%xmm2          \n\t"
+        "movdqu     %1, %%xmm0          \n\t"
+        "movdqu     %2, %%xmm1          \n\t"
+        "pcmpeqb    %%xmm2, %%xmm0      \n\t"
+        "pcmpeqb    %%xmm2, %%xmm1      \n\t"
+        "pand       %%xmm1, %%xmm0      \n\t"
+        "pmovmskb   %%xmm0, %0          \n\t"
+        :"=r"(mask)
+        :"m"(*(const sse2_block*)buf),
+         "m"(*(const sse2_block*)(buf + TSPacket::SIZE)),
+         "m"(sync_bytes16)
+        :"xmm0", "xmm1", "xmm2"
+    );
+    return mask;
+}
+#endif //ARCH_X86
+
+/** \brief Returns true if every byte at pos + n * TSPacket::SIZE
+ *         is a sync byte, for up to MPEGStreamData::kResyncSyncBytes
+ *         positions that lie inside the buffer.
+ */
+static inline bool is_sync_aligned(const unsigned char *buffer, int pos,
+                                   int len, int sync_bytes)
+{
+    for (int i = 0; i < sync_bytes && pos < len; i++, pos += TSPacket::SIZE)
+    {
+        if (buffer[pos] != SYNC_BYTE)
+            return false;
+    }
+    return true;
+}
+
 /** \class MPEGStreamData
  *  \brief Encapsulates data about MPEG stream and emits events for each table.
  */
@@ -84,6 +163,7 @@ MPEGStreamData::MPEGStreamData(int desiredProgram, bool cacheTables)
 
     // MS Windows doesn't like bzero()..
     memset(_si_time_offsets, 0, sizeof(_si_time_offsets));
+    memset(_pid_flags, 0, sizeof(_pid_flags));
 
     AddListeningPID(MPEG_PAT_PID);
 }
@@ -213,6 +293,8 @@ void MPEGStreamData::Reset(int desiredProgram)
 
     ResetDecryptionMonitoringState();
 
+    RebuildPIDTable();
+
     AddListeningPID(MPEG_PAT_PID);
 }
 
@@ -619,11 +701,16 @@ bool MPEGStreamData::CreatePMTSingleProgram(const ProgramMapTable &pmt)
     }
 
     _pids_audio.clear();
+    ClearPIDFlags(kPIDFlagAudio);
     for (uint i = 0; i < audioPIDs.size(); i++)
         AddAudioPID(audioPIDs[i]);
 
     if (videoPIDs.size() >= 1)
+    {
+        ClearPIDFlags(kPIDFlagVideo);
         _pid_video_single_program = videoPIDs[0];
+        SetPIDFlag(_pid_video_single_program, kPIDFlagVideo);
+    }
     for (uint i = 1; i < videoPIDs.size(); i++)
         AddWritingPID(videoPIDs[i]);
 
@@ -875,6 +962,10 @@ void MPEGStreamData::HandleTSTables(const TSPacket* tspacket)
         (TableID::STUFFING == psip->TableID()))
         DONE_WITH_PES_PACKET();
 
+    // drop repeats of sections already handled, before the CRC check
+    if (IsKnownSection(tspacket->PID(), *psip))
+        DONE_WITH_PES_PACKET();
+
     // Validate PSIP
     // but don't validate PMT/PAT if our driver has the PMT/PAT CRC bug.
     bool buggy = _have_CRC_bug &&
@@ -932,6 +1023,19 @@ void MPEGStreamData::HandleTSTables(const TSPacket* tspacket)
 }
 #undef DONE_WITH_PES_PACKET
 
+/// Returns a copy of the statistics, they are updated by ProcessData()
+TSStats MPEGStreamData::GetTSStats(void) const
+{
+    QMutexLocker locker(&_ts_stats_lock);
+    return _ts_stats;
+}
+
+void MPEGStreamData::ResetTSStats(void)
+{
+    QMutexLocker locker(&_ts_stats_lock);
+    _ts_stats.Reset();
+}
+
 int MPEGStreamData::ProcessData(const unsigned char *buffer, int len)
 {
     int pos = 0;
@@ -945,12 +1049,30 @@ int MPEGStreamData::ProcessData(const unsigned char *buffer, int len)
             if (newpos == -1)
                 return len - pos;
             if (newpos == -2)
+            {
+                QMutexLocker locker(&_ts_stats_lock);
+                _ts_stats.IncrResyncCount(len - pos - TSPacket::SIZE);
                 return TSPacket::SIZE;
+            }
 
+            _ts_stats_lock.lock();
+            _ts_stats.IncrResyncCount(newpos - pos);
+            _ts_stats_lock.unlock();
             pos = newpos;
         }
 
         const TSPacket *pkt = reinterpret_cast<const TSPacket*>(&buffer[pos]);
+
+        // Runs of A/V or write-only packets go to the listeners in one call
+        uint run = PacketRunLength(pkt, (len - pos) / TSPacket::SIZE);
+        if (run > 1)
+        {
+            ProcessTSPacketRun(pkt, run);
+            pos += run * TSPacket::SIZE;
+            resync = false;
+            continue;
+        }
+
         if (ProcessTSPacket(*pkt))
         {
             pos += TSPacket::SIZE; // Advance to next TS packet
@@ -1014,48 +1136,179 @@ bool MPEGStreamData::ProcessTSPacket(const TSPacket& tspacket)
     return true;
 }
 
+/** \fn MPEGStreamData::PacketRunLength(const TSPacket*,uint) const
+ *  \brief Returns the number of consecutive packets, starting with
+ *         tspacket, that ProcessTSPacketRun() can handle as one batch.
+ *
+ *   A run only contains in sync, error free, unscrambled packets
+ *   on a single PID which GetPIDDispatch() allows to be batched.
+ *   A/V packets without payload end the run since ProcessTSPacket()
+ *   treats them differently.
+ *
+ *  \param max_packets Number of whole packets available in the buffer.
+ */
+uint MPEGStreamData::PacketRunLength(
+    const TSPacket *tspacket, uint max_packets) const
+{
+    const uint pid = tspacket->PID();
+    const PIDDispatch dispatch = GetPIDDispatch(pid);
+    if (kPIDDispatchNone == dispatch)
+        return 0;
+
+    const bool need_payload = (kPIDDispatchWriting != dispatch);
+
+    uint cnt = 0;
+    for (; cnt < max_packets; cnt++)
+    {
+        const TSPacket &pkt = tspacket[cnt];
+        if (!pkt.HasSync() || pkt.PID() != pid ||
+            pkt.TransportError() || pkt.Scrambled() ||
+            (need_payload && !pkt.HasPayload()))
+        {
+            break;
+        }
+    }
+
+    return cnt;
+}
+
+/** \fn MPEGStreamData::ProcessTSPacketRun(const TSPacket*,uint)
+ *  \brief Hands a run of packets found by PacketRunLength() to the
+ *         A/V or writing listeners with a single call per listener.
+ */
+void MPEGStreamData::ProcessTSPacketRun(const TSPacket *tspackets, uint count)
+{
+    switch (GetPIDDispatch(tspackets->PID()))
+    {
+        case kPIDDispatchVideo:
+            for (uint j = 0; j < _ts_av_listeners.size(); j++)
+                _ts_av_listeners[j]->ProcessVideoTSPackets(tspackets, count);
+            break;
+        case kPIDDispatchAudio:
+            for (uint j = 0; j < _ts_av_listeners.size(); j++)
+                _ts_av_listeners[j]->ProcessAudioTSPackets(tspackets, count);
+            break;
+        case kPIDDispatchWriting:
+            for (uint j = 0; j < _ts_writing_listeners.size(); j++)
+                _ts_writing_listeners[j]->ProcessTSPackets(tspackets, count);
+            break;
+        case kPIDDispatchNone:
+            break;
+    }
+}
+
+/** \fn MPEGStreamData::ResyncStream(const unsigned char*,int,int)
+ *  \brief Finds the first offset at or after curr_pos where
+ *         kResyncSyncBytes sync bytes line up TSPacket::SIZE apart.
+ *
+ *   At least two sync bytes must be present, sync bytes which would
+ *   lie past the end of the buffer are not checked. On x86 with SSE2
+ *   sixteen candidate offsets are tested per step.
+ *
+ *  \return offset, -1 if there are not enough bytes to check,
+ *          or -2 if no sync was found.
+ */
 int MPEGStreamData::ResyncStream(const unsigned char *buffer, int curr_pos,
                                  int len)
 {
-    // Search for two sync bytes 188 bytes apart,
     int pos = curr_pos;
-    int nextpos = pos + TSPacket::SIZE;
-    if (nextpos >= len)
+    if (pos + (int)TSPacket::SIZE >= len)
         return -1; // not enough bytes; caller should try again
 
-    while (buffer[pos] != SYNC_BYTE || buffer[nextpos] != SYNC_BYTE)
+#if ARCH_X86
+    if (sse2_check())
+    {
+        // Each step looks at buffer[pos..pos+15] and the sixteen
+        // bytes one packet later, so stop while both are in range.
+        for (; pos + 16 + (int)TSPacket::SIZE <= len; pos += 16)
+        {
+            uint mask = sync_pair_mask_sse2(buffer + pos);
+            for (int i = 0; mask; i++, mask >>= 1)
+            {
+                if ((mask & 0x1) &&
+                    is_sync_aligned(buffer, pos + i + 2 * TSPacket::SIZE,
+                                    len, kResyncSyncBytes - 2))
+                {
+                    return pos + i;
+                }
+            }
+        }
+    }
+#endif //ARCH_X86
+
+    for (; pos + (int)TSPacket::SIZE < len; pos++)
     {
-        pos++;
-        nextpos++;
-        if (nextpos == len)
-            return -2; // not found
+        if (is_sync_aligned(buffer, pos, len, kResyncSyncBytes))
+            return pos;
     }
 
-    return pos;
+    return -2; // not found
 }
 
 bool MPEGStreamData::IsListeningPID(uint pid) const
 {
-    pid_map_t::const_iterator it = _pids_listening.find(pid);
-    return it != _pids_listening.end();
+    return _pid_flags[pid & 0x1fff] & kPIDFlagListening;
 }
 
 bool MPEGStreamData::IsNotListeningPID(uint pid) const
 {
-    pid_map_t::const_iterator it = _pids_notlistening.find(pid);
-    return it != _pids_notlistening.end();
+    return _pid_flags[pid & 0x1fff] & kPIDFlagNotListening;
 }
 
 bool MPEGStreamData::IsWritingPID(uint pid) const
 {
-    pid_map_t::const_iterator it = _pids_writing.find(pid);
-    return it != _pids_writing.end();
+    return _pid_flags[pid & 0x1fff] & kPIDFlagWriting;
 }
 
 bool MPEGStreamData::IsAudioPID(uint pid) const
 {
-    pid_map_t::const_iterator it = _pids_audio.find(pid);
-    return it != _pids_audio.end();
+    return _pid_flags[pid & 0x1fff] & kPIDFlagAudio;
+}
+
+void MPEGStreamData::ClearPIDFlags(uint flag)
+{
+    const unsigned char mask = ~flag;
+    for (uint i = 0; i < sizeof(_pid_flags); i++)
+        _pid_flags[i] &= mask;
+}
+
+/** \fn MPEGStreamData::RebuildPIDTable(void)
+ *  \brief Recomputes the flat per-PID classification table from the
+ *         listening, writing, audio, video and encryption test PIDs.
+ *
+ *   ProcessTSPacket() is called for every packet, so it consults
+ *   this table rather than doing several map lookups per packet.
+ *   The Add/Remove methods keep it current, this is used when
+ *   whole PID sets are replaced.
+ */
+void MPEGStreamData::RebuildPIDTable(void)
+{
+    memset(_pid_flags, 0, sizeof(_pid_flags));
+
+    pid_map_t::const_iterator it = _pids_listening.begin();
+    for (; it != _pids_listening.end(); ++it)
+        SetPIDFlag(it.key(), kPIDFlagListening);
+
+    it = _pids_notlistening.begin();
+    for (; it != _pids_notlistening.end(); ++it)
+        SetPIDFlag(it.key(), kPIDFlagNotListening);
+
+    it = _pids_writing.begin();
+    for (; it != _pids_writing.end(); ++it)
+        SetPIDFlag(it.key(), kPIDFlagWriting);
+
+    it = _pids_audio.begin();
+    for (; it != _pids_audio.end(); ++it)
+        SetPIDFlag(it.key(), kPIDFlagAudio);
+
+    if (_pid_video_single_program < 0x1fff)
+        SetPIDFlag(_pid_video_single_program, kPIDFlagVideo);
+
+    QMutexLocker locker(&_encryption_lock);
+    QMap<uint, CryptInfo>::const_iterator eit =
+        _encryption_pid_to_info.begin();
+    for (; eit != _encryption_pid_to_info.end(); ++eit)
+        SetPIDFlag(eit.key(), kPIDFlagEncTest);
 }
 
 uint MPEGStreamData::GetPIDs(pid_map_t &pids) const
@@ -1605,6 +1858,7 @@ void MPEGStreamData::AddEncryptionTestPID(uint pnum, uint pid, bool isvideo)
     AddListeningPID(pid);
 
     _encryption_pid_to_info[pid] = CryptInfo((isvideo) ? 10000 : 500, 8);
+    SetPIDFlag(pid, kPIDFlagEncTest);
 
     _encryption_pid_to_pnums[pid].push_back(pnum);
     _encryption_pnum_to_pids[pnum].push_back(pid);
@@ -1644,6 +1898,7 @@ void MPEGStreamData::RemoveEncryptionTestPIDs(uint pnum)
             {
                 _encryption_pid_to_pnums.remove(pid);
                 _encryption_pid_to_info.remove(pid);
+                ClearPIDFlag(pid, kPIDFlagEncTest);
             }
         }
     }
@@ -1653,12 +1908,7 @@ void MPEGStreamData::RemoveEncryptionTestPIDs(uint pnum)
 
 bool MPEGStreamData::IsEncryptionTestPID(uint pid) const
 {
-    QMutexLocker locker(&_encryption_lock);
-
-    QMap<uint, CryptInfo>::const_iterator it =
-        _encryption_pid_to_info.find(pid);
-
-    return it != _encryption_pid_to_info.end();
+    return _pid_flags[pid & 0x1fff] & kPIDFlagEncTest;
 }
 
 void MPEGStreamData::TestDecryption(const ProgramMapTable *pmt)
@@ -1692,6 +1942,7 @@ void MPEGStreamData::ResetDecryptionMonitoringState(void)
     _encryption_pid_to_info.clear();
     _encryption_pid_to_pnums.clear();
     _encryption_pnum_to_pids.clear();
+    ClearPIDFlags(kPIDFlagEncTest);
 }
 
 bool MPEGStreamData::IsProgramDecrypted(uint pnum) const
@@ -14,6 +14,7 @@ using namespace std;
 #include <QMap>
 
 #include "tspacket.h"
+#include "tsstats.h"
 #include "util.h"
 #include "streamlisteners.h"
 #include "eitscanner.h"
@@ -83,6 +84,26 @@ typedef enum
 } PIDPriority;
 typedef QMap<uint, PIDPriority> pid_map_t;
 
+/// Bits in MPEGStreamData's flat per-PID classification table
+typedef enum
+{
+    kPIDFlagListening    = 0x01,
+    kPIDFlagNotListening = 0x02,
+    kPIDFlagWriting      = 0x04,
+    kPIDFlagAudio        = 0x08,
+    kPIDFlagVideo        = 0x10,
+    kPIDFlagEncTest      = 0x20,
+} PIDFlag;
+
+/// How a run of packets on one PID is handed to the TS listeners
+typedef enum
+{
+    kPIDDispatchNone    = 0,
+    kPIDDispatchVideo   = 1,
+    kPIDDispatchAudio   = 2,
+    kPIDDispatchWriting = 3,
+} PIDDispatch;
+
 class MPEGStreamData : public EITSource
 {
   public:
@@ -109,36 +130,69 @@ class MPEGStreamData : public EITSource
     // Table processing
     void SetIgnoreCRC(bool haveCRCbug) { _have_CRC_bug = haveCRCbug; }
     virtual bool IsRedundant(uint pid, const PSIPTable&) const;
+    virtual bool IsKnownSection(uint /*pid*/, const PSIPTable&)
+        { return false; }
     virtual bool HandleTables(uint pid, const PSIPTable &psip);
     virtual void HandleTSTables(const TSPacket* tspacket);
     virtual bool ProcessTSPacket(const TSPacket& tspacket);
     virtual int  ProcessData(const unsigned char *buffer, int len);
     inline  void HandleAdaptationFieldControl(const TSPacket* tspacket);
 
+    // Statistics
+    TSStats GetTSStats(void) const;
+    void ResetTSStats(void);
+
     // Listening
     virtual void AddListeningPID(
         uint pid, PIDPriority priority = kPIDPriorityNormal)
-        { _pids_listening[pid] = priority; }
+    {
+        _pids_listening[pid] = priority;
+        SetPIDFlag(pid, kPIDFlagListening);
+    }
     virtual void AddNotListeningPID(uint pid)
-        { _pids_notlistening[pid] = kPIDPriorityNormal; }
+    {
+        _pids_notlistening[pid] = kPIDPriorityNormal;
+        SetPIDFlag(pid, kPIDFlagNotListening);
+    }
     virtual void AddWritingPID(
         uint pid, PIDPriority priority = kPIDPriorityHigh)
-        { _pids_writing[pid] = priority; }
+    {
+        _pids_writing[pid] = priority;
+        SetPIDFlag(pid, kPIDFlagWriting);
+    }
     virtual void AddAudioPID(
         uint pid, PIDPriority priority = kPIDPriorityHigh)
-        { _pids_audio[pid] = priority; }
+    {
+        _pids_audio[pid] = priority;
+        SetPIDFlag(pid, kPIDFlagAudio);
+    }
 
-    virtual void RemoveListeningPID(uint pid) { _pids_listening.remove(pid);  }
+    virtual void RemoveListeningPID(uint pid)
+    {
+        _pids_listening.remove(pid);
+        ClearPIDFlag(pid, kPIDFlagListening);
+    }
     virtual void RemoveNotListeningPID(uint pid)
-        { _pids_notlistening.remove(pid); }
-    virtual void RemoveWritingPID(uint pid) { _pids_writing.remove(pid);    }
-    virtual void RemoveAudioPID(uint pid)   { _pids_audio.remove(pid);      }
+    {
+        _pids_notlistening.remove(pid);
+        ClearPIDFlag(pid, kPIDFlagNotListening);
+    }
+    virtual void RemoveWritingPID(uint pid)
+    {
+        _pids_writing.remove(pid);
+        ClearPIDFlag(pid, kPIDFlagWriting);
+    }
+    virtual void RemoveAudioPID(uint pid)
+    {
+        _pids_audio.remove(pid);
+        ClearPIDFlag(pid, kPIDFlagAudio);
+    }
 
     virtual bool IsListeningPID(uint pid) const;
     virtual bool IsNotListeningPID(uint pid) const;
     virtual bool IsWritingPID(uint pid) const;
     bool IsVideoPID(uint pid) const
-        { return _pid_video_single_program == pid; }
+        { return _pid_flags[pid & 0x1fff] & kPIDFlagVideo; }
     virtual bool IsAudioPID(uint pid) const;
 
     const pid_map_t& ListeningPIDs(void) const
@@ -301,6 +355,18 @@ class MPEGStreamData : public EITSource
     void ProcessEncryptedPacket(const TSPacket&);
 
     static int ResyncStream(const unsigned char *buffer, int curr_pos, int len);
+    static const int kResyncSyncBytes;
+
+    // Flat PID classification table, kept in sync with the PID maps
+    void SetPIDFlag(uint pid, uint flag)
+        { _pid_flags[pid & 0x1fff] |= flag; }
+    void ClearPIDFlag(uint pid, uint flag)
+        { _pid_flags[pid & 0x1fff] &= ~flag; }
+    void ClearPIDFlags(uint flag);
+    void RebuildPIDTable(void);
+    inline PIDDispatch GetPIDDispatch(uint pid) const;
+    uint PacketRunLength(const TSPacket *tspacket, uint max_packets) const;
+    void ProcessTSPacketRun(const TSPacket *tspackets, uint count);
 
     void UpdateTimeOffset(uint64_t si_utc_time);
 
@@ -331,6 +397,11 @@ class MPEGStreamData : public EITSource
     pid_map_t _pids_notlistening;
     pid_map_t _pids_writing;
     pid_map_t _pids_audio;
+    unsigned char _pid_flags[0x1fff + 1];
+
+    // Statistics
+    mutable QMutex            _ts_stats_lock;
+    TSStats                   _ts_stats;
 
     // Encryption monitoring
     mutable QMutex            _encryption_lock;
@@ -412,6 +483,28 @@ inline int MPEGStreamData::VersionPMTSingleProgram() const
     return (_pmt_single_program) ? int(_pmt_single_program->Version()) : -1;
 }
 
+/** \fn MPEGStreamData::GetPIDDispatch(uint) const
+ *  \brief Returns the listener group packets on this PID can be
+ *         handed to in a batch, mirroring the order of the checks
+ *         in ProcessTSPacket().
+ *
+ *   PIDs we are monitoring for encryption or are parsing tables
+ *   from always take the per-packet path.
+ */
+inline PIDDispatch MPEGStreamData::GetPIDDispatch(uint pid) const
+{
+    const uint flags = _pid_flags[pid & 0x1fff];
+    if (flags & kPIDFlagEncTest)
+        return kPIDDispatchNone;
+    if (flags & kPIDFlagVideo)
+        return kPIDDispatchVideo;
+    if (flags & kPIDFlagAudio)
+        return kPIDDispatchAudio;
+    if ((flags & kPIDFlagWriting) && !(flags & kPIDFlagListening))
+        return kPIDDispatchWriting;
+    return kPIDDispatchNone;
+}
+
 inline void MPEGStreamData::HandleAdaptationFieldControl(const TSPacket*)
 {
     // TODO
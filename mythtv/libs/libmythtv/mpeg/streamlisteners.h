@@ -52,6 +52,13 @@ class TSPacketListener
   public:
     virtual bool ProcessTSPacket(const TSPacket& tspacket) = 0;
 
+    /// Called with a run of consecutive packets sharing one PID
+    virtual void ProcessTSPackets(const TSPacket *tspackets, uint count)
+    {
+        for (uint i = 0; i < count; i++)
+            ProcessTSPacket(tspackets[i]);
+    }
+
   protected:
     virtual ~TSPacketListener() { }
 };
@@ -62,6 +69,20 @@ class TSPacketListenerAV
     virtual bool ProcessVideoTSPacket(const TSPacket& tspacket) = 0;
     virtual bool ProcessAudioTSPacket(const TSPacket& tspacket) = 0;
 
+    /// Called with a run of consecutive packets on the video PID
+    virtual void ProcessVideoTSPackets(const TSPacket *tspackets, uint count)
+    {
+        for (uint i = 0; i < count; i++)
+            ProcessVideoTSPacket(tspackets[i]);
+    }
+
+    /// Called with a run of consecutive packets on one audio PID
+    virtual void ProcessAudioTSPackets(const TSPacket *tspackets, uint count)
+    {
+        for (uint i = 0; i < count; i++)
+            ProcessAudioTSPacket(tspackets[i]);
+    }
+
   protected:
     virtual ~TSPacketListenerAV() { }
 };
@@ -7,31 +7,46 @@
 #include <QMap>
 
 /** \class TSStats
- *  \brief Collects statistics on the number of TSPacket's seen on each PID.
+ *  \brief Collects statistics on the number of TSPacket's seen on each PID,
+ *         and on how often the stream had to be resynchronized.
  *
- *  \sa TSPacket, HDTVRecorder
+ *  \sa TSPacket, HDTVRecorder, MPEGStreamData::ProcessData()
  */
 class TSStats
 {
   public:
-    TSStats() : _tspacket_count(0) { ; }
+    TSStats() :
+        _tspacket_count(0), _resync_count(0), _resync_bytes(0) { ; }
     void IncrPIDCount(int pid)  { _pid_counts[pid]++;  }
     void IncrTSPacketCount() { _tspacket_count++; }
-    long long TSPacketCount() { return _tspacket_count; }
-    void Reset() { _tspacket_count = 0; _pid_counts.clear(); }
-    inline QString toString();
+    long long TSPacketCount() const { return _tspacket_count; }
+    void IncrResyncCount(long long skipped_bytes)
+        { _resync_count++; _resync_bytes += skipped_bytes; }
+    long long ResyncCount() const { return _resync_count; }
+    long long ResyncBytes() const { return _resync_bytes; }
+    void Reset()
+    {
+        _tspacket_count = 0; _pid_counts.clear();
+        _resync_count = 0; _resync_bytes = 0;
+    }
+    inline QString toString() const;
   private:
     long long _tspacket_count;
+    long long _resync_count;
+    long long _resync_bytes;
     QMap<int, long long> _pid_counts;
 };
 
-inline QString TSStats::toString() {
+inline QString TSStats::toString() const
+{
     QString str("Transport Stream Statistics\n");
-    str.append(QString("TSPacket Count: %1").arg((long)_tspacket_count));
-    QMapIterator<int, long long> it = _pid_counts.begin();
-    for (; it != _pid_counts.end(); it++)
+    str.append(QString("TSPacket Count: %1").arg(_tspacket_count));
+    str.append(QString("\nResync Count: %1 (%2 bytes skipped)")
+               .arg(_resync_count).arg(_resync_bytes));
+    QMap<int, long long>::const_iterator it = _pid_counts.begin();
+    for (; it != _pid_counts.end(); ++it)
         str.append(QString("\nPID 0x%1 Count: %2").
-                   arg((int)it.key(),0,16).arg((long)it.data(),10,10));
+                   arg(it.key(),0,16).arg(*it,10,10));
     return str;
 }
 
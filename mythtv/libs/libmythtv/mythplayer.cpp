@@ -430,6 +430,7 @@ void MythPlayer::PauseVideo(void)
     videoPauseLock.lock();
     needNewPauseFrame = true;
     videoPaused = true;
+    telemetry.Reset();
     videoPauseLock.unlock();
 }
 
@@ -437,6 +438,8 @@ void MythPlayer::UnpauseVideo(void)
 {
     videoPauseLock.lock();
     videoPaused = false;
+    // The time spent paused is not a frame interval
+    telemetry.Reset();
     if (videoOutput)
         videoOutput->ExposeEvent();
     videoPauseLock.unlock();
@@ -1111,9 +1114,11 @@ void MythPlayer::InitFilters(void)
         int btmp;
         postfilt_width = video_dim.width();
         postfilt_height = video_dim.height();
+        int threads = videoOutput ? videoOutput->GetMaxCPUs() : 1;
 
         videoFilters = FiltMan->LoadFilters(
-            filters, itmp, otmp, postfilt_width, postfilt_height, btmp);
+            filters, itmp, otmp, postfilt_width, postfilt_height, btmp,
+            threads);
     }
 
     videofiltersLock.unlock();
@@ -1728,20 +1733,27 @@ void MythPlayer::AVSync(VideoFrame *buffer, bool limit_delay)
         {
             // If we are using software decoding, skip this frame altogether.
             VERBOSE(VB_PLAYBACK, LOC + dbg + "dropping frame to catch up.");
+            telemetry_sample.flags |= TelemetrySample::kDropped;
         }
     }
     else if (!using_null_videoout)
     {
         // if we get here, we're actually going to do video output
+        int64_t start = PlaybackTelemetry::Now();
         osdLock.lock();
         videoOutput->PrepareFrame(buffer, ps, osd);
         osdLock.unlock();
+        int64_t prepared = PlaybackTelemetry::Now();
         VERBOSE(VB_PLAYBACK|VB_TIMESTAMP, QString("AVSync waitforframe %1 %2")
                 .arg(avsync_adjustment).arg(m_double_framerate));
         videosync->WaitForFrame(frameDelay + avsync_adjustment + repeat_delay);
         VERBOSE(VB_PLAYBACK|VB_TIMESTAMP, "AVSync show");
+        int64_t waited = PlaybackTelemetry::Now();
         videoOutput->Show(ps);
 
+        telemetry_sample.present =
+            (int)((prepared - start) + (PlaybackTelemetry::Now() - waited));
+
         if (videoOutput->IsErrored())
         {
             VERBOSE(VB_IMPORTANT, LOC_ERR + "Error condition detected "
@@ -1774,8 +1786,11 @@ void MythPlayer::AVSync(VideoFrame *buffer, bool limit_delay)
         repeat_delay = frame_interval * repeat_pict * 0.5;
 
         if (repeat_delay)
+        {
             VERBOSE(VB_TIMESTAMP, QString("A/V repeat_pict, adding %1 repeat "
                     "delay").arg(repeat_delay));
+            telemetry_sample.flags |= TelemetrySample::kRepeated;
+        }
     }
     else
     {
@@ -1785,6 +1800,9 @@ void MythPlayer::AVSync(VideoFrame *buffer, bool limit_delay)
     if (output_jmeter)
         output_jmeter->RecordCycleTime();
 
+    telemetry_sample.av_offset = avsync_delay;
+    telemetry.AddSample(telemetry_sample);
+
     avsync_adjustment = 0;
 
     if (diverge > MAXDIVERGE)
@@ -1934,8 +1952,11 @@ bool MythPlayer::PrebufferEnoughFrames(bool pause_audio, int min_buffers)
         if ((waited_for & 100) == 100)
         {
             VERBOSE(VB_IMPORTANT, LOC +
-                QString("Waited 100ms for video buffers %1")
-                .arg(videoOutput->GetFrameStatus()));
+                QString("Waited 100ms for video buffers %1, "
+                        "%2 of %3 hand-offs contended")
+                .arg(videoOutput->GetFrameStatus())
+                .arg(videoOutput->GetFrameStats().contended)
+                .arg(videoOutput->GetFrameStats().transitions));
         }
         if ((waited_for > 500) && !videoOutput->EnoughFreeFrames())
         {
@@ -1981,11 +2002,16 @@ void MythPlayer::DisplayNormalFrame(bool check_prebuffer)
     if (kScan_Detect == m_scan || kScan_Ignore == m_scan)
         ps = kScan_Progressive;
 
+    int64_t start = PlaybackTelemetry::Now();
     osdLock.lock();
     videofiltersLock.lock();
     videoOutput->ProcessFrame(frame, osd, videoFilters, pip_players, ps);
+    telemetry_sample.frame  = framesPlayed;
+    telemetry_sample.filter = videoFilters ? videoFilters->GetProcessTime() : 0;
     videofiltersLock.unlock();
     osdLock.unlock();
+    telemetry_sample.osd = (int)(PlaybackTelemetry::Now() - start) -
+        telemetry_sample.filter;
 
     AVSync(frame, 0);
     videoOutput->DoneDisplayingFrame(frame);
@@ -2508,6 +2534,44 @@ void MythPlayer::EventStart(void)
     commBreakMap.LoadMap(player_ctx, framesPlayed);
 }
 
+/** \fn MythPlayer::UpdatePrefetchTargets(void)
+ *  \brief Tells the RingBuffer where the next jumps are likely to land.
+ *
+ *   These are the end of the next commercial break and the end of the
+ *   next cut. The RingBuffer fetches the data there while its buffer is
+ *   full, so the jump does not stall on a cold read from the backend.
+ *
+ *   The targets only change when playback passes a break or cut. Skip
+ *   ahead and skip back targets are not used, they move with every
+ *   keyframe and each new target costs the backend its read-ahead.
+ */
+void MythPlayer::UpdatePrefetchTargets(void)
+{
+    if (!decoder || !player_ctx->buffer || player_ctx->buffer->IsDisc())
+        return;
+
+    QList<uint64_t> frames;
+    uint64_t jumpto = 0;
+
+    if (deleteMap.IsEmpty() &&
+        commBreakMap.GetNextSkipTarget(jumpto, framesPlayed, video_frame_rate))
+    {
+        frames.push_back(jumpto);
+    }
+    if (deleteMap.TrackerNextJump(totalFrames, jumpto))
+        frames.push_back(jumpto);
+
+    QList<long long> positions;
+    for (int i = 0; i < frames.size(); i++)
+    {
+        long long pos = decoder->GetSeekPosition(frames[i]);
+        if (pos >= 0 && !positions.contains(pos))
+            positions.push_back(pos);
+    }
+
+    player_ctx->buffer->SetPrefetchTargets(positions);
+}
+
 void MythPlayer::EventLoop(void)
 {
     // recreate the osd if a reinit was triggered by another thread
@@ -2536,6 +2600,13 @@ void MythPlayer::EventLoop(void)
         }
     }
 
+    // Let the RingBuffer fetch the data for the likely next jumps
+    if (prefetchTimer.isNull() || prefetchTimer.elapsed() > 2000)
+    {
+        UpdatePrefetchTargets();
+        prefetchTimer.start();
+    }
+
     // Refresh the programinfo in use status
     player_ctx->LockPlayingInfo(__FILE__, __LINE__);
     if (player_ctx->playingInfo)
@@ -2921,7 +2992,11 @@ bool MythPlayer::DecoderGetFrame(DecodeType decodetype, bool unsafe)
         return false;
     }
     else if (ffrew_skip == 1 || decodeOneFrame)
+    {
+        int64_t start = PlaybackTelemetry::Now();
         ret = decoder->GetFrame(decodetype);
+        telemetry.AddDecodeTime((int)(PlaybackTelemetry::Now() - start));
+    }
     else if (ffrew_skip != 0)
         ret = DecoderGetFrameFFREW();
     return ret;
@@ -3478,6 +3553,7 @@ void MythPlayer::ClearAfterSeek(bool clearvideobuffers)
     commBreakMap.SetTracker(framesPlayed);
     commBreakMap.ResetLastSkip();
     needNewPauseFrame = true;
+    telemetry.Reset();
 }
 
 void MythPlayer::SetPlayerInfo(TV *tv, QWidget *widget,
@@ -4096,6 +4172,31 @@ QString MythPlayer::GetXDS(const QString &key) const
     return decoder->GetXDS(key);
 }
 
+/// \brief Returns the timing of the recently displayed frames as CSV.
+QString MythPlayer::GetTelemetryCSV(void) const
+{
+    return telemetry.GetCSV();
+}
+
+/// \brief Returns a text histogram of the recent frame intervals.
+QString MythPlayer::GetTelemetryHistogram(void) const
+{
+    return telemetry.GetHistogram(frame_interval);
+}
+
+/// \brief Returns the frame queue hand-off and lock wait counters.
+QString MythPlayer::GetFrameQueueStats(void) const
+{
+    if (!videoOutput)
+        return QString();
+
+    VideoBufferStats stats = videoOutput->GetFrameStats();
+    return QString("Frame hand-offs %1, %2 waited %3 ms, "
+                   "%4 waits for a free frame")
+        .arg(stats.transitions).arg(stats.contended)
+        .arg(stats.wait_usecs / 1000).arg(stats.free_waits);
+}
+
 void MythPlayer::InitForTranscode(bool copyaudio, bool copyvideo)
 {
     // Are these really needed?
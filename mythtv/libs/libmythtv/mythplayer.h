@@ -14,6 +14,7 @@
 #include "ringbuffer.h"
 #include "osd.h"
 #include "jitterometer.h"
+#include "playbacktelemetry.h"
 #include "videooutbase.h"
 #include "teletextreader.h"
 #include "subtitlereader.h"
@@ -175,6 +176,7 @@ class MPUBLIC MythPlayer
     int     GetLength(void) const             { return totalLength; }
     uint64_t GetTotalFrameCount(void) const   { return totalFrames; }
     uint64_t GetFramesPlayed(void) const      { return framesPlayed; }
+    PlayerContext *GetPlayerContext(void)     { return player_ctx; }
     virtual  uint64_t GetBookmark(void);
     QString   GetError(void) const;
     bool      IsErrorRecoverable(void) const
@@ -185,6 +187,9 @@ class MPUBLIC MythPlayer
     void      GetCodecDescription(InfoMap &infoMap);
     QString   GetXDS(const QString &key) const;
     PIPLocation GetNextPIPLocation(void) const;
+    QString   GetTelemetryCSV(void) const;
+    QString   GetTelemetryHistogram(void) const;
+    QString   GetFrameQueueStats(void) const;
 
     // Bool Gets
     bool    GetRawAudioState(void) const;
@@ -397,6 +402,7 @@ class MPUBLIC MythPlayer
     virtual void EventStart(void);
     virtual void EventLoop(void);
     virtual void InitialSeek(void);
+    void         UpdatePrefetchTargets(void);
 
     // Protected MHEG/MHI stuff
     bool ITVHandleAction(const QString &action);
@@ -683,6 +689,9 @@ class MPUBLIC MythPlayer
     QTime      editUpdateTimer;
     float      speedBeforeEdit;
 
+    // Seek prefetching
+    QTime      prefetchTimer;
+
     // Playback (output) speed control
     /// Lock for next_play_speed and next_normal_speed
     QMutex     decoder_lock;
@@ -720,6 +729,8 @@ class MPUBLIC MythPlayer
 
     // Debugging variables
     Jitterometer *output_jmeter;
+    PlaybackTelemetry telemetry;
+    TelemetrySample   telemetry_sample; ///< frame being displayed
 };
 
 #endif
@@ -0,0 +1,211 @@
+#include <sys/time.h>
+
+#include <climits>
+#include <cstdlib>
+#include <algorithm>
+using namespace std;
+
+#include <QStringList>
+
+#include "playbacktelemetry.h"
+
+#define HISTOGRAM_WIDTH 40
+
+/// Upper bounds of the frame interval histogram buckets, in tenths of
+/// the nominal frame interval; the last bucket is open ended.
+static const int kIntervalBuckets[] = { 5, 9, 11, 16, 25, INT_MAX };
+static const char *kIntervalLabels[] =
+{
+    "   < 0.5x", "0.5 - 0.9x", "0.9 - 1.1x", "1.1 - 1.6x", "1.6 - 2.5x",
+    "   > 2.5x",
+};
+static const uint kNumIntervalBuckets =
+    sizeof(kIntervalBuckets) / sizeof(kIntervalBuckets[0]);
+
+PlaybackTelemetry::PlaybackTelemetry(uint size) :
+    ring(max(size, 1U)), next(0), count(0),
+    last_shown(0), decode_sum(0), decode_count(0)
+{
+}
+
+/// \brief Returns the current time in microseconds.
+int64_t PlaybackTelemetry::Now(void)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+}
+
+/// \brief Discards all samples, e.g. after a seek.
+void PlaybackTelemetry::Reset(void)
+{
+    QMutexLocker locker(&lock);
+    next         = 0;
+    count        = 0;
+    last_shown   = 0;
+    decode_sum   = 0;
+    decode_count = 0;
+}
+
+/// \brief Records the time the decoder took for one frame.
+void PlaybackTelemetry::AddDecodeTime(int usecs)
+{
+    QMutexLocker locker(&lock);
+    decode_sum += usecs;
+    decode_count++;
+}
+
+/** \fn PlaybackTelemetry::AddSample(TelemetrySample&)
+ *  \brief Adds the sample for a frame which was just shown.
+ *
+ *   The interval and decode fields are filled in here, the sample is
+ *   cleared afterwards so it can be reused for the next frame.
+ */
+void PlaybackTelemetry::AddSample(TelemetrySample &sample)
+{
+    int64_t now = Now();
+
+    QMutexLocker locker(&lock);
+
+    sample.interval = (last_shown) ? (int)(now - last_shown) : 0;
+    sample.decode   = (decode_count) ? (int)(decode_sum / decode_count) : 0;
+    last_shown      = now;
+    decode_sum      = 0;
+    decode_count    = 0;
+
+    ring[next] = sample;
+    next = (next + 1) % ring.size();
+    count = min(count + 1, (uint)ring.size());
+
+    sample = TelemetrySample();
+}
+
+void PlaybackTelemetry::GetSamples(vector<TelemetrySample> &samples) const
+{
+    QMutexLocker locker(&lock);
+
+    samples.clear();
+    samples.reserve(count);
+    uint first = (next + ring.size() - count) % ring.size();
+    for (uint i = 0; i < count; i++)
+        samples.push_back(ring[(first + i) % ring.size()]);
+}
+
+/// \brief Returns the samples, oldest first, as lines of CSV.
+QString PlaybackTelemetry::GetCSV(void) const
+{
+    vector<TelemetrySample> samples;
+    GetSamples(samples);
+
+    QStringList lines;
+    lines << "frame,interval_us,decode_us,filter_us,osd_us,present_us,"
+             "av_offset_us,dropped,repeated";
+
+    vector<TelemetrySample>::const_iterator it = samples.begin();
+    for (; it != samples.end(); ++it)
+    {
+        lines << QString("%1,%2,%3,%4,%5,%6,%7,%8,%9")
+            .arg(it->frame).arg(it->interval).arg(it->decode)
+            .arg(it->filter).arg(it->osd).arg(it->present)
+            .arg(it->av_offset)
+            .arg((it->flags & TelemetrySample::kDropped)  ? 1 : 0)
+            .arg((it->flags & TelemetrySample::kRepeated) ? 1 : 0);
+    }
+
+    return lines.join("\n");
+}
+
+static QString summary(const char *name, vector<int> &values)
+{
+    if (values.empty())
+        return QString();
+
+    sort(values.begin(), values.end());
+
+    int64_t sum = 0;
+    for (uint i = 0; i < values.size(); i++)
+        sum += values[i];
+
+    return QString("%1 mean %2 ms, 95% %3 ms, max %4 ms")
+        .arg(name, -8)
+        .arg(sum / values.size() / 1000.0, 0, 'f', 1)
+        .arg(values[values.size() * 95 / 100] / 1000.0, 0, 'f', 1)
+        .arg(values.back() / 1000.0, 0, 'f', 1);
+}
+
+/** \fn PlaybackTelemetry::GetHistogram(int) const
+ *  \brief Returns a text histogram of the intervals between shown frames,
+ *         relative to frame_interval, followed by a summary of the
+ *         other times.
+ */
+QString PlaybackTelemetry::GetHistogram(int frame_interval) const
+{
+    vector<TelemetrySample> samples;
+    GetSamples(samples);
+
+    frame_interval = max(frame_interval, 1);
+
+    uint buckets[kNumIntervalBuckets];
+    for (uint i = 0; i < kNumIntervalBuckets; i++)
+        buckets[i] = 0;
+
+    vector<int> decode, filter, osd, present;
+    int64_t av_offset = 0;
+    uint dropped = 0, repeated = 0, intervals = 0;
+
+    vector<TelemetrySample>::const_iterator it = samples.begin();
+    for (; it != samples.end(); ++it)
+    {
+        if (it->interval)
+        {
+            int tenths = (int)((int64_t)it->interval * 10 / frame_interval);
+            uint b = 0;
+            while (tenths >= kIntervalBuckets[b] &&
+                   b < kNumIntervalBuckets - 1)
+            {
+                b++;
+            }
+            buckets[b]++;
+            intervals++;
+        }
+
+        decode.push_back(it->decode);
+        filter.push_back(it->filter);
+        osd.push_back(it->osd);
+        present.push_back(it->present);
+        av_offset += abs(it->av_offset);
+        dropped   += (it->flags & TelemetrySample::kDropped)  ? 1 : 0;
+        repeated  += (it->flags & TelemetrySample::kRepeated) ? 1 : 0;
+    }
+
+    uint peak = 1;
+    for (uint i = 0; i < kNumIntervalBuckets; i++)
+        peak = max(peak, buckets[i]);
+
+    QStringList lines;
+    lines << QString("Frame intervals, last %1 frames at %2 ms")
+        .arg(intervals).arg(frame_interval / 1000.0, 0, 'f', 1);
+
+    for (uint i = 0; i < kNumIntervalBuckets; i++)
+    {
+        lines << QString("%1 %2 %3")
+            .arg(kIntervalLabels[i])
+            .arg(QString(buckets[i] * HISTOGRAM_WIDTH / peak, '|'),
+                 -HISTOGRAM_WIDTH)
+            .arg(buckets[i]);
+    }
+
+    lines << summary("decode", decode)
+          << summary("filter", filter)
+          << summary("osd", osd)
+          << summary("present", present);
+
+    if (!samples.empty())
+    {
+        lines << QString("A/V offset mean %1 ms, %2 dropped, %3 repeated")
+            .arg(av_offset / (int64_t)samples.size() / 1000.0, 0, 'f', 1)
+            .arg(dropped).arg(repeated);
+    }
+
+    return lines.join("\n");
+}
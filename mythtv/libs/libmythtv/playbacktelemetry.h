@@ -0,0 +1,71 @@
+// -*- Mode: c++ -*-
+
+#ifndef _PLAYBACK_TELEMETRY_H_
+#define _PLAYBACK_TELEMETRY_H_
+
+#include <stdint.h>
+#include <vector>
+using namespace std;
+
+#include <QString>
+#include <QMutex>
+
+/// \brief Timing of a single displayed frame, all times in microseconds.
+class TelemetrySample
+{
+  public:
+    TelemetrySample() :
+        frame(0), interval(0), decode(0), filter(0), osd(0), present(0),
+        av_offset(0), flags(0) { }
+
+    enum
+    {
+        kDropped  = 0x01, ///< frame was not shown to catch up with audio
+        kRepeated = 0x02, ///< frame has repeat_pict set, held for extra fields
+    };
+
+    long long frame;     ///< frames played when the frame was shown
+    int       interval;  ///< time since the previous frame was shown
+    int       decode;    ///< mean decode time since the previous frame
+    int       filter;    ///< video filter chain
+    int       osd;       ///< rest of VideoOutput::ProcessFrame(), OSD blend
+    int       present;   ///< PrepareFrame() and Show(), without the wait
+    int       av_offset; ///< video timecode minus audio timecode
+    int       flags;
+};
+
+/** \class PlaybackTelemetry
+ *  \brief Ring of the timing of the most recently displayed frames.
+ *
+ *   The video thread adds one sample per displayed frame, the decoder
+ *   thread adds decode times which are averaged into the next sample.
+ *   The ring can be read as CSV or as a text histogram of the frame
+ *   intervals for the OSD.
+ */
+class PlaybackTelemetry
+{
+  public:
+    PlaybackTelemetry(uint size = 1024);
+
+    static int64_t Now(void);
+
+    void Reset(void);
+    void AddDecodeTime(int usecs);
+    void AddSample(TelemetrySample &sample);
+
+    QString GetCSV(void) const;
+    QString GetHistogram(int frame_interval) const;
+
+  private:
+    void GetSamples(vector<TelemetrySample> &samples) const;
+
+    mutable QMutex          lock;
+    vector<TelemetrySample> ring;
+    uint                    next;
+    uint                    count;
+    int64_t                 last_shown;
+    int64_t                 decode_sum;
+    int                     decode_count;
+};
+
+#endif // _PLAYBACK_TELEMETRY_H_
@@ -245,38 +245,22 @@ uint DBEvent::UpdateDB(
     }
 }
 
-uint DBEvent::GetOverlappingPrograms(
-    MSqlQuery &query, uint chanid, vector<DBEvent> &programs) const
+static const char *program_columns =
+    "SELECT title,          subtitle,      description, "
+    "       category,       category_type, "
+    "       starttime,      endtime, "
+    "       subtitletypes+0,audioprop+0,   videoprop+0, "
+    "       seriesid,       programid, "
+    "       partnumber,     parttotal, "
+    "       syndicatedepisodenumber, "
+    "       airdate,        originalairdate, "
+    "       previouslyshown,listingsource, "
+    "       stars+0 "
+    "FROM program ";
+
+static uint load_programs(MSqlQuery &query, vector<DBEvent> &programs)
 {
     uint count = 0;
-    query.prepare(
-        "SELECT title,          subtitle,      description, "
-        "       category,       category_type, "
-        "       starttime,      endtime, "
-        "       subtitletypes+0,audioprop+0,   videoprop+0, "
-        "       seriesid,       programid, "
-        "       partnumber,     parttotal, "
-        "       syndicatedepisodenumber, "
-        "       airdate,        originalairdate, "
-        "       previouslyshown,listingsource, "
-        "       stars+0 "
-        "FROM program "
-        "WHERE chanid   = :CHANID AND "
-        "      manualid = 0       AND "
-        "      ( ( starttime >= :STIME1 AND starttime <  :ETIME1 ) OR "
-        "        ( endtime   >  :STIME2 AND endtime   <= :ETIME2 ) )");
-    query.bindValue(":CHANID", chanid);
-    query.bindValue(":STIME1", starttime);
-    query.bindValue(":ETIME1", endtime);
-    query.bindValue(":STIME2", starttime);
-    query.bindValue(":ETIME2", endtime);
-
-    if (!query.exec())
-    {
-        MythDB::DBError("GetOverlappingPrograms 1", query);
-        return 0;
-    }
-
     while (query.next())
     {
         MythCategoryType category_type =
@@ -303,7 +287,6 @@ uint DBEvent::GetOverlappingPrograms(
         prog.airdate    = query.value(15).toUInt();
         prog.originalairdate  = query.value(16).toDate();
         prog.previouslyshown  = query.value(17).toBool();
-        ;
 
         programs.push_back(prog);
         count++;
@@ -312,6 +295,37 @@ uint DBEvent::GetOverlappingPrograms(
     return count;
 }
 
+uint DBEvent::GetOverlappingPrograms(
+    MSqlQuery &query, uint chanid, vector<DBEvent> &programs) const
+{
+    query.prepare(
+        QString(program_columns) +
+        "WHERE chanid   = :CHANID AND "
+        "      manualid = 0       AND "
+        "      ( ( starttime >= :STIME1 AND starttime <  :ETIME1 ) OR "
+        "        ( endtime   >  :STIME2 AND endtime   <= :ETIME2 ) )");
+    query.bindValue(":CHANID", chanid);
+    query.bindValue(":STIME1", starttime);
+    query.bindValue(":ETIME1", endtime);
+    query.bindValue(":STIME2", starttime);
+    query.bindValue(":ETIME2", endtime);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("GetOverlappingPrograms 1", query);
+        return 0;
+    }
+
+    return load_programs(query, programs);
+}
+
+/// \brief True if GetOverlappingPrograms() would return prog for this event.
+bool DBEvent::IsOverlapping(const DBEvent &prog) const
+{
+    return ((prog.starttime >= starttime && prog.starttime <  endtime) ||
+            (prog.endtime   >  starttime && prog.endtime   <= endtime));
+}
+
 
 static int score_words(const QStringList &al, const QStringList &bl)
 {
@@ -467,65 +481,80 @@ uint DBEvent::UpdateDB(
     return UpdateDB(q, chanid, p[match]);
 }
 
-uint DBEvent::UpdateDB(
-    MSqlQuery &query, uint chanid, const DBEvent &match) const
+/** \fn DBEvent::Merge(const DBEvent&,DBEvent&) const
+ *  \brief Combines this event with the matching program, the way
+ *         UpdateDB(MSqlQuery&,uint,const DBEvent&) writes them.
+ *
+ *   The credits of merged are left alone.
+ */
+void DBEvent::Merge(const DBEvent &match, DBEvent &merged) const
 {
-    QString  ltitle     = title;
-    QString  lsubtitle  = subtitle;
-    QString  ldesc      = description;
-    QString  lcategory  = category;
-    uint16_t lairdate   = airdate;
-    QString  lprogramId = programId;
-    QString  lseriesId  = seriesId;
-    QDate loriginalairdate = originalairdate;
+    merged.title       = title;
+    merged.subtitle    = subtitle;
+    merged.description = description;
+    merged.category    = category;
+    merged.airdate     = airdate;
+    merged.programId   = programId;
+    merged.seriesId    = seriesId;
+    merged.originalairdate = originalairdate;
+    merged.starttime   = starttime;
+    merged.endtime     = endtime;
+    merged.stars       = match.stars;
 
-    if (match.title.length() >= ltitle.length())
-        ltitle = match.title;
+    if (match.title.length() >= merged.title.length())
+        merged.title = match.title;
 
-    if (match.subtitle.length() >= lsubtitle.length())
-        lsubtitle = match.subtitle;
+    if (match.subtitle.length() >= merged.subtitle.length())
+        merged.subtitle = match.subtitle;
 
-    if (match.description.length() >= ldesc.length())
-        ldesc = match.description;
+    if (match.description.length() >= merged.description.length())
+        merged.description = match.description;
 
-    if (lcategory.isEmpty() && !match.category.isEmpty())
-        lcategory = match.category;
+    if (merged.category.isEmpty() && !match.category.isEmpty())
+        merged.category = match.category;
 
-    if (!lairdate && !match.airdate)
-        lairdate = match.airdate;
+    if (!merged.airdate && !match.airdate)
+        merged.airdate = match.airdate;
 
-    if (!loriginalairdate.isValid() && match.originalairdate.isValid())
-        loriginalairdate = match.originalairdate;
+    if (!merged.originalairdate.isValid() && match.originalairdate.isValid())
+        merged.originalairdate = match.originalairdate;
 
-    if (lprogramId.isEmpty() && !match.programId.isEmpty())
-        lprogramId = match.programId;
+    if (merged.programId.isEmpty() && !match.programId.isEmpty())
+        merged.programId = match.programId;
 
-    if (lseriesId.isEmpty() && !match.seriesId.isEmpty())
-        lseriesId = match.seriesId;
+    if (merged.seriesId.isEmpty() && !match.seriesId.isEmpty())
+        merged.seriesId = match.seriesId;
 
-    uint tmp = categoryType;
+    merged.categoryType = categoryType;
     if (!categoryType && match.categoryType)
-        tmp = match.categoryType;
-
-    QString lcattype = myth_category_type_to_string(tmp);
+        merged.categoryType = match.categoryType;
 
-    unsigned char lsubtype = subtitleType | match.subtitleType;
-    unsigned char laudio   = audioProps   | match.audioProps;
-    unsigned char lvideo   = videoProps   | match.videoProps;
+    merged.subtitleType = subtitleType | match.subtitleType;
+    merged.audioProps   = audioProps   | match.audioProps;
+    merged.videoProps   = videoProps   | match.videoProps;
 
-    uint lpartnumber =
+    merged.partnumber =
         (!partnumber && match.partnumber) ? match.partnumber : partnumber;
-    uint lparttotal =
+    merged.parttotal =
         (!parttotal  && match.parttotal ) ? match.parttotal  : parttotal;
 
-    bool lpreviouslyshown = previouslyshown | match.previouslyshown;
+    merged.previouslyshown = previouslyshown | match.previouslyshown;
 
-    uint32_t llistingsource = listingsource | match.listingsource;
+    merged.listingsource = listingsource | match.listingsource;
 
-    QString lsyndicatedepisodenumber = syndicatedepisodenumber;
-    if (lsyndicatedepisodenumber.isEmpty() &&
+    merged.syndicatedepisodenumber = syndicatedepisodenumber;
+    if (merged.syndicatedepisodenumber.isEmpty() &&
         !match.syndicatedepisodenumber.isEmpty())
-        lsyndicatedepisodenumber = match.syndicatedepisodenumber;
+        merged.syndicatedepisodenumber = match.syndicatedepisodenumber;
+}
+
+uint DBEvent::UpdateDB(
+    MSqlQuery &query, uint chanid, const DBEvent &match) const
+{
+    DBEvent m(listingsource);
+    Merge(match, m);
+
+    QString lcattype = myth_category_type_to_string(m.categoryType);
 
     query.prepare(
         "UPDATE program "
@@ -548,29 +577,29 @@ uint DBEvent::UpdateDB(
 
     query.bindValue(":CHANID",      chanid);
     query.bindValue(":OLDSTART",    match.starttime);
-    query.bindValue(":TITLE",       ltitle);
-    query.bindValue(":SUBTITLE",    lsubtitle);
-    query.bindValue(":DESC",        ldesc);
-    query.bindValue(":CATEGORY",    lcategory);
+    query.bindValue(":TITLE",       m.title);
+    query.bindValue(":SUBTITLE",    m.subtitle);
+    query.bindValue(":DESC",        m.description);
+    query.bindValue(":CATEGORY",    m.category);
     query.bindValue(":CATTYPE",     lcattype);
-    query.bindValue(":STARTTIME",   starttime);
-    query.bindValue(":ENDTIME",     endtime);
-    query.bindValue(":CC",          lsubtype & SUB_HARDHEAR ? true : false);
-    query.bindValue(":HASSUBTITLES",lsubtype & SUB_NORMAL   ? true : false);
-    query.bindValue(":STEREO",      laudio   & AUD_STEREO   ? true : false);
-    query.bindValue(":HDTV",        lvideo   & VID_HDTV     ? true : false);
-    query.bindValue(":SUBTYPE",     lsubtype);
-    query.bindValue(":AUDIOPROP",   laudio);
-    query.bindValue(":VIDEOPROP",   lvideo);
-    query.bindValue(":PARTNO",      lpartnumber);
-    query.bindValue(":PARTTOTAL",   lparttotal);
-    query.bindValue(":SYNDICATENO", lsyndicatedepisodenumber);
-    query.bindValue(":AIRDATE",     lairdate?QString::number(lairdate):"0000");
-    query.bindValue(":ORIGAIRDATE", loriginalairdate);
-    query.bindValue(":LSOURCE",     llistingsource);
-    query.bindValue(":SERIESID",    lseriesId);
-    query.bindValue(":PROGRAMID",   lprogramId);
-    query.bindValue(":PREVSHOWN",   lpreviouslyshown);
+    query.bindValue(":STARTTIME",   m.starttime);
+    query.bindValue(":ENDTIME",     m.endtime);
+    query.bindValue(":CC",          m.subtitleType & SUB_HARDHEAR ? true : false);
+    query.bindValue(":HASSUBTITLES",m.subtitleType & SUB_NORMAL   ? true : false);
+    query.bindValue(":STEREO",      m.audioProps   & AUD_STEREO   ? true : false);
+    query.bindValue(":HDTV",        m.videoProps   & VID_HDTV     ? true : false);
+    query.bindValue(":SUBTYPE",     m.subtitleType);
+    query.bindValue(":AUDIOPROP",   m.audioProps);
+    query.bindValue(":VIDEOPROP",   m.videoProps);
+    query.bindValue(":PARTNO",      m.partnumber);
+    query.bindValue(":PARTTOTAL",   m.parttotal);
+    query.bindValue(":SYNDICATENO", m.syndicatedepisodenumber);
+    query.bindValue(":AIRDATE",     m.airdate ? QString::number(m.airdate):"0000");
+    query.bindValue(":ORIGAIRDATE", m.originalairdate);
+    query.bindValue(":LSOURCE",     m.listingsource);
+    query.bindValue(":SERIESID",    m.seriesId);
+    query.bindValue(":PROGRAMID",   m.programId);
+    query.bindValue(":PREVSHOWN",   m.previouslyshown);
 
     if (!query.exec())
     {
@@ -751,6 +780,376 @@ uint DBEvent::InsertDB(MSqlQuery &query, uint chanid) const
     return 1;
 }
 
+static void copy_without_credits(DBEvent &dst, const DBEvent &src)
+{
+    dst = src;
+    delete dst.credits;
+    dst.credits = NULL;
+}
+
+/// \brief A program in the time window of DBEvent::BulkUpdateDB().
+class BulkProgram
+{
+  public:
+    BulkProgram(const DBEvent &p, bool _in_db) :
+        prog(p.listingsource), base(p.listingsource),
+        oldstart(p.starttime), oldend(p.endtime),
+        source(NULL), in_db(_in_db), deleted(false)
+    {
+        copy_without_credits(prog, p);
+    }
+
+    DBEvent        prog;     ///< current contents, never has credits
+    DBEvent        base;     ///< contents before source was merged in
+    QDateTime      oldstart; ///< start time in the DB
+    QDateTime      oldend;   ///< end time in the DB
+    const DBEvent *source;   ///< last event merged into or inserted as prog
+    vector<const DBEvent*> sources; ///< every event merged into prog
+    bool           in_db;
+    bool           deleted;
+};
+
+/// \brief In memory version of DBEvent::MoveOutOfTheWayDB().
+static void move_out_of_the_way(const DBEvent &event, BulkProgram &bp)
+{
+    DBEvent &prog = bp.prog;
+    if (prog.starttime >= event.starttime && prog.endtime <= event.endtime)
+    {
+        // inside current program
+        bp.deleted = true;
+    }
+    else if (prog.starttime < event.starttime &&
+             prog.endtime   > event.starttime)
+    {
+        // starts before, but ends during our program
+        prog.endtime = event.starttime;
+    }
+    else if (prog.starttime < event.endtime && prog.endtime > event.endtime)
+    {
+        // starts during, but ends after our program
+        prog.starttime = event.endtime;
+    }
+}
+
+/// Rows per multi-row statement of DBEvent::BulkUpdateDB().
+static const uint kBulkRows = 100;
+
+static bool delete_programs(MSqlQuery &query, uint chanid,
+                            const vector<QDateTime> &starts,
+                            const QStringList &tables)
+{
+    for (uint i = 0; i < starts.size(); i += kBulkRows)
+    {
+        uint rows = min(kBulkRows, (uint)starts.size() - i);
+
+        QStringList values;
+        for (uint r = 0; r < rows; r++)
+            values << QString(":STARTTIME%1").arg(r);
+
+        for (int t = 0; t < tables.size(); t++)
+        {
+            query.prepare(
+                QString("DELETE FROM %1 "
+                        "WHERE chanid    = :CHANID AND "
+                        "      starttime IN (%2)")
+                .arg(tables[t]).arg(values.join(", ")));
+
+            query.bindValue(":CHANID", chanid);
+            for (uint r = 0; r < rows; r++)
+                query.bindValue(values[r], starts[i + r]);
+
+            if (!query.exec())
+            {
+                MythDB::DBError("delete_programs", query);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static bool insert_programs(MSqlQuery &query, uint chanid,
+                            const vector<const DBEvent*> &progs)
+{
+    for (uint i = 0; i < progs.size(); i += kBulkRows)
+    {
+        uint rows = min(kBulkRows, (uint)progs.size() - i);
+
+        QStringList values;
+        for (uint r = 0; r < rows; r++)
+        {
+            values << QString(
+                "(:CHANID%1,   :TITLE%1,     :SUBTITLE%1, :DESCRIPTION%1, "
+                " :CATEGORY%1, :CATTYPE%1, "
+                " :STARTTIME%1,:ENDTIME%1, "
+                " :CC%1,       :STEREO%1,    :HDTV%1,     :HASSUBTITLES%1, "
+                " :SUBTYPES%1, :AUDIOPROP%1, :VIDEOPROP%1, "
+                " :STARS%1,    :PARTNUMBER%1,:PARTTOTAL%1, "
+                " :SYNDICATENO%1, "
+                " :AIRDATE%1,  :ORIGAIRDATE%1,:LSOURCE%1, "
+                " :SERIESID%1, :PROGRAMID%1, :PREVSHOWN%1)").arg(r);
+        }
+
+        query.prepare(
+            "REPLACE INTO program ("
+            "  chanid,         title,          subtitle,        description, "
+            "  category,       category_type, "
+            "  starttime,      endtime, "
+            "  closecaptioned, stereo,         hdtv,            subtitled, "
+            "  subtitletypes,  audioprop,      videoprop, "
+            "  stars,          partnumber,     parttotal, "
+            "  syndicatedepisodenumber, "
+            "  airdate,        originalairdate,listingsource, "
+            "  seriesid,       programid,      previouslyshown ) "
+            "VALUES " + values.join(", "));
+
+        for (uint r = 0; r < rows; r++)
+        {
+            const DBEvent &p = *progs[i + r];
+            QString n = QString::number(r);
+
+            query.bindValue(":CHANID"      + n, chanid);
+            query.bindValue(":TITLE"       + n, p.title);
+            query.bindValue(":SUBTITLE"    + n, p.subtitle);
+            query.bindValue(":DESCRIPTION" + n, p.description);
+            query.bindValue(":CATEGORY"    + n, p.category);
+            query.bindValue(":CATTYPE"     + n,
+                            myth_category_type_to_string(p.categoryType));
+            query.bindValue(":STARTTIME"   + n, p.starttime);
+            query.bindValue(":ENDTIME"     + n, p.endtime);
+            query.bindValue(":CC"          + n,
+                            p.subtitleType & SUB_HARDHEAR ? true : false);
+            query.bindValue(":STEREO"      + n,
+                            p.audioProps   & AUD_STEREO   ? true : false);
+            query.bindValue(":HDTV"        + n,
+                            p.videoProps   & VID_HDTV     ? true : false);
+            query.bindValue(":HASSUBTITLES"+ n,
+                            p.subtitleType & SUB_NORMAL   ? true : false);
+            query.bindValue(":SUBTYPES"    + n, p.subtitleType);
+            query.bindValue(":AUDIOPROP"   + n, p.audioProps);
+            query.bindValue(":VIDEOPROP"   + n, p.videoProps);
+            query.bindValue(":STARS"       + n, p.stars);
+            query.bindValue(":PARTNUMBER"  + n, p.partnumber);
+            query.bindValue(":PARTTOTAL"   + n, p.parttotal);
+            query.bindValue(":SYNDICATENO" + n, p.syndicatedepisodenumber);
+            query.bindValue(":AIRDATE"     + n,
+                            p.airdate ? QString::number(p.airdate) : "0000");
+            query.bindValue(":ORIGAIRDATE" + n, p.originalairdate);
+            query.bindValue(":LSOURCE"     + n, p.listingsource);
+            query.bindValue(":SERIESID"    + n, p.seriesId);
+            query.bindValue(":PROGRAMID"   + n, p.programId);
+            query.bindValue(":PREVSHOWN"   + n, p.previouslyshown);
+        }
+
+        if (!query.exec())
+        {
+            MythDB::DBError("insert_programs", query);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** \fn DBEvent::BulkUpdateDB(MSqlQuery&,uint,const vector<const DBEvent*>&,int,uint&)
+ *  \brief Applies a batch of events for one channel with the same rules
+ *         as calling UpdateDB(MSqlQuery&,uint,int) for each in turn.
+ *
+ *   The programs in the time span of the batch are loaded once and each
+ *   event is reconciled against that copy, including the changes made
+ *   for the events before it. The result is then written with deletions
+ *   and insertions as multi-row statements, time changes and updates of
+ *   matched programs one at a time.
+ *
+ *   The caller should run this inside a transaction and roll it back if
+ *   this fails, some of the changes may have been written by then. When
+ *   the program table can not roll back (MyISAM) the events can instead
+ *   be replayed with UpdateDB(MSqlQuery&,uint,int): programs and credits
+ *   are written with REPLACE and each event moves whatever overlaps it
+ *   out of the way or matches it, so replaying over a partial update
+ *   does not duplicate anything.
+ *
+ *  \param count Set to the number of events inserted or updated.
+ *  \return false on a database error.
+ */
+bool DBEvent::BulkUpdateDB(MSqlQuery &query, uint chanid,
+                           const vector<const DBEvent*> &events,
+                           int match_threshold, uint &count)
+{
+    count = 0;
+    if (events.empty())
+        return true;
+
+    QDateTime start = events[0]->starttime;
+    QDateTime end   = events[0]->endtime;
+    for (uint i = 1; i < events.size(); i++)
+    {
+        start = min(start, events[i]->starttime);
+        end   = max(end,   events[i]->endtime);
+    }
+
+    query.prepare(
+        QString(program_columns) +
+        "WHERE chanid    = :CHANID AND "
+        "      manualid  = 0       AND "
+        "      starttime <= :ETIME AND "
+        "      endtime   >= :STIME");
+    query.bindValue(":CHANID", chanid);
+    query.bindValue(":STIME",  start);
+    query.bindValue(":ETIME",  end);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("BulkUpdateDB", query);
+        return false;
+    }
+
+    vector<DBEvent> loaded;
+    load_programs(query, loaded);
+
+    vector<BulkProgram*> window;
+    for (uint i = 0; i < loaded.size(); i++)
+        window.push_back(new BulkProgram(loaded[i], true));
+
+    // Reconcile the events against the window, in order
+    for (uint i = 0; i < events.size(); i++)
+    {
+        const DBEvent *event = events[i];
+
+        vector<DBEvent>      programs;
+        vector<BulkProgram*> overlap;
+        for (uint j = 0; j < window.size(); j++)
+        {
+            if (!window[j]->deleted && event->IsOverlapping(window[j]->prog))
+            {
+                overlap.push_back(window[j]);
+                programs.push_back(window[j]->prog);
+            }
+        }
+
+        int match = -1;
+        if (!programs.empty())
+        {
+            int best;
+            int score = event->GetMatch(programs, best);
+            if (score >= match_threshold)
+            {
+                VERBOSE(VB_EIT | VB_EXTRA,
+                        QString("EIT: accept match[%1]: %2 '%3' vs. '%4'")
+                        .arg(best).arg(score).arg(event->title)
+                        .arg(programs[best].title));
+                match = best;
+            }
+            else if (best >= 0)
+            {
+                VERBOSE(VB_EIT,
+                        QString("EIT: reject match[%1]: %2 '%3' vs. '%4'")
+                        .arg(best).arg(score).arg(event->title)
+                        .arg(programs[best].title));
+            }
+        }
+
+        for (uint j = 0; j < overlap.size(); j++)
+        {
+            if (j != (uint)match)
+                move_out_of_the_way(*event, *overlap[j]);
+        }
+
+        if (match >= 0)
+        {
+            BulkProgram *bp = overlap[match];
+            bp->base = bp->prog;
+            event->Merge(bp->base, bp->prog);
+            bp->source = event;
+            bp->sources.push_back(event);
+        }
+        else
+        {
+            BulkProgram *bp = new BulkProgram(*event, false);
+            bp->source = event;
+            bp->sources.push_back(event);
+            window.push_back(bp);
+        }
+    }
+
+    // Write the result
+    vector<QDateTime>        deletes;
+    vector<const DBEvent*>   inserts;
+    vector<BulkProgram*>     changes;
+    for (uint i = 0; i < window.size(); i++)
+    {
+        BulkProgram *bp = window[i];
+        if (bp->in_db && bp->deleted)
+            deletes.push_back(bp->oldstart);
+        else if (bp->in_db)
+            changes.push_back(bp);
+        else if (!bp->deleted)
+            inserts.push_back(&bp->prog);
+    }
+
+    bool ok = delete_programs(query, chanid, deletes,
+                              QStringList() << "program" << "credits");
+
+    for (uint i = 0; ok && i < changes.size(); i++)
+    {
+        BulkProgram *bp    = changes[i];
+        QDateTime    cur_s = bp->oldstart;
+        QDateTime    cur_e = bp->oldend;
+
+        if (bp->source)
+        {
+            if (bp->base.starttime != cur_s || bp->base.endtime != cur_e)
+            {
+                ok = change_program(query, chanid, cur_s,
+                                    bp->base.starttime, bp->base.endtime);
+            }
+            ok = ok && bp->source->UpdateDB(query, chanid, bp->base);
+            cur_s = bp->source->starttime;
+            cur_e = bp->source->endtime;
+        }
+
+        if (ok && (bp->prog.starttime != cur_s || bp->prog.endtime != cur_e))
+        {
+            ok = change_program(query, chanid, cur_s,
+                                bp->prog.starttime, bp->prog.endtime);
+        }
+    }
+
+    ok = ok && insert_programs(query, chanid, inserts);
+
+    // Credits of every event merged into a program that is kept; UpdateDB()
+    // above already wrote those of the last one for programs in the DB
+    for (uint i = 0; ok && i < window.size(); i++)
+    {
+        BulkProgram *bp = window[i];
+        if (bp->deleted)
+            continue;
+
+        uint num = bp->sources.size();
+        if (bp->in_db && num)
+            num--;
+
+        for (uint j = 0; j < num; j++)
+        {
+            if (!bp->sources[j]->credits)
+                continue;
+
+            DBCredits &credits = *bp->sources[j]->credits;
+            for (uint k = 0; k < credits.size(); k++)
+                credits[k].InsertDB(query, chanid, bp->prog.starttime);
+        }
+    }
+
+    for (uint i = 0; i < window.size(); i++)
+        delete window[i];
+
+    if (ok)
+        count = events.size();
+
+    return ok;
+}
+
 ProgInfo::ProgInfo(const ProgInfo &other) :
     DBEvent(other.listingsource)
 {
@@ -901,6 +1300,420 @@ uint ProgInfo::InsertDB(MSqlQuery &query, uint chanid) const
     return 1;
 }
 
+/** \class ProgramRow
+ *  \brief The columns of a program compared by ProgramData::IsUnchanged(),
+ *         for ProgramData::HandleProgramsDelta().
+ */
+class ProgramRow
+{
+  public:
+    ProgramRow(const MSqlQuery &query);
+    ProgramRow(const ProgInfo &pi);
+
+    bool IsUnchanged(const ProgramRow &other) const;
+
+  public:
+    QDateTime       starttime;
+    QDateTime       endtime;
+    uint            manualid;
+    QString         title;
+    QString         subtitle;
+    QString         description;
+    QString         category;
+    QString         category_type;
+    uint            airdate;
+    float           stars;
+    bool            previouslyshown;
+    QString         title_pronounce;
+    uint            audioprop;
+    uint            videoprop;
+    uint            subtitletypes;
+    uint            partnumber;
+    uint            parttotal;
+    QString         seriesid;
+    QString         showtype;
+    QString         colorcode;
+    QString         syndicatedepisodenumber;
+    QString         programid;
+    /// A compared column is NULL, which never compares equal in SQL
+    bool            has_null;
+    /// The program to insert, NULL for a program loaded from the DB
+    const ProgInfo *source;
+};
+
+static const char *program_row_columns =
+    "SELECT starttime,      endtime,       manualid, "
+    "       title,          subtitle,      description, "
+    "       category,       category_type, airdate, "
+    "       stars,          previouslyshown, "
+    "       title_pronounce,audioprop+0,   videoprop+0, "
+    "       subtitletypes+0,partnumber,    parttotal, "
+    "       seriesid,       showtype,      colorcode, "
+    "       syndicatedepisodenumber,       programid "
+    "FROM program ";
+
+ProgramRow::ProgramRow(const MSqlQuery &query) :
+    starttime(query.value(0).toDateTime()),
+    endtime(query.value(1).toDateTime()),
+    manualid(query.value(2).toUInt()),
+    title(query.value(3).toString()),
+    subtitle(query.value(4).toString()),
+    description(query.value(5).toString()),
+    category(query.value(6).toString()),
+    category_type(query.value(7).toString()),
+    airdate(query.value(8).toUInt()),
+    stars(query.value(9).toDouble()),
+    previouslyshown(query.value(10).toBool()),
+    title_pronounce(query.value(11).toString()),
+    audioprop(query.value(12).toUInt()),
+    videoprop(query.value(13).toUInt()),
+    subtitletypes(query.value(14).toUInt()),
+    partnumber(query.value(15).toUInt()),
+    parttotal(query.value(16).toUInt()),
+    seriesid(query.value(17).toString()),
+    showtype(query.value(18).toString()),
+    colorcode(query.value(19).toString()),
+    syndicatedepisodenumber(query.value(20).toString()),
+    programid(query.value(21).toString()),
+    has_null(false), source(NULL)
+{
+    for (uint i = 0; i < 22 && !has_null; i++)
+        has_null = query.value(i).isNull();
+}
+
+ProgramRow::ProgramRow(const ProgInfo &pi) :
+    starttime(pi.starttime),
+    endtime(pi.endtime),
+    manualid(0),
+    title(pi.title),
+    subtitle(pi.subtitle),
+    description(pi.description),
+    category(pi.category),
+    category_type(myth_category_type_to_string(pi.categoryType)),
+    airdate(pi.airdate),
+    stars(pi.stars.toFloat()),
+    previouslyshown(pi.previouslyshown),
+    title_pronounce(pi.title_pronounce),
+    audioprop(pi.audioProps),
+    videoprop(pi.videoProps),
+    subtitletypes(pi.subtitleType),
+    partnumber(pi.partnumber),
+    parttotal(pi.parttotal),
+    seriesid(pi.seriesId),
+    showtype(pi.showtype),
+    colorcode(pi.colorcode),
+    syndicatedepisodenumber(pi.syndicatedepisodenumber),
+    programid(pi.programId),
+    has_null(false), source(&pi)
+{
+}
+
+/// \brief In memory version of ProgramData::IsUnchanged().
+bool ProgramRow::IsUnchanged(const ProgramRow &other) const
+{
+    return (!has_null && !other.has_null &&
+            starttime       == other.starttime       &&
+            endtime         == other.endtime         &&
+            title           == other.title           &&
+            subtitle        == other.subtitle        &&
+            description     == other.description     &&
+            category        == other.category        &&
+            category_type   == other.category_type   &&
+            airdate         == other.airdate         &&
+            stars           >= other.stars - 0.001f  &&
+            stars           <= other.stars + 0.001f  &&
+            previouslyshown == other.previouslyshown &&
+            title_pronounce == other.title_pronounce &&
+            audioprop       == other.audioprop       &&
+            videoprop       == other.videoprop       &&
+            subtitletypes   == other.subtitletypes   &&
+            partnumber      == other.partnumber      &&
+            parttotal       == other.parttotal       &&
+            seriesid        == other.seriesid        &&
+            showtype        == other.showtype        &&
+            colorcode       == other.colorcode       &&
+            syndicatedepisodenumber == other.syndicatedepisodenumber &&
+            programid       == other.programid);
+}
+
+/// \brief Multi-row version of ProgInfo::InsertDB() without the ratings
+///        and credits, see insert_ratings() and insert_credits().
+static bool insert_proginfos(MSqlQuery &query, uint chanid,
+                             const vector<const ProgInfo*> &progs)
+{
+    for (uint i = 0; i < progs.size(); i += kBulkRows)
+    {
+        uint rows = min(kBulkRows, (uint)progs.size() - i);
+
+        QStringList values;
+        for (uint r = 0; r < rows; r++)
+        {
+            values << QString(
+                "(:CHANID%1,   :TITLE%1,     :SUBTITLE%1, :DESCRIPTION%1, "
+                " :CATEGORY%1, :CATTYPE%1, "
+                " :STARTTIME%1,:ENDTIME%1, "
+                " :CC%1,       :STEREO%1,    :HDTV%1,     :HASSUBTITLES%1, "
+                " :SUBTYPES%1, :AUDIOPROP%1, :VIDEOPROP%1, "
+                " :PARTNUMBER%1,:PARTTOTAL%1, "
+                " :SYNDICATENO%1, "
+                " :AIRDATE%1,  :ORIGAIRDATE%1,:LSOURCE%1, "
+                " :SERIESID%1, :PROGRAMID%1, :PREVSHOWN%1, "
+                " :STARS%1,    :SHOWTYPE%1,  :TITLEPRON%1,:COLORCODE%1)")
+                .arg(r);
+        }
+
+        query.prepare(
+            "REPLACE INTO program ("
+            "  chanid,         title,          subtitle,        description, "
+            "  category,       category_type,  "
+            "  starttime,      endtime, "
+            "  closecaptioned, stereo,         hdtv,            subtitled, "
+            "  subtitletypes,  audioprop,      videoprop, "
+            "  partnumber,     parttotal, "
+            "  syndicatedepisodenumber, "
+            "  airdate,        originalairdate,listingsource, "
+            "  seriesid,       programid,      previouslyshown, "
+            "  stars,          showtype,       title_pronounce, colorcode ) "
+            "VALUES " + values.join(", "));
+
+        for (uint r = 0; r < rows; r++)
+        {
+            const ProgInfo &p = *progs[i + r];
+            QString n = QString::number(r);
+
+            VERBOSE(VB_XMLTV,
+                    QString("Inserting new program    : %1 - %2 %3 %4")
+                    .arg(p.starttime.toString(Qt::ISODate))
+                    .arg(p.endtime.toString(Qt::ISODate))
+                    .arg(p.channel)
+                    .arg(p.title));
+
+            query.bindValue(":CHANID"      + n, chanid);
+            query.bindValue(":TITLE"       + n, p.title);
+            query.bindValue(":SUBTITLE"    + n, p.subtitle);
+            query.bindValue(":DESCRIPTION" + n, p.description);
+            query.bindValue(":CATEGORY"    + n, p.category);
+            query.bindValue(":CATTYPE"     + n,
+                            myth_category_type_to_string(p.categoryType));
+            query.bindValue(":STARTTIME"   + n, p.starttime);
+            query.bindValue(":ENDTIME"     + n, p.endtime);
+            query.bindValue(":CC"          + n,
+                            p.subtitleType & SUB_HARDHEAR ? true : false);
+            query.bindValue(":STEREO"      + n,
+                            p.audioProps   & AUD_STEREO   ? true : false);
+            query.bindValue(":HDTV"        + n,
+                            p.videoProps   & VID_HDTV     ? true : false);
+            query.bindValue(":HASSUBTITLES"+ n,
+                            p.subtitleType & SUB_NORMAL   ? true : false);
+            query.bindValue(":SUBTYPES"    + n, p.subtitleType);
+            query.bindValue(":AUDIOPROP"   + n, p.audioProps);
+            query.bindValue(":VIDEOPROP"   + n, p.videoProps);
+            query.bindValue(":PARTNUMBER"  + n, p.partnumber);
+            query.bindValue(":PARTTOTAL"   + n, p.parttotal);
+            query.bindValue(":SYNDICATENO" + n, p.syndicatedepisodenumber);
+            query.bindValue(":AIRDATE"     + n,
+                            p.airdate ? QString::number(p.airdate) : "0000");
+            query.bindValue(":ORIGAIRDATE" + n, p.originalairdate);
+            query.bindValue(":LSOURCE"     + n, p.listingsource);
+            query.bindValue(":SERIESID"    + n, p.seriesId);
+            query.bindValue(":PROGRAMID"   + n, p.programId);
+            query.bindValue(":PREVSHOWN"   + n, p.previouslyshown);
+            query.bindValue(":STARS"       + n, p.stars);
+            query.bindValue(":SHOWTYPE"    + n, p.showtype);
+            query.bindValue(":TITLEPRON"   + n, p.title_pronounce);
+            query.bindValue(":COLORCODE"   + n, p.colorcode);
+        }
+
+        if (!query.exec())
+        {
+            MythDB::DBError("insert_proginfos", query);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool insert_ratings(MSqlQuery &query, uint chanid,
+                           const vector<const ProgInfo*> &progs)
+{
+    vector<const ProgInfo*> prog;
+    vector<const EventRating*> ratings;
+    for (uint i = 0; i < progs.size(); i++)
+    {
+        QList<EventRating>::const_iterator it = progs[i]->ratings.begin();
+        for (; it != progs[i]->ratings.end(); ++it)
+        {
+            prog.push_back(progs[i]);
+            ratings.push_back(&(*it));
+        }
+    }
+
+    for (uint i = 0; i < ratings.size(); i += kBulkRows)
+    {
+        uint rows = min(kBulkRows, (uint)ratings.size() - i);
+
+        QStringList values;
+        for (uint r = 0; r < rows; r++)
+        {
+            values << QString("(:CHANID%1, :START%1, :SYS%1, :RATING%1)")
+                .arg(r);
+        }
+
+        query.prepare(
+            "INSERT INTO programrating "
+            "       ( chanid, starttime, system, rating) "
+            "VALUES " + values.join(", "));
+
+        for (uint r = 0; r < rows; r++)
+        {
+            QString n = QString::number(r);
+            query.bindValue(":CHANID" + n, chanid);
+            query.bindValue(":START"  + n, prog[i + r]->starttime);
+            query.bindValue(":SYS"    + n, ratings[i + r]->system);
+            query.bindValue(":RATING" + n, ratings[i + r]->rating);
+        }
+
+        if (!query.exec())
+        {
+            MythDB::DBError("insert_ratings", query);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** \fn insert_credits(MSqlQuery&,uint,const vector<const ProgInfo*>&)
+ *  \brief Multi-row version of DBPerson::InsertDB() for all the credits
+ *         of the programs.
+ *
+ *   The people are added and looked up by name in batches. A name the
+ *   lookup does not return verbatim, e.g. because the DB collation
+ *   folded its case, is left to DBPerson::InsertDB().
+ */
+static bool insert_credits(MSqlQuery &query, uint chanid,
+                           const vector<const ProgInfo*> &progs)
+{
+    QMap<QString, uint> people;
+    QStringList names;
+    for (uint i = 0; i < progs.size(); i++)
+    {
+        if (!progs[i]->credits)
+            continue;
+
+        const DBCredits &credits = *progs[i]->credits;
+        for (uint j = 0; j < credits.size(); j++)
+        {
+            if (!people.contains(credits[j].GetName()))
+            {
+                people[credits[j].GetName()] = 0;
+                names << credits[j].GetName();
+            }
+        }
+    }
+
+    for (int i = 0; i < names.size(); i += kBulkRows)
+    {
+        int rows = min((int)kBulkRows, names.size() - i);
+
+        QStringList values;
+        for (int r = 0; r < rows; r++)
+            values << QString(":NAME%1").arg(r);
+
+        query.prepare(
+            "INSERT IGNORE INTO people (name) "
+            "VALUES (" + values.join("), (") + ")");
+        for (int r = 0; r < rows; r++)
+            query.bindValue(values[r], names[i + r]);
+
+        if (!query.exec())
+        {
+            MythDB::DBError("insert_credits people", query);
+            return false;
+        }
+
+        query.prepare(
+            "SELECT person, name "
+            "FROM people "
+            "WHERE name IN (" + values.join(", ") + ")");
+        for (int r = 0; r < rows; r++)
+            query.bindValue(values[r], names[i + r]);
+
+        if (!query.exec())
+        {
+            MythDB::DBError("insert_credits person", query);
+            return false;
+        }
+
+        while (query.next())
+        {
+            QMap<QString, uint>::iterator it =
+                people.find(query.value(1).toString());
+            if (it != people.end())
+                *it = query.value(0).toUInt();
+        }
+    }
+
+    vector<uint>            personids;
+    vector<const DBPerson*> persons;
+    vector<const ProgInfo*> prog;
+    for (uint i = 0; i < progs.size(); i++)
+    {
+        if (!progs[i]->credits)
+            continue;
+
+        const DBCredits &credits = *progs[i]->credits;
+        for (uint j = 0; j < credits.size(); j++)
+        {
+            uint personid = people[credits[j].GetName()];
+            if (!personid)
+            {
+                credits[j].InsertDB(query, chanid, progs[i]->starttime);
+                continue;
+            }
+
+            personids.push_back(personid);
+            persons.push_back(&credits[j]);
+            prog.push_back(progs[i]);
+        }
+    }
+
+    for (uint i = 0; i < persons.size(); i += kBulkRows)
+    {
+        uint rows = min(kBulkRows, (uint)persons.size() - i);
+
+        QStringList values;
+        for (uint r = 0; r < rows; r++)
+        {
+            values << QString("(:PERSON%1, :CHANID%1, :STARTTIME%1, :ROLE%1)")
+                .arg(r);
+        }
+
+        query.prepare(
+            "REPLACE INTO credits "
+            "       ( person,  chanid,  starttime,  role) "
+            "VALUES " + values.join(", "));
+
+        for (uint r = 0; r < rows; r++)
+        {
+            QString n = QString::number(r);
+            query.bindValue(":PERSON"    + n, personids[i + r]);
+            query.bindValue(":CHANID"    + n, chanid);
+            query.bindValue(":STARTTIME" + n, prog[i + r]->starttime);
+            query.bindValue(":ROLE"      + n, persons[i + r]->GetRole());
+        }
+
+        if (!query.exec())
+        {
+            MythDB::DBError("insert_credits", query);
+            return false;
+        }
+    }
+
+    return true;
+}
+
 bool ProgramData::ClearDataByChannel(
     uint chanid, const QDateTime &from, const QDateTime &to,
     bool use_channel_time_offset)
@@ -1053,75 +1866,105 @@ void ProgramData::FixProgramList(QList<ProgInfo*> &fixlist)
     }
 }
 
-void ProgramData::HandlePrograms(
-    uint sourceid, QMap<QString, QList<ProgInfo> > &proglist)
+/** \fn ProgramData::GetChanIDs(MSqlQuery&,uint,const QString&)
+ *  \brief Returns the channels of the source that use an XMLTV channel
+ *         identifier, callers that get many batches per channel should
+ *         keep the result.
+ */
+vector<uint> ProgramData::GetChanIDs(
+    MSqlQuery &query, uint sourceid, const QString &xmltvid)
 {
-    uint unchanged = 0, updated = 0;
+    vector<uint> chanids;
+    if (xmltvid.isEmpty())
+        return chanids;
 
-    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare(
+        "SELECT chanid "
+        "FROM channel "
+        "WHERE sourceid = :ID AND "
+        "      xmltvid  = :XMLTVID");
+    query.bindValue(":ID",      sourceid);
+    query.bindValue(":XMLTVID", xmltvid);
 
-    QMap<QString, QList<ProgInfo> >::const_iterator mapiter;
-    for (mapiter = proglist.begin(); mapiter != proglist.end(); ++mapiter)
+    if (!query.exec())
     {
-        if (mapiter.key().isEmpty())
-            continue;
+        MythDB::DBError("ProgramData::GetChanIDs", query);
+        return chanids;
+    }
 
-        query.prepare(
-            "SELECT chanid "
-            "FROM channel "
-            "WHERE sourceid = :ID AND "
-            "      xmltvid  = :XMLTVID");
-        query.bindValue(":ID",      sourceid);
-        query.bindValue(":XMLTVID", mapiter.key());
+    while (query.next())
+        chanids.push_back(query.value(0).toUInt());
 
-        if (!query.exec())
-        {
-            MythDB::DBError("ProgramData::HandlePrograms", query);
-            continue;
-        }
+    if (chanids.empty())
+    {
+        VERBOSE(VB_IMPORTANT, QString(
+                    "Unknown xmltv channel identifier: %1"
+                    " - Skipping channel.").arg(xmltvid));
+    }
 
-        vector<uint> chanids;
-        while (query.next())
-            chanids.push_back(query.value(0).toUInt());
+    return chanids;
+}
+
+/** \fn ProgramData::HandleChannelPrograms(MSqlQuery&,const vector<uint>&,QList<ProgInfo*>&,uint&,uint&,bool,bool)
+ *  \brief Inserts the programs of one XMLTV channel into the database.
+ *
+ *   The list is sorted and cleaned up by FixProgramList() first, so it
+ *   may be in any order. This lets a streaming importer hand over the
+ *   programs in batches instead of collecting the whole listing first.
+ *
+ *  \param chanids The channels of the XMLTV channel, see GetChanIDs().
+ *  \param delta Write only what changed, see HandleProgramsDelta().
+ *  \param transactional false if the program table can not roll back a
+ *         failed delta update (MyISAM), see DBUtil::IsTransactional().
+ */
+void ProgramData::HandleChannelPrograms(
+    MSqlQuery &query, const vector<uint> &chanids,
+    QList<ProgInfo*> &sortlist, uint &unchanged, uint &updated,
+    bool delta, bool transactional)
+{
+    if (chanids.empty() || sortlist.empty())
+        return;
+
+    FixProgramList(sortlist);
 
-        if (chanids.empty())
+    for (uint i = 0; i < chanids.size(); ++i)
+    {
+        if (delta && HandleProgramsDelta(
+                query, chanids[i], sortlist, unchanged, updated,
+                transactional))
         {
-            VERBOSE(VB_IMPORTANT, QString(
-                        "Unknown xmltv channel identifier: %1"
-                        " - Skipping channel.").arg(mapiter.key()));
             continue;
         }
 
-        QList<ProgInfo> &list = proglist[mapiter.key()];
-        QList<ProgInfo*> sortlist;
-        QList<ProgInfo>::iterator it = list.begin();
-        for (; it != list.end(); ++it)
-            sortlist.push_back(&(*it));
-
-        FixProgramList(sortlist);
-
-        for (uint i = 0; i < chanids.size(); ++i)
+        if (delta)
         {
-            HandlePrograms(query, chanids[i], sortlist, unchanged, updated);
+            VERBOSE(VB_IMPORTANT, LOC_ERR + QString(
+                        "Delta update of channel %1 failed, "
+                        "writing programs one at a time").arg(chanids[i]));
         }
-    }
 
-    VERBOSE(VB_GENERAL,
-            QString("Updated programs: %1 Unchanged programs: %2")
-                .arg(updated)
-                .arg(unchanged));
+        // Without a rollback the failed delta may have left programs
+        // without their ratings and credits, so none can be trusted
+        HandlePrograms(query, chanids[i], sortlist, unchanged, updated,
+                       delta && !transactional);
+    }
 }
 
+/** \fn ProgramData::HandlePrograms(MSqlQuery&,uint,const QList<ProgInfo*>&,uint&,uint&,bool)
+ *  \brief Writes the programs one at a time, skipping those that are
+ *         already in the database unless rewrite is set.
+ */
 void ProgramData::HandlePrograms(MSqlQuery             &query,
                                  uint                   chanid,
                                  const QList<ProgInfo*> &sortlist,
                                  uint &unchanged,
-                                 uint &updated)
+                                 uint &updated,
+                                 bool rewrite)
 {
     QList<ProgInfo*>::const_iterator it = sortlist.begin();
     for (; it != sortlist.end(); ++it)
     {
-        if (IsUnchanged(query, chanid, **it))
+        if (!rewrite && IsUnchanged(query, chanid, **it))
         {
             unchanged++;
             continue;
@@ -1134,6 +1977,155 @@ void ProgramData::HandlePrograms(MSqlQuery             &query,
     }
 }
 
+/** \fn ProgramData::HandleProgramsDelta(MSqlQuery&,uint,const QList<ProgInfo*>&,uint&,uint&,bool)
+ *  \brief Same result as HandlePrograms(), but only writes the difference
+ *         to what is already in the database.
+ *
+ *   The programs of the channel in the time span of the list are loaded
+ *   once, and IsUnchanged(), DeleteOverlaps() and InsertDB() are played
+ *   through on that copy. The removed programs are then deleted and the
+ *   new or changed programs inserted with multi-row statements, in one
+ *   transaction if the program table supports them. An unchanged
+ *   schedule costs a single query.
+ *
+ *  \return false if the update failed, the counts are only updated on
+ *          success. Unless transactional is set some of the changes may
+ *          have been written.
+ */
+bool ProgramData::HandleProgramsDelta(MSqlQuery              &query,
+                                      uint                    chanid,
+                                      const QList<ProgInfo*> &sortlist,
+                                      uint &unchanged,
+                                      uint &updated,
+                                      bool transactional)
+{
+    if (sortlist.empty())
+        return true;
+
+    QDateTime start = sortlist.front()->starttime;
+    QDateTime end   = sortlist.front()->endtime;
+    QList<ProgInfo*>::const_iterator it = sortlist.begin();
+    for (; it != sortlist.end(); ++it)
+    {
+        start = min(start, (*it)->starttime);
+        end   = max(end,   (*it)->endtime);
+    }
+
+    query.prepare(
+        QString(program_row_columns) +
+        "WHERE chanid     = :CHANID AND "
+        "      starttime >= :STIME  AND "
+        "      starttime <  :ETIME");
+    query.bindValue(":CHANID", chanid);
+    query.bindValue(":STIME",  start);
+    query.bindValue(":ETIME",  end);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("ProgramData::HandleProgramsDelta", query);
+        return false;
+    }
+
+    // Programs by start time, as the database would have them
+    vector<ProgramRow*>               rows;
+    QMultiMap<QDateTime, ProgramRow*> window;
+    while (query.next())
+    {
+        rows.push_back(new ProgramRow(query));
+        window.insert(rows.back()->starttime, rows.back());
+    }
+
+    uint new_unchanged = 0, new_updated = 0;
+    vector<QDateTime> deletes;
+    for (it = sortlist.begin(); it != sortlist.end(); ++it)
+    {
+        const ProgInfo &pi = **it;
+        ProgramRow *row = new ProgramRow(pi);
+        rows.push_back(row);
+
+        // IsUnchanged()
+        QMultiMap<QDateTime, ProgramRow*>::iterator wit =
+            window.find(pi.starttime);
+        for (; wit != window.end() && wit.key() == pi.starttime; ++wit)
+        {
+            if ((*wit)->IsUnchanged(*row))
+                break;
+        }
+        if (wit != window.end() && wit.key() == pi.starttime)
+        {
+            new_unchanged++;
+            continue;
+        }
+
+        // DeleteOverlaps()
+        wit = window.lowerBound(pi.starttime);
+        while (wit != window.end() && wit.key() < pi.endtime)
+        {
+            if (!(*wit)->source)
+            {
+                VERBOSE(VB_XMLTV,
+                        QString("Removing existing program: %1 - %2 %3 %4")
+                        .arg((*wit)->starttime.toString(Qt::ISODate))
+                        .arg((*wit)->endtime.toString(Qt::ISODate))
+                        .arg(pi.channel)
+                        .arg((*wit)->title));
+                deletes.push_back(wit.key());
+            }
+            wit = window.erase(wit);
+        }
+
+        // InsertDB(), which replaces the program at the same start time
+        wit = window.find(pi.starttime);
+        while (wit != window.end() && wit.key() == pi.starttime)
+        {
+            if ((*wit)->manualid == 0)
+                wit = window.erase(wit);
+            else
+                ++wit;
+        }
+        window.insert(pi.starttime, row);
+        new_updated++;
+    }
+
+    vector<const ProgInfo*> inserts;
+    QMultiMap<QDateTime, ProgramRow*>::const_iterator rit = window.begin();
+    for (; rit != window.end(); ++rit)
+    {
+        if ((*rit)->source)
+            inserts.push_back((*rit)->source);
+    }
+
+    for (uint i = 0; i < rows.size(); i++)
+        delete rows[i];
+
+    if (deletes.empty() && inserts.empty())
+    {
+        unchanged += new_unchanged;
+        updated   += new_updated;
+        return true;
+    }
+
+    bool ok = !transactional || query.exec("START TRANSACTION");
+    ok = ok && delete_programs(query, chanid, deletes,
+                               QStringList() << "program" << "programrating"
+                               << "credits" << "programgenres");
+    ok = ok && insert_proginfos(query, chanid, inserts);
+    ok = ok && insert_ratings(query, chanid, inserts);
+    ok = ok && insert_credits(query, chanid, inserts);
+    ok = ok && (!transactional || query.exec("COMMIT"));
+
+    if (!ok)
+    {
+        if (transactional)
+            query.exec("ROLLBACK");
+        return false;
+    }
+
+    unchanged += new_unchanged;
+    updated   += new_updated;
+    return true;
+}
+
 int ProgramData::fix_end_times(void)
 {
     int count = 0;
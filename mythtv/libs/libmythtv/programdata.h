@@ -44,6 +44,7 @@ class MPUBLIC DBPerson
     DBPerson(const QString &_role, const QString &_name);
 
     QString GetRole(void) const;
+    QString GetName(void) const { return name; }
 
     uint InsertDB(MSqlQuery &query, uint chanid,
                   const QDateTime &starttime) const;
@@ -126,6 +127,9 @@ class MPUBLIC DBEvent
     void AddPerson(const QString &role, const QString &name);
 
     uint UpdateDB(MSqlQuery &query, uint chanid, int match_threshold) const;
+    static bool BulkUpdateDB(MSqlQuery &query, uint chanid,
+                             const vector<const DBEvent*> &events,
+                             int match_threshold, uint &count);
 
     bool HasCredits(void) const { return credits; }
     bool HasTimeConflict(const DBEvent &other) const;
@@ -135,8 +139,10 @@ class MPUBLIC DBEvent
   protected:
     uint GetOverlappingPrograms(
         MSqlQuery&, uint chanid, vector<DBEvent> &programs) const;
+    bool IsOverlapping(const DBEvent &prog) const;
     int  GetMatch(
         const vector<DBEvent> &programs, int &bestmatch) const;
+    void Merge(const DBEvent &match, DBEvent &merged) const;
     uint UpdateDB(
         MSqlQuery&, uint chanid, const vector<DBEvent> &p, int match) const;
     uint UpdateDB(
@@ -256,8 +262,12 @@ class MPUBLIC ProgInfo : public DBEvent
 class MPUBLIC ProgramData
 {
   public:
-    static void HandlePrograms(uint sourceid,
-                               QMap<QString, QList<ProgInfo> > &proglist);
+    static vector<uint> GetChanIDs(
+        MSqlQuery &query, uint sourceid, const QString &xmltvid);
+    static void HandleChannelPrograms(
+        MSqlQuery &query, const vector<uint> &chanids,
+        QList<ProgInfo*> &sortlist, uint &unchanged, uint &updated,
+        bool delta = false, bool transactional = true);
 
     static int  fix_end_times(void);
     static bool ClearDataByChannel(
@@ -276,7 +286,11 @@ class MPUBLIC ProgramData
     static void HandlePrograms(
         MSqlQuery &query, uint chanid,
         const QList<ProgInfo*> &sortlist,
-        uint &unchanged, uint &updated);
+        uint &unchanged, uint &updated, bool rewrite = false);
+    static bool HandleProgramsDelta(
+        MSqlQuery &query, uint chanid,
+        const QList<ProgInfo*> &sortlist,
+        uint &unchanged, uint &updated, bool transactional);
     static bool IsUnchanged(
         MSqlQuery &query, uint chanid, const ProgInfo &pi);
     static bool DeleteOverlaps(
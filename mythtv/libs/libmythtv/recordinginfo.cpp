@@ -873,6 +873,14 @@ void RecordingInfo::StartedRecording(QString ext)
     if (!query.exec() || !query.isActive())
         MythDB::DBError("Clear seek info on record", query);
 
+    query.prepare("DELETE FROM recordedseekblob WHERE chanid = :CHANID"
+                  " AND starttime = :START;");
+    query.bindValue(":CHANID", chanid);
+    query.bindValue(":START", recstartts);
+
+    if (!query.exec() || !query.isActive())
+        MythDB::DBError("Clear seek blob on record", query);
+
     query.prepare("DELETE FROM recordedmarkup WHERE chanid = :CHANID"
                   " AND starttime = :START;");
     query.bindValue(":CHANID", chanid);
@@ -1052,6 +1060,9 @@ void RecordingInfo::FinishedRecording(bool prematurestop)
     if (!query.exec())
         MythDB::DBError("FinishedRecording update", query);
 
+    // The recorder has saved its last position map delta by now
+    CompactPositionMap();
+
     GetProgramRecordingStatus();
     if (!prematurestop)
     {
@@ -1008,6 +1008,27 @@ class RecordingType : public ComboBoxSetting, public CodecParamStorage
     };
 };
 
+class RecordingWriteMode : public ComboBoxSetting, public CodecParamStorage
+{
+  public:
+    RecordingWriteMode(const RecordingProfile &parent) :
+        ComboBoxSetting(this), CodecParamStorage(this, parent, "writemode")
+    {
+        setLabel(QObject::tr("Disk Write Mode"));
+
+        QString msg = QObject::tr(
+            "'Buffered' writes recordings through the operating system's "
+            "file cache. 'Direct' bypasses the cache with several writes "
+            "in flight, which helps when many recordings share a disk. "
+            "Live TV is always buffered, since it is being watched.");
+        setHelpText(msg);
+
+        addSelection(QObject::tr("Buffered"), "buffered");
+        addSelection(QObject::tr("Direct"),   "directio");
+        setValue(0);
+    };
+};
+
 class TranscodeFilters : public LineEditSetting, public CodecParamStorage
 {
   public:
@@ -1293,6 +1314,11 @@ void RecordingProfile::loadByID(int profileId)
     else if (type.toUpper() == "DVB")
     {
         addChild(new RecordingType(*this));
+        addChild(new RecordingWriteMode(*this));
+    }
+    else
+    {
+        addChild(new RecordingWriteMode(*this));
     }
 
     id->setValue(profileId);
@@ -58,7 +58,7 @@ QStringList RingBuffer::subExtNoCheck;
 
 /*
   Locking relations:
-    rwlock->poslock->rbrlock->rbwlock
+    rwlock->poslock->prefetchlock->rbrlock->rbwlock
 
   A child should never lock any of the parents without locking
   the parent lock before the child lock.
@@ -216,7 +216,8 @@ RingBuffer::RingBuffer(void) :
     readblocksize(CHUNK),     wanttoread(0),
     numfailures(0),           commserror(false),
     oldfile(false),           livetvchain(NULL),
-    ignoreliveeof(false),     readAdjust(0)
+    ignoreliveeof(false),     readAdjust(0),
+    prefetchsize(0)
 {
     {
         QMutexLocker locker(&subExtLock);
@@ -601,6 +602,141 @@ void RingBuffer::WaitForPause(void)
     rwlock.unlock();
 }
 
+/** \fn RingBuffer::SetPrefetchTargets(const QList<long long>&)
+ *  \brief Sets the positions the next seek is likely to go to.
+ *
+ *   While the read-ahead buffer is full the read-ahead thread reads
+ *   the data at these positions into a cache, so that a seek to one
+ *   of them does not have to wait for the file. Data cached for
+ *   positions which are no longer wanted is discarded.
+ */
+void RingBuffer::SetPrefetchTargets(const QList<long long> &positions)
+{
+    QMutexLocker locker(&prefetchlock);
+    prefetchwanted = positions;
+
+    QMap<long long,QByteArray>::iterator it = prefetched.begin();
+    while (it != prefetched.end())
+    {
+        if (positions.contains(it.key()))
+            ++it;
+        else
+            it = prefetched.erase(it);
+    }
+}
+
+/** \fn RingBuffer::PrefetchNext(void)
+ *  \brief Fetches the data for one prefetch target which has not been
+ *         fetched yet, returns false if there was none.
+ *
+ *   Remote files are read into the cache, for local files the kernel
+ *   is asked to read ahead instead.
+ *
+ *   WARNING: Must be called with rwlock in read lock state.
+ */
+bool RingBuffer::PrefetchNext(void)
+{
+    long long pos = -1;
+    prefetchlock.lock();
+    // CalcReadAheadThresh() or the read ahead loop raised fill_min or
+    // readblocksize, fetch the targets again with the larger size.
+    if (max(fill_min, readblocksize) > prefetchsize)
+    {
+        prefetched.clear();
+        prefetchsize = max(fill_min, readblocksize);
+    }
+    for (int i = 0; i < prefetchwanted.size() && pos < 0; i++)
+    {
+        if (!prefetched.contains(prefetchwanted[i]))
+            pos = prefetchwanted[i];
+    }
+    prefetchlock.unlock();
+
+    if (pos < 0)
+        return false;
+
+    // enough to allow reads right after the seek, the read ahead
+    // thread streams the rest as usual
+    QByteArray data;
+    int size = max(fill_min, readblocksize);
+
+    if (remotefile && !livetvchain)
+    {
+        data.resize(size);
+        int ret = -1;
+        if (remotefile->Seek(pos, SEEK_SET) >= 0)
+            ret = remotefile->Read(data.data(), size);
+
+        // the read ahead continues where it left off
+        poslock.lockForRead();
+        if (remotefile->Seek(internalreadpos - readAdjust, SEEK_SET) < 0)
+            numfailures++;
+        poslock.unlock();
+
+        data.resize(max(ret, 0));
+    }
+    else if (fd2 >= 0)
+    {
+        posix_fadvise(fd2, pos, size, POSIX_FADV_WILLNEED);
+    }
+
+    VERBOSE(VB_FILE, LOC + QString("Prefetched %1 KB at %2")
+            .arg(data.size() / 1024).arg(pos));
+
+    prefetchlock.lock();
+    if (prefetchwanted.contains(pos))
+        prefetched[pos] = data;
+    prefetchlock.unlock();
+
+    return true;
+}
+
+/** \fn RingBuffer::UsePrefetched(long long)
+ *  \brief Restarts the read-ahead buffer at newpos with prefetched data,
+ *         returns false if no data was prefetched for newpos.
+ *
+ *   WARNING: Must be called with rwlock and poslock in write lock state.
+ */
+bool RingBuffer::UsePrefetched(long long newpos)
+{
+    QMutexLocker locker(&prefetchlock);
+
+    QMap<long long,QByteArray>::const_iterator it =
+        prefetched.upperBound(newpos);
+    if (!remotefile || !readAheadBuffer || it == prefetched.begin())
+        return false;
+    --it;
+
+    long long offset = newpos - it.key();
+    if (offset >= it->size())
+        return false;
+
+    long long end = it.key() + it->size();
+    if (remotefile->Seek(end, SEEK_SET) < 0)
+        return false;
+
+    int len = it->size() - offset;
+    ResetReadAhead(end);
+    memcpy(readAheadBuffer, it->constData() + offset, len);
+    rbwlock.lockForWrite();
+    rbwpos = len;
+    rbwlock.unlock();
+    readpos = newpos;
+
+    // ResetReadAhead() blocked reads until fill_min is buffered, which
+    // the cached data may already satisfy.
+    if (len >= fill_min)
+    {
+        readsallowed = true;
+        generalWait.wakeAll();
+    }
+
+    VERBOSE(VB_FILE, LOC + QString("Seek(): %1 KB at %2 from prefetch cache")
+            .arg(len / 1024).arg(newpos));
+
+    return true;
+}
+
 bool RingBuffer::PauseAndWait(void)
 {
     const uint timeout = 500; // ms
@@ -683,6 +819,15 @@ void RingBuffer::run(void)
 
         long long totfree = ReadBufFree();
 
+        // Use the time the buffer is full to fetch the data at
+        // the likely targets of the next seek.
+        if ((totfree < readblocksize) && readsallowed &&
+            (ignorereadpos < 0) && !commserror && !stopreads &&
+            PrefetchNext())
+        {
+            continue;
+        }
+
         // These are conditions where we don't want to go through
         // the loop if they are true.
         if (((totfree < readblocksize) && readsallowed) ||
@@ -1335,6 +1480,23 @@ void RingBuffer::SetWriteBufferMinWriteSize(int newMinSize)
     rwlock.unlock();
 }
 
+/** \fn RingBuffer::SetDirectWrite(bool)
+ *  \brief Calls ThreadedFileWriter::SetWriteMode(WriteMode) to select
+ *         page cache bypassing direct writes, or plain buffered writes.
+ */
+bool RingBuffer::SetDirectWrite(bool enable)
+{
+    bool ok = false;
+    rwlock.lockForRead();
+    if (tfw)
+    {
+        ok = tfw->SetWriteMode(enable ? ThreadedFileWriter::kWriteDirectAIO :
+                               ThreadedFileWriter::kWriteBuffered);
+    }
+    rwlock.unlock();
+    return ok;
+}
+
 /** \brief Tell RingBuffer if this is an old file or not.
  *
  *  Normally the RingBuffer determines that the file is old
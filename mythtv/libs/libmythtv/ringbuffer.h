@@ -5,9 +5,12 @@
 
 #include <QReadWriteLock>
 #include <QWaitCondition>
+#include <QByteArray>
 #include <QString>
 #include <QThread>
 #include <QMutex>
+#include <QList>
+#include <QMap>
 
 #include "mythconfig.h"
 
@@ -35,6 +38,7 @@ class MPUBLIC RingBuffer : protected QThread
     // Sets
     void SetWriteBufferSize(int newSize);
     void SetWriteBufferMinWriteSize(int newMinSize);
+    bool SetDirectWrite(bool enable);
     void SetOldFile(bool is_old);
     void UpdateRawBitrate(uint rawbitrate);
     void UpdatePlaySpeed(float playspeed);
@@ -98,6 +102,9 @@ class MPUBLIC RingBuffer : protected QThread
     void StopReads(void);
     void StartReads(void);
 
+    // Prefetch commands
+    void SetPrefetchTargets(const QList<long long> &positions);
+
     // LiveTVChain support
     bool LiveMode(void) const;
     void SetLiveMode(LiveTVChain *chain);
@@ -137,6 +144,9 @@ class MPUBLIC RingBuffer : protected QThread
     void ResetReadAhead(long long newinternal);
     void KillReadAheadThread(void);
 
+    bool PrefetchNext(void);
+    bool UsePrefetched(long long newpos);
+
   protected:
     mutable QReadWriteLock poslock;
     long long readpos;            // protected by poslock
@@ -199,6 +209,12 @@ class MPUBLIC RingBuffer : protected QThread
     /// Condition to signal that the read ahead thread is running
     QWaitCondition generalWait;         // protected by rwlock
 
+    /// Likely targets of the next seek, and the data fetched for them
+    mutable QMutex prefetchlock;
+    QList<long long> prefetchwanted;         // protected by prefetchlock
+    QMap<long long,QByteArray> prefetched;   // protected by prefetchlock
+    int prefetchsize;                        // protected by prefetchlock
+
   public:
     static QMutex subExtLock;
     static QStringList subExt;
@@ -743,6 +743,9 @@ void TV::InitKeys(void)
     REG_KEY("TV Playback", "SCREENSHOT",
             QT_TRANSLATE_NOOP("MythControls", "Save screenshot of current "
             "video frame"), "");
+    REG_KEY("TV Playback", "TOGGLEPLAYBACKSTATS",
+            QT_TRANSLATE_NOOP("MythControls", "Toggle the display of "
+            "playback timing statistics"), "");
 
     /* Interactive Television keys */
     REG_KEY("TV Playback", "MENURED",    QT_TRANSLATE_NOOP("MythControls",
@@ -932,6 +935,7 @@ TV::TV(void)
       switchToInputTimerId(0),      ccInputTimerId(0),
       asInputTimerId(0),            queueInputTimerId(0),
       browseTimerId(0),             updateOSDPosTimerId(0),
+      playbackStatsTimerId(0),
       endOfPlaybackTimerId(0),      embedCheckTimerId(0),
       endOfRecPromptTimerId(0),     videoExitDialogTimerId(0),
       pseudoChangeChanTimerId(0),   speedChangeTimerId(0),
@@ -2951,6 +2955,17 @@ void TV::timerEvent(QTimerEvent *te)
         handled = true;
     }
 
+    if (handled)
+        return;
+
+    if (timer_id == playbackStatsTimerId)
+    {
+        PlayerContext *actx = GetPlayerReadLock(-1, __FILE__, __LINE__);
+        UpdatePlaybackStats(actx);
+        ReturnPlayerLock(actx);
+        handled = true;
+    }
+
     if (handled)
         return;
 
@@ -4463,6 +4478,8 @@ bool TV::ToggleHandleAction(PlayerContext *ctx,
         ToggleTimeStretch(ctx);
     else if (has_action("TOGGLEUPMIX", actions))
         ToggleUpmix(ctx);
+    else if (has_action("TOGGLEPLAYBACKSTATS", actions))
+        TogglePlaybackStats(ctx);
     else if (has_action("TOGGLESLEEP", actions))
         ToggleSleepTimer(ctx);
     else if (has_action("TOGGLERECORD", actions) && islivetv)
@@ -4980,6 +4997,20 @@ void TV::ProcessNetworkControlCommand(PlayerContext *ctx,
             MythEvent me(message);
             gCoreContext->dispatch(me);
         }
+        else if (tokens[2] == "PLAYBACKSTATS")
+        {
+            ctx->LockDeletePlayer(__FILE__, __LINE__);
+            QString infoStr;
+            if (ctx->player)
+                infoStr = ctx->player->GetTelemetryCSV();
+            ctx->UnlockDeletePlayer(__FILE__, __LINE__);
+
+            // The event is split on white space, so send one row per word.
+            QString message = QString("NETWORK_CONTROL ANSWER %1")
+                .arg(infoStr.replace('\n', ' '));
+            MythEvent me(message);
+            gCoreContext->dispatch(me);
+        }
     }
 }
 
@@ -8034,6 +8065,41 @@ void TV::ChangeVolume(PlayerContext *ctx, bool up)
     }
 }
 
+/** \fn TV::TogglePlaybackStats(PlayerContext*)
+ *  \brief Shows or hides the histogram of the recent frame intervals and
+ *         the frame queue counters, refreshed every second while shown.
+ */
+void TV::TogglePlaybackStats(PlayerContext *ctx)
+{
+    QMutexLocker locker(&timerIdLock);
+    if (playbackStatsTimerId)
+    {
+        KillTimer(playbackStatsTimerId);
+        playbackStatsTimerId = 0;
+        locker.unlock();
+        HideOSDWindow(ctx, "osd_playback_stats");
+        return;
+    }
+
+    playbackStatsTimerId = StartTimer(1000, __LINE__);
+    locker.unlock();
+    UpdatePlaybackStats(ctx);
+}
+
+void TV::UpdatePlaybackStats(PlayerContext *ctx)
+{
+    QString stats;
+    ctx->LockDeletePlayer(__FILE__, __LINE__);
+    if (ctx->player)
+    {
+        stats = ctx->player->GetTelemetryHistogram();
+        stats += "\n" + ctx->player->GetFrameQueueStats();
+    }
+    ctx->UnlockDeletePlayer(__FILE__, __LINE__);
+
+    SetOSDText(ctx, "osd_playback_stats", "stats", stats, kOSDTimeout_None);
+}
+
 void TV::ToggleTimeStretch(PlayerContext *ctx)
 {
     if (ctx->ts_normal == 1.0f)
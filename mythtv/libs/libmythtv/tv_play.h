@@ -435,6 +435,8 @@ class MPUBLIC TV : public QThread
                                  const QStringList &actions);
 
     void ToggleUpmix(PlayerContext*);
+    void TogglePlaybackStats(PlayerContext*);
+    void UpdatePlaybackStats(PlayerContext*);
     void ChangeAudioSync(PlayerContext*, int dir);
     bool AudioSyncHandleAction(PlayerContext*, const QStringList &actions);
 
@@ -849,6 +851,7 @@ class MPUBLIC TV : public QThread
     volatile int         queueInputTimerId;
     volatile int         browseTimerId;
     volatile int         updateOSDPosTimerId;
+    volatile int         playbackStatsTimerId;
     volatile int         endOfPlaybackTimerId;
     volatile int         embedCheckTimerId;
     volatile int         endOfRecPromptTimerId;
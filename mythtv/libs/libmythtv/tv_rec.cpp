@@ -68,6 +68,8 @@ using namespace std;
 
 /// How many milliseconds the signal monitor should wait between checks
 const uint TVRec::kSignalMonitoringRate = 50; /* msec */
+/// How many seconds to wait between checks for readers of a direct write
+const uint TVRec::kDirectWriteCheckInterval = 5; /* sec */
 
 QMutex            TVRec::cardsLock;
 QMap<uint,TVRec*> TVRec::cards;
@@ -139,7 +141,7 @@ TVRec::TVRec(int capturecardnum)
       // tvchain
       tvchain(NULL),
       // RingBuffer info
-      ringBuffer(NULL), rbFileExt("mpg")
+      ringBuffer(NULL), rbFileExt("mpg"), directWrite(false)
 {
     QMutexLocker locker(&cardsLock);
     cards[cardid] = this;
@@ -1452,6 +1454,12 @@ void TVRec::RunTV(void)
         {
             curRecording->UpdateInUseMark();
 
+            if (directWrite &&
+                QDateTime::currentDateTime() >= directWriteCheckTime)
+            {
+                CheckDirectWriteReaders();
+            }
+
             if (recorder)
             {
                 recorder->SavePositionMap();
@@ -4020,6 +4028,38 @@ static QString load_profile(QString cardtype, void *tvchain,
     return profileName;
 }
 
+/** \fn TVRec::CheckDirectWriteReaders(void)
+ *  \brief Switches a recording written with O_DIRECT back to buffered
+ *         writes once a player, file transfer or job has it open.
+ *
+ *   Readers of a file that is still being recorded are normally served
+ *   from the page cache, which direct writes bypass. Each reader marks
+ *   the recording in use, so the inuseprograms table tells us.
+ */
+void TVRec::CheckDirectWriteReaders(void)
+{
+    directWriteCheckTime = QDateTime::currentDateTime()
+        .addSecs(kDirectWriteCheckInterval);
+
+    QStringList byWho;
+    if (!curRecording->QueryIsInUse(byWho))
+        return;
+
+    for (uint i = 0; i + 2 < (uint)byWho.size(); i += 3)
+    {
+        if (byWho[i] == kRecorderInUseID)
+            continue;
+
+        VERBOSE(VB_RECORD, LOC + QString("Recording opened by %1, "
+                                         "switching to buffered writes.")
+                .arg(byWho[i + 2]));
+        if (ringBuffer)
+            ringBuffer->SetDirectWrite(false);
+        directWrite = false;
+        return;
+    }
+}
+
 /** \fn TVRec::TuningNewRecorder(MPEGStreamData*)
  *  \brief Creates a recorder instance.
  */
@@ -4121,6 +4161,17 @@ void TVRec::TuningNewRecorder(MPEGStreamData *streamData)
         GetDTVRecorder()->SetStreamData(streamData);
     }
 
+    // Bypass the page cache for recordings which nobody is watching yet
+    directWrite = false;
+    if (!HasFlags(kFlagLiveTV))
+    {
+        const Setting *setting = profile.byName("writemode");
+        if (setting && setting->getValue() == "directio")
+            directWrite = ringBuffer->SetDirectWrite(true);
+        directWriteCheckTime = QDateTime::currentDateTime()
+            .addSecs(kDirectWriteCheckInterval);
+    }
+
     if (channel && genOpt.cardtype == "MJPEG")
         channel->Open(); // Needed because of NVR::MJPEGInit()
 
@@ -288,6 +288,7 @@ class MPUBLIC TVRec : public SignalMonitorListener
     MPEGStreamData *TuningSignalCheck(void);
 
     void TuningNewRecorder(MPEGStreamData*);
+    void CheckDirectWriteReaders(void);
     void TuningRestartRecorder(void);
     QString TuningGetChanNum(const TuningRequest&, QString &input) const;
     uint TuningCheckForHWChange(const TuningRequest&,
@@ -392,12 +393,15 @@ class MPUBLIC TVRec : public SignalMonitorListener
     // RingBuffer info
     RingBuffer  *ringBuffer;
     QString      rbFileExt;
+    bool         directWrite;
+    QDateTime    directWriteCheckTime;
 
     static QMutex            cardsLock;
     static QMap<uint,TVRec*> cards;
 
   public:
     static const uint kSignalMonitoringRate;
+    static const uint kDirectWriteCheckInterval;
 
     // General State flags
     static const uint kFlagFrontendReady        = 0x00000001;
@@ -2,6 +2,7 @@
 // based on earlier work in MythTV's videout_xvmc.cpp
 
 #include <unistd.h>
+#include <sys/time.h>
 
 #include "mythconfig.h"
 
@@ -26,6 +27,43 @@ extern "C" {
 
 int next_dbg_str = 0;
 
+/** \class TransitionLocker
+ *  \brief QMutexLocker for the frame hand-offs between the decoder and
+ *         video threads, which counts how often and for how long the
+ *         lock had to be waited for.
+ */
+class TransitionLocker
+{
+  public:
+    TransitionLocker(QMutex &lock, QAtomicInt &transitions,
+                     QAtomicInt &contended, uint64_t &wait_usecs) :
+        m_lock(lock)
+    {
+        transitions.ref();
+        if (m_lock.tryLock())
+            return;
+
+        struct timeval start, end;
+        gettimeofday(&start, NULL);
+        m_lock.lock();
+        gettimeofday(&end, NULL);
+
+        // wait_usecs is only changed with the lock held
+        contended.ref();
+        wait_usecs += (end.tv_sec - start.tv_sec) * 1000000LL +
+            (end.tv_usec - start.tv_usec);
+    }
+
+    ~TransitionLocker() { m_lock.unlock(); }
+
+  private:
+    QMutex &m_lock;
+};
+
+#define TRANSITION_LOCKER(vb) \
+    TransitionLocker locker((vb)->global_lock, (vb)->stat_transitions, \
+                            (vb)->stat_contended, (vb)->stat_wait_usecs)
+
 YUVInfo::YUVInfo(uint w, uint h, uint sz, const int *p, const int *o)
     : width(w), height(h), size(sz)
 {
@@ -110,6 +148,12 @@ YUVInfo::YUVInfo(uint w, uint h, uint sz, const int *p, const int *o)
  *  used by VideoOutputXv to avoid throwing away displayed frames too
  *  early. See videoout_xv.cpp for their use.
  *
+ *  The sizes of the available and used queues are mirrored in atomic
+ *  counters, so that the decoder and video threads can poll them
+ *  without taking the lock. The frame hand-offs between the two
+ *  threads count how often they found the lock held by the other
+ *  thread, see GetStats().
+ *
  * \see VideoOutput
  */
 
@@ -117,8 +161,11 @@ VideoBuffers::VideoBuffers()
     : numbuffers(0), needfreeframes(0), needprebufferframes(0),
       needprebufferframes_normal(0), needprebufferframes_small(0),
       keepprebufferframes(0), need_extra_for_pause(false), rpos(0), vpos(0),
-      global_lock(QMutex::Recursive), use_frame_locks(true),
-      frame_lock(QMutex::Recursive)
+      global_lock(QMutex::Recursive),
+      available_count(0), used_count(0),
+      stat_transitions(0), stat_contended(0),
+      stat_wait_usecs(0), stat_free_waits(0),
+      use_frame_locks(true), frame_lock(QMutex::Recursive)
 {
 }
 
@@ -160,6 +207,11 @@ void VideoBuffers::Init(uint numdecode, bool extra_for_pause,
 
     Reset();
 
+    stat_transitions = 0;
+    stat_contended   = 0;
+    stat_wait_usecs  = 0;
+    stat_free_waits  = 0;
+
     uint numcreate = numdecode + ((extra_for_pause) ? 1 : 0);
 
     // make a big reservation, so that things that depend on
@@ -217,6 +269,7 @@ void VideoBuffers::Reset()
     parents.clear();
     children.clear();
     vbufferMap.clear();
+    SyncCounts();
 }
 
 /**
@@ -233,7 +286,7 @@ void VideoBuffers::SetPrebuffering(bool normal)
 VideoFrame *VideoBuffers::GetNextFreeFrameInternal(
     bool with_lock, bool allow_unsafe, BufferType enqueue_to)
 {
-    QMutexLocker locker(&global_lock);
+    TRANSITION_LOCKER(this);
     VideoFrame *frame = available.dequeue();
 
     // Try to get a frame not being used by the decoder
@@ -284,6 +337,8 @@ VideoFrame *VideoBuffers::GetNextFreeFrameInternal(
         }
     }
 
+    SyncCounts();
+
     return frame;
 }
 
@@ -325,6 +380,7 @@ VideoFrame *VideoBuffers::GetNextFreeFrame(bool with_lock,
                     QString("GetNextFreeFrame() TryLock has "
                             "spun %1 times, this is a lot.").arg(tries));
         }
+        stat_free_waits.ref();
         usleep(TRY_LOCK_SPIN_WAIT);
     }
 
@@ -339,12 +395,13 @@ VideoFrame *VideoBuffers::GetNextFreeFrame(bool with_lock,
  */
 void VideoBuffers::ReleaseFrame(VideoFrame *frame)
 {
-    QMutexLocker locker(&global_lock);
+    TRANSITION_LOCKER(this);
 
     vpos = vbufferMap[frame];
     limbo.remove(frame);
     decode.enqueue(frame);
     used.enqueue(frame);
+    SyncCounts();
 }
 
 /**
@@ -354,11 +411,12 @@ void VideoBuffers::ReleaseFrame(VideoFrame *frame)
  */
 void VideoBuffers::DeLimboFrame(VideoFrame *frame)
 {
-    QMutexLocker locker(&global_lock);
+    TRANSITION_LOCKER(this);
     if (limbo.contains(frame))
     {
         limbo.remove(frame);
         available.enqueue(frame);
+        SyncCounts();
     }
 
     // BEGIN HACK HACK HACK, see trac ticket #4159
@@ -375,7 +433,7 @@ void VideoBuffers::DeLimboFrame(VideoFrame *frame)
  */
 void VideoBuffers::StartDisplayingFrame(void)
 {
-    QMutexLocker locker(&global_lock);
+    TRANSITION_LOCKER(this);
     rpos = vbufferMap[used.head()];
 }
 
@@ -385,7 +443,7 @@ void VideoBuffers::StartDisplayingFrame(void)
  */
 void VideoBuffers::DoneDisplayingFrame(VideoFrame *frame)
 {
-    QMutexLocker locker(&global_lock);
+    TRANSITION_LOCKER(this);
 
     if(used.contains(frame))
     {
@@ -401,7 +459,7 @@ void VideoBuffers::DoneDisplayingFrame(VideoFrame *frame)
  */
 void VideoBuffers::DiscardFrame(VideoFrame *frame)
 {
-    QMutexLocker locker(&global_lock);
+    TRANSITION_LOCKER(this);
 
     bool ok = TryLockFrame(frame, "DiscardFrame A");
     for (uint i=0; i<5 && !ok; i++)
@@ -478,7 +536,9 @@ VideoFrame *VideoBuffers::dequeue(BufferType type)
     if (!q)
         return NULL;
 
-    return q->dequeue();
+    VideoFrame *frame = q->dequeue();
+    SyncCounts();
+    return frame;
 }
 
 VideoFrame *VideoBuffers::head(BufferType type)
@@ -523,6 +583,7 @@ void VideoBuffers::enqueue(BufferType type, VideoFrame *frame)
     global_lock.lock();
     q->remove(frame);
     q->enqueue(frame);
+    SyncCounts();
     global_lock.unlock();
 
     return;
@@ -547,6 +608,7 @@ void VideoBuffers::remove(BufferType type, VideoFrame *frame)
         pause.remove(frame);
     if ((type & kVideoBuffer_decode) == kVideoBuffer_decode)
         decode.remove(frame);
+    SyncCounts();
 }
 
 void VideoBuffers::requeue(BufferType dst, BufferType src, int num)
@@ -599,6 +661,11 @@ frame_queue_t::iterator VideoBuffers::end(BufferType type)
 
 uint VideoBuffers::size(BufferType type) const
 {
+    if (type == kVideoBuffer_avail)
+        return available_count;
+    if (type == kVideoBuffer_used)
+        return used_count;
+
     QMutexLocker locker(&global_lock);
 
     const frame_queue_t *q = queue(type);
@@ -716,6 +783,7 @@ void VideoBuffers::DiscardFrames(bool next_frame_keyframe)
     for (it = decode.begin(); it != decode.end(); ++it)
         available.enqueue(*it);
     decode.clear();
+    SyncCounts();
 
     VERBOSE(VB_PLAYBACK, QString("VideoBuffers::DiscardFrames(): %1 -- done()")
             .arg(GetStatus()));
@@ -750,6 +818,8 @@ void VideoBuffers::ClearAfterSeek(void)
         {
             vpos = rpos = 0;
         }
+
+        SyncCounts();
     }
 }
 
@@ -1325,6 +1395,29 @@ QString VideoBuffers::GetStatus(int n) const
     return str;
 }
 
+/// \brief Returns the hand-off counters accumulated since Init().
+VideoBufferStats VideoBuffers::GetStats(void) const
+{
+    VideoBufferStats stats;
+    stats.transitions = stat_transitions;
+    stats.contended   = stat_contended;
+    stats.free_waits  = stat_free_waits;
+
+    global_lock.lock();
+    stats.wait_usecs  = stat_wait_usecs;
+    global_lock.unlock();
+
+    return stats;
+}
+
+/// \brief Updates the lock free copies of the queue sizes,
+///        global_lock must be held.
+void VideoBuffers::SyncCounts(void)
+{
+    available_count = available.size();
+    used_count      = used.size();
+}
+
 void VideoBuffers::Clear(uint i)
 {
     clear(at(i));
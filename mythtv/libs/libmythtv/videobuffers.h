@@ -13,6 +13,7 @@ using namespace std;
 #include <QMutex>
 #include <QString>
 #include <QWaitCondition>
+#include <QAtomicInt>
 
 #ifdef USING_XVMC
 #include <qwindowdefs.h>
@@ -64,6 +65,20 @@ class YUVInfo
     uint offsets[3];
 };
 
+/// \brief Counters for the hand-offs between the decoder and video
+///        threads, see VideoBuffers::GetStats()
+class VideoBufferStats
+{
+  public:
+    VideoBufferStats() :
+        transitions(0), contended(0), wait_usecs(0), free_waits(0) { }
+
+    uint transitions; ///< frame hand-offs which took the queue lock
+    uint contended;   ///< hand-offs which had to wait for the queue lock
+    uint64_t wait_usecs; ///< total time spent waiting for the queue lock
+    uint free_waits;  ///< times GetNextFreeFrame() slept for a free frame
+};
+
 class VideoBuffers
 {
   public:
@@ -161,7 +176,10 @@ class VideoBuffers
                       VideoFrameType fmt);
 
     QString GetStatus(int n=-1) const; // debugging method
+    VideoBufferStats GetStats(void) const;
+
   private:
+    void                   SyncCounts(void);
     frame_queue_t         *queue(BufferType type);
     const frame_queue_t   *queue(BufferType type) const;
     VideoFrame            *GetNextFreeFrameInternal(
@@ -188,6 +206,15 @@ class VideoBuffers
 
     mutable QMutex         global_lock;
 
+    // Sizes of available and used, readable without global_lock
+    QAtomicInt             available_count;
+    QAtomicInt             used_count;
+
+    QAtomicInt             stat_transitions;
+    QAtomicInt             stat_contended;
+    uint64_t               stat_wait_usecs;  // protected by global_lock
+    QAtomicInt             stat_free_waits;
+
     bool                   use_frame_locks;
     QMutex                 frame_lock;
     frame_lock_map_t       frame_locks;
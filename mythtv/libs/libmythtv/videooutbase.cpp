@@ -434,6 +434,14 @@ QString VideoOutput::GetFilters(void) const
     return QString::null;
 }
 
+/// \brief Returns the number of threads the display profile allows.
+uint VideoOutput::GetMaxCPUs(void) const
+{
+    if (db_vdisp_profile)
+        return db_vdisp_profile->GetMaxCPUs();
+    return 1;
+}
+
 bool VideoOutput::IsPreferredRenderer(QSize video_size)
 {
     if (!db_vdisp_profile || (video_size == window.GetVideoDispDim()))
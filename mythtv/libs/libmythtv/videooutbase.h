@@ -222,6 +222,8 @@ class VideoOutput
 
     /// \brief Returns string with status of each frame for debugging.
     QString GetFrameStatus(void) const { return vbuffers.GetStatus(); }
+    /// \brief Returns the frame queue contention counters.
+    VideoBufferStats GetFrameStats(void) const { return vbuffers.GetStats(); }
 
     /// \brief Updates frame displayed when video is paused.
     virtual void UpdatePauseFrame(void) = 0;
@@ -246,6 +248,7 @@ class VideoOutput
     virtual MythPainter *GetOSDPainter(void) { return (MythPainter*)osd_painter; }
 
     QString GetFilters(void) const;
+    uint    GetMaxCPUs(void) const;
     /// \brief translates caption/dvd button rectangle into 'screen' space
     QRect   GetImageRect(const QRect &rect, QRect *display = NULL);
     QRect   GetSafeRect(void);
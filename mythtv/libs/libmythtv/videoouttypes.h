@@ -119,6 +119,8 @@ typedef enum AVSpecialDecode
     kAVSpecialDecode_FewBlocks      = 0x04,
     kAVSpecialDecode_NoLoopFilter   = 0x08,
     kAVSpecialDecode_NoDecode       = 0x10,
+    kAVSpecialDecode_LumaOnly       = 0x20,
+    kAVSpecialDecode_FastNonRef     = 0x40,
 } AVSpecialDecode;
 
 inline bool is_interlaced(FrameScanType scan)
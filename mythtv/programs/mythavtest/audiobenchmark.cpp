@@ -0,0 +1,138 @@
+// ANSI C headers
+#include <cmath>
+#include <cstdlib>
+
+// POSIX headers
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+// C++ headers
+#include <iostream>
+#include <vector>
+using namespace std;
+
+#include <stdint.h>
+
+// MythTV headers
+#include "audiooutput.h"
+#include "exitcodes.h"
+#include "mythverbose.h"
+#include "audiobenchmark.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+namespace {
+
+const int kSampleRate    = 48000;
+/// Seconds of audio fed through the output for each configuration
+const int kSeconds       = 20;
+/// Frames per AddFrames() call, the size of an AC3 frame
+const int kChunkFrames   = 1536;
+
+/// User plus system CPU time of all threads in the process, in ms
+double cpu_ms(void)
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) < 0)
+        return 0.0;
+    return (usage.ru_utime.tv_sec  + usage.ru_stime.tv_sec)  * 1000.0 +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+}
+
+/// One second of interleaved S16 audio, a different tone on each channel
+void make_tones(vector<int16_t> &buf, int channels)
+{
+    buf.resize(kSampleRate * channels);
+    for (int i = 0; i < kSampleRate; i++)
+    {
+        for (int ch = 0; ch < channels; ch++)
+        {
+            double tone = sin(2.0 * M_PI * 110.0 * (ch + 1) * i / kSampleRate);
+            int noise   = (random() & 0x3ff) - 0x200;
+            buf[i * channels + ch] = (int16_t)(tone * 12000.0) + noise;
+        }
+    }
+}
+
+/// Returns CPU ms per second of audio, or a negative value on error
+double run_one(int channels, float stretch)
+{
+    AudioOutput *audio = AudioOutput::OpenAudio(
+        "NULL", QString::null, FORMAT_S16, channels, CODEC_ID_NONE,
+        kSampleRate, AUDIOOUTPUT_VIDEO, false, false);
+
+    if (!audio)
+        return -1.0;
+    if (!audio->GetError().isEmpty())
+    {
+        VERBOSE(VB_IMPORTANT, QString("Audio benchmark: %1")
+                .arg(audio->GetError()));
+        delete audio;
+        return -1.0;
+    }
+
+    vector<int16_t> tones;
+    make_tones(tones, channels);
+
+    audio->SetStretchFactor(stretch);
+
+    double  start     = cpu_ms();
+    int64_t timecode  = 0;
+    for (int sec = 0; sec < kSeconds; sec++)
+    {
+        for (int pos = 0; pos + kChunkFrames <= kSampleRate;
+             pos += kChunkFrames)
+        {
+            // The output thread drains the buffer as fast as it can
+            while (!audio->AddFrames(&tones[pos * channels], kChunkFrames,
+                                     timecode))
+                usleep(1000);
+            timecode += (int64_t)kChunkFrames * 1000 / kSampleRate;
+        }
+    }
+    audio->Drain();
+    double used = cpu_ms() - start;
+
+    delete audio;
+
+    // Time stretching changes how much audio is actually played
+    return used / (kSeconds / stretch);
+}
+
+};  // namespace
+
+int RunAudioBenchmark(void)
+{
+    const int   channels[] = { 6, 8 };
+    const float stretch[]  = { 0.5f, 0.9f, 1.0f, 1.1f, 1.5f, 2.0f };
+
+    cout << "NULL audio output, S16 " << kSampleRate << "Hz, "
+         << kSeconds << " s per run" << endl;
+    cout << "channels  stretch  CPU ms per second of audio" << endl;
+
+    srandom(1);
+
+    for (uint i = 0; i < sizeof(channels) / sizeof(channels[0]); i++)
+    {
+        for (uint j = 0; j < sizeof(stretch) / sizeof(stretch[0]); j++)
+        {
+            double ms = run_one(channels[i], stretch[j]);
+            if (ms < 0.0)
+            {
+                cerr << "Could not open the NULL audio output" << endl;
+                return GENERIC_EXIT_NOT_OK;
+            }
+
+            cout << QString("%1  %2  %3")
+                .arg(channels[i], 8).arg(stretch[j], 7, 'f', 2)
+                .arg(ms, 8, 'f', 2).toLocal8Bit().constData() << endl;
+        }
+    }
+
+    return GENERIC_EXIT_OK;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
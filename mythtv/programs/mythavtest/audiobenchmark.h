@@ -0,0 +1,8 @@
+#ifndef _AUDIOBENCHMARK_H_
+#define _AUDIOBENCHMARK_H_
+
+// Feeds synthetic multichannel audio through the NULL audio output and
+// reports the CPU time spent per second of audio. Returns an exit code.
+int RunAudioBenchmark(void);
+
+#endif // _AUDIOBENCHMARK_H_
@@ -18,6 +18,7 @@ using namespace std;
 #include "mythdbcon.h"
 #include "compat.h"
 #include "dbcheck.h"
+#include "audiobenchmark.h"
 
 // libmythui
 #include "mythuihelper.h"
@@ -110,10 +111,15 @@ int main(int argc, char *argv[])
 
     int argpos = 1;
     QString filename = "";
+    bool audio_benchmark = false;
 
     while (argpos < a.argc())
     {
-        if (cmdline.Parse(a.argc(), a.argv(), argpos, cmdline_err))
+        if (QString(a.argv()[argpos]) == "--audio-benchmark")
+        {
+            audio_benchmark = true;
+        }
+        else if (cmdline.Parse(a.argc(), a.argv(), argpos, cmdline_err))
         {
             if (cmdline_err)
                 return GENERIC_EXIT_INVALID_CMDLINE;
@@ -163,6 +169,13 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (audio_benchmark)
+    {
+        int ret = RunAudioBenchmark();
+        delete gContext;
+        return ret;
+    }
+
     // Create priveledged thread, then drop privs
     pthread_t priv_thread;
     bool priv_thread_created = true;
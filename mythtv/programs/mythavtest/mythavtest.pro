@@ -13,7 +13,8 @@ INSTALLS = target
 QMAKE_CLEAN += $(TARGET)
 
 # Input
-SOURCES += main.cpp
+HEADERS += audiobenchmark.h
+SOURCES += main.cpp audiobenchmark.cpp
 
 macx {
     mac_bundle {
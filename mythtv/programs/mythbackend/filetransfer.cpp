@@ -1,3 +1,20 @@
+// POSIX headers
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+#include "mythconfig.h"
+#if !( CONFIG_DARWIN || CONFIG_CYGWIN || defined(__FreeBSD__) || defined(USING_MINGW))
+#define USING_SENDFILE
+#include <sys/sendfile.h>
+#include <poll.h>
+#endif
+
+#ifndef O_LARGEFILE
+#define O_LARGEFILE 0
+#endif
+
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QFileInfo>
@@ -6,15 +23,35 @@
 #include "ringbuffer.h"
 #include "util.h"
 #include "mythsocket.h"
+#include "mythverbose.h"
 #include "programinfo.h"
 
+#define LOC      QString("FileTransfer: ")
+#define LOC_WARN QString("FileTransfer, Warning: ")
+#define LOC_ERR  QString("FileTransfer, Error: ")
+
+const int FileTransfer::kZeroCopyFallback     = -2;
+const int FileTransfer::kZeroCopyWriteTimeout = 5000; // ms
+
+/** \fn FileTransfer::FileTransfer(QString&,MythSocket*,bool,int,bool)
+ *  \brief Opens filename for reading.
+ *
+ *   With zerocopy the data is sent with sendfile() from a descriptor of
+ *   our own. The RingBuffer is opened the same way as without zerocopy,
+ *   so a transfer that falls back to copying reads exactly like one
+ *   that never used zero-copy.
+ */
 FileTransfer::FileTransfer(QString &filename, MythSocket *remote,
-                           bool usereadahead, int timeout_ms) :
+                           bool usereadahead, int timeout_ms, bool zerocopy) :
     readthreadlive(true), readsLocked(false),
     rbuffer(RingBuffer::Create(filename, false, usereadahead, timeout_ms)),
     sock(remote), ateof(false), lock(QMutex::NonRecursive),
-    refLock(QMutex::NonRecursive), refCount(0), writemode(false)
+    refLock(QMutex::NonRecursive), refCount(0), writemode(false),
+    oldfile(false), zerocopy_fd(-1), zerocopy_pos(0)
 {
+    if (zerocopy)
+        EnableZeroCopy();
+
     pginfo = new ProgramInfo(filename);
     pginfo->MarkAsInUse(true, kFileTransferInUseID);
 }
@@ -23,7 +60,8 @@ FileTransfer::FileTransfer(QString &filename, MythSocket *remote, bool write) :
     readthreadlive(true), readsLocked(false),
     rbuffer(RingBuffer::Create(filename, write)),
     sock(remote), ateof(false), lock(QMutex::NonRecursive),
-    refLock(QMutex::NonRecursive), refCount(0), writemode(write)
+    refLock(QMutex::NonRecursive), refCount(0), writemode(write),
+    oldfile(false), zerocopy_fd(-1), zerocopy_pos(0)
 {
     pginfo = new ProgramInfo(filename);
     pginfo->MarkAsInUse(true, kFileTransferInUseID);
@@ -36,6 +74,12 @@ FileTransfer::~FileTransfer()
 {
     Stop();
 
+    if (zerocopy_fd >= 0)
+    {
+        ::close(zerocopy_fd);
+        zerocopy_fd = -1;
+    }
+
     if (rbuffer)
     {
         delete rbuffer;
@@ -76,6 +120,66 @@ bool FileTransfer::isOpen(void)
     return false;
 }
 
+/** \fn FileTransfer::EnableZeroCopy(void)
+ *  \brief Serve REQUEST_BLOCK with sendfile() instead of copying the
+ *         data through the RingBuffer and the MythSocket.
+ *
+ *   Only plain files opened for reading qualify. The bytes sent to
+ *   the client are identical, so this needs no protocol change.
+ *
+ *  \return true if zero-copy transfers are now in use.
+ */
+bool FileTransfer::EnableZeroCopy(void)
+{
+#ifdef USING_SENDFILE
+    if (writemode || !rbuffer || !rbuffer->IsOpen() || rbuffer->IsDisc())
+        return false;
+
+    if (zerocopy_fd >= 0)
+        return true;
+
+    QString filename = rbuffer->GetFilename();
+    if (!QFileInfo(filename).isFile())
+        return false;
+
+    zerocopy_fd = ::open(filename.toLocal8Bit().constData(),
+                         O_RDONLY | O_LARGEFILE);
+    if (zerocopy_fd < 0)
+    {
+        VERBOSE(VB_IMPORTANT, LOC_WARN +
+                QString("Could not open '%1' for zero-copy transfer")
+                .arg(filename) + ENO);
+        return false;
+    }
+
+    QMutexLocker locker(&lock);
+    zerocopy_pos = rbuffer->GetReadPosition();
+
+    VERBOSE(VB_FILE, LOC + QString("Using zero-copy transfer for '%1'")
+            .arg(filename));
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+/** \fn FileTransfer::DisableZeroCopy(void)
+ *  \brief Returns to RingBuffer reads at the current zero-copy position.
+ *
+ *   Must be called with lock held.
+ */
+void FileTransfer::DisableZeroCopy(void)
+{
+    if (zerocopy_fd < 0)
+        return;
+
+    ::close(zerocopy_fd);
+    zerocopy_fd = -1;
+
+    rbuffer->Seek(zerocopy_pos, SEEK_SET);
+}
+
 void FileTransfer::Stop(void)
 {
     if (readthreadlive)
@@ -128,6 +232,19 @@ int FileTransfer::RequestBlock(int size)
     while (readsLocked)
         readsUnlockedCond.wait(&lock, 100 /*ms*/);
 
+    if (zerocopy_fd >= 0)
+    {
+        tot = RequestBlockZeroCopy(size);
+        if (tot != kZeroCopyFallback)
+        {
+            if (pginfo)
+                pginfo->UpdateInUseMark();
+
+            return tot;
+        }
+        tot = 0;
+    }
+
     requestBuffer.resize(max((size_t)max(size,0) + 128, requestBuffer.size()));
     char *buf = &requestBuffer[0];
     while (tot < size && !rbuffer->GetStopReads() && readthreadlive)
@@ -156,6 +273,105 @@ int FileTransfer::RequestBlock(int size)
     return (ret < 0) ? -1 : tot;
 }
 
+/** \fn FileTransfer::RequestBlockZeroCopy(int)
+ *  \brief Sends up to size bytes from zerocopy_pos with sendfile().
+ *
+ *   The kernel moves the data from the page cache to the socket without
+ *   a trip through user space. At the end of a recording that is still
+ *   in progress this waits for the file to grow, the same way
+ *   FileRingBuffer::safe_read() does.
+ *
+ *   sendfile() writes to the socket descriptor directly, so this holds
+ *   the MythSocket lock while sending to keep other writes from being
+ *   interleaved with the data.
+ *
+ *   Must be called with lock held, which is released while waiting for
+ *   a recording in progress to grow so Seek() and Pause() do not block.
+ *
+ *  \return bytes sent, -1 on error, or kZeroCopyFallback if
+ *          sendfile() is not supported for this file.
+ */
+int FileTransfer::RequestBlockZeroCopy(int size)
+{
+#ifdef USING_SENDFILE
+    int  tot     = 0;
+    uint zerocnt = 0;
+
+    sock->Lock();
+    int sockfd = sock->socket();
+
+    while (tot < size && !rbuffer->GetStopReads() && readthreadlive)
+    {
+        __off64_t offset = zerocopy_pos;
+        ssize_t ret = sendfile64(sockfd, zerocopy_fd, &offset, size - tot);
+
+        if (ret > 0)
+        {
+            tot += ret;
+            zerocopy_pos = offset;
+            zerocnt = 0;
+            continue;
+        }
+
+        if (ret == 0) // at end of file
+        {
+            // 2.4 second timeout for a file which is still being written
+            if (oldfile || tot > 0 || ++zerocnt >= 40)
+                break;
+
+            sock->Unlock();
+            lock.unlock();
+            usleep(60000);
+            lock.lock();
+            sock->Lock();
+
+            sockfd = sock->socket();
+            continue;
+        }
+
+        if (EINTR == errno)
+            continue;
+
+        if (EAGAIN == errno)
+        {
+            // The data socket is non-blocking, wait for it to drain.
+            struct pollfd pfd;
+            pfd.fd      = sockfd;
+            pfd.events  = POLLOUT;
+            pfd.revents = 0;
+            if (poll(&pfd, 1, kZeroCopyWriteTimeout) > 0)
+                continue;
+
+            VERBOSE(VB_IMPORTANT, LOC_ERR +
+                    "Timed out waiting to write to data socket");
+            tot = -1;
+            break;
+        }
+
+        if (tot == 0 && (EINVAL == errno || ENOSYS == errno))
+        {
+            VERBOSE(VB_IMPORTANT, LOC_WARN + "sendfile() not supported "
+                    "for this file, falling back to copying" + ENO);
+            DisableZeroCopy();
+            tot = kZeroCopyFallback;
+            break;
+        }
+
+        VERBOSE(VB_IMPORTANT, LOC_ERR + "sendfile() failed" + ENO);
+        tot = -1;
+        break;
+    }
+
+    sock->Unlock();
+
+    return tot;
+#else
+    (void) size;
+    DisableZeroCopy();
+    return kZeroCopyFallback;
+#endif
+}
+
 int FileTransfer::WriteBlock(int size)
 {
     if (!writemode || !rbuffer)
@@ -203,6 +419,32 @@ long long FileTransfer::Seek(long long curpos, long long pos, int whence)
 
     Pause();
 
+    if (zerocopy_fd >= 0)
+    {
+        long long ret = -1;
+        {
+            QMutexLocker locker(&lock);
+            if (whence == SEEK_SET)
+                ret = pos;
+            else if (whence == SEEK_CUR)
+                ret = curpos + pos;
+            else if (whence == SEEK_END)
+                ret = QFileInfo(rbuffer->GetFilename()).size() + pos;
+
+            if (ret < 0)
+                ret = -1;
+            else
+                zerocopy_pos = ret;
+        }
+
+        Unpause();
+
+        if (pginfo)
+            pginfo->UpdateInUseMark();
+
+        return ret;
+    }
+
     if (whence == SEEK_CUR)
     {
         long long desired = curpos + pos;
@@ -234,6 +476,7 @@ void FileTransfer::SetTimeout(bool fast)
     if (pginfo)
         pginfo->UpdateInUseMark();
 
+    oldfile = fast;
     rbuffer->SetOldFile(fast);
 }
 
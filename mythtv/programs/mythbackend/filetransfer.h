@@ -26,12 +26,13 @@ class FileTransfer
 
   public:
     FileTransfer(QString &filename, MythSocket *remote,
-                 bool usereadahead, int timeout_ms);
+                 bool usereadahead, int timeout_ms, bool zerocopy = false);
     FileTransfer(QString &filename, MythSocket *remote, bool write);
 
     MythSocket *getSocket() { return sock; }
 
     bool isOpen(void);
+    bool IsZeroCopy(void) const { return zerocopy_fd >= 0; }
 
     void Stop(void);
 
@@ -52,6 +53,10 @@ class FileTransfer
   private:
    ~FileTransfer();
 
+    bool EnableZeroCopy(void);
+    int RequestBlockZeroCopy(int size);
+    void DisableZeroCopy(void);
+
     volatile bool  readthreadlive;
     bool           readsLocked;
     QWaitCondition readsUnlockedCond;
@@ -68,6 +73,13 @@ class FileTransfer
     int refCount;
 
     bool writemode;
+    bool oldfile;
+
+    int       zerocopy_fd;  ///< our own descriptor for sendfile, or -1
+    long long zerocopy_pos; ///< protected by lock
+
+    static const int kZeroCopyFallback;
+    static const int kZeroCopyWriteTimeout;
 };
 
 #endif
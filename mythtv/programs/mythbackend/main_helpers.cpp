@@ -493,6 +493,7 @@ int handle_command(const MythCommandLineParser &cmdline)
 
         print_verbose_messages |= VB_SCHEDULE;
         sched->PrintList(true);
+        sched->PrintPhaseTimes();
         return BACKEND_EXIT_OK;
     }
 
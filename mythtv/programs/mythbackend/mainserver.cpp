@@ -49,7 +49,9 @@ using namespace std;
 #include "scheduler.h"
 #include "backendutil.h"
 #include "programinfo.h"
+#include "programlistcodec.h"
 #include "recordinginfo.h"
+#include "recordingcatalog.h"
 #include "recordingrule.h"
 #include "scheduledrecording.h"
 #include "jobqueue.h"
@@ -180,7 +182,8 @@ MainServer::MainServer(bool master, int port,
                        Scheduler *sched, AutoExpire *expirer) :
     encoderList(tvList), mythserver(NULL), masterServerReconnect(NULL),
     masterServer(NULL), ismaster(master), masterBackendOverride(false),
-    m_sched(sched), m_expirer(expirer), deferredDeleteTimer(NULL),
+    m_sched(sched), m_expirer(expirer),
+    m_recCatalog(new RecordingCatalog()), deferredDeleteTimer(NULL),
     autoexpireUpdateTimer(NULL), m_exitCode(BACKEND_EXIT_OK)
 {
     PreviewGeneratorQueue::CreatePreviewGeneratorQueue(
@@ -251,6 +254,9 @@ MainServer::~MainServer()
         mythserver->deleteLater();
         mythserver = NULL;
     }
+
+    delete m_recCatalog;
+    m_recCatalog = NULL;
 }
 
 void MainServer::autoexpireUpdate(void)
@@ -360,7 +366,8 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
         if (tokens.size() != 2)
             VERBOSE(VB_IMPORTANT, "Bad QUERY_RECORDINGS query");
         else
-            HandleQueryRecordings(tokens[1], pbs);
+            HandleQueryRecordings(tokens[1], pbs,
+                                  ProgramListCodec::IsRequested(listline));
     }
     else if (command == "QUERY_RECORDING")
     {
@@ -471,16 +478,19 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
     }
     else if (command == "QUERY_GETALLPENDING")
     {
+        bool compact = ProgramListCodec::IsRequested(listline);
         if (tokens.size() == 1)
-            HandleGetPendingRecordings(pbs);
+            HandleGetPendingRecordings(pbs, "", -1, compact);
         else if (tokens.size() == 2)
-            HandleGetPendingRecordings(pbs, tokens[1]);
+            HandleGetPendingRecordings(pbs, tokens[1], -1, compact);
         else
-            HandleGetPendingRecordings(pbs, tokens[1], tokens[2].toInt());
+            HandleGetPendingRecordings(pbs, tokens[1], tokens[2].toInt(),
+                                       compact);
     }
     else if (command == "QUERY_GETALLSCHEDULED")
     {
-        HandleGetScheduledRecordings(pbs);
+        HandleGetScheduledRecordings(
+            pbs, ProgramListCodec::IsRequested(listline));
     }
     else if (command == "QUERY_GETCONFLICTING")
     {
@@ -1034,6 +1044,13 @@ void MainServer::customEvent(QEvent *e)
             }
         }
 
+        if (me->Message().left(21) == "RECORDING_LIST_CHANGE" ||
+            me->Message().left(16) == "UPDATE_FILE_SIZE")
+        {
+            if (m_recCatalog->HandleEvent(*me) && m_sched)
+                m_sched->HistoryChanged();
+        }
+
         if (me->Message().left(13) == "DOWNLOAD_FILE")
         {
             QStringList extraDataList = me->ExtraDataList();
@@ -1452,7 +1469,12 @@ void MainServer::HandleAnnounce(QStringList &slist, QStringList commands,
         if (writemode)
             ft = new FileTransfer(filename, socket, writemode);
         else
-            ft = new FileTransfer(filename, socket, usereadahead, timeout_ms);
+        {
+            bool zerocopy =
+                gCoreContext->GetNumSetting("BackendZeroCopyStreaming", 1);
+            ft = new FileTransfer(filename, socket, usereadahead, timeout_ms,
+                                  zerocopy);
+        }
 
         sockListLock.lockForWrite();
         fileTransferList.push_back(ft);
@@ -1526,8 +1548,12 @@ void MainServer::SendResponse(MythSocket *socket, QStringList &commands)
  * The \e type parameter can be either "Play", "Recording" or "Delete".
  * Returns programinfo (title, subtitle, description, category, chanid,
  * channum, callsign, channel.name, fileURL, \e et \e cetera)
+ *
+ * If the command is followed by a ProgramListCodec::Request() entry
+ * the programinfo are sent in the compact encoding.
  */
-void MainServer::HandleQueryRecordings(QString type, PlaybackSock *pbs)
+void MainServer::HandleQueryRecordings(QString type, PlaybackSock *pbs,
+                                       bool compact)
 {
     MythSocket *pbssock = pbs->getSocket();
     QString playbackhost = pbs->getHostname();
@@ -1537,13 +1563,31 @@ void MainServer::HandleQueryRecordings(QString type, PlaybackSock *pbs)
         recMap = m_sched->GetRecording();
 
     QMap<QString,uint32_t> inUseMap = ProgramInfo::QueryInUseMap();
-    QMap<QString,bool> isJobRunning =
-        ProgramInfo::QueryJobsRunning(JOB_COMMFLAG);
 
+    // The catalog is kept current from recording list events, but the
+    // in-use flags and recording status are not and are applied here.
     ProgramList destination;
-    LoadFromRecorded(
-        destination, (type == "Recording"),
-        inUseMap, isJobRunning, recMap);
+    m_recCatalog->GetRecordings(destination, (type == "Recording"));
+
+    QDateTime rectime = QDateTime::currentDateTime().addSecs(
+        -gCoreContext->GetNumSetting("RecordOverTime"));
+
+    ProgramList::iterator dit = destination.begin();
+    for (; dit != destination.end(); ++dit)
+    {
+        ProgramInfo *p = *dit;
+        QString key = p->MakeUniqueKey();
+
+        uint32_t flags = p->GetProgramFlags() &
+            ~(FL_INUSERECORDING | FL_INUSEPLAYING | FL_INUSEOTHER);
+        QMap<QString,uint32_t>::const_iterator uit = inUseMap.find(key);
+        if (uit != inUseMap.end())
+            flags |= *uit;
+        p->SetProgramFlags(flags);
+
+        if (p->GetRecordingEndTime() > rectime && recMap.contains(key))
+            p->SetRecordingStatus(rsRecording);
+    }
 
     QMap<QString,ProgramInfo*>::iterator mit = recMap.begin();
     for (; mit != recMap.end(); mit = recMap.erase(mit))
@@ -1645,6 +1689,9 @@ void MainServer::HandleQueryRecordings(QString type, PlaybackSock *pbs)
         proginfo->ToStringList(outputlist);
     }
 
+    if (compact)
+        ProgramListCodec::Encode(outputlist, 1, destination.size());
+
     SendResponse(pbssock, outputlist);
 }
 
@@ -2023,6 +2070,19 @@ void MainServer::DoDeleteInDB(const DeleteStruct *ds)
                            QString("Error deleting recordedseek for %1.")
                                    .arg(logInfo));
     }
+
+    query.prepare("DELETE FROM recordedseekblob "
+                  "WHERE chanid = :CHANID AND starttime = :STARTTIME;");
+    query.bindValue(":CHANID", ds->chanid);
+    query.bindValue(":STARTTIME", ds->recstartts);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("Recorded program delete recordedseekblob", query);
+        gCoreContext->LogEntry("mythbackend", LP_ERROR, "Delete Recording",
+                           QString("Error deleting recordedseekblob for %1.")
+                                   .arg(logInfo));
+    }
 }
 
 /**
@@ -2960,7 +3020,8 @@ void MainServer::HandleQueryGuideDataThrough(PlaybackSock *pbs)
 }
 
 void MainServer::HandleGetPendingRecordings(PlaybackSock *pbs,
-                                            QString tmptable, int recordid)
+                                            QString tmptable, int recordid,
+                                            bool compact)
 {
     MythSocket *pbssock = pbs->getSocket();
 
@@ -3008,10 +3069,14 @@ void MainServer::HandleGetPendingRecordings(PlaybackSock *pbs,
         strList << QString::number(0);
     }
 
+    // reply is: hasconflicts, count, programs..
+    if (compact)
+        ProgramListCodec::Encode(strList, 2, strList[1].toUInt());
+
     SendResponse(pbssock, strList);
 }
 
-void MainServer::HandleGetScheduledRecordings(PlaybackSock *pbs)
+void MainServer::HandleGetScheduledRecordings(PlaybackSock *pbs, bool compact)
 {
     MythSocket *pbssock = pbs->getSocket();
 
@@ -3022,6 +3087,9 @@ void MainServer::HandleGetScheduledRecordings(PlaybackSock *pbs)
     else
         strList << QString::number(0);
 
+    if (compact)
+        ProgramListCodec::Encode(strList, 1, strList[0].toUInt());
+
     SendResponse(pbssock, strList);
 }
 
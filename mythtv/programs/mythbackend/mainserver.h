@@ -29,6 +29,7 @@ class ProcessRequestThread;
 class QUrl;
 class MythServer;
 class VideoScanner;
+class RecordingCatalog;
 class QTimer;
 
 class MainServer : public QObject, public MythSocketCBs
@@ -95,7 +96,8 @@ class MainServer : public QObject, public MythSocketCBs
     bool HandleDeleteFile(QStringList &slist, PlaybackSock *pbs);
     bool HandleDeleteFile(QString filename, QString storagegroup,
                           PlaybackSock *pbs = NULL);
-    void HandleQueryRecordings(QString type, PlaybackSock *pbs);
+    void HandleQueryRecordings(QString type, PlaybackSock *pbs,
+                               bool compact = false);
     void HandleQueryRecording(QStringList &slist, PlaybackSock *pbs);
     void HandleStopRecording(QStringList &slist, PlaybackSock *pbs);
     void DoHandleStopRecording(RecordingInfo &recinfo, PlaybackSock *pbs);
@@ -118,8 +120,9 @@ class MainServer : public QObject, public MythSocketCBs
     void HandleQueryFileExists(QStringList &slist, PlaybackSock *pbs);
     void HandleQueryFileHash(QStringList &slist, PlaybackSock *pbs);
     void HandleQueryGuideDataThrough(PlaybackSock *pbs);
-    void HandleGetPendingRecordings(PlaybackSock *pbs, QString table = "", int recordid=-1);
-    void HandleGetScheduledRecordings(PlaybackSock *pbs);
+    void HandleGetPendingRecordings(PlaybackSock *pbs, QString table = "",
+                                    int recordid = -1, bool compact = false);
+    void HandleGetScheduledRecordings(PlaybackSock *pbs, bool compact = false);
     void HandleGetConflictingRecordings(QStringList &slist, PlaybackSock *pbs);
     void HandleGetExpiringRecordings(PlaybackSock *pbs);
     void HandleSGGetFileList(QStringList &sList, PlaybackSock *pbs);
@@ -232,6 +235,7 @@ class MainServer : public QObject, public MythSocketCBs
 
     Scheduler *m_sched;
     AutoExpire *m_expirer;
+    RecordingCatalog *m_recCatalog;
 
     struct DeferredDeleteStruct
     {
@@ -0,0 +1,252 @@
+#include <QStringList>
+#include <QMap>
+
+#include "recordingcatalog.h"
+#include "programinfo.h"
+#include "mythverbose.h"
+#include "mythevent.h"
+#include "jobqueue.h"
+
+#define LOC QString("RecordingCatalog: ")
+
+/// Seconds after which the catalog is reloaded from the database
+const int RecordingCatalog::kMaxAge = 300;
+
+RecordingCatalog::RecordingCatalog() :
+    m_valid(false)
+{
+}
+
+RecordingCatalog::~RecordingCatalog()
+{
+    Clear();
+}
+
+/** \fn RecordingCatalog::GetRecordings(ProgramList&,bool)
+ *  \brief Appends a copy of each cataloged recording to destination.
+ *
+ *   The copies carry no in-use flags and a status of rsRecorded, the
+ *   caller applies the current values of both.
+ *
+ *  \param in_progress_only Only return recordings whose recording
+ *                          start and end times span the current time.
+ *  \return the number of recordings appended.
+ */
+uint RecordingCatalog::GetRecordings(
+    ProgramList &destination, bool in_progress_only)
+{
+    QMutexLocker locker(&m_lock);
+
+    QDateTime now = QDateTime::currentDateTime();
+    if (m_valid && m_loadTime.secsTo(now) > kMaxAge)
+        Clear();
+
+    if (!m_valid)
+        Load();
+
+    uint count = 0;
+    ProgramList::const_iterator it = m_list.begin();
+    for (; it != m_list.end(); ++it)
+    {
+        if (in_progress_only &&
+            ((*it)->GetRecordingEndTime()   < now ||
+             (*it)->GetRecordingStartTime() > now))
+        {
+            continue;
+        }
+
+        destination.push_back(new ProgramInfo(**it));
+        count++;
+    }
+
+    return count;
+}
+
+/** \fn history_differs(const ProgramInfo&,const ProgramInfo&)
+ *  \brief Returns true if the recorded columns the scheduler's duplicate
+ *         and episode checks read differ between a and b.
+ */
+static bool history_differs(const ProgramInfo &a, const ProgramInfo &b)
+{
+    return (a.GetTitle()               != b.GetTitle()               ||
+            a.GetSubtitle()            != b.GetSubtitle()            ||
+            a.GetDescription()         != b.GetDescription()         ||
+            a.GetProgramID()           != b.GetProgramID()           ||
+            a.GetFindID()              != b.GetFindID()              ||
+            a.GetRecordingRuleID()     != b.GetRecordingRuleID()     ||
+            a.GetRecordingGroup()      != b.GetRecordingGroup()      ||
+            a.GetScheduledStartTime()  != b.GetScheduledStartTime()  ||
+            a.GetScheduledEndTime()    != b.GetScheduledEndTime()    ||
+            a.IsDuplicate()            != b.IsDuplicate()            ||
+            a.IsPreserved()            != b.IsPreserved());
+}
+
+/** \fn RecordingCatalog::HandleEvent(const MythEvent&)
+ *  \brief Applies a RECORDING_LIST_CHANGE or UPDATE_FILE_SIZE event.
+ *
+ *   Additions, deletions, updates and file size changes of a single
+ *   recording are applied in place. A RECORDING_LIST_CHANGE without
+ *   any details causes a reload on the next request.
+ *
+ *  \return true if the event may have changed the recording history
+ *          the scheduler uses, see Scheduler::HistoryChanged().
+ */
+bool RecordingCatalog::HandleEvent(const MythEvent &me)
+{
+    QStringList tokens = me.Message().simplified().split(" ");
+
+    QMutexLocker locker(&m_lock);
+
+    if (tokens[0] == "UPDATE_FILE_SIZE")
+    {
+        if (m_valid && tokens.size() >= 4)
+        {
+            QHash<QString,ProgramInfo*>::iterator it =
+                m_index.find(ProgramInfo::MakeUniqueKey(
+                    tokens[1].toUInt(),
+                    QDateTime::fromString(tokens[2], Qt::ISODate)));
+            if (it != m_index.end())
+                (*it)->SetFilesize(tokens[3].toULongLong());
+        }
+        return false;
+    }
+
+    if (tokens[0] != "RECORDING_LIST_CHANGE")
+        return false;
+
+    // Without the old copy any change may matter
+    if (!m_valid)
+        return true;
+
+    uint      chanid = 0;
+    QDateTime recstartts;
+    if (tokens.size() >= 2 && tokens[1] == "UPDATE" && me.ExtraDataCount())
+    {
+        ProgramInfo *pginfo = new ProgramInfo(me.ExtraDataList());
+        if (pginfo->GetChanID())
+            return Update(pginfo);
+        delete pginfo;
+    }
+    else if (tokens.size() >= 4 &&
+             (tokens[1] == "ADD" || tokens[1] == "DELETE"))
+    {
+        chanid     = tokens[2].toUInt();
+        recstartts = QDateTime::fromString(tokens[3], Qt::ISODate);
+
+        if (tokens[1] == "DELETE")
+        {
+            Remove(ProgramInfo::MakeUniqueKey(chanid, recstartts));
+            return true;
+        }
+
+        ProgramInfo *pginfo = new ProgramInfo(chanid, recstartts);
+        if (pginfo->GetChanID())
+            return Update(pginfo);
+        delete pginfo;
+    }
+
+    VERBOSE(VB_GENERAL|VB_EXTRA, LOC + QString("'%1', reloading on next "
+            "request").arg(me.Message()));
+
+    Clear();
+    return true;
+}
+
+/// Discards the catalog so that it is reloaded on the next request.
+void RecordingCatalog::Invalidate(void)
+{
+    QMutexLocker locker(&m_lock);
+    Clear();
+}
+
+void RecordingCatalog::Load(void)
+{
+    Clear();
+
+    // In-use flags and the recording status are applied per request,
+    // so load without them.
+    QMap<QString,uint32_t> inUseMap;
+    QMap<QString,ProgramInfo*> recMap;
+    QMap<QString,bool> isJobRunning =
+        ProgramInfo::QueryJobsRunning(JOB_COMMFLAG);
+
+    LoadFromRecorded(m_list, false, inUseMap, isJobRunning, recMap);
+
+    ProgramList::iterator it = m_list.begin();
+    for (; it != m_list.end(); ++it)
+        m_index[(*it)->MakeUniqueKey()] = *it;
+
+    m_valid    = true;
+    m_loadTime = QDateTime::currentDateTime();
+
+    VERBOSE(VB_GENERAL, LOC + QString("Loaded %1 recordings")
+            .arg(m_list.size()));
+}
+
+/** \fn RecordingCatalog::Update(ProgramInfo*)
+ *  \brief Adds or replaces a recording loaded for an event.
+ *
+ *   A recording loaded by itself is marked as being flagged whenever
+ *   its commflagged column says so, LoadFromRecorded() also requires a
+ *   running commercial flagging job. Apply the same check here, it is
+ *   one query for the one recording.
+ *
+ *  \return true if the recording is new or its history fields changed.
+ */
+bool RecordingCatalog::Update(ProgramInfo *pginfo)
+{
+    pginfo->SetRecordingStatus(rsRecorded);
+
+    uint32_t flags = pginfo->GetProgramFlags();
+    if ((flags & FL_COMMPROCESSING) &&
+        !JobQueue::IsJobRunning(JOB_COMMFLAG, *pginfo))
+    {
+        flags &= ~FL_COMMPROCESSING;
+        if (!(flags & FL_REALLYEDITING))
+            flags &= ~FL_EDITING;
+        pginfo->SetProgramFlags(flags);
+    }
+
+    QString key = pginfo->MakeUniqueKey();
+    QHash<QString,ProgramInfo*>::iterator it = m_index.find(key);
+    if (it != m_index.end())
+    {
+        bool changed = history_differs(**it, *pginfo);
+        **it = *pginfo;
+        delete pginfo;
+        return changed;
+    }
+
+    m_list.push_back(pginfo);
+    m_index[key] = pginfo;
+    return true;
+}
+
+void RecordingCatalog::Remove(const QString &key)
+{
+    QHash<QString,ProgramInfo*>::iterator hit = m_index.find(key);
+    if (hit == m_index.end())
+        return;
+
+    ProgramInfo *pginfo = *hit;
+    m_index.erase(hit);
+
+    ProgramList::iterator it = m_list.begin();
+    for (; it != m_list.end(); ++it)
+    {
+        if (*it == pginfo)
+        {
+            m_list.erase(it);
+            break;
+        }
+    }
+}
+
+void RecordingCatalog::Clear(void)
+{
+    m_index.clear();
+    m_list.clear();
+    m_valid = false;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,57 @@
+#ifndef _RECORDING_CATALOG_H_
+#define _RECORDING_CATALOG_H_
+
+#include <stdint.h>
+
+#include <QDateTime>
+#include <QString>
+#include <QMutex>
+#include <QHash>
+
+#include "programinfo.h"
+
+class MythEvent;
+
+/** \class RecordingCatalog
+ *  \brief Resident copy of the recorded table used to answer
+ *         QUERY_RECORDINGS without running LoadFromRecorded() for
+ *         every request.
+ *
+ *   The catalog is loaded on first use and is then kept current from
+ *   the RECORDING_LIST_CHANGE and UPDATE_FILE_SIZE events the backend
+ *   already relays. This includes the commercial flagging and editing
+ *   state, which mythcommflag, the job queue and the editor announce
+ *   with update events. Edits which send no event, from other backends
+ *   or straight to the database, are picked up by reloading a catalog
+ *   older than kMaxAge seconds. The in-use flags and the rsRecording
+ *   status are applied to the copies handed out by the caller.
+ */
+class RecordingCatalog
+{
+  public:
+    RecordingCatalog();
+    ~RecordingCatalog();
+
+    uint GetRecordings(ProgramList &destination, bool in_progress_only);
+
+    bool HandleEvent(const MythEvent &me);
+    void Invalidate(void);
+
+  private:
+    void Load(void);
+    bool Update(ProgramInfo *pginfo);
+    void Remove(const QString &key);
+    void Clear(void);
+
+    mutable QMutex              m_lock;
+    bool                        m_valid;
+    QDateTime                   m_loadTime;
+    ProgramList                 m_list;
+    QHash<QString,ProgramInfo*> m_index;
+
+    static const int            kMaxAge;
+};
+
+#endif // _RECORDING_CATALOG_H_
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -51,6 +51,8 @@ Scheduler::Scheduler(bool runthread, QMap<int, EncoderLink *> *tvList,
     recordTable(tmptable),
     priorityTable("powerpriority"),
     schedLock(),
+    candidatesvalid(false),
+    historychanged(false),
     reclist_changed(false),
     specsched(master_sched),
     schedMoveHigher(false),
@@ -61,10 +63,14 @@ Scheduler::Scheduler(bool runthread, QMap<int, EncoderLink *> *tvList,
     m_mainServer(NULL),
     resetIdleTime(false),
     m_isShuttingDown(false),
+    testRecordMatch(false),
     error(0),
     livetvTime(QDateTime()),
     livetvpriority(0),
-    prefinputpri(0)
+    prefinputpri(0),
+    findConflictCount(0),
+    tryAnotherCount(0),
+    moveHigherCount(0)
 {
     if (master_sched)
         master_sched->getAllPending(&reclist);
@@ -125,6 +131,15 @@ Scheduler::~Scheduler()
         pthread_cancel(schedThread);
         pthread_join(schedThread, NULL);
     }
+
+    ClearCandidates();
+
+    if (testRecordMatch)
+    {
+        MSqlQuery query(dbConn);
+        if (!query.exec("DROP TABLE recordmatch"))
+            MythDB::DBError("~Scheduler", query);
+    }
 }
 
 void Scheduler::SetMainServer(MainServer *ms)
@@ -336,47 +351,79 @@ static bool comp_timechannel(RecordingInfo *a, RecordingInfo *b)
     return a->GetChanNum() < b->GetChanNum();
 }
 
-bool Scheduler::FillRecordList(bool doLock)
+/** \fn Scheduler::FillRecordList(bool,const QMap<int,bool>*)
+ *  \param changed Record IDs of the rules whose matches have changed
+ *                 since the last pass, or NULL if anything might have
+ *                 been changed. When this is given, and incremental
+ *                 scheduling is enabled, only the candidates of those
+ *                 rules are queried again.
+ */
+bool Scheduler::FillRecordList(bool doLock, const QMap<int, bool> *changed)
 {
     schedMoveHigher = (bool)gCoreContext->GetNumSetting("SchedMoveHigher");
     schedTime = QDateTime::currentDateTime();
 
-    VERBOSE(VB_SCHEDULE, "BuildWorkList...");
+    bool incremental = changed &&
+        gCoreContext->GetNumSetting("SchedIncremental", 1);
+    bool verify = incremental &&
+        gCoreContext->GetNumSetting("SchedVerifyIncremental", 0);
+
+    BeginPhase("BuildWorkList");
     BuildWorkList();
+    // Every pass reads the history it needs, only a change after this
+    // point must be seen by the next pass.
+    bool history_changed = historychanged;
+    historychanged = false;
     if (doLock)
         schedLock.unlock();
-    VERBOSE(VB_SCHEDULE, "AddNewRecords...");
+    if (incremental)
+    {
+        BeginPhase("UpdateCandidates");
+        incremental = UpdateCandidates(*changed, history_changed);
+    }
+    if (!incremental)
+    {
+        BeginPhase("LoadCandidates");
+        LoadCandidates(-1);
+    }
+    else if (verify)
+    {
+        BeginPhase("CheckCandidates");
+        CheckCandidates();
+    }
+    BeginPhase("AddNewRecords");
     AddNewRecords();
-    VERBOSE(VB_SCHEDULE, "AddNotListed...");
+    BeginPhase("AddNotListed");
     AddNotListed();
 
-    VERBOSE(VB_SCHEDULE, "Sort by time...");
+    BeginPhase("Sort by time");
     SORT_RECLIST(worklist, comp_overlap);
-    VERBOSE(VB_SCHEDULE, "PruneOverlaps...");
+    BeginPhase("PruneOverlaps");
     PruneOverlaps();
 
-    VERBOSE(VB_SCHEDULE, "Sort by priority...");
+    BeginPhase("Sort by priority");
     SORT_RECLIST(worklist, comp_priority);
-    VERBOSE(VB_SCHEDULE, "BuildListMaps...");
+    BeginPhase("BuildListMaps");
     BuildListMaps();
-    VERBOSE(VB_SCHEDULE, "SchedNewRecords...");
+    BeginPhase("SchedNewRecords");
     SchedNewRecords();
-    VERBOSE(VB_SCHEDULE, "SchedPreserveLiveTV...");
+    BeginPhase("SchedPreserveLiveTV");
     SchedPreserveLiveTV();
-    VERBOSE(VB_SCHEDULE, "ClearListMaps...");
+    BeginPhase("ClearListMaps");
     ClearListMaps();
     if (doLock)
         schedLock.lock();
 
-    VERBOSE(VB_SCHEDULE, "Sort by time...");
+    BeginPhase("Sort by time");
     SORT_RECLIST(worklist, comp_redundant);
-    VERBOSE(VB_SCHEDULE, "PruneRedundants...");
+    BeginPhase("PruneRedundants");
     PruneRedundants();
 
-    VERBOSE(VB_SCHEDULE, "Sort by time...");
+    BeginPhase("Sort by time");
     SORT_RECLIST(worklist, comp_recstart);
-    VERBOSE(VB_SCHEDULE, "ClearWorkList...");
+    BeginPhase("ClearWorkList");
     bool res = ClearWorkList();
+    EndPhase();
 
     return res;
 }
@@ -394,6 +441,8 @@ void Scheduler::FillRecordListFromDB(int recordid)
     QString thequery;
     QString where = "";
 
+    ResetPhaseTimes();
+
     // This will cause our temp copy of recordmatch to be empty
     if (recordid == -1)
         where = "WHERE recordid IS NULL ";
@@ -446,6 +495,43 @@ void Scheduler::FillRecordListFromDB(int recordid)
     VERBOSE(VB_GENERAL, msg);
 }
 
+/** \fn Scheduler::TestReschedule(int)
+ *  \brief Reschedules from the database the way the scheduler thread
+ *         does, for the mythschedtest harness.
+ *
+ *   The matches go to a temporary copy of recordmatch which is kept
+ *   for the lifetime of this Scheduler, so a pass for a single rule
+ *   only matches that rule again and may reuse the cached candidates
+ *   of the other rules. The first pass is always a full one.
+ *
+ *  \param recordid Record ID of the rule that has changed,
+ *                  or -1 if anything might have been changed.
+ */
+void Scheduler::TestReschedule(int recordid)
+{
+    ResetPhaseTimes();
+
+    if (!testRecordMatch)
+    {
+        MSqlQuery query(dbConn);
+        if (!query.exec("CREATE TEMPORARY TABLE recordmatch "
+                        "SELECT * FROM recordmatch WHERE recordid IS NULL") ||
+            !query.exec("ALTER TABLE recordmatch ADD INDEX (recordid)"))
+        {
+            MythDB::DBError("TestReschedule", query);
+            return;
+        }
+        testRecordMatch = true;
+        recordid = -1;
+    }
+
+    UpdateMatches(recordid);
+
+    QMap<int, bool> changed;
+    changed[recordid] = true;
+    FillRecordList(false, (recordid > 0) ? &changed : NULL);
+}
+
 void Scheduler::FillRecordListFromMaster(void)
 {
     RecordingList schedList(false);
@@ -487,6 +573,79 @@ void Scheduler::PrintList(RecList &list, bool onlyFutureRecordings)
     cout << "---  print list end  ---\n";
 }
 
+void Scheduler::ResetPhaseTimes(void)
+{
+    phaseOrder.clear();
+    phaseTimes.clear();
+    phaseName.clear();
+    findConflictCount = 0;
+    tryAnotherCount = 0;
+    moveHigherCount = 0;
+}
+
+/** \fn Scheduler::BeginPhase(const QString&)
+ *  \brief Ends the current phase and starts timing the named one.
+ *
+ *   Time spent in phases with the same name is added up, so a phase
+ *   may be entered more than once per reschedule.
+ */
+void Scheduler::BeginPhase(const QString &name)
+{
+    EndPhase();
+    VERBOSE(VB_SCHEDULE, name + "...");
+    phaseName = name;
+    gettimeofday(&phaseStart, NULL);
+}
+
+void Scheduler::EndPhase(void)
+{
+    if (phaseName.isEmpty())
+        return;
+
+    struct timeval phaseEnd;
+    gettimeofday(&phaseEnd, NULL);
+
+    if (!phaseTimes.contains(phaseName))
+        phaseOrder.push_back(phaseName);
+    phaseTimes[phaseName] +=
+        ((phaseEnd.tv_sec  - phaseStart.tv_sec) * 1000000 +
+         (phaseEnd.tv_usec - phaseStart.tv_usec)) / 1000000.0;
+    phaseName.clear();
+}
+
+/** \fn Scheduler::PrintPhaseTimes(void) const
+ *  \brief Prints the time spent in each phase of the last reschedule,
+ *         and how often the conflict resolution steps were run.
+ */
+void Scheduler::PrintPhaseTimes(void) const
+{
+    if (!VERBOSE_LEVEL_CHECK(VB_SCHEDULE) || phaseOrder.empty())
+        return;
+
+    cout << "--- phase times start ---\n";
+
+    double total = 0.0;
+    QStringList::const_iterator it = phaseOrder.begin();
+    for (; it != phaseOrder.end(); ++it)
+    {
+        double secs = phaseTimes[*it];
+        total += secs;
+        QString outstr = QString("%1 %2 sec")
+            .arg(*it, -24).arg(secs, 9, 'f', 3);
+        cout << outstr.toLocal8Bit().constData() << endl;
+    }
+
+    QString outstr = QString("%1 %2 sec\n"
+                             "FindNextConflict calls  %3\n"
+                             "TryAnotherShowing calls %4\n"
+                             "MoveHigherRecords calls %5")
+        .arg("Total", -24).arg(total, 9, 'f', 3)
+        .arg(findConflictCount).arg(tryAnotherCount).arg(moveHigherCount);
+    cout << outstr.toLocal8Bit().constData() << endl;
+
+    cout << "---  phase times end  ---\n";
+}
+
 void Scheduler::PrintRec(const RecordingInfo *p, const char *prefix)
 {
     if (!VERBOSE_LEVEL_CHECK(VB_SCHEDULE))
@@ -888,6 +1047,8 @@ bool Scheduler::FindNextConflict(
 {
     bool is_conflict_dbg = false;
 
+    findConflictCount++;
+
     for ( ; j != cardlist.end(); ++j)
     {
         const RecordingInfo *q = *j;
@@ -1062,6 +1223,8 @@ void Scheduler::RestoreRecStatus(void)
 bool Scheduler::TryAnotherShowing(RecordingInfo *p, bool samePriority,
                                    bool preserveLive)
 {
+    tryAnotherCount++;
+
     PrintRec(p, "     >");
 
     if (p->GetRecordingStatus() == rsRecording ||
@@ -1255,6 +1418,8 @@ void Scheduler::SchedNewRecords(void)
 
 void Scheduler::MoveHigherRecords(bool move_this)
 {
+    moveHigherCount++;
+
     RecIter i = retrylist.begin();
     for ( ; move_this && i != retrylist.end(); ++i)
     {
@@ -1593,6 +1758,19 @@ void Scheduler::Reschedule(int recordid)
     reschedWait.wakeOne();
 }
 
+/** \fn Scheduler::HistoryChanged(void)
+ *  \brief Tells the scheduler that the recorded table changed in a way
+ *         the duplicate checks may depend on, without a reschedule.
+ *
+ *   The next pass then reloads the candidates of all rules. Changes to
+ *   oldrecorded are always followed by a full reschedule.
+ */
+void Scheduler::HistoryChanged(void)
+{
+    QMutexLocker locker(&schedLock);
+    historychanged = true;
+}
+
 void Scheduler::AddRecording(const RecordingInfo &pi)
 {
     QMutexLocker lockit(&schedLock);
@@ -1628,8 +1806,10 @@ void Scheduler::AddRecording(const RecordingInfo &pi)
     // Make sure we have a ScheduledRecording instance
     new_pi->GetRecordingRule();
 
-    // Trigger reschedule..
+    // Trigger reschedule.. The new history affects the duplicate checks
+    // of every rule, so this needs a full pass.
     reschedQueue.enqueue(pi.GetRecordingRuleID());
+    reschedQueue.enqueue(0);
     reschedWait.wakeOne();
 }
 
@@ -1748,6 +1928,12 @@ void Scheduler::RunScheduler(void)
 
                 gettimeofday(&fillstart, NULL);
                 QString msg;
+                ResetPhaseTimes();
+
+                // Only the candidates of the changed rules need to be
+                // queried again, unless anything else might have changed.
+                QMap<int, bool> changed;
+                bool fullpass = false;
 
                 while (!reschedQueue.empty())
                 {
@@ -1757,6 +1943,11 @@ void Scheduler::RunScheduler(void)
                             QString("Reschedule requested for id %1.")
                             .arg(recordid));
 
+                    if (recordid <= 0)
+                        fullpass = true;
+                    else
+                        changed[recordid] = true;
+
                     if (recordid != 0)
                     {
                         if (recordid == -1)
@@ -1776,12 +1967,14 @@ void Scheduler::RunScheduler(void)
                              (fillend.tv_usec - fillstart.tv_usec)) / 1000000.0;
 
                 gettimeofday(&fillstart, NULL);
-                bool worklistused = FillRecordList(true);
+                bool worklistused =
+                    FillRecordList(true, (fullpass) ? NULL : &changed);
                 gettimeofday(&fillend, NULL);
                 if (worklistused)
                 {
                     UpdateNextRecord();
                     PrintList();
+                    PrintPhaseTimes();
                 }
                 else
                 {
@@ -2908,6 +3101,8 @@ void Scheduler::UpdateMatches(int recordid) {
     if (recordid == 0)
         return;
 
+    BeginPhase("UpdateMatches");
+
     MSqlQuery query(dbConn);
 
     if (recordid == -1)
@@ -2962,7 +3157,9 @@ void Scheduler::UpdateMatches(int recordid) {
     QStringList fromclauses, whereclauses;
     MSqlBindings bindings;
 
+    BeginPhase("BuildNewRecordsQueries");
     BuildNewRecordsQueries(recordid, fromclauses, whereclauses, bindings);
+    BeginPhase("UpdateMatches");
 
     if (VERBOSE_LEVEL_CHECK(VB_SCHEDULE))
     {
@@ -3063,35 +3260,104 @@ void Scheduler::UpdateMatches(int recordid) {
     }
 
     VERBOSE(VB_SCHEDULE, " +-- Done.");
+    EndPhase();
 }
 
-void Scheduler::AddNewRecords(void)
+/** \fn Scheduler::GetAvailableCards(void) const
+ *  \brief Returns the cards which are connected or asleep, programs
+ *         on any other card are marked rsOffLine.
+ */
+QMap<int, bool> Scheduler::GetAvailableCards(void) const
 {
-    struct timeval dbstart, dbend;
-
-    QMap<RecordingType, int> recTypeRecPriorityMap;
-    RecList tmpList;
-
     QMap<int, bool> cardMap;
-    QMap<int, EncoderLink *>::Iterator enciter = m_tvList->begin();
+    QMap<int, EncoderLink *>::const_iterator enciter = m_tvList->begin();
     for (; enciter != m_tvList->end(); ++enciter)
     {
         EncoderLink *enc = *enciter;
         if (enc->IsConnected() || enc->IsAsleep())
             cardMap[enc->GetCardID()] = true;
     }
+    return cardMap;
+}
+
+/** \fn Scheduler::ClearCandidates(int)
+ *  \brief Deletes the cached candidates of one rule, or of all rules
+ *         if recordid is -1.
+ */
+void Scheduler::ClearCandidates(int recordid)
+{
+    QMap<int, RecList>::iterator it = candidatemap.begin();
+    if (recordid != -1)
+        it = candidatemap.find(recordid);
+
+    while (it != candidatemap.end())
+    {
+        while (!(*it).empty())
+        {
+            delete (*it).back();
+            (*it).pop_back();
+        }
+
+        if (recordid != -1)
+        {
+            candidatemap.erase(it);
+            return;
+        }
+        ++it;
+    }
+
+    candidatemap.clear();
+}
+
+/** \fn Scheduler::LoadCandidates(int)
+ *  \brief Queries the programs matched by a recording rule, with the
+ *         priority and the status the rule gives them, into the
+ *         candidate cache.
+ *
+ *   The cached status does not depend on the time of the pass, programs
+ *   which have already ended are marked rsMissed by AddNewRecords().
+ *
+ *  \param recordid Record ID of the rule to query, or -1 to replace
+ *                  the candidates of all rules.
+ *  \return false if a query failed, in which case the cache must be
+ *          reloaded with LoadCandidates(-1) before it is used again.
+ */
+bool Scheduler::LoadCandidates(int recordid)
+{
+    struct timeval dbstart, dbend;
+
+    QMap<RecordingType, int> recTypeRecPriorityMap;
+
+    ClearCandidates(recordid);
+    if (recordid == -1)
+    {
+        candidatesvalid = false;
+        candidatecards = GetAvailableCards();
+    }
+    const QMap<int, bool> &cardMap = candidatecards;
+
+    QString recidclause;
+    if (recordid != -1)
+        recidclause = QString(" AND RECTABLE.recordid = %1 ").arg(recordid);
 
     QMap<int, bool> tooManyMap;
     bool checkTooMany = false;
-    schedAfterStartMap.clear();
+    if (recordid == -1)
+        schedAfterStartMap.clear();
+    else
+        schedAfterStartMap.remove(recordid);
 
     MSqlQuery rlist(dbConn);
-    rlist.prepare(QString("SELECT recordid,title,maxepisodes,maxnewest FROM %1;").arg(recordTable));
+    rlist.prepare(QString("SELECT recordid,title,maxepisodes,maxnewest "
+                          "FROM %1%2;").arg(recordTable)
+                  .arg((recordid == -1) ? QString() :
+                       QString(" WHERE recordid = %1").arg(recordid)));
 
     if (!rlist.exec())
     {
         MythDB::DBError("CheckTooMany", rlist);
-        return;
+        candidatesvalid = false;
+        return false;
     }
 
     while (rlist.next())
@@ -3190,7 +3456,8 @@ void Scheduler::AddNewRecords(void)
         if (!result.exec())
         {
             MythDB::DBError("Dropping sched_temp_record table", result);
-            return;
+            candidatesvalid = false;
+            return false;
         }
 
         result.prepare("CREATE TEMPORARY TABLE sched_temp_record "
@@ -3200,16 +3467,20 @@ void Scheduler::AddNewRecords(void)
         {
             MythDB::DBError("Creating sched_temp_record table",
                                  result);
-            return;
+            candidatesvalid = false;
+            return false;
         }
 
-        result.prepare("INSERT sched_temp_record SELECT * from record;");
+        result.prepare(QString("INSERT sched_temp_record SELECT * from record%1;")
+                       .arg((recordid == -1) ? QString() :
+                            QString(" WHERE recordid = %1").arg(recordid)));
 
         if (!result.exec())
         {
             MythDB::DBError("Populating sched_temp_record table",
                                  result);
-            return;
+            candidatesvalid = false;
+            return false;
         }
     }
 
@@ -3218,7 +3489,8 @@ void Scheduler::AddNewRecords(void)
     if (!result.exec())
     {
         MythDB::DBError("Dropping sched_temp_recorded table", result);
-        return;
+        candidatesvalid = false;
+        return false;
     }
 
     result.prepare("CREATE TEMPORARY TABLE sched_temp_recorded "
@@ -3227,7 +3499,8 @@ void Scheduler::AddNewRecords(void)
     if (!result.exec())
     {
         MythDB::DBError("Creating sched_temp_recorded table", result);
-        return;
+        candidatesvalid = false;
+        return false;
     }
 
     result.prepare("INSERT sched_temp_recorded SELECT * from recorded;");
@@ -3235,7 +3508,8 @@ void Scheduler::AddNewRecords(void)
     if (!result.exec())
     {
         MythDB::DBError("Populating sched_temp_recorded table", result);
-        return;
+        candidatesvalid = false;
+        return false;
     }
 
     result.prepare(QString("SELECT recpriority, selectclause FROM %1;")
@@ -3244,7 +3518,8 @@ void Scheduler::AddNewRecords(void)
     if (!result.exec())
     {
         MythDB::DBError("Power Priority", result);
-        return;
+        candidatesvalid = false;
+        return false;
     }
 
     while (result.next())
@@ -3357,7 +3632,7 @@ void Scheduler::AddNewRecords(void)
 "      findduplicate = (oldfind.findid IS NOT NULL), "
 "      oldrecstatus = oldrecorded.recstatus "
 " WHERE program.endtime >= NOW() - INTERVAL 1 DAY "
-);
+) + recidclause;
     rmquery.replace("RECTABLE", schedTmpRecord);
 
     pwrpri.replace("program.","p.");
@@ -3402,7 +3677,7 @@ void Scheduler::AddNewRecords(void)
         "ON ( oldrecstatus.station   = c.callsign  AND "
         "     oldrecstatus.starttime = p.starttime AND "
         "     oldrecstatus.title     = p.title ) "
-        "WHERE p.endtime >= NOW() - INTERVAL 1 DAY "
+        "WHERE p.endtime >= NOW() - INTERVAL 1 DAY ") + recidclause + QString(
         "ORDER BY RECTABLE.recordid DESC ");
     query.replace("RECTABLE", schedTmpRecord);
 
@@ -3413,13 +3688,15 @@ void Scheduler::AddNewRecords(void)
     if (!result.exec())
     {
         MythDB::DBError("AddNewRecords recordmatch", result);
-        return;
+        candidatesvalid = false;
+        return false;
     }
     result.prepare(query);
     if (!result.exec())
     {
         MythDB::DBError("AddNewRecords", result);
-        return;
+        candidatesvalid = false;
+        return false;
     }
     gettimeofday(&dbend, NULL);
 
@@ -3499,30 +3776,6 @@ void Scheduler::AddNewRecords(void)
             ((autopriority) ?
              autopriority - (result.value(44).toInt() * autostrata / 200) : 0));
 
-        // Check to see if the program is currently recording and if
-        // the end time was changed.  Ideally, checking for a new end
-        // time should be done after PruneOverlaps, but that would
-        // complicate the list handling.  Do it here unless it becomes
-        // problematic.
-        RecIter rec = worklist.begin();
-        for ( ; rec != worklist.end(); ++rec)
-        {
-            RecordingInfo *r = *rec;
-            if (p->IsSameTimeslot(*r))
-            {
-                if (r->GetInputID() == p->GetInputID() &&
-                    r->GetRecordingEndTime() != p->GetRecordingEndTime() &&
-                    (r->GetRecordingRuleID() == p->GetRecordingRuleID() ||
-                     p->GetRecordingRuleType() == kOverrideRecord))
-                    ChangeRecordingEnd(r, p);
-                delete p;
-                p = NULL;
-                break;
-            }
-        }
-        if (p == NULL)
-            continue;
-
         RecStatusType newrecstatus = p->GetRecordingStatus();
         // Check for rsOffLine
         if ((threadrunning || specsched) && !cardMap.contains(p->GetCardID()))
@@ -3566,21 +3819,12 @@ void Scheduler::AddNewRecords(void)
         if (inactive)
             newrecstatus = rsInactive;
 
-        // Mark anything that has already passed as missed.  If it
-        // survives PruneOverlaps, it will get deleted or have its old
-        // status restored in PruneRedundants.
-        if (p->GetRecordingEndTime() < schedTime)
-            newrecstatus = rsMissed;
-
         p->SetRecordingStatus(newrecstatus);
 
-        tmpList.push_back(p);
+        candidatemap[p->GetRecordingRuleID()].push_back(p);
     }
 
     VERBOSE(VB_SCHEDULE, " +-- Cleanup...");
-    RecIter tmp = tmpList.begin();
-    for ( ; tmp != tmpList.end(); ++tmp)
-        worklist.push_back(*tmp);
 
     if (schedTmpRecord == "sched_temp_record")
     {
@@ -3592,6 +3836,208 @@ void Scheduler::AddNewRecords(void)
     result.prepare("DROP TABLE IF EXISTS sched_temp_recorded;");
     if (!result.exec())
         MythDB::DBError("AddNewRecords drop table", query);
+
+    if (recordid == -1)
+        candidatesvalid = true;
+
+    return true;
+}
+
+/** \fn Scheduler::UpdateCandidates(const QMap<int,bool>&,bool)
+ *  \brief Queries the candidates of the changed rules again and keeps
+ *         the cached candidates of all other rules.
+ *
+ *   Matching and the priorities of a rule's programs only depend on
+ *   that rule and on tables whose changes are followed by a full
+ *   reschedule. Duplicate checking also depends on the recording
+ *   history, so the whole cache is reloaded whenever that changed.
+ *   The result is the same as that of LoadCandidates(-1) while only
+ *   running the queries for the changed rules.
+ *
+ *  \param history_changed HistoryChanged() was called since the
+ *                         last pass.
+ *  \return false if the cache can not be used and a full
+ *          LoadCandidates(-1) is needed.
+ */
+bool Scheduler::UpdateCandidates(const QMap<int, bool> &changed,
+                                 bool history_changed)
+{
+    if (!candidatesvalid)
+        return false;
+
+    // rsOffLine is part of the cached status
+    if (GetAvailableCards() != candidatecards)
+    {
+        VERBOSE(VB_SCHEDULE, "Available cards changed, "
+                "reloading all candidates");
+        return false;
+    }
+
+    // The duplicate checks and statuses of every rule depend on the
+    // recording history, which is also written without a reschedule.
+    if (history_changed)
+    {
+        VERBOSE(VB_SCHEDULE, "Recording history changed, "
+                "reloading all candidates");
+        return false;
+    }
+
+    QMap<int, bool>::const_iterator it = changed.begin();
+    for (; it != changed.end(); ++it)
+    {
+        VERBOSE(VB_SCHEDULE, QString("UpdateCandidates for id %1...")
+                .arg(it.key()));
+
+        if (!LoadCandidates(it.key()))
+            return false;
+    }
+
+    return true;
+}
+
+static bool comp_candidate(const RecordingInfo *a, const RecordingInfo *b)
+{
+    if (a->GetScheduledStartTime() != b->GetScheduledStartTime())
+        return a->GetScheduledStartTime() < b->GetScheduledStartTime();
+    if (a->GetChanID() != b->GetChanID())
+        return a->GetChanID() < b->GetChanID();
+    return a->GetInputID() < b->GetInputID();
+}
+
+/** \fn Scheduler::CheckCandidates(void)
+ *  \brief Consistency check for incremental scheduling, reloads all
+ *         candidates and logs every difference to the incrementally
+ *         updated ones.
+ *
+ *   The reloaded candidates replace the cached ones, so this pass is
+ *   scheduled as a full pass would have been.
+ */
+void Scheduler::CheckCandidates(void)
+{
+    QMap<int, RecList> incremental = candidatemap;
+    candidatemap.clear();
+
+    if (!LoadCandidates(-1))
+    {
+        // Schedule with the incremental candidates, the next pass
+        // reloads all of them.
+        ClearCandidates();
+        candidatemap = incremental;
+        return;
+    }
+
+    uint mismatches = 0;
+    QMap<int, RecList>::iterator it = incremental.begin();
+    for (; it != incremental.end(); ++it)
+    {
+        if (!candidatemap.contains(it.key()))
+        {
+            VERBOSE(VB_IMPORTANT, LOC_WARN + QString("Incremental candidates "
+                    "for id %1 should not exist").arg(it.key()));
+            mismatches++;
+        }
+    }
+
+    QMap<int, RecList>::const_iterator cit = candidatemap.begin();
+    for (; cit != candidatemap.end(); ++cit)
+    {
+        RecList full = *cit;
+        RecList incr = incremental[cit.key()];
+        SORT_RECLIST(full, comp_candidate);
+        SORT_RECLIST(incr, comp_candidate);
+
+        bool same = (full.size() == incr.size());
+        for (uint i = 0; same && i < full.size(); ++i)
+        {
+            same = full[i]->IsSameTimeslot(*incr[i]) &&
+                full[i]->GetInputID() == incr[i]->GetInputID() &&
+                full[i]->GetRecordingStartTime() ==
+                incr[i]->GetRecordingStartTime() &&
+                full[i]->GetRecordingEndTime() ==
+                incr[i]->GetRecordingEndTime() &&
+                full[i]->GetRecordingPriority() ==
+                incr[i]->GetRecordingPriority() &&
+                full[i]->GetRecordingStatus() ==
+                incr[i]->GetRecordingStatus();
+        }
+
+        if (!same)
+        {
+            VERBOSE(VB_IMPORTANT, LOC_WARN + QString("Incremental candidates "
+                    "for id %1 differ, %2 incremental vs %3 full")
+                    .arg(cit.key()).arg(incr.size()).arg(full.size()));
+            mismatches++;
+        }
+    }
+
+    VERBOSE(VB_SCHEDULE, QString("Incremental candidates checked, "
+                                 "%1 rules differ").arg(mismatches));
+
+    for (it = incremental.begin(); it != incremental.end(); ++it)
+    {
+        while (!(*it).empty())
+        {
+            delete (*it).back();
+            (*it).pop_back();
+        }
+    }
+}
+
+/** \fn Scheduler::AddNewRecords(void)
+ *  \brief Adds a copy of every cached candidate to the work list.
+ */
+void Scheduler::AddNewRecords(void)
+{
+    RecList tmpList;
+
+    // Same order as the full query, by descending record ID
+    QMap<int, RecList>::const_iterator it = candidatemap.end();
+    while (it != candidatemap.begin())
+    {
+        --it;
+
+        RecConstIter cand = (*it).begin();
+        for (; cand != (*it).end(); ++cand)
+        {
+            RecordingInfo *p = new RecordingInfo(**cand);
+
+            // Check to see if the program is currently recording and if
+            // the end time was changed.  Ideally, checking for a new end
+            // time should be done after PruneOverlaps, but that would
+            // complicate the list handling.  Do it here unless it becomes
+            // problematic.
+            RecIter rec = worklist.begin();
+            for ( ; rec != worklist.end(); ++rec)
+            {
+                RecordingInfo *r = *rec;
+                if (p->IsSameTimeslot(*r))
+                {
+                    if (r->GetInputID() == p->GetInputID() &&
+                        r->GetRecordingEndTime() != p->GetRecordingEndTime() &&
+                        (r->GetRecordingRuleID() == p->GetRecordingRuleID() ||
+                         p->GetRecordingRuleType() == kOverrideRecord))
+                        ChangeRecordingEnd(r, p);
+                    delete p;
+                    p = NULL;
+                    break;
+                }
+            }
+            if (p == NULL)
+                continue;
+
+            // Mark anything that has already passed as missed.  If it
+            // survives PruneOverlaps, it will get deleted or have its old
+            // status restored in PruneRedundants.
+            if (p->GetRecordingEndTime() < schedTime)
+                p->SetRecordingStatus(rsMissed);
+
+            tmpList.push_back(p);
+        }
+    }
+
+    RecIter tmp = tmpList.begin();
+    for ( ; tmp != tmpList.end(); ++tmp)
+        worklist.push_back(*tmp);
 }
 
 void Scheduler::AddNotListed(void) {
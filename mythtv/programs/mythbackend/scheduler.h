@@ -3,6 +3,7 @@
 
 // POSIX headers
 #include <pthread.h>
+#include <sys/time.h>
 
 // C++ headers
 #include <deque>
@@ -13,6 +14,7 @@ using namespace std;
 #include <QWaitCondition>
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QMutex>
 #include <QMap>
 
@@ -45,9 +47,11 @@ class Scheduler : public QObject
     void SetExpirer(AutoExpire *autoExpirer) { expirer = autoExpirer; }
 
     void Reschedule(int recordid);
+    void HistoryChanged(void);
     void AddRecording(const RecordingInfo&);
     void FillRecordListFromDB(int recordid = -1);
     void FillRecordListFromMaster(void);
+    void TestReschedule(int recordid);
 
     void UpdateRecStatus(RecordingInfo *pginfo);
     void UpdateRecStatus(uint cardid, uint chanid,
@@ -67,6 +71,7 @@ class Scheduler : public QObject
         { PrintList(reclist, onlyFutureRecordings); };
     void PrintList(RecList &list, bool onlyFutureRecordings = false);
     void PrintRec(const RecordingInfo *p, const char *prefix = NULL);
+    void PrintPhaseTimes(void) const;
 
     void SetMainServer(MainServer *ms);
 
@@ -94,11 +99,21 @@ class Scheduler : public QObject
 
     bool VerifyCards(void);
 
-    bool FillRecordList(bool doLock);
+    void ResetPhaseTimes(void);
+    void BeginPhase(const QString &name);
+    void EndPhase(void);
+
+    bool FillRecordList(bool doLock, const QMap<int, bool> *changed = NULL);
     void UpdateMatches(int recordid);
     void UpdateManuals(int recordid);
     void BuildWorkList(void);
     bool ClearWorkList(void);
+    bool LoadCandidates(int recordid);
+    bool UpdateCandidates(const QMap<int, bool> &changed,
+                          bool history_changed);
+    void CheckCandidates(void);
+    void ClearCandidates(int recordid = -1);
+    QMap<int, bool> GetAvailableCards(void) const;
     void AddNewRecords(void);
     void AddNotListed(void);
     void BuildNewRecordsQueries(int recordid, QStringList &from, QStringList &where,
@@ -160,6 +175,13 @@ class Scheduler : public QObject
     QMap<QString, RecList> titlelistmap;
     InputGroupMap igrp;
 
+    // Per rule results of the last LoadCandidates(), so that a change
+    // to one rule only needs that rule's candidates to be queried again
+    QMap<int, RecList> candidatemap;
+    QMap<int, bool> candidatecards;
+    bool candidatesvalid;
+    bool historychanged; ///< protected by schedLock
+
     bool reclist_changed;
 
     bool specsched;
@@ -182,6 +204,7 @@ class Scheduler : public QObject
 
     bool m_isShuttingDown;
     MSqlQueryInfo dbConn;
+    bool testRecordMatch; ///< dbConn has TestReschedule()'s recordmatch
 
     QDateTime fsInfoCacheFillTime;
     QMap<QString, FileSystemInfo> fsInfoCache;
@@ -198,6 +221,15 @@ class Scheduler : public QObject
     typedef pair<const RecordingInfo*,const RecordingInfo*> IsSameKey;
     typedef QMap<IsSameKey,bool> IsSameCacheType;
     mutable IsSameCacheType cache_is_same_program;
+
+    // Time spent in each phase of the last reschedule, in seconds
+    QStringList phaseOrder;
+    QMap<QString, double> phaseTimes;
+    QString phaseName;
+    struct timeval phaseStart;
+    mutable uint findConflictCount;
+    uint tryAnotherCount;
+    uint moveHigherCount;
 };
 
 #endif
@@ -660,4 +660,16 @@ BlankFrameDetector::reportTime(void) const
     return histogramAnalyzer->reportTime();
 }
 
+AVSpecialDecode
+BlankFrameDetector::decodeShortcuts(void) const
+{
+    /*
+     * Reduced resolution luma. Only the center of the frame needs to be
+     * decoded.
+     */
+    return (AVSpecialDecode)
+        (kAVSpecialDecode_LowRes | kAVSpecialDecode_NoLoopFilter |
+         kAVSpecialDecode_LumaOnly | kAVSpecialDecode_FewBlocks);
+}
+
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
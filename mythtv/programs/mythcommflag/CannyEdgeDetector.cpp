@@ -1,6 +1,8 @@
 // ANSI C headers
 #include <cmath>
 
+#include "mythconfig.h"
+
 // MythTV headers
 #include "mythplayer.h"
 #include "frame.h"          // VideoFrame
@@ -10,10 +12,15 @@
 #include "pgm.h"
 #include "CannyEdgeDetector.h"
 
+#if HAVE_MMX
+extern "C" int mm_support(void);    // in libavcodec/x86/cpuid.c
+#endif
+
 using namespace edgeDetector;
 
 CannyEdgeDetector::CannyEdgeDetector(void)
-    : sgm(NULL)
+    : use_sse2(0)
+    , sgm(NULL)
     , sgmsorted(NULL)
     , ewidth(-1)
     , eheight(-1)
@@ -50,6 +57,11 @@ CannyEdgeDetector::CannyEdgeDetector(void)
     for (ii = 0; ii < mask_width; ii++)
         mask[ii] /= sum;    /* normalize to [0,1] */
 
+#if HAVE_MMX
+    /* cpuid is not cheap; check once instead of in every detectEdges(). */
+    use_sse2 = (mm_support() & FF_MM_SSE2) ? 1 : 0;
+#endif
+
     memset(&s1, 0, sizeof(s1));
     memset(&s2, 0, sizeof(s2));
     memset(&convolved, 0, sizeof(convolved));
@@ -167,13 +179,13 @@ CannyEdgeDetector::detectEdges(const AVPicture *pgm, int pgmheight,
         return NULL;
 
     if (pgm_convolve_radial(&convolved, &s1, &s2, pgm, pgmheight,
-                mask, mask_radius))
+                mask, mask_radius, use_sse2))
         return NULL;
 
     if (edge_mark_uniform_exclude(&edges, pgmheight, mask_radius,
                 sgm_init_exclude(sgm, &convolved, padded_height,
                     exclude.row + mask_radius, exclude.col + mask_radius,
-                    exclude.width, exclude.height),
+                    exclude.width, exclude.height, use_sse2),
                 sgmsorted, percentile,
                 exclude.row, exclude.col, exclude.width, exclude.height))
         return NULL;
@@ -30,6 +30,7 @@ private:
 
     double          *mask;                  /* pre-computed Gaussian mask */
     int             mask_radius;            /* radius of mask */
+    int             use_sse2;               /* mm_support() has SSE2 */
 
     unsigned int    *sgm, *sgmsorted;       /* squared-gradient magnitude */
     AVPicture       s1, s2, convolved;      /* smoothed grayscale frame */
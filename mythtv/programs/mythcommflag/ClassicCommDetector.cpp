@@ -11,11 +11,15 @@ using namespace std;
 
 // Qt headers
 #include <QString>
+#include <QThread>
 
 // MythTV headers
 #include "mythcontext.h"
 #include "programinfo.h"
 #include "mythplayer.h"
+#include "mythcommflagplayer.h"
+#include "playercontext.h"
+#include "ringbuffer.h"
 
 // Commercial Flagging headers
 #include "ClassicCommDetector.h"
@@ -140,6 +144,7 @@ ClassicCommDetector::ClassicCommDetector(SkipType commDetectMethod_in,
     sceneHasChanged(false),                    stationLogoPresent(false),
     lastFrameWasBlank(false),                  lastFrameWasSceneChange(false),
     decoderFoundAspectChanges(false),          sceneChangeDetector(0),
+    segmentWorker(false),                      segmentFrame(-1),
     player(player_in),
     startedAt(startedAt_in),                   stopsAt(stopsAt_in),
     recordingStartedAt(recordingStartedAt_in),
@@ -248,11 +253,13 @@ void ClassicCommDetector::Init()
 
     sceneChangeDetector = new ClassicSceneChangeDetector(width, height,
         commDetectBorder, horizSpacing, vertSpacing);
+    // Direct, segment workers emit this from their own thread.
     connect(
          sceneChangeDetector, 
          SIGNAL(haveNewInformation(unsigned int,bool,float)), 
          this, 
-         SLOT(sceneChangeDetectorHasNewInformation(unsigned int,bool,float))
+         SLOT(sceneChangeDetectorHasNewInformation(unsigned int,bool,float)),
+         Qt::DirectConnection
     );
 
     frameIsBlank = false;
@@ -397,6 +404,16 @@ bool ClassicCommDetector::go()
 
     emit breathe();
 
+    uint segments = 1;
+    if (!stillRecording && fullSpeed && myTotalFrames &&
+        gCoreContext->GetNumSetting("CommFlagParallel", 0))
+    {
+        segments = max(QThread::idealThreadCount(), 1);
+    }
+
+    if ((segments > 1) && FlagSegments(segments, myTotalFrames))
+        return !m_bStop;
+
     while (!player->GetEof())
     {
         struct timeval startTime;
@@ -588,9 +605,367 @@ bool ClassicCommDetector::go()
     return true;
 }
 
+/** \class ClassicCommDetectorSegment
+ *  \brief Runs ClassicCommDetector::FlagSegment() for one segment of a
+ *         recording on its own thread.
+ */
+class ClassicCommDetectorSegment : public QThread
+{
+  public:
+    ClassicCommDetectorSegment(ClassicCommDetector *det, PlayerContext *c,
+                               long long warmup, long long start,
+                               long long end) :
+        detector(det), ctx(c),
+        warmupFrame(warmup), startFrame(start), endFrame(end) { }
+
+    ~ClassicCommDetectorSegment()
+    {
+        wait();
+        // the logo detector belongs to the detector which made the segments
+        detector->logoDetector = NULL;
+        detector->deleteLater();
+        delete ctx;
+    }
+
+    void run(void)
+    {
+        detector->FlagSegment(warmupFrame, startFrame, endFrame);
+    }
+
+    ClassicCommDetector *detector;
+    PlayerContext       *ctx;
+    long long            warmupFrame;
+    long long            startFrame;
+    long long            endFrame;
+};
+
+static void delete_segments(QList<ClassicCommDetectorSegment*> &segments)
+{
+    while (!segments.empty())
+        delete segments.takeFirst();
+}
+
+/** \fn ClassicCommDetector::FlagSegments(uint,long long)
+ *  \brief Flags a finished recording as count segments in parallel.
+ *
+ *   Each segment starts on a keyframe from the position map and is
+ *   decoded by its own player and analyzed by its own detector, which
+ *   shares the logo found by this one. Decoding starts one GOP early so
+ *   the state carried from frame to frame is settled by the first frame
+ *   of the segment. The per frame results are merged into this detector
+ *   and the commercial breaks are then built from them as usual.
+ *
+ *  \return false if the segments could not be set up, the recording
+ *          should then be flagged sequentially.
+ */
+bool ClassicCommDetector::FlagSegments(uint count, long long totalFrames)
+{
+    PlayerContext *ctx = player->GetPlayerContext();
+    if (!ctx || !ctx->buffer)
+        return false;
+
+    ProgramInfo *pginfo = NULL;
+    ctx->LockPlayingInfo(__FILE__, __LINE__);
+    if (ctx->playingInfo)
+        pginfo = new ProgramInfo(*ctx->playingInfo);
+    ctx->UnlockPlayingInfo(__FILE__, __LINE__);
+    if (!pginfo)
+        return false;
+
+    frm_pos_map_t posMap;
+    pginfo->QueryPositionMap(posMap, MARK_GOP_BYFRAME);
+
+    // Without a position map start on the nominal boundary and decode
+    // a couple of seconds before it instead of one GOP.
+    long long warmupFrames = (long long)(fps * 2);
+
+    QList<long long> warmups, starts;
+    warmups << 0;
+    starts  << 0;
+    for (uint i = 1; i < count; i++)
+    {
+        long long start  = totalFrames * i / count;
+        long long warmup = max(start - warmupFrames, 0LL);
+
+        if (!posMap.empty())
+        {
+            frm_pos_map_t::const_iterator it =
+                posMap.lowerBound((uint64_t)start);
+            if (it == posMap.end())
+                break;
+            start  = it.key();
+            warmup = (it == posMap.begin()) ? start : (--it).key();
+        }
+
+        if (start > starts.back())
+        {
+            warmups << warmup;
+            starts  << start;
+        }
+    }
+
+    if (starts.size() < 2)
+    {
+        delete pginfo;
+        return false;
+    }
+
+    QList<ClassicCommDetectorSegment*> segments;
+    bool ok = true;
+    for (int i = 0; ok && (i < starts.size()); i++)
+    {
+        RingBuffer *rbuf =
+            RingBuffer::Create(ctx->buffer->GetFilename(), false);
+        if (!rbuf)
+        {
+            ok = false;
+            break;
+        }
+
+        MythCommFlagPlayer *cfp = new MythCommFlagPlayer();
+        PlayerContext *segctx = new PlayerContext(
+            QString("%1 segment %2").arg(kFlaggerInUseID).arg(i));
+        segctx->SetSpecialDecode(ctx->GetSpecialDecode());
+        segctx->SetPlayingInfo(pginfo);
+        segctx->SetRingBuffer(rbuf);
+        segctx->SetPlayer(cfp);
+        cfp->SetPlayerInfo(NULL, NULL, true, segctx);
+
+        ClassicCommDetector *det = new ClassicCommDetector(
+            commDetectMethod, false, fullSpeed, cfp, startedAt, stopsAt,
+            recordingStartedAt, recordingStopsAt);
+
+        long long end = (i + 1 < starts.size()) ? starts[i + 1] : -1;
+        segments.push_back(new ClassicCommDetectorSegment(
+                               det, segctx, warmups[i], starts[i], end));
+
+        cfp->SetNullVideo();
+        if (cfp->OpenFile() < 0)
+        {
+            ok = false;
+            break;
+        }
+
+        det->Init();
+
+        if (!cfp->InitVideo())
+        {
+            ok = false;
+            break;
+        }
+        cfp->EnableSubtitles(false);
+
+        det->segmentWorker       = true;
+        det->aggressiveDetection = aggressiveDetection;
+        det->logoDetector        = logoDetector;
+        det->logoInfoAvailable   = logoInfoAvailable;
+        det->SetVideoParams(cfp->GetVideoAspect());
+    }
+
+    delete pginfo;
+
+    if (!ok)
+    {
+        VERBOSE(VB_IMPORTANT, "Unable to set up the segment players, "
+                "flagging sequentially.");
+        delete_segments(segments);
+        return false;
+    }
+
+    VERBOSE(VB_COMMFLAG, QString("Flagging %1 segments in parallel")
+            .arg(segments.size()));
+
+    QTime flagTime;
+    flagTime.start();
+
+    for (int i = 0; i < segments.size(); i++)
+        segments[i]->start();
+
+    int prevpercent = -1;
+    bool running = true;
+    while (running)
+    {
+        emit breathe();
+
+        running = false;
+        long long framesDone = 0;
+        for (int i = 0; i < segments.size(); i++)
+        {
+            ClassicCommDetector *det = segments[i]->detector;
+            det->m_bStop   = m_bStop;
+            det->m_bPaused = m_bPaused;
+
+            if (!segments[i]->isFinished())
+                running = true;
+
+            long long frame = det->segmentFrame;
+            if (frame >= segments[i]->startFrame)
+                framesDone += frame - segments[i]->startFrame + 1;
+        }
+
+        float elapsed = flagTime.elapsed() / 1000.0;
+        float flagFPS = (elapsed) ? framesDone / elapsed : 0.0;
+        int percentage = min(framesDone * 100 / totalFrames, 100LL);
+
+        if (showProgress)
+        {
+            QString tmp = QString("\b\b\b\b\b\b\b\b\b\b\b%1%/%2fps")
+                .arg(percentage, 3).arg((int)flagFPS, 3);
+            QByteArray ba = tmp.toAscii();
+            cerr << ba.constData() << flush;
+        }
+
+        emit statusUpdate(QObject::tr("%1% Completed @ %2 fps.")
+                          .arg(percentage).arg(flagFPS));
+
+        if (percentage % 10 == 0 && prevpercent != percentage)
+        {
+            prevpercent = percentage;
+            VERBOSE(VB_GENERAL|VB_EXTRA, QString("%1% Completed @ %2 fps.")
+                    .arg(percentage) .arg(flagFPS));
+        }
+
+        if (running)
+            usleep(500000);
+    }
+
+    if (showProgress)
+    {
+        cerr << "\b\b\b\b\b\b      \b\b\b\b\b\b";
+        cerr.flush();
+    }
+
+    if (!m_bStop)
+    {
+        for (int i = 0; i < segments.size(); i++)
+        {
+            MergeSegment(segments[i]->detector,
+                         segments[i]->startFrame, segments[i]->endFrame);
+        }
+    }
+
+    delete_segments(segments);
+
+    return true;
+}
+
+/** \fn ClassicCommDetector::FlagSegment(long long,long long,long long)
+ *  \brief Analyzes the frames of one segment on a segment worker thread.
+ *
+ *   Frames from warmupFrame on are analyzed only to settle the scene
+ *   change and skipped frame state, MergeSegment() drops their results.
+ *
+ *  \param endFrame first frame of the next segment, or -1 for the last
+ *                  segment which runs to the end of the recording.
+ */
+void ClassicCommDetector::FlagSegment(
+    long long warmupFrame, long long startFrame, long long endFrame)
+{
+    float aspect = player->GetVideoAspect();
+    float newAspect = aspect;
+    bool counting = false;
+
+    if (warmupFrame > 0)
+        lastFrameNumber = warmupFrame - 1;
+
+    VideoFrame *currentFrame = player->GetRawVideoFrame(warmupFrame);
+    while (currentFrame && !m_bStop)
+    {
+        long long currentFrameNumber = currentFrame->frameNumber;
+        if ((endFrame >= 0) && (currentFrameNumber >= endFrame))
+        {
+            player->DiscardVideoFrame(currentFrame);
+            break;
+        }
+
+        newAspect = player->GetVideoAspect();
+        if (newAspect != aspect)
+        {
+            SetVideoParams(aspect);
+            aspect = newAspect;
+        }
+
+        // Only count the frames which are merged
+        if (!counting && (currentFrameNumber >= startFrame))
+        {
+            framesProcessed = 0;
+            blankFrameCount = 0;
+            totalMinBrightness = 0;
+            counting = true;
+        }
+
+        ProcessFrame(currentFrame, currentFrameNumber);
+        segmentFrame = currentFrameNumber;
+
+        player->DiscardVideoFrame(currentFrame);
+
+        while (m_bPaused && !m_bStop)
+            sleep(1);
+
+        if (player->GetEof())
+            break;
+
+        currentFrame = player->GetRawVideoFrame();
+    }
+}
+
+static void merge_segment_map(frm_dir_map_t &dst, const frm_dir_map_t &src,
+                              long long startFrame, long long endFrame)
+{
+    frm_dir_map_t::const_iterator it =
+        src.lowerBound((uint64_t)max(startFrame, 0LL));
+    for (; it != src.end(); ++it)
+    {
+        if ((endFrame >= 0) && ((long long)it.key() >= endFrame))
+            break;
+        dst[it.key()] = *it;
+    }
+}
+
+/** \fn ClassicCommDetector::MergeSegment(const ClassicCommDetector*,long long,long long)
+ *  \brief Copies the results of a segment worker for the frames from
+ *         startFrame up to endFrame into this detector.
+ *
+ *   Segments must be merged in order. The first segment, which starts
+ *   at frame 0, is merged as a whole.
+ */
+void ClassicCommDetector::MergeSegment(
+    const ClassicCommDetector *segment,
+    long long startFrame, long long endFrame)
+{
+    QMap<long long, FrameInfoEntry>::const_iterator it =
+        (startFrame > 0) ? segment->frameInfo.lowerBound(startFrame) :
+                           segment->frameInfo.begin();
+    for (; it != segment->frameInfo.end(); ++it)
+    {
+        if ((endFrame >= 0) && (it.key() >= endFrame))
+            break;
+        frameInfo[it.key()] = *it;
+        if (it->flagMask & COMM_FRAME_ASPECT_CHANGE)
+            decoderFoundAspectChanges = true;
+    }
+
+    merge_segment_map(blankFrameMap, segment->blankFrameMap,
+                      startFrame, endFrame);
+    merge_segment_map(sceneMap, segment->sceneMap, startFrame, endFrame);
+
+    blankFrameCount    += segment->blankFrameCount;
+    totalMinBrightness += segment->totalMinBrightness;
+    framesProcessed    += segment->framesProcessed;
+
+    currentAspect   = segment->currentAspect;
+    lastFrameNumber = segment->lastFrameNumber;
+    curFrameNumber  = segment->curFrameNumber;
+}
+
 void ClassicCommDetector::sceneChangeDetectorHasNewInformation(
     unsigned int framenum,bool isSceneChange,float debugValue)
 {
+    // The detector counts frames from the first one it is given, which
+    // for a segment is not the start of the recording.
+    if (segmentWorker)
+        framenum = curFrameNumber;
+
     if (isSceneChange)
     {
         frameInfo[framenum].flagMask |= COMM_FRAME_SCENE_CHANGE;
@@ -691,6 +1066,22 @@ void ClassicCommDetector::requestCommBreakMapUpdate(void)
     sendCommBreakMapUpdates = true;
 }
 
+AVSpecialDecode ClassicCommDetector::GetDecodeShortcuts(void) const
+{
+    int shortcuts = kAVSpecialDecode_LowRes       |
+                    kAVSpecialDecode_NoLoopFilter |
+                    kAVSpecialDecode_LumaOnly;
+
+    // The blank frame check only samples the center of the frame, and
+    // the logo is still there in a frame predicted without the residual.
+    if (commDetectMethod == COMM_DETECT_BLANKS)
+        shortcuts |= kAVSpecialDecode_FewBlocks;
+    else if (commDetectMethod == COMM_DETECT_LOGO)
+        shortcuts |= kAVSpecialDecode_FastNonRef;
+
+    return (AVSpecialDecode)shortcuts;
+}
+
 void ClassicCommDetector::SetVideoParams(float aspect)
 {
     int newAspect = COMM_ASPECT_WIDE;
@@ -18,6 +18,7 @@
 
 class MythPlayer;
 class LogoDetectorBase;
+class ClassicCommDetectorSegment;
 class SceneChangeDetectorBase;
 
 enum frameMaskValues {
@@ -60,6 +61,7 @@ class ClassicCommDetector : public CommDetectorBase
         void GetCommercialBreakList(frm_dir_map_t &comms);
         void recordingFinished(long long totalFileSize);
         void requestCommBreakMapUpdate(void);
+        AVSpecialDecode GetDecodeShortcuts(void) const;
 
         void PrintFullMap(
             ostream &out, const frm_dir_map_t *comm_breaks,
@@ -68,6 +70,7 @@ class ClassicCommDetector : public CommDetectorBase
         void logoDetectorBreathe();
 
         friend class ClassicLogoDetector;
+        friend class ClassicCommDetectorSegment;
 
     protected:
         virtual ~ClassicCommDetector() {}
@@ -111,6 +114,11 @@ class ClassicCommDetector : public CommDetectorBase
             frm_dir_map_t &out, const show_map_t &in);
         void CleanupFrameInfo(void);
         void GetLogoCommBreakMap(show_map_t &map);
+        bool FlagSegments(uint count, long long totalFrames);
+        void FlagSegment(long long warmupFrame, long long startFrame,
+                         long long endFrame);
+        void MergeSegment(const ClassicCommDetector *segment,
+                          long long startFrame, long long endFrame);
 
         enum SkipTypes commDetectMethod;
         frm_dir_map_t lastSentCommBreakMap;
@@ -173,6 +181,9 @@ class ClassicCommDetector : public CommDetectorBase
 
         SceneChangeDetectorBase* sceneChangeDetector;
 
+        bool segmentWorker;
+        volatile long long segmentFrame;
+
 protected:
         MythPlayer *player;
         QDateTime startedAt, stopsAt;
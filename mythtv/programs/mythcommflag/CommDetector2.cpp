@@ -12,10 +12,12 @@ using namespace std;
 // Qt headers
 #include <QDir>
 #include <QFileInfo>
+#include <QThread>
 
 // MythTV headers
 #include "compat.h"
 #include "mythdb.h"
+#include "mythcorecontext.h"
 #include "mythverbose.h"
 #include "mythplayer.h"
 #include "programinfo.h"
@@ -32,6 +34,7 @@ using namespace std;
 #include "SceneChangeDetector.h"
 #include "TemplateFinder.h"
 #include "TemplateMatcher.h"
+#include "FrameAnalyzerPipeline.h"
 
 namespace {
 
@@ -316,6 +319,9 @@ QString strftimeval(const struct timeval *tv)
 
 using namespace commDetector2;
 
+/* Frames queued for each lane when the analyzers run concurrently. */
+static const int kPipelineFrames = 16;
+
 CommDetector2::CommDetector2(
     enum SkipTypes     commDetectMethod_in,
     bool               showProgress_in,
@@ -329,7 +335,7 @@ CommDetector2::CommDetector2(
     bool               useDB) :
     commDetectMethod((enum SkipTypes)(commDetectMethod_in & ~COMM_DETECT_2)),
     showProgress(showProgress_in),  fullSpeed(fullSpeed_in),
-    player(player_in),
+    parallel(false),                player(player_in),
     startts(startts_in),            endts(endts_in),
     recstartts(recstartts_in),      recendts(recendts_in),
     isRecording(QDateTime::currentDateTime() < recendts),
@@ -347,6 +353,10 @@ CommDetector2::CommDetector2(
     if (useDB)
         debugdir = debugDirectory(chanid, recstartts);
 
+    parallel = !isRecording && fullSpeed &&
+        gCoreContext->GetNumSetting("CommFlagParallel", 0) &&
+        QThread::idealThreadCount() > 1;
+
     /*
      * Look for blank frames to use as delimiters between commercial and
      * non-commercial segments.
@@ -428,15 +438,29 @@ CommDetector2::CommDetector2(
 
         if (!logoMatcher)
         {
-            logoMatcher = new TemplateMatcher(pgmConverter, cannyEdgeDetector,
-                    logoFinder, debugdir);
+            /*
+             * A converter of its own lets the matcher run alongside the
+             * histogram based analyzers.
+             */
+            logoMatcher = new TemplateMatcher(
+                    parallel ? new PGMConverter() : pgmConverter,
+                    cannyEdgeDetector, logoFinder, debugdir);
             pass1.push_back(logoMatcher);
+            analyzerLanes[logoMatcher] = parallel ? 1 : 0;
         }
     }
 
     if (histogramAnalyzer && logoFinder)
         histogramAnalyzer->setLogoState(logoFinder);
 
+    /* Everything else shares the histogram analyzer or is alone. */
+    if (blankFrameDetector)
+        analyzerLanes[blankFrameDetector] = 0;
+    if (sceneChangeDetector)
+        analyzerLanes[sceneChangeDetector] = 0;
+    if (logoFinder)
+        analyzerLanes[logoFinder] = 0;
+
     /* Aggregate them all together. */
     frameAnalyzers.push_back(pass0);
     frameAnalyzers.push_back(pass1);
@@ -534,6 +558,34 @@ int CommDetector2::computeBreaks(long long nframes)
     return 0;
 }
 
+/*
+ * Split the pass into lanes of analyzers which share state. Returns NULL if
+ * there is only one lane, the pass then runs on the decoding thread.
+ */
+FrameAnalyzerPipeline *CommDetector2::makePipeline(
+    const FrameAnalyzerItem &pass) const
+{
+    if (!parallel)
+        return NULL;
+
+    QMap<int, FrameAnalyzerItem> lanes;
+    FrameAnalyzerItem::const_iterator it = pass.begin();
+    for (; it != pass.end(); ++it)
+        lanes[analyzerLanes.value(*it, 0)].push_back(*it);
+
+    if (lanes.size() < 2)
+        return NULL;
+
+    FrameAnalyzerPipeline *pipeline =
+        new FrameAnalyzerPipeline(kPipelineFrames);
+
+    QMap<int, FrameAnalyzerItem>::const_iterator lit = lanes.begin();
+    for (; lit != lanes.end(); ++lit)
+        pipeline->addLane(*lit);
+
+    return pipeline;
+}
+
 bool CommDetector2::go(void)
 {
     int minlag = 7; // seconds
@@ -592,6 +644,15 @@ bool CommDetector2::go(void)
             return false;
         }
 
+        FrameAnalyzerPipeline *pipeline = makePipeline(*currentPass);
+        if (pipeline)
+        {
+            VERBOSE(VB_COMMFLAG, QString(
+                        "CommDetector2::go running %1 lanes concurrently")
+                    .arg(pipeline->laneCount()));
+            pipeline->start();
+        }
+
         player->DiscardVideoFrame(player->GetRawVideoFrame(0));
         long long nextFrame = -1;
         currentFrameNumber = 0;
@@ -605,7 +666,8 @@ bool CommDetector2::go(void)
         clock.start();
         passTime.start();
         memset(&getframetime, 0, sizeof(getframetime));
-        while (!(*currentPass).empty() && !player->GetEof())
+        while ((pipeline ? !pipeline->isFinished() : !(*currentPass).empty()) &&
+               !player->GetEof())
         {
             struct timeval start, end, elapsedtv;
 
@@ -634,6 +696,7 @@ bool CommDetector2::go(void)
                 if (m_bStop)
                 {
                     player->DiscardVideoFrame(currentFrame);
+                    delete pipeline;
                     return false;
                 }
             }
@@ -652,9 +715,17 @@ bool CommDetector2::go(void)
                         nframes, passno, npasses);
             }
 
-            nextFrame = processFrame(
-                *currentPass, finishedAnalyzers,
-                deadAnalyzers, currentFrame, currentFrameNumber);
+            if (pipeline)
+            {
+                (void)pipeline->queueFrame(currentFrame, currentFrameNumber);
+                nextFrame = pipeline->nextFrame(currentFrameNumber);
+            }
+            else
+            {
+                nextFrame = processFrame(
+                    *currentPass, finishedAnalyzers,
+                    deadAnalyzers, currentFrame, currentFrameNumber);
+            }
 
             if (((currentFrameNumber >= 1) &&
                  (((nextFrame * 10) / nframes) !=
@@ -685,7 +756,8 @@ bool CommDetector2::go(void)
             if (!fullSpeed && !isRecording)
                 usleep(10000);  // 10ms
 
-            if (sendBreakMapUpdates && (breakMapUpdateRequested ||
+            /* The analyzers can't be looked at while the lanes run. */
+            if (!pipeline && sendBreakMapUpdates && (breakMapUpdateRequested ||
                         !(currentFrameNumber % 500)))
             {
                 frm_dir_map_t breakMap;
@@ -716,6 +788,15 @@ bool CommDetector2::go(void)
             player->DiscardVideoFrame(currentFrame);
         }
 
+        if (pipeline)
+        {
+            pipeline->finish();
+            pipeline->takeAnalyzers(
+                *currentPass, finishedAnalyzers, deadAnalyzers);
+            (void)pipeline->reportTime();
+            delete pipeline;
+        }
+
         currentPass->insert(currentPass->end(),
                             finishedAnalyzers.begin(),
                             finishedAnalyzers.end());
@@ -841,6 +922,24 @@ void CommDetector2::requestCommBreakMapUpdate(void)
     breakMapUpdateRequested = true;
 }
 
+AVSpecialDecode CommDetector2::GetDecodeShortcuts(void) const
+{
+    /* One decoder serves every pass. */
+    int shortcuts = ~0;
+    bool empty = true;
+    for (FrameAnalyzerList::const_iterator pass = frameAnalyzers.begin();
+            pass != frameAnalyzers.end(); ++pass)
+    {
+        for (FrameAnalyzerItem::const_iterator it = pass->begin();
+                it != pass->end(); ++it)
+        {
+            shortcuts &= (*it)->decodeShortcuts();
+            empty = false;
+        }
+    }
+    return empty ? kAVSpecialDecode_None : (AVSpecialDecode)shortcuts;
+}
+
 static void PrintReportMap(ostream &out,
                            const FrameAnalyzer::FrameMap &frameMap)
 {
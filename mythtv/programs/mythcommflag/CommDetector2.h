@@ -20,6 +20,7 @@ class TemplateFinder;
 class TemplateMatcher;
 class BlankFrameDetector;
 class SceneChangeDetector;
+class FrameAnalyzerPipeline;
 
 namespace commDetector2 {
 
@@ -46,6 +47,7 @@ class CommDetector2 : public CommDetectorBase
     virtual void GetCommercialBreakList(frm_dir_map_t &comms);
     virtual void recordingFinished(long long totalFileSize);
     virtual void requestCommBreakMapUpdate(void);
+    virtual AVSpecialDecode GetDecodeShortcuts(void) const;
     virtual void PrintFullMap(
         ostream &out, const frm_dir_map_t *comm_breaks, bool verbose) const;
 
@@ -55,11 +57,13 @@ class CommDetector2 : public CommDetectorBase
     void reportState(int elapsed_sec, long long frameno, long long nframes,
             unsigned int passno, unsigned int npasses);
     int computeBreaks(long long nframes);
+    FrameAnalyzerPipeline *makePipeline(const FrameAnalyzerItem &pass) const;
 
   private:
     enum SkipTypes          commDetectMethod;
     bool                    showProgress;
     bool                    fullSpeed;
+    bool                    parallel;
     MythPlayer             *player;
     QDateTime               startts, endts, recstartts, recendts;
 
@@ -80,6 +84,9 @@ class CommDetector2 : public CommDetectorBase
     BlankFrameDetector      *blankFrameDetector;
     SceneChangeDetector     *sceneChangeDetector;
 
+    /* Analyzers which share no state are in different lanes. */
+    QMap<FrameAnalyzer*, int> analyzerLanes;
+
     QString                 debugdir;
 };
 
@@ -8,6 +8,7 @@ using namespace std;
 #include <QMap>
 
 #include "programtypes.h"
+#include "videoouttypes.h"
 
 #define MAX_BLANK_FRAMES 60
 
@@ -41,6 +42,10 @@ public:
         { (void)totalFileSize; };
     virtual void requestCommBreakMapUpdate(void) {};
 
+    /// Decoding shortcuts which do not affect the detection results.
+    virtual AVSpecialDecode GetDecodeShortcuts(void) const
+        { return kAVSpecialDecode_None; }
+
     virtual void PrintFullMap(
         ostream &out, const frm_dir_map_t *comm_breaks, bool verbose) const = 0;
 
@@ -3,7 +3,10 @@
 #include "CommDetector2.h"
 #include "PrePostRollFlagger.h"
 
-class MythPlayer;
+#include "mythplayer.h"
+#include "playercontext.h"
+#include "mythverbose.h"
+
 class RemoteEncoder;
 
 CommDetectorBase*
@@ -18,24 +21,54 @@ CommDetectorFactory::makeCommDetector(
     const QDateTime& recordingStopsAt,
     bool useDB)
 {
+    CommDetectorBase *detector;
+
     if(commDetectMethod & COMM_DETECT_PREPOSTROLL)
     {
-        return new PrePostRollFlagger(commDetectMethod, showProgress, fullSpeed,
-                                      player, startedAt, stopsAt,
-                                      recordingStartedAt, recordingStopsAt);
+        detector = new PrePostRollFlagger(commDetectMethod, showProgress,
+                                          fullSpeed, player,
+                                          startedAt, stopsAt,
+                                          recordingStartedAt, recordingStopsAt);
     }
-
-    if ((commDetectMethod & COMM_DETECT_2))
+    else if ((commDetectMethod & COMM_DETECT_2))
     {
-        return new CommDetector2(
+        detector = new CommDetector2(
             commDetectMethod, showProgress, fullSpeed,
             player, chanid, startedAt, stopsAt,
             recordingStartedAt, recordingStopsAt, useDB);
     }
-
-    return new ClassicCommDetector(commDetectMethod, showProgress, fullSpeed,
+    else
+    {
+        detector = new ClassicCommDetector(
+            commDetectMethod, showProgress, fullSpeed,
             player, startedAt, stopsAt, recordingStartedAt, recordingStopsAt);
+    }
+
+    setDecodeProfile(detector, player);
+
+    return detector;
 }
 
+/** \fn CommDetectorFactory::setDecodeProfile(const CommDetectorBase*,MythPlayer*)
+ *  \brief Selects the cheapest decoding which leaves the results of the
+ *         detector unchanged.
+ *
+ *   Must be called before the player opens the file. The shortcuts are
+ *   only taken when the CommFlagFast setting is enabled.
+ */
+void CommDetectorFactory::setDecodeProfile(
+    const CommDetectorBase *detector, MythPlayer *player)
+{
+    PlayerContext *ctx = player ? player->GetPlayerContext() : NULL;
+    if (!ctx)
+        return;
+
+    AVSpecialDecode sp = (AVSpecialDecode)
+        (kAVSpecialDecode_SingleThreaded | detector->GetDecodeShortcuts());
+    ctx->SetSpecialDecode(sp);
+
+    VERBOSE(VB_COMMFLAG, QString("Commercial flagging decode profile: 0x%1")
+            .arg(sp, 0, 16));
+}
 
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
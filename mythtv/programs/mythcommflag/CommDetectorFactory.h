@@ -24,6 +24,10 @@ class CommDetectorFactory
         const QDateTime& recordingStartedAt,
         const QDateTime& recordingStopsAt,
         bool useDB);
+
+  private:
+    void setDecodeProfile(const CommDetectorBase *detector,
+                          MythPlayer *player);
 };
 
 #endif
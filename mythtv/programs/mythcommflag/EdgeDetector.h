@@ -12,11 +12,15 @@ typedef struct AVPicture AVPicture;
 
 namespace edgeDetector {
 
-/* Pass all zeroes to not exclude any areas from examination. */
+/*
+ * Pass all zeroes to not exclude any areas from examination. "use_sse2"
+ * selects the SSE2 kernel (see CannyEdgeDetector).
+ */
 
 unsigned int *sgm_init_exclude(unsigned int *sgm,
         const AVPicture *src, int srcheight,
-        int excluderow, int excludecol, int excludewidth, int excludeheight);
+        int excluderow, int excludecol, int excludewidth, int excludeheight,
+        int use_sse2);
 
 int edge_mark_uniform_exclude(AVPicture *dst, int dstheight, int extramargin,
         const unsigned int *sgm, unsigned int *sgmsorted, int percentile,
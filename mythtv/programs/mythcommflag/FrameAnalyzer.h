@@ -13,6 +13,8 @@
 
 #include <QMap>
 
+#include "videoouttypes.h"
+
 /*  
  * At least FreeBSD doesn't define LONG_LONG_MAX, but it does define  
  * __LONG_LONG_MAX__.  Who knows what other systems do the same?  
@@ -66,6 +68,15 @@ public:
     }
     virtual int reportTime(void) const { return 0; }
 
+    /*
+     * Decoding shortcuts (kAVSpecialDecode_* flags) which do not affect the
+     * results of this analyzer. The decoder only takes the shortcuts that all
+     * analyzers of a CommDetector2 allow.
+     */
+    virtual AVSpecialDecode decodeShortcuts(void) const {
+        return kAVSpecialDecode_None;
+    }
+
     virtual FrameMap GetMap(unsigned int) const = 0;
 };
 
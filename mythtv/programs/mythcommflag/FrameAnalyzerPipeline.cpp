@@ -0,0 +1,446 @@
+// ANSI C headers
+#include <cstring>
+
+// C++ headers
+#include <algorithm>
+using namespace std;
+
+// Qt headers
+#include <QRunnable>
+
+// MythTV headers
+#include "mythverbose.h"
+
+// Commercial Flagging headers
+#include "CommDetector2.h"
+#include "FrameAnalyzer.h"
+#include "FrameAnalyzerPipeline.h"
+
+using namespace commDetector2;
+
+class FrameAnalyzerLane : public QRunnable
+{
+public:
+    FrameAnalyzerLane(FrameAnalyzerPipeline *p, const FrameAnalyzerItem &a);
+
+    void run(void);
+
+    FrameAnalyzerPipeline   *pipeline;
+    FrameAnalyzerItem       allAnalyzers;
+    FrameAnalyzerItem       analyzers;          /* still analyzing */
+    FrameAnalyzerItem       finishedAnalyzers;
+    FrameAnalyzerItem       deadAnalyzers;
+
+    /* Next frame requested by each analyzer, -1 for any frame. */
+    QMap<FrameAnalyzer*, long long>         wantFrame;
+    QMap<FrameAnalyzer*, long long>         analyzedFrames;
+    QMap<FrameAnalyzer*, struct timeval>    analyzeTime;
+
+    /* Protected by the pipeline lock. */
+    QList<PipelineFrame*>   queue;
+    long long               nextFrame;
+    bool                    done;
+
+private:
+    long long analyze(const PipelineFrame *pf);
+};
+
+FrameAnalyzerLane::FrameAnalyzerLane(FrameAnalyzerPipeline *p,
+        const FrameAnalyzerItem &a)
+    : pipeline(p)
+    , allAnalyzers(a)
+    , analyzers(a)
+    , nextFrame(0)
+    , done(a.empty())
+{
+    setAutoDelete(false);
+
+    FrameAnalyzerItem::const_iterator it = a.begin();
+    for (; it != a.end(); ++it)
+    {
+        struct timeval zero;
+        memset(&zero, 0, sizeof(zero));
+
+        wantFrame[*it] = -1;
+        analyzedFrames[*it] = 0;
+        analyzeTime[*it] = zero;
+    }
+}
+
+void
+FrameAnalyzerLane::run(void)
+{
+    for (;;)
+    {
+        PipelineFrame *pf;
+        {
+            QMutexLocker locker(&pipeline->lock);
+            while (queue.empty() && !pipeline->closed && !pipeline->stopped)
+                pipeline->frameQueued.wait(&pipeline->lock);
+            if (queue.empty() || pipeline->stopped)
+                break;
+            pf = queue.takeFirst();
+            pipeline->frameTaken.wakeAll();
+        }
+
+        long long next = analyze(pf);
+
+        QMutexLocker locker(&pipeline->lock);
+        nextFrame = next;
+        done = analyzers.empty();
+        pipeline->releaseFrame(pf);
+        pipeline->frameTaken.wakeAll();
+        if (done)
+            break;
+    }
+
+    /* Drop the frames nobody is going to look at. */
+    QMutexLocker locker(&pipeline->lock);
+    done = true;
+    while (!queue.empty())
+        pipeline->releaseFrame(queue.takeFirst());
+    pipeline->frameTaken.wakeAll();
+}
+
+long long
+FrameAnalyzerLane::analyze(const PipelineFrame *pf)
+{
+    long long frameno = pf->frameno;
+    long long minNextFrame = FrameAnalyzer::ANYFRAME;
+
+    FrameAnalyzerItem::iterator iifa = analyzers.begin();
+    FrameAnalyzerItem::iterator jjfa = iifa;
+    for ( ; iifa != analyzers.end(); iifa = jjfa)
+    {
+        FrameAnalyzer *fa = *iifa;
+        ++jjfa;
+
+        /*
+         * Other lanes may want frames this analyzer asked to skip; don't
+         * give it those.
+         */
+        long long want = wantFrame[fa];
+        if (frameno < want)
+        {
+            minNextFrame = min(minNextFrame, want);
+            continue;
+        }
+
+        struct timeval start, end, elapsed;
+        long long nextFrame;
+
+        (void)gettimeofday(&start, NULL);
+        FrameAnalyzer::analyzeFrameResult ares =
+            fa->analyzeFrame(&pf->frame, frameno, &nextFrame);
+        (void)gettimeofday(&end, NULL);
+        timersub(&end, &start, &elapsed);
+        timeradd(&analyzeTime[fa], &elapsed, &analyzeTime[fa]);
+        analyzedFrames[fa]++;
+
+        if (ares == FrameAnalyzer::ANALYZE_OK ||
+            ares == FrameAnalyzer::ANALYZE_ERROR)
+        {
+            if (nextFrame == FrameAnalyzer::NEXTFRAME)
+                nextFrame = frameno + 1;
+            wantFrame[fa] = (nextFrame == FrameAnalyzer::ANYFRAME) ?
+                -1 : nextFrame;
+            minNextFrame = min(minNextFrame, nextFrame);
+            continue;
+        }
+
+        if (ares == FrameAnalyzer::ANALYZE_FINISHED)
+        {
+            jjfa = analyzers.erase(iifa);
+            finishedAnalyzers.push_back(fa);
+            continue;
+        }
+
+        if (ares == FrameAnalyzer::ANALYZE_FATAL)
+        {
+            jjfa = analyzers.erase(iifa);
+            deadAnalyzers.push_back(fa);
+            continue;
+        }
+
+        VERBOSE(VB_IMPORTANT, QString("Unexpected return value from"
+                    " %1::analyzeFrame: %2")
+                .arg(fa->name()).arg(ares));
+
+        jjfa = analyzers.erase(iifa);
+        deadAnalyzers.push_back(fa);
+    }
+
+    if (minNextFrame == FrameAnalyzer::ANYFRAME)
+        minNextFrame = frameno + 1;
+
+    return minNextFrame;
+}
+
+FrameAnalyzerPipeline::FrameAnalyzerPipeline(int maxqueued)
+    : maxQueued(max(maxqueued, 1))
+    , closed(false)
+    , stopped(false)
+    , blocked_count(0)
+{
+    memset(&blocked_time, 0, sizeof(blocked_time));
+}
+
+FrameAnalyzerPipeline::~FrameAnalyzerPipeline(void)
+{
+    stop();
+
+    while (!lanes.empty())
+        delete lanes.takeFirst();
+
+    while (!freeFrames.empty())
+    {
+        PipelineFrame *pf = freeFrames.takeFirst();
+        delete [] pf->frame.buf;
+        delete pf;
+    }
+}
+
+void
+FrameAnalyzerPipeline::addLane(const FrameAnalyzerItem &analyzers)
+{
+    lanes.push_back(new FrameAnalyzerLane(this, analyzers));
+}
+
+void
+FrameAnalyzerPipeline::start(void)
+{
+    pool.setMaxThreadCount(max(lanes.size(), 1));
+
+    QList<FrameAnalyzerLane*>::iterator it = lanes.begin();
+    for (; it != lanes.end(); ++it)
+        pool.start(*it);
+}
+
+/*
+ * Copy the frame and queue it for every lane which wants it, waiting while
+ * a lane's queue is full. Lanes which asked for a later frame, or whose
+ * analyzers have all finished, are passed over.
+ */
+bool
+FrameAnalyzerPipeline::queueFrame(const VideoFrame *frame, long long frameno)
+{
+    if (isFinished())
+        return false;
+
+    PipelineFrame *pf = getFrame(frame, frameno);
+
+    QMutexLocker locker(&lock);
+    QList<FrameAnalyzerLane*>::iterator it = lanes.begin();
+    for (; it != lanes.end() && !stopped; ++it)
+    {
+        FrameAnalyzerLane *lane = *it;
+        if (lane->done || frameno < lane->nextFrame)
+            continue;
+
+        if (lane->queue.size() >= maxQueued)
+        {
+            struct timeval start, end, elapsed;
+
+            (void)gettimeofday(&start, NULL);
+            while (lane->queue.size() >= maxQueued && !lane->done && !stopped)
+                frameTaken.wait(&lock);
+            (void)gettimeofday(&end, NULL);
+            timersub(&end, &start, &elapsed);
+            timeradd(&blocked_time, &elapsed, &blocked_time);
+            blocked_count++;
+
+            if (lane->done || stopped)
+                continue;
+        }
+
+        pf->refs++;
+        lane->queue.push_back(pf);
+        frameQueued.wakeAll();
+    }
+
+    if (!pf->refs)
+        freeFrames.push_back(pf);
+
+    return true;
+}
+
+/*
+ * The frame the decoding thread should get next: the earliest frame any
+ * lane asked for, but never one it already has.
+ */
+long long
+FrameAnalyzerPipeline::nextFrame(long long frameno) const
+{
+    QMutexLocker locker(&lock);
+
+    long long next = FrameAnalyzer::ANYFRAME;
+    QList<FrameAnalyzerLane*>::const_iterator it = lanes.begin();
+    for (; it != lanes.end(); ++it)
+    {
+        if (!(*it)->done)
+            next = min(next, (*it)->nextFrame);
+    }
+
+    if (next == FrameAnalyzer::ANYFRAME)
+        return frameno + 1;
+
+    return max(next, frameno + 1);
+}
+
+bool
+FrameAnalyzerPipeline::isFinished(void) const
+{
+    QMutexLocker locker(&lock);
+
+    QList<FrameAnalyzerLane*>::const_iterator it = lanes.begin();
+    for (; it != lanes.end(); ++it)
+    {
+        if (!(*it)->done)
+            return false;
+    }
+    return true;
+}
+
+/* Let the lanes analyze what is queued and wait for them. */
+void
+FrameAnalyzerPipeline::finish(void)
+{
+    {
+        QMutexLocker locker(&lock);
+        closed = true;
+        frameQueued.wakeAll();
+    }
+    pool.waitForDone();
+}
+
+/* Drop what is queued and wait for the lanes. */
+void
+FrameAnalyzerPipeline::stop(void)
+{
+    {
+        QMutexLocker locker(&lock);
+        stopped = true;
+        frameQueued.wakeAll();
+        frameTaken.wakeAll();
+    }
+    pool.waitForDone();
+}
+
+/*
+ * Sort the analyzers of the pass, keeping their order, into those still
+ * analyzing, those which finished and those which died. Only valid once
+ * finish() or stop() returned.
+ */
+void
+FrameAnalyzerPipeline::takeAnalyzers(FrameAnalyzerItem &pass,
+        FrameAnalyzerItem &finishedAnalyzers,
+        FrameAnalyzerItem &deadAnalyzers)
+{
+    FrameAnalyzerItem::iterator iifa = pass.begin();
+    FrameAnalyzerItem::iterator jjfa = iifa;
+    for ( ; iifa != pass.end(); iifa = jjfa)
+    {
+        FrameAnalyzer *fa = *iifa;
+        ++jjfa;
+
+        QList<FrameAnalyzerLane*>::const_iterator it = lanes.begin();
+        for (; it != lanes.end(); ++it)
+        {
+            const FrameAnalyzerItem &finished = (*it)->finishedAnalyzers;
+            const FrameAnalyzerItem &dead = (*it)->deadAnalyzers;
+
+            if (std::find(finished.begin(), finished.end(), fa) !=
+                    finished.end())
+            {
+                jjfa = pass.erase(iifa);
+                finishedAnalyzers.push_back(fa);
+                break;
+            }
+
+            if (std::find(dead.begin(), dead.end(), fa) != dead.end())
+            {
+                jjfa = pass.erase(iifa);
+                deadAnalyzers.push_back(fa);
+                break;
+            }
+        }
+    }
+}
+
+int
+FrameAnalyzerPipeline::reportTime(void) const
+{
+    QList<FrameAnalyzerLane*>::const_iterator it = lanes.begin();
+    for (int laneno = 0; it != lanes.end(); ++it, laneno++)
+    {
+        const FrameAnalyzerLane *lane = *it;
+
+        FrameAnalyzerItem::const_iterator iifa = lane->allAnalyzers.begin();
+        for (; iifa != lane->allAnalyzers.end(); ++iifa)
+        {
+            const struct timeval &tv = lane->analyzeTime[*iifa];
+            long long frames = lane->analyzedFrames[*iifa];
+            float secs = tv.tv_sec + tv.tv_usec / 1000000.0;
+
+            VERBOSE(VB_COMMFLAG, QString("%1 Time: analyze=%2s "
+                        "(lane %3, %4 frames, %5 fps)")
+                    .arg((*iifa)->name()).arg(strftimeval(&tv))
+                    .arg(laneno).arg(frames)
+                    .arg(secs ? frames / secs : 0, 0, 'f', 2));
+        }
+    }
+
+    VERBOSE(VB_COMMFLAG, QString("Pipeline Time: decoder blocked=%1s "
+                "(%2 times)")
+            .arg(strftimeval(&blocked_time)).arg(blocked_count));
+
+    return 0;
+}
+
+PipelineFrame *
+FrameAnalyzerPipeline::getFrame(const VideoFrame *frame, long long frameno)
+{
+    PipelineFrame *pf = NULL;
+    {
+        QMutexLocker locker(&lock);
+        if (!freeFrames.empty())
+            pf = freeFrames.takeFirst();
+    }
+
+    if (!pf)
+    {
+        pf = new PipelineFrame;
+        pf->frame.buf = NULL;
+        pf->bufsize = 0;
+    }
+
+    if (pf->bufsize < frame->size)
+    {
+        delete [] pf->frame.buf;
+        pf->frame.buf = new unsigned char[frame->size];
+        pf->bufsize = frame->size;
+    }
+
+    unsigned char *buf = pf->frame.buf;
+    pf->frame = *frame;
+    pf->frame.buf = buf;
+    pf->frame.qscale_table = NULL;
+    pf->frame.qstride = 0;
+    memset(pf->frame.priv, 0, sizeof(pf->frame.priv));
+    memcpy(buf, frame->buf, frame->size);
+
+    pf->frameno = frameno;
+    pf->refs = 0;
+
+    return pf;
+}
+
+/* Called with the lock held. */
+void
+FrameAnalyzerPipeline::releaseFrame(PipelineFrame *pf)
+{
+    if (--pf->refs <= 0)
+        freeFrames.push_back(pf);
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,87 @@
+/*
+ * FrameAnalyzerPipeline
+ *
+ * Run the lanes of a CommDetector2 pass concurrently. The decoding thread
+ * copies each frame once into a reference counted buffer and queues it for
+ * every lane which wants it. Each lane runs on a thread of its own and feeds
+ * the frames to its analyzers in order.
+ *
+ * Analyzers which share state (e.g., BlankFrameDetector and
+ * SceneChangeDetector share a HistogramAnalyzer) must be in the same lane.
+ */
+
+#ifndef __FRAMEANALYZERPIPELINE_H__
+#define __FRAMEANALYZERPIPELINE_H__
+
+#include <sys/time.h>
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThreadPool>
+#include <QList>
+#include <QMap>
+
+#include "frame.h"
+
+#include "CommDetector2.h"
+
+class FrameAnalyzerLane;
+
+class PipelineFrame
+{
+public:
+    VideoFrame      frame;
+    long long       frameno;
+    int             refs;           /* lanes holding the frame */
+    int             bufsize;
+};
+
+class FrameAnalyzerPipeline
+{
+public:
+    /* Ctor/dtor. */
+    FrameAnalyzerPipeline(int maxqueued);
+    ~FrameAnalyzerPipeline(void);
+
+    void addLane(const FrameAnalyzerItem &analyzers);
+    int laneCount(void) const { return lanes.size(); }
+    void start(void);
+
+    /* Decoding thread. */
+    bool queueFrame(const VideoFrame *frame, long long frameno);
+    long long nextFrame(long long frameno) const;
+    bool isFinished(void) const;
+
+    void finish(void);
+    void stop(void);
+
+    void takeAnalyzers(FrameAnalyzerItem &pass,
+            FrameAnalyzerItem &finishedAnalyzers,
+            FrameAnalyzerItem &deadAnalyzers);
+    int reportTime(void) const;
+
+private:
+    friend class FrameAnalyzerLane;
+
+    PipelineFrame *getFrame(const VideoFrame *frame, long long frameno);
+    void releaseFrame(PipelineFrame *pf);
+
+    int                         maxQueued;
+    QList<FrameAnalyzerLane*>   lanes;
+    QThreadPool                 pool;
+
+    mutable QMutex              lock;
+    QWaitCondition              frameQueued;
+    QWaitCondition              frameTaken;
+    QList<PipelineFrame*>       freeFrames;
+    bool                        closed;
+    bool                        stopped;
+
+    /* Time the decoding thread waited for a lane. */
+    struct timeval              blocked_time;
+    long long                   blocked_count;
+};
+
+#endif  /* !__FRAMEANALYZERPIPELINE_H__ */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -225,4 +225,13 @@ SceneChangeDetector::reportTime(void) const
     return histogramAnalyzer->reportTime();
 }
 
+AVSpecialDecode
+SceneChangeDetector::decodeShortcuts(void) const
+{
+    /* Reduced resolution luma of every frame. */
+    return (AVSpecialDecode)
+        (kAVSpecialDecode_LowRes | kAVSpecialDecode_NoLoopFilter |
+         kAVSpecialDecode_LumaOnly);
+}
+
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -1072,4 +1072,16 @@ TemplateFinder::getTemplate(int *prow, int *pcol, int *pwidth, int *pheight)
     return NULL;
 }
 
+AVSpecialDecode
+TemplateFinder::decodeShortcuts(void) const
+{
+    /*
+     * Reduced resolution luma. Static edges survive the motion compensation
+     * of non-reference frames.
+     */
+    return (AVSpecialDecode)
+        (kAVSpecialDecode_LowRes | kAVSpecialDecode_NoLoopFilter |
+         kAVSpecialDecode_LumaOnly | kAVSpecialDecode_FastNonRef);
+}
+
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -850,4 +850,16 @@ TemplateMatcher::computeBreaks(FrameAnalyzer::FrameMap *breaks)
     return 0;
 }
 
+AVSpecialDecode
+TemplateMatcher::decodeShortcuts(void) const
+{
+    /*
+     * A logo does not move, so a non-reference frame predicted from its
+     * references without the residual still shows it.
+     */
+    return (AVSpecialDecode)
+        (kAVSpecialDecode_LowRes | kAVSpecialDecode_NoLoopFilter |
+         kAVSpecialDecode_LumaOnly | kAVSpecialDecode_FastNonRef);
+}
+
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -758,19 +758,8 @@ static int FlagCommercials(
 
     PlayerContext *ctx = new PlayerContext(kFlaggerInUseID);
 
-    AVSpecialDecode sp = (AVSpecialDecode)
-        (kAVSpecialDecode_LowRes         |
-         kAVSpecialDecode_SingleThreaded |
-         kAVSpecialDecode_NoLoopFilter);
-
-    /* blank detector needs to be only sample center for this optimization. */
-    if ((COMM_DETECT_BLANKS  == commDetectMethod) ||
-        (COMM_DETECT_2_BLANK == commDetectMethod))
-    {
-        sp = (AVSpecialDecode) (sp | kAVSpecialDecode_FewBlocks);
-    }
-
-    ctx->SetSpecialDecode(sp);
+    // CommDetectorFactory selects the decoding shortcuts for the detector
+    ctx->SetSpecialDecode(kAVSpecialDecode_SingleThreaded);
 
     ctx->SetPlayingInfo(program_info);
     ctx->SetRingBuffer(tmprbuf);
@@ -19,7 +19,7 @@ HEADERS += CommDetector2.h
 HEADERS += pgm.h
 HEADERS += EdgeDetector.h CannyEdgeDetector.h
 HEADERS += PGMConverter.h BorderDetector.h
-HEADERS += FrameAnalyzer.h
+HEADERS += FrameAnalyzer.h FrameAnalyzerPipeline.h
 HEADERS += TemplateFinder.h TemplateMatcher.h
 HEADERS += HistogramAnalyzer.h
 HEADERS += BlankFrameDetector.h
@@ -39,7 +39,7 @@ SOURCES += CommDetector2.cpp
 SOURCES += pgm.cpp
 SOURCES += EdgeDetector.cpp CannyEdgeDetector.cpp
 SOURCES += PGMConverter.cpp BorderDetector.cpp
-SOURCES += FrameAnalyzer.cpp
+SOURCES += FrameAnalyzer.cpp FrameAnalyzerPipeline.cpp
 SOURCES += TemplateFinder.cpp TemplateMatcher.cpp
 SOURCES += HistogramAnalyzer.cpp
 SOURCES += BlankFrameDetector.cpp
@@ -1,8 +1,18 @@
 #include <climits>
+#include <stdint.h>
+
+#include "mythconfig.h"
 
 extern "C" {
 #include "libavcodec/avcodec.h"
 }
+#if HAVE_MMX
+#ifdef __SSE__
+#define CONVOLVE_CLOBBERS "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm7",
+#else
+#define CONVOLVE_CLOBBERS   /* registers unknown to gcc without -msse */
+#endif
+#endif
 #include "frame.h"
 #include "mythverbose.h"
 #include "myth_imgconvert.h"
@@ -235,10 +245,80 @@ pgm_overlay(AVPicture *dst, const AVPicture *s1, int s1height,
     return 0;
 }
 
+#if HAVE_MMX
+static void
+convolve_row_sse2(unsigned char *dst, const unsigned char *src, int width,
+        intptr_t step, const double *mask, int ntaps)
+{
+    /*
+     * Convolve one row of "width" pixels with a one-dimensional mask of
+     * "ntaps" taps, "step" bytes apart in "src" ("src" is the first tap of the
+     * first pixel).
+     *
+     * Four pixels at a time in two pairs of packed doubles. The products are
+     * summed in the same order as in the scalar code and truncated the same
+     * way, so the result is bit-exact with it.
+     */
+    static const double half[2] __attribute__ ((aligned (16))) =
+        { 0.5, 0.5 };
+    int                 cc, ii;
+    double              sum;
+
+    for (cc = 0; cc + 4 <= width; cc += 4)
+    {
+        const unsigned char *pp = src + cc;
+        const double        *mm = mask;
+        int                 nn = ntaps;
+
+        __asm__ volatile (
+            "pxor       %%xmm7, %%xmm7      \n\t"
+            "xorpd      %%xmm0, %%xmm0      \n\t"
+            "xorpd      %%xmm1, %%xmm1      \n\t"
+            "1:                             \n\t"
+            "movd       (%0),   %%xmm2      \n\t"
+            "movsd      (%1),   %%xmm4      \n\t"
+            "punpcklbw  %%xmm7, %%xmm2      \n\t"
+            "unpcklpd   %%xmm4, %%xmm4      \n\t"
+            "punpcklwd  %%xmm7, %%xmm2      \n\t"
+            "pshufd     $0xee,  %%xmm2, %%xmm3  \n\t"
+            "cvtdq2pd   %%xmm2, %%xmm2      \n\t"
+            "cvtdq2pd   %%xmm3, %%xmm3      \n\t"
+            "mulpd      %%xmm4, %%xmm2      \n\t"
+            "mulpd      %%xmm4, %%xmm3      \n\t"
+            "addpd      %%xmm2, %%xmm0      \n\t"
+            "addpd      %%xmm3, %%xmm1      \n\t"
+            "add        %4,     %0          \n\t"
+            "add        $8,     %1          \n\t"
+            "sub        $1,     %2          \n\t"
+            "jnz        1b                  \n\t"
+            "addpd      %5,     %%xmm0      \n\t"
+            "addpd      %5,     %%xmm1      \n\t"
+            "cvttpd2dq  %%xmm0, %%xmm0      \n\t"
+            "cvttpd2dq  %%xmm1, %%xmm1      \n\t"
+            "punpcklqdq %%xmm1, %%xmm0      \n\t"
+            "packssdw   %%xmm0, %%xmm0      \n\t"
+            "packuswb   %%xmm0, %%xmm0      \n\t"
+            "movd       %%xmm0, (%3)        \n\t"
+            : "+r"(pp), "+r"(mm), "+r"(nn)
+            : "r"(dst + cc), "r"(step), "m"(*half)
+            : CONVOLVE_CLOBBERS "memory"
+        );
+    }
+
+    for (; cc < width; cc++)
+    {
+        sum = 0;
+        for (ii = 0; ii < ntaps; ii++)
+            sum += mask[ii] * src[ii * step + cc];
+        dst[cc] = (unsigned char)(sum + 0.5);
+    }
+}
+#endif /* HAVE_MMX */
+
 int
 pgm_convolve_radial(AVPicture *dst, AVPicture *s1, AVPicture *s2,
         const AVPicture *src, int srcheight,
-        const double *mask, int mask_radius)
+        const double *mask, int mask_radius, int use_sse2)
 {
     /*
      * Pad and convolve an image.
@@ -252,6 +332,9 @@ pgm_convolve_radial(AVPicture *dst, AVPicture *s1, AVPicture *s2,
      * Optimization for radially-symmetric masks: implement a single
      * two-dimensional convolution with two commutative single-dimensional
      * convolutions.
+     *
+     * "use_sse2" selects the SSE2 row kernel; the caller checks mm_support()
+     * once rather than on every frame.
      */
     const int       srcwidth = src->linesize[0];
     const int       newwidth = srcwidth + 2 * mask_radius;
@@ -270,6 +353,28 @@ pgm_convolve_radial(AVPicture *dst, AVPicture *s1, AVPicture *s2,
     /* "s1" convolve with column vector => "s2" */
     rr2 = mask_radius + srcheight;
     cc2 = mask_radius + srcwidth;
+
+#if HAVE_MMX
+    if (use_sse2)
+    {
+        for (rr = mask_radius; rr < rr2; rr++)
+        {
+            convolve_row_sse2(&s2->data[0][rr * newwidth + mask_radius],
+                    &s1->data[0][(rr - mask_radius) * newwidth + mask_radius],
+                    srcwidth, newwidth, mask, 2 * mask_radius + 1);
+        }
+        for (rr = mask_radius; rr < rr2; rr++)
+        {
+            convolve_row_sse2(&dst->data[0][rr * newwidth + mask_radius],
+                    &s2->data[0][rr * newwidth],
+                    srcwidth, 1, mask, 2 * mask_radius + 1);
+        }
+        return 0;
+    }
+#else
+    (void)use_sse2;
+#endif /* HAVE_MMX */
+
     for (rr = mask_radius; rr < rr2; rr++)
     {
         for (cc = mask_radius; cc < cc2; cc++)
@@ -21,7 +21,7 @@ int pgm_overlay(struct AVPicture *dst,
         const struct AVPicture *s2, int s2height);
 int pgm_convolve_radial(struct AVPicture *dst, struct AVPicture *s1,
         struct AVPicture *s2, const struct AVPicture *src, int srcheight,
-        const double *mask, int mask_radius);
+        const double *mask, int mask_radius, int use_sse2);
 
 #endif  /* !__PGM_H__ */
 
@@ -186,6 +186,10 @@ void ChannelData::handleChannels(int id, QList<ChanInfo> *chanlist)
                 {
                     MythDB::DBError("xmltvid conversion 2", query);
                 }
+                else
+                {
+                    channels_changed = true;
+                }
             }
         }
 
@@ -286,6 +290,7 @@ void ChannelData::handleChannels(int id, QList<ChanInfo> *chanlist)
                     }
                     else
                     {
+                        channels_changed = true;
                         cout << "### " << endl;
                         cout << "### Change performed" << endl;
                         cout << "### " << endl;
@@ -363,6 +368,7 @@ void ChannelData::handleChannels(int id, QList<ChanInfo> *chanlist)
                         (*i).freqid,      localfile,        (*i).tvformat,
                         (*i).xmltvid))
                 {
+                    channels_changed = true;
                     cout << "### " << endl;
                     cout << "### Channel inserted" << endl;
                     cout << "### " << endl;
@@ -431,6 +437,8 @@ void ChannelData::handleChannels(int id, QList<ChanInfo> *chanlist)
                     if (!retval)
                         cout << "Channel " << chanid << " creation failed"
                              << endl;
+                    else
+                        channels_changed = true;
                 }
             }
         }
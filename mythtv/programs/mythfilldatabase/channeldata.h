@@ -37,7 +37,8 @@ class ChannelData
     ChannelData() :
         interactive(false),         non_us_updating(false),
         channel_preset(false),      channel_updates(false),
-        remove_new_channels(false), filter_new_channels(true) {}
+        remove_new_channels(false), filter_new_channels(true),
+        channels_changed(false) {}
 
     bool insert_chan(uint sourceid);
     void handleChannels(int id, QList<ChanInfo> *chanlist);
@@ -51,6 +52,9 @@ class ChannelData
     bool    channel_updates;
     bool    remove_new_channels;
     bool    filter_new_channels;
+    /// Set when handleChannels() added a channel or changed its callsign,
+    /// number or xmltvid, which the scheduler must see
+    bool    channels_changed;
     QString cardtype;
 };
 
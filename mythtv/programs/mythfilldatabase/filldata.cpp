@@ -32,6 +32,7 @@ using namespace std;
 
 // filldata headers
 #include "filldata.h"
+#include "programimporter.h"
 
 #define LOC QString("FillData: ")
 #define LOC_WARN QString("FillData, Warning: ")
@@ -186,6 +187,8 @@ bool FillData::DataDirectUpdateChannels(Source source)
 bool FillData::GrabDDData(Source source, int poffset,
                           QDate pdate, int ddSource)
 {
+    programs_changed = true;
+
     if (source.dd_dups.empty())
         ddprocessor.SetCacheData(false);
     else
@@ -317,24 +320,18 @@ bool FillData::GrabDDData(Source source, int poffset,
 // XMLTV stuff
 bool FillData::GrabDataFromFile(int id, QString &filename)
 {
-    QList<ChanInfo> chanlist;
-    QMap<QString, QList<ProgInfo> > proglist;
+    ProgramImporter importer(id, chan_data, icon_data, delta_import);
 
-    if (!xmltv_parser.parseFile(filename, &chanlist, &proglist))
+    if (!xmltv_parser.parseFile(filename, &importer))
         return false;
 
-    chan_data.handleChannels(id, &chanlist);
-    icon_data.UpdateSourceIcons(id);
-    if (proglist.count() == 0)
+    if (importer.Finish() == 0)
     {
         VERBOSE(VB_GENERAL,
                 QString("No programs found in data."));
         endofdata = true;
     }
-    else
-    {
-        prog_data.HandlePrograms(id, proglist);
-    }
+    programs_changed |= importer.HasChanges();
     return true;
 }
 
@@ -1051,6 +1048,8 @@ ChanInfo *FillData::xawtvChannel(QString &id, QString &channel, QString &fine)
 
 void FillData::readXawtvChannels(int id, QString xawrcfile)
 {
+    programs_changed = true;
+
     QByteArray tmp = xawrcfile.toAscii();
     fstream fin(tmp.constData(), ios::in);
 
@@ -52,7 +52,8 @@ class FillData
         refresh_tba(true),              dd_grab_all(false),
         dddataretrieved(false),
         need_post_grab_proc(true),      only_update_channels(false),
-        channel_update_run(false),      refresh_all(false)
+        channel_update_run(false),      delta_import(true),
+        programs_changed(false),        refresh_all(false)
     {
         SetRefresh(1, true);
     }
@@ -98,6 +99,9 @@ class FillData
     bool    need_post_grab_proc;
     bool    only_update_channels;
     bool    channel_update_run;
+    bool    delta_import;
+    /// Set when the listings may have changed and the scheduler must run
+    bool    programs_changed;
 
   private:
     QMap<uint,bool>     refresh_day;
@@ -302,6 +302,10 @@ int main(int argc, char *argv[])
         {
             fill_data.only_update_channels = true;
         }
+        else if (!strcmp(a.argv()[argpos], "--no-delta-import"))
+        {
+            fill_data.delta_import = false;
+        }
         else if (!strcmp(a.argv()[argpos],"-v") ||
                  !strcmp(a.argv()[argpos],"--verbose"))
         {
@@ -490,6 +494,12 @@ int main(int argc, char *argv[])
             cout << "   \"To be announced\" programs will always be refreshed \n";
             cout << "   unless this argument is used\n";
             cout << "\n";
+            cout << "--no-delta-import\n";
+            cout << "   XMLTV listings are compared with the programs already\n";
+            cout << "   in the database and only the differences are written.\n";
+            cout << "   This argument writes each changed program on its own\n";
+            cout << "   instead.\n";
+            cout << "\n";
             cout << "--dd-grab-all\n";
             cout << "   The DataDirect grabber will grab all available data\n";
             cout << "   in a single pull. This will ensure you always have\n";
@@ -979,15 +989,22 @@ int main(int argc, char *argv[])
         fill_data.ddprocessor.GrabNextSuggestedTime();
     }
 
-    VERBOSE(VB_GENERAL, "\n"
+    if (grab_data && !fill_data.programs_changed &&
+        !fill_data.chan_data.channels_changed)
+    {
+        VERBOSE(VB_GENERAL, "Listings are unchanged, not rescheduling.");
+    }
+    else if (grab_data || mark_repeats)
+    {
+        VERBOSE(VB_GENERAL, "\n"
             "===============================================================\n"
             "| Attempting to contact the master backend for rescheduling.  |\n"
             "| If the master is not running, rescheduling will happen when |\n"
             "| the master backend is restarted.                            |\n"
             "===============================================================");
 
-    if (grab_data || mark_repeats)
         ScheduledRecording::signalChange(-1);
+    }
 
     RemoteSendMessage("CLEAR_SETTINGS_CACHE");
 
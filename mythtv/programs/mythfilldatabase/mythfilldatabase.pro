@@ -18,8 +18,8 @@ DEPENDPATH  += ../../libs/libmythtv/mpeg
 # Input
 HEADERS += filldata.h   channeldata.h
 HEADERS += icondata.h   xmltvparser.h
-HEADERS += fillutil.h
+HEADERS += fillutil.h   programimporter.h
 SOURCES += filldata.cpp channeldata.cpp
 SOURCES += icondata.cpp xmltvparser.cpp
-SOURCES += fillutil.cpp
+SOURCES += fillutil.cpp programimporter.cpp
 SOURCES += main.cpp
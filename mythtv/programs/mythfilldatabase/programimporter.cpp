@@ -0,0 +1,136 @@
+// Qt headers
+#include <QMutexLocker>
+
+// libmyth headers
+#include "mythverbose.h"
+#include "mythdbcon.h"
+#include "dbutil.h"
+
+// libmythtv headers
+#include "programdata.h"
+
+// filldata headers
+#include "programimporter.h"
+#include "channeldata.h"
+#include "icondata.h"
+
+/// Batches the parser may get ahead of the database writes
+static const int kMaxQueuedBatches = 8;
+
+ProgramImporter::ProgramImporter(uint _sourceid, ChannelData &_chan_data,
+                                 IconData &_icon_data, bool _delta) :
+    sourceid(_sourceid), chan_data(_chan_data), icon_data(_icon_data),
+    delta(_delta), finished(false), count(0), unchanged(0), updated(0)
+{
+}
+
+ProgramImporter::~ProgramImporter()
+{
+    Finish();
+
+    while (!queue.empty())
+        qDeleteAll(queue.takeFirst().proglist);
+}
+
+/** \fn ProgramImporter::HandleChannels(QList<ChanInfo>&)
+ *  \brief Updates the channels of the source and starts writing
+ *         programmes, which may only be done once the channels exist.
+ */
+void ProgramImporter::HandleChannels(QList<ChanInfo> &chanlist)
+{
+    chan_data.handleChannels(sourceid, &chanlist);
+    icon_data.UpdateSourceIcons(sourceid);
+
+    start();
+}
+
+/** \fn ProgramImporter::HandlePrograms(const QString&, QList<ProgInfo*>&)
+ *  \brief Queues a batch of programmes of one channel, blocks while the
+ *         queue is full.
+ */
+void ProgramImporter::HandlePrograms(
+    const QString &xmltvid, QList<ProgInfo*> &proglist)
+{
+    ProgramBatch batch;
+    batch.xmltvid  = xmltvid;
+    batch.proglist = proglist;
+    proglist.clear();
+
+    QMutexLocker locker(&lock);
+
+    while (queue.size() >= kMaxQueuedBatches)
+        dequeued.wait(&lock);
+
+    count += batch.proglist.size();
+    queue.push_back(batch);
+    queued.wakeAll();
+}
+
+/** \fn ProgramImporter::Finish(void)
+ *  \brief Waits for the queued programmes to be written.
+ *  \return number of programmes found in the file
+ */
+uint ProgramImporter::Finish(void)
+{
+    {
+        QMutexLocker locker(&lock);
+        if (finished)
+            return count;
+        finished = true;
+        queued.wakeAll();
+    }
+
+    wait();
+
+    if (count)
+    {
+        VERBOSE(VB_GENERAL,
+                QString("Updated programs: %1 Unchanged programs: %2")
+                    .arg(updated)
+                    .arg(unchanged));
+    }
+
+    return count;
+}
+
+void ProgramImporter::run(void)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+
+    // ROLLBACK does nothing for MyISAM, the delta update must know that
+    bool transactional = delta && DBUtil::IsTransactional("program");
+
+    QMutexLocker locker(&lock);
+
+    while (true)
+    {
+        while (queue.empty() && !finished)
+            queued.wait(&lock);
+
+        if (queue.empty())
+            break;
+
+        ProgramBatch batch = queue.takeFirst();
+        dequeued.wakeAll();
+
+        locker.unlock();
+
+        // Long listings come in several batches per channel, so only look
+        // up each channel once; the channels do not change while we run
+        QMap<QString, vector<uint> >::const_iterator cit =
+            chanids.find(batch.xmltvid);
+        if (cit == chanids.end())
+        {
+            cit = chanids.insert(batch.xmltvid, ProgramData::GetChanIDs(
+                                     query, sourceid, batch.xmltvid));
+        }
+
+        // FixProgramList() drops conflicting programmes from the list
+        QList<ProgInfo*> sortlist = batch.proglist;
+        ProgramData::HandleChannelPrograms(
+            query, *cit, sortlist, unchanged, updated, delta, transactional);
+        qDeleteAll(batch.proglist);
+
+        locker.relock();
+    }
+}
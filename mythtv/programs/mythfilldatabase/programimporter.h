@@ -0,0 +1,76 @@
+#ifndef _PROGRAMIMPORTER_H_
+#define _PROGRAMIMPORTER_H_
+
+// C++ headers
+#include <vector>
+using namespace std;
+
+// Qt headers
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QString>
+#include <QList>
+#include <QMap>
+
+// filldata headers
+#include "xmltvparser.h"
+
+class ChannelData;
+class IconData;
+
+/// Programmes of one channel waiting to be written to the database
+class ProgramBatch
+{
+  public:
+    QString          xmltvid;
+    QList<ProgInfo*> proglist;
+};
+
+/** \class ProgramImporter
+ *  \brief Writes the programmes found by XMLTVParser::parseFile() to the
+ *         database on a thread of its own, while the file is still
+ *         being read.
+ *
+ *   The parser blocks when the writer falls more than a few batches
+ *   behind, so the programmes of the whole file are never in memory
+ *   at once.
+ */
+class ProgramImporter : public QThread, public XMLTVListener
+{
+  public:
+    ProgramImporter(uint sourceid, ChannelData &chan_data,
+                    IconData &icon_data, bool delta);
+    ~ProgramImporter();
+
+    // XMLTVListener
+    void HandleChannels(QList<ChanInfo> &chanlist);
+    void HandlePrograms(const QString &xmltvid, QList<ProgInfo*> &proglist);
+
+    uint Finish(void);
+    /// True if any programme was added or changed, valid after Finish()
+    bool HasChanges(void) const { return updated; }
+
+  protected:
+    void run(void);
+
+  private:
+    uint                 sourceid;
+    ChannelData         &chan_data;
+    IconData            &icon_data;
+    bool                 delta;
+    /// xmltvid to chanids, only used by the writer thread
+    QMap<QString, vector<uint> > chanids;
+
+    QMutex               lock;
+    QWaitCondition       queued;
+    QWaitCondition       dequeued;
+    QList<ProgramBatch>  queue;
+    bool                 finished;
+
+    uint                 count;
+    uint                 unchanged;
+    uint                 updated;
+};
+
+#endif // _PROGRAMIMPORTER_H_
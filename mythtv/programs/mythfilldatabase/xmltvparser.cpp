@@ -5,6 +5,7 @@
 #include <QStringList>
 #include <QDateTime>
 #include <QDomDocument>
+#include <QXmlStreamReader>
 #include <QUrl>
 
 // C++ headers
@@ -25,7 +26,12 @@
 #include "channeldata.h"
 #include "fillutil.h"
 
-XMLTVParser::XMLTVParser() : isJapan(false), current_year(0)
+/// Programmes of one channel handed to the listener at a time, the
+/// parser holds at most this many per channel in memory.
+static const int kMaxBatchSize = 1000;
+
+XMLTVParser::XMLTVParser() :
+    isJapan(false), current_year(0), listener(NULL)
 {
     current_year = QDate::currentDate().toString("yyyy").toUInt();
 }
@@ -576,34 +582,140 @@ ProgInfo *XMLTVParser::parseProgram(
     return pginfo;
 }
 
-bool XMLTVParser::parseFile(
-    QString filename, QList<ChanInfo> *chanlist,
-    QMap<QString, QList<ProgInfo> > *proglist)
+static QDomElement createElement(QXmlStreamReader &xml, QDomDocument &doc)
 {
-    QDomDocument doc;
-    QFile f;
+    QDomElement element = doc.createElement(xml.qualifiedName().toString());
 
-    if (!dash_open(f, filename, QIODevice::ReadOnly))
+    QXmlStreamAttributes attrs = xml.attributes();
+    for (int i = 0; i < attrs.size(); i++)
     {
-        VERBOSE(VB_IMPORTANT, QString("Error unable to open '%1' for reading.")
-                .arg(filename));
-        return false;
+        element.setAttribute(attrs[i].qualifiedName().toString(),
+                             attrs[i].value().toString());
     }
 
-    QString errorMsg = "unknown";
-    int errorLine = 0;
-    int errorColumn = 0;
+    return element;
+}
 
-    if (!doc.setContent(&f, &errorMsg, &errorLine, &errorColumn))
+/** \fn readElement(QXmlStreamReader&, QDomDocument&)
+ *  \brief Reads the element the reader is on, with everything in it,
+ *         into an element of doc.
+ *
+ *   Whitespace only text is dropped, as QDomDocument::setContent() does,
+ *   so parseChannel() and parseProgram() see the same tree as they would
+ *   in a document built from the whole file.
+ */
+static QDomElement readElement(QXmlStreamReader &xml, QDomDocument &doc)
+{
+    QDomElement top = createElement(xml, doc);
+    doc.appendChild(top);
+
+    QDomElement cur = top;
+    while (!xml.atEnd())
     {
-        VERBOSE(VB_IMPORTANT, QString("Error in %1:%2: %3")
-            .arg(errorLine).arg(errorColumn).arg(errorMsg));
+        xml.readNext();
+        if (xml.isStartElement())
+        {
+            QDomElement e = createElement(xml, doc);
+            cur.appendChild(e);
+            cur = e;
+        }
+        else if (xml.isEndElement())
+        {
+            if (cur == top)
+                break;
+            cur = cur.parentNode().toElement();
+        }
+        else if (xml.isCharacters() && !xml.isWhitespace())
+        {
+            QDomText text = cur.lastChild().toText();
+            if (text.isNull())
+                cur.appendChild(doc.createTextNode(xml.text().toString()));
+            else
+                text.appendData(xml.text().toString());
+        }
+    }
+
+    return top;
+}
+
+static bool start_time_less_than(const ProgInfo *a, const ProgInfo *b)
+{
+    return (a->starttime < b->starttime);
+}
+
+/** \fn XMLTVParser::addProgram(ProgInfo*)
+ *  \brief Collects the programmes of each channel, and hands them to
+ *         the listener once kMaxBatchSize of them are pending.
+ *
+ *   XMLTV files are usually sorted by time rather than by channel, so
+ *   the programmes are collected per channel; this way the listener sees
+ *   all programmes of a channel that overlap each other together.
+ */
+void XMLTVParser::addProgram(ProgInfo *pginfo)
+{
+    QList<ProgInfo*> &proglist = pending[pginfo->channel];
+    proglist.push_back(pginfo);
 
-        f.close();
-        return true;
+    if (proglist.size() >= kMaxBatchSize)
+        flushPrograms(pginfo->channel, false);
+}
+
+/** \fn XMLTVParser::flushPrograms(QString, bool)
+ *  \brief Hands the pending programmes of a channel to the listener.
+ *
+ *   ProgramData::FixProgramList() takes a missing stop time from the next
+ *   programme of the channel, so unless this is the final flush the last
+ *   programme is kept for the next batch of its channel if it has
+ *   no stop time.
+ */
+void XMLTVParser::flushPrograms(QString xmltvid, bool final)
+{
+    QMap<QString, QList<ProgInfo*> >::iterator it = pending.find(xmltvid);
+    if (it == pending.end())
+        return;
+
+    QList<ProgInfo*> batch = *it;
+    pending.erase(it);
+
+    qStableSort(batch.begin(), batch.end(), start_time_less_than);
+
+    ProgInfo *last = batch.back();
+    if (!final && (last->endts.isEmpty() || last->startts > last->endts))
+    {
+        pending[xmltvid].push_back(last);
+        batch.pop_back();
     }
 
-    f.close();
+    if (!batch.empty())
+        listener->HandlePrograms(xmltvid, batch);
+}
+
+/** \fn XMLTVParser::flushPrograms(void)
+ *  \brief Hands all pending programmes to the listener, at the end
+ *         of the file.
+ */
+void XMLTVParser::flushPrograms(void)
+{
+    while (!pending.empty())
+        flushPrograms(pending.begin().key(), true);
+}
+
+/** \fn XMLTVParser::parseFile(QString, XMLTVListener*)
+ *  \brief Reads an XMLTV file one channel or programme at a time.
+ *
+ *   The channels are passed to the listener before the first programme,
+ *   the programmes follow in batches of one channel, see addProgram().
+ */
+bool XMLTVParser::parseFile(QString filename, XMLTVListener *xmltv_listener)
+{
+    QFile f;
+
+    if (!dash_open(f, filename, QIODevice::ReadOnly))
+    {
+        VERBOSE(VB_IMPORTANT, QString("Error unable to open '%1' for reading.")
+                .arg(filename));
+        return false;
+    }
 
     // now we calculate the localTimezoneOffset, so that we can fix
     // the programdata if needed
@@ -627,11 +739,17 @@ bool XMLTVParser::parseFile(
         }
     }
 
-    QDomElement docElem = doc.documentElement();
+    listener = xmltv_listener;
+    pending.clear();
+
+    QXmlStreamReader xml(&f);
 
-    QUrl baseUrl(docElem.attribute("source-data-url", ""));
+    while (!xml.atEnd() && !xml.isStartElement())
+        xml.readNext();
 
-    QUrl sourceUrl(docElem.attribute("source-info-url", ""));
+    QUrl baseUrl(xml.attributes().value("source-data-url").toString());
+
+    QUrl sourceUrl(xml.attributes().value("source-info-url").toString());
     if (sourceUrl.toString() == "http://labs.zap2it.com/")
     {
         VERBOSE(VB_IMPORTANT, "Don't use tv_grab_na_dd, use the"
@@ -639,91 +757,117 @@ bool XMLTVParser::parseFile(
         exit(FILLDB_BUGGY_EXIT_SRC_IS_DD);
     }
 
+    QList<ChanInfo> chanlist;
+    bool channels_done = false;
+
     QString aggregatedTitle;
     QString aggregatedDesc;
     QString groupingTitle;
     QString groupingDesc;
 
-    QDomNode n = docElem.firstChild();
-    while (!n.isNull())
+    while (!xml.atEnd())
     {
-        QDomElement e = n.toElement();
-        if (!e.isNull())
+        xml.readNext();
+        if (!xml.isStartElement())
+            continue;
+
+        QDomDocument doc;
+        QDomElement e = readElement(xml, doc);
+
+        if (e.tagName() == "channel")
+        {
+            ChanInfo *chinfo = parseChannel(e, baseUrl);
+            chanlist.push_back(*chinfo);
+            delete chinfo;
+        }
+        else if (e.tagName() == "programme")
         {
-            if (e.tagName() == "channel")
+            if (!channels_done)
             {
-                ChanInfo *chinfo = parseChannel(e, baseUrl);
-                chanlist->push_back(*chinfo);
-                delete chinfo;
+                listener->HandleChannels(chanlist);
+                channels_done = true;
             }
-            else if (e.tagName() == "programme")
+
+            ProgInfo *pginfo = parseProgram(e, localTimezoneOffset);
+
+            if (pginfo->startts == pginfo->endts)
             {
-                ProgInfo *pginfo = parseProgram(e, localTimezoneOffset);
+                /* Not a real program : just a grouping marker */
+                if (!pginfo->title.isEmpty())
+                    groupingTitle = pginfo->title + " : ";
 
-                if (pginfo->startts == pginfo->endts)
+                if (!pginfo->description.isEmpty())
+                    groupingDesc = pginfo->description + " : ";
+            }
+            else
+            {
+                if (pginfo->clumpidx.isEmpty())
                 {
-                    /* Not a real program : just a grouping marker */
-                    if (!pginfo->title.isEmpty())
-                        groupingTitle = pginfo->title + " : ";
+                    if (!groupingTitle.isEmpty())
+                    {
+                        pginfo->title.prepend(groupingTitle);
+                        groupingTitle.clear();
+                    }
 
-                    if (!pginfo->description.isEmpty())
-                        groupingDesc = pginfo->description + " : ";
+                    if (!groupingDesc.isEmpty())
+                    {
+                        pginfo->description.prepend(groupingDesc);
+                        groupingDesc.clear();
+                    }
+
+                    addProgram(pginfo);
+                    continue;
                 }
                 else
                 {
-                    if (pginfo->clumpidx.isEmpty())
+                    /* append all titles/descriptions from one clump */
+                    if (pginfo->clumpidx.toInt() == 0)
                     {
-                        if (!groupingTitle.isEmpty())
-                        {
-                            pginfo->title.prepend(groupingTitle);
-                            groupingTitle.clear();
-                        }
+                        aggregatedTitle.clear();
+                        aggregatedDesc.clear();
+                    }
 
-                        if (!groupingDesc.isEmpty())
-                        {
-                            pginfo->description.prepend(groupingDesc);
-                            groupingDesc.clear();
-                        }
+                    if (!pginfo->title.isEmpty())
+                    {
+                        if (!aggregatedTitle.isEmpty())
+                            aggregatedTitle.append(" | ");
+                        aggregatedTitle.append(pginfo->title);
+                    }
 
-                        (*proglist)[pginfo->channel].push_back(*pginfo);
+                    if (!pginfo->description.isEmpty())
+                    {
+                        if (!aggregatedDesc.isEmpty())
+                            aggregatedDesc.append(" | ");
+                        aggregatedDesc.append(pginfo->description);
                     }
-                    else
+                    if (pginfo->clumpidx.toInt() ==
+                        pginfo->clumpmax.toInt() - 1)
                     {
-                        /* append all titles/descriptions from one clump */
-                        if (pginfo->clumpidx.toInt() == 0)
-                        {
-                            aggregatedTitle.clear();
-                            aggregatedDesc.clear();
-                        }
-
-                        if (!pginfo->title.isEmpty())
-                        {
-                            if (!aggregatedTitle.isEmpty())
-                                aggregatedTitle.append(" | ");
-                            aggregatedTitle.append(pginfo->title);
-                        }
-
-                        if (!pginfo->description.isEmpty())
-                        {
-                            if (!aggregatedDesc.isEmpty())
-                                aggregatedDesc.append(" | ");
-                            aggregatedDesc.append(pginfo->description);
-                        }
-                        if (pginfo->clumpidx.toInt() ==
-                            pginfo->clumpmax.toInt() - 1)
-                        {
-                            pginfo->title = aggregatedTitle;
-                            pginfo->description = aggregatedDesc;
-                            (*proglist)[pginfo->channel].push_back(*pginfo);
-                        }
+                        pginfo->title = aggregatedTitle;
+                        pginfo->description = aggregatedDesc;
+                        addProgram(pginfo);
+                        continue;
                     }
                 }
-                delete pginfo;
             }
+            delete pginfo;
         }
-        n = n.nextSibling();
     }
 
+    if (xml.hasError())
+    {
+        VERBOSE(VB_IMPORTANT, QString("Error in %1:%2: %3")
+            .arg(xml.lineNumber()).arg(xml.columnNumber())
+            .arg(xml.errorString()));
+    }
+
+    f.close();
+
+    if (!channels_done)
+        listener->HandleChannels(chanlist);
+
+    flushPrograms();
+    listener = NULL;
+
     return true;
 }
-
@@ -11,6 +11,24 @@ class ChanInfo;
 class QUrl;
 class QDomElement;
 
+/** \class XMLTVListener
+ *  \brief Receives the channels and programmes found by
+ *         XMLTVParser::parseFile() while the file is being read.
+ */
+class XMLTVListener
+{
+  public:
+    /// Called once, after the last channel and before the first programme.
+    virtual void HandleChannels(QList<ChanInfo> &chanlist) = 0;
+    /// Called with a batch of programmes of one channel, the listener
+    /// takes ownership of the programmes.
+    virtual void HandlePrograms(const QString &xmltvid,
+                                QList<ProgInfo*> &proglist) = 0;
+
+  protected:
+    virtual ~XMLTVListener() {}
+};
+
 class XMLTVParser
 {
   public:
@@ -18,16 +36,22 @@ class XMLTVParser
 
     ChanInfo *parseChannel(QDomElement &element, QUrl &baseUrl);
     ProgInfo *parseProgram(QDomElement &element, int localTimezoneOffset);
-    bool parseFile(
-        QString filename, QList<ChanInfo> *chanlist,
-        QMap<QString, QList<ProgInfo> > *proglist);
-
+    bool parseFile(QString filename, XMLTVListener *listener);
 
   public:
     bool isJapan;
 
+  private:
+    void addProgram(ProgInfo *pginfo);
+    void flushPrograms(QString xmltvid, bool final);
+    void flushPrograms(void);
+
   private:
     unsigned int current_year;
+
+    // Programmes read but not handed to the listener, see addProgram()
+    XMLTVListener                    *listener;
+    QMap<QString, QList<ProgInfo*> >  pending;
 };
 
 #endif // _XMLTVPARSER_H_
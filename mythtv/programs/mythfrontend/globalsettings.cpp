@@ -738,7 +738,23 @@ static GlobalCheckBox *CommFlagFast()
     gc->setLabel(QObject::tr("Enable experimental speedup of commercial detection"));
     gc->setValue(false);
     gc->setHelpText(QObject::tr("If enabled, experimental commercial detection "
-                    "speedups will be enabled."));
+                    "speedups will be enabled. Video is only decoded as far "
+                    "as the detection method needs, e.g. at reduced "
+                    "resolution and without color."));
+    return gc;
+}
+
+static GlobalCheckBox *CommFlagParallel()
+{
+    GlobalCheckBox *gc = new GlobalCheckBox("CommFlagParallel");
+    gc->setLabel(QObject::tr("Use all CPU cores for commercial detection"));
+    gc->setValue(false);
+    gc->setHelpText(QObject::tr("If enabled, finished recordings are split "
+                    "into segments which are flagged in parallel, one per "
+                    "CPU core. The experimental detection methods instead "
+                    "run the logo and the blank frame and scene change "
+                    "analysis side by side. This is not used when the job "
+                    "queue is set to use low CPU."));
     return gc;
 }
 
@@ -2952,6 +2968,18 @@ static GlobalCheckBox *GRSchedMoveHigher()
     return bc;
 }
 
+static GlobalCheckBox *GRSchedIncremental()
+{
+    GlobalCheckBox *bc = new GlobalCheckBox("SchedIncremental");
+    bc->setLabel(QObject::tr("Incremental rescheduling"));
+    bc->setHelpText(QObject::tr("When a single recording rule is changed, "
+                    "only look up the programs matched by that rule again "
+                    "instead of those of all rules. Guide updates and "
+                    "changes to recordings always reschedule everything."));
+    bc->setValue(true);
+    return bc;
+}
+
 static GlobalComboBox *GRSchedOpenEnd()
 {
     GlobalComboBox *bc = new GlobalComboBox("SchedOpenEnd");
@@ -4179,6 +4207,7 @@ GeneralSettings::GeneralSettings()
     jobs->setLabel(QObject::tr("General (Jobs)"));
     jobs->addChild(CommercialSkipMethod());
     jobs->addChild(CommFlagFast());
+    jobs->addChild(CommFlagParallel());
     jobs->addChild(AggressiveCommDetect());
     jobs->addChild(DefaultTranscoder());
     jobs->addChild(DeferAutoTranscodeDays());
@@ -4237,6 +4266,7 @@ GeneralRecPrioritiesSettings::GeneralRecPrioritiesSettings()
     sched->setLabel(QObject::tr("Scheduler Options"));
 
     sched->addChild(GRSchedMoveHigher());
+    sched->addChild(GRSchedIncremental());
     sched->addChild(GRSchedOpenEnd());
     sched->addChild(GRDefaultStartOffset());
     sched->addChild(GRDefaultEndOffset());
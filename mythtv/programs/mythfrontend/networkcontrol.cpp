@@ -891,6 +891,29 @@ QString NetworkControl::processQuery(NetworkCommand *nc)
 
         return str;
     }
+    else if (is_abbrev("playbackstats", nc->getArg(1)))
+    {
+        QString location = GetMythUI()->GetCurrentLocation(false, false);
+
+        if (location != "Playback")
+            return QString("ERROR: Not currently in playback");
+
+        gotAnswer = false;
+        QString message = QString("NETWORK_CONTROL QUERY PLAYBACKSTATS");
+        MythEvent me(message);
+        gCoreContext->dispatch(me);
+
+        QTime timer;
+        timer.start();
+        while (timer.elapsed() < 2000  && !gotAnswer)
+            usleep(10000);
+
+        if (!gotAnswer)
+            return QString("ERROR: Timed out waiting for reply from player");
+
+        // The rows of CSV arrive space separated, they contain no spaces.
+        return answer.split(" ", QString::SkipEmptyParts).join("\r\n");
+    }
     else if ((nc->getArgCount() == 4) &&
              is_abbrev("recording", nc->getArg(1)) &&
              (nc->getArg(2).contains(QRegExp("^\\d+$"))) &&
@@ -1045,6 +1068,7 @@ QString NetworkControl::processHelp(NetworkCommand *nc)
         helpText +=
             "query location        - Query current screen or location\r\n"
             "query volume          - Query the current playback volume\r\n"
+            "query playbackstats   - Timing of the recently displayed frames as CSV\r\n"
             "query recordings      - List currently available recordings\r\n"
             "query recording CHANID STARTTIME\r\n"
             "                      - List info about the specified program\r\n"
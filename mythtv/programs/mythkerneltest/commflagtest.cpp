@@ -0,0 +1,231 @@
+// ANSI C headers
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+// C++ headers
+#include <iostream>
+using namespace std;
+
+#include "mythconfig.h"
+
+// avlib/ffmpeg headers
+extern "C" {
+#include "libavcodec/avcodec.h"        // AVPicture
+}
+#if HAVE_MMX
+extern "C" int mm_support(void);    // in libavcodec/x86/cpuid.c
+#endif
+
+// Commercial Flagging headers
+#include "pgm.h"
+#include "EdgeDetector.h"
+
+#include "kerneltest.h"
+
+/*
+ * FrameAnalyzer.cpp pulls in the whole CommDetector2 pipeline, so the one
+ * helper the SGM kernel needs is repeated here.
+ */
+namespace frameAnalyzer {
+
+bool
+rrccinrect(int rr, int cc, int rrow, int rcol, int rwidth, int rheight)
+{
+    return rr >= rrow && cc >= rcol &&
+        rr < rrow + rheight && cc < rcol + rwidth;
+}
+
+};  /* namespace */
+
+using namespace edgeDetector;
+
+namespace {
+
+/* Same mask as CannyEdgeDetector. */
+const int kMaskRadius = 2;
+
+void
+make_mask(double *mask)
+{
+    const double    TWO_SIGMA2 = 2 * 0.5 * 0.5;
+    double          sum = 1.0;
+
+    mask[kMaskRadius] = 1.0;
+    for (int rr = 1; rr <= kMaskRadius; rr++)
+    {
+        double val = exp(-(rr * rr) / TWO_SIGMA2);
+        mask[kMaskRadius + rr] = val;
+        mask[kMaskRadius - rr] = val;
+        sum += 2 * val;
+    }
+    for (int ii = 0; ii < 2 * kMaskRadius + 1; ii++)
+        mask[ii] /= sum;
+}
+
+struct Buffers
+{
+    Buffers(int width, int height) :
+        sgm(new unsigned int[(width + 2 * kMaskRadius) *
+                             (height + 2 * kMaskRadius)])
+    {
+        int pw = width + 2 * kMaskRadius;
+        int ph = height + 2 * kMaskRadius;
+        avpicture_alloc(&s1, PIX_FMT_GRAY8, pw, ph);
+        avpicture_alloc(&s2, PIX_FMT_GRAY8, pw, ph);
+        avpicture_alloc(&dst, PIX_FMT_GRAY8, pw, ph);
+    }
+    ~Buffers()
+    {
+        avpicture_free(&dst);
+        avpicture_free(&s2);
+        avpicture_free(&s1);
+        delete [] sgm;
+    }
+
+    AVPicture       s1, s2, dst;
+    unsigned int    *sgm;
+};
+
+/* Noise with some flat areas and hard edges, like a logo over video. */
+void
+fill_frame(AVPicture *pic, int width, int height)
+{
+    for (int rr = 0; rr < height; rr++)
+    {
+        for (int cc = 0; cc < width; cc++)
+        {
+            unsigned char val = random() & 0xff;
+            if ((rr / 16 + cc / 16) % 3 == 0)
+                val = (cc & 8) ? 235 : 16;
+            pic->data[0][rr * width + cc] = val;
+        }
+    }
+}
+
+bool
+check_frame(int width, int height, const double *mask)
+{
+    AVPicture   src;
+    bool        ok = true;
+
+    avpicture_alloc(&src, PIX_FMT_GRAY8, width, height);
+    fill_frame(&src, width, height);
+
+    Buffers ref(width, height), opt(width, height);
+    const int pw = width + 2 * kMaskRadius;
+    const int ph = height + 2 * kMaskRadius;
+
+    pgm_convolve_radial(&ref.dst, &ref.s1, &ref.s2, &src, height,
+            mask, kMaskRadius, 0);
+    pgm_convolve_radial(&opt.dst, &opt.s1, &opt.s2, &src, height,
+            mask, kMaskRadius, 1);
+    if (memcmp(ref.dst.data[0], opt.dst.data[0], pw * ph))
+    {
+        cerr << "pgm_convolve_radial " << width << "x" << height
+             << ": SSE2 output differs" << endl;
+        ok = false;
+    }
+
+    /* No exclusion, a centred logo, and logos touching the edges. */
+    const int excludes[][4] =
+    {
+        { 0, 0, 0, 0 },
+        { ph / 4, pw / 4, pw / 2, ph / 2 },
+        { 0, 0, pw / 3 + 1, ph / 3 },
+        { ph / 2, pw / 2 + 3, pw, ph },
+        { 1, 0, pw, 1 },
+    };
+    for (uint ii = 0; ii < sizeof(excludes) / sizeof(excludes[0]); ii++)
+    {
+        const int *ex = excludes[ii];
+        sgm_init_exclude(ref.sgm, &ref.dst, ph, ex[0], ex[1], ex[2], ex[3], 0);
+        sgm_init_exclude(opt.sgm, &ref.dst, ph, ex[0], ex[1], ex[2], ex[3], 1);
+        if (memcmp(ref.sgm, opt.sgm, pw * ph * sizeof(*ref.sgm)))
+        {
+            cerr << "sgm_init_exclude " << width << "x" << height
+                 << " exclude " << ex[0] << "," << ex[1] << " "
+                 << ex[2] << "x" << ex[3] << ": SSE2 output differs" << endl;
+            ok = false;
+        }
+    }
+
+    avpicture_free(&src);
+    return ok;
+}
+
+void
+benchmark_frame(int width, int height, const double *mask)
+{
+    const int   kIterations = 200;
+    AVPicture   src;
+
+    avpicture_alloc(&src, PIX_FMT_GRAY8, width, height);
+    fill_frame(&src, width, height);
+
+    Buffers buf(width, height);
+    const int ph = height + 2 * kMaskRadius;
+
+    for (int sse2 = 0; sse2 <= 1; sse2++)
+    {
+        struct timeval start;
+
+        (void)gettimeofday(&start, NULL);
+        for (int ii = 0; ii < kIterations; ii++)
+            pgm_convolve_radial(&buf.dst, &buf.s1, &buf.s2, &src, height,
+                    mask, kMaskRadius, sse2);
+        double convolve = elapsed_ms(start) / kIterations;
+
+        (void)gettimeofday(&start, NULL);
+        for (int ii = 0; ii < kIterations; ii++)
+            sgm_init_exclude(buf.sgm, &buf.dst, ph,
+                    ph / 4, width / 4, width / 2, ph / 2, sse2);
+        double sgm = elapsed_ms(start) / kIterations;
+
+        cout << "  " << width << "x" << height
+             << (sse2 ? " SSE2: " : " C:    ")
+             << "convolve " << convolve << " ms, sgm " << sgm
+             << " ms per frame" << endl;
+    }
+
+    avpicture_free(&src);
+}
+
+};  /* namespace */
+
+bool
+commflag_kernel_test(bool benchmark)
+{
+#if HAVE_MMX
+    if (!(mm_support() & FF_MM_SSE2))
+#endif
+    {
+        cout << "commflag: no SSE2, nothing to compare" << endl;
+        return true;
+    }
+
+    double      mask[2 * kMaskRadius + 1];
+    bool        ok = true;
+
+    make_mask(mask);
+    srandom(1);
+
+    /* Widths exercise the 4 and 8 pixel steps and their remainders. */
+    const int sizes[][2] =
+    {
+        { 1, 1 }, { 3, 2 }, { 7, 5 }, { 8, 8 }, { 13, 9 },
+        { 64, 36 }, { 359, 71 }, { 480, 270 }, { 720, 576 },
+    };
+    for (uint ii = 0; ii < sizeof(sizes) / sizeof(sizes[0]); ii++)
+        ok &= check_frame(sizes[ii][0], sizes[ii][1], mask);
+
+    if (benchmark)
+    {
+        benchmark_frame(720, 576, mask);
+        benchmark_frame(1920, 1080, mask);
+    }
+
+    return ok;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
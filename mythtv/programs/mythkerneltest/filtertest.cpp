@@ -0,0 +1,182 @@
+// ANSI C headers
+#include <cstdlib>
+#include <cstring>
+
+// C++ headers
+#include <algorithm>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+#include <stdint.h>
+
+#include "mythconfig.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"        // FF_MM_SSE2
+}
+#if HAVE_MMX
+extern "C" int mm_support(void);    // in libavcodec/x86/cpuid.c
+#endif
+
+#include "kerneltest.h"
+
+extern "C" {
+void quickdnr_plane_test(uint8_t *avg, uint8_t *buf, int size,
+                         int thr1, int thr2, int sse2);
+void linearblend_row_test(unsigned char *src, int stride, int sse2);
+}
+
+namespace {
+
+void
+fill_noise(vector<uint8_t> &data)
+{
+    for (uint ii = 0; ii < data.size(); ii++)
+        data[ii] = random() & 0xff;
+}
+
+/* A previous frame close to the current one, so both branches are taken. */
+void
+fill_near(vector<uint8_t> &data, const vector<uint8_t> &base)
+{
+    for (uint ii = 0; ii < data.size(); ii++)
+    {
+        int val = base[ii] + (int)(random() % 41) - 20;
+        if (random() % 8 == 0)
+            val = random() & 0xff;
+        data[ii] = max(0, min(255, val));
+    }
+}
+
+bool
+check_quickdnr(void)
+{
+    /* Remainders of the 16 byte step, and a full frame. */
+    const int sizes[] = { 1, 15, 16, 17, 33, 360 * 288 + 7, 720 * 576 };
+    /* thr2 < 0 selects the single threshold kernel. */
+    const int thresholds[][2] =
+    {
+        { 0, -1 }, { 1, -1 }, { 15, -1 }, { 25, -1 }, { 255, -1 },
+        { 10, 1 }, { 20, 2 }, { 10, 0 }, { 1, 4 }, { 255, 255 }, { 0, 0 },
+    };
+    bool ok = true;
+
+    for (uint ii = 0; ii < sizeof(sizes) / sizeof(sizes[0]); ii++)
+    {
+        vector<uint8_t> avg(sizes[ii]), buf(sizes[ii]);
+        fill_noise(buf);
+        fill_near(avg, buf);
+
+        for (uint jj = 0; jj < sizeof(thresholds) / sizeof(thresholds[0]);
+             jj++)
+        {
+            int thr1 = thresholds[jj][0], thr2 = thresholds[jj][1];
+            vector<uint8_t> ravg(avg), rbuf(buf), savg(avg), sbuf(buf);
+
+            quickdnr_plane_test(&ravg[0], &rbuf[0], sizes[ii],
+                                thr1, thr2, 0);
+            quickdnr_plane_test(&savg[0], &sbuf[0], sizes[ii],
+                                thr1, thr2, 1);
+            if (ravg != savg || rbuf != sbuf)
+            {
+                cerr << "quickdnr size " << sizes[ii] << " thresholds "
+                     << thr1 << "," << thr2 << ": SSE2 output differs"
+                     << endl;
+                ok = false;
+            }
+        }
+    }
+
+    return ok;
+}
+
+bool
+check_linearblend(void)
+{
+    /* The filter blends whole 8 column blocks; 360 leaves an 8 remainder. */
+    const int strides[] = { 8, 16, 24, 40, 360, 720, 1920 };
+    bool ok = true;
+
+    for (uint ii = 0; ii < sizeof(strides) / sizeof(strides[0]); ii++)
+    {
+        /* The kernels read two lines past the 8 they blend. */
+        vector<uint8_t> src(strides[ii] * 10);
+        fill_noise(src);
+
+        vector<uint8_t> mmx(src), sse2(src);
+        linearblend_row_test(&mmx[0], strides[ii], 0);
+        linearblend_row_test(&sse2[0], strides[ii], 1);
+        if (mmx != sse2)
+        {
+            cerr << "linearblend stride " << strides[ii]
+                 << ": SSE2 output differs from MMX" << endl;
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+void
+benchmark(int width, int height)
+{
+    const int       kIterations = 200;
+    const int       size = width * height;
+    vector<uint8_t> avg(size), buf(size), frame(size);
+    struct timeval  start;
+
+    fill_noise(buf);
+    fill_near(avg, buf);
+    fill_noise(frame);
+
+    for (int sse2 = 0; sse2 <= 1; sse2++)
+    {
+        (void)gettimeofday(&start, NULL);
+        for (int ii = 0; ii < kIterations; ii++)
+            quickdnr_plane_test(&avg[0], &buf[0], size, 10, 1, sse2);
+        double dnr = elapsed_ms(start) / kIterations;
+
+        (void)gettimeofday(&start, NULL);
+        for (int ii = 0; ii < kIterations; ii++)
+        {
+            for (int y = 0; y < height - 8; y += 8)
+                linearblend_row_test(&frame[y * width], width, sse2);
+        }
+        double blend = elapsed_ms(start) / kIterations;
+
+        cout << "  " << width << "x" << height << " luma"
+             << (sse2 ? " SSE2: " : " C/MMX:")
+             << " quickdnr " << dnr << " ms, linearblend " << blend
+             << " ms per frame" << endl;
+    }
+}
+
+};  /* namespace */
+
+bool
+filter_kernel_test(bool benchmark_kernels)
+{
+#if HAVE_MMX
+    if (!(mm_support() & FF_MM_SSE2))
+#endif
+    {
+        cout << "filters: no SSE2, nothing to compare" << endl;
+        return true;
+    }
+
+    srandom(1);
+
+    bool ok = check_quickdnr();
+    ok &= check_linearblend();
+
+    if (benchmark_kernels)
+    {
+        benchmark(720, 576);
+        benchmark(1920, 1080);
+    }
+
+    return ok;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,311 @@
+/*
+ * huffman_reference.cpp
+ *
+ * The bit at a time EIT text decoders that the table driven ones in
+ * libmythtv/mpeg replaced, kept as the reference for mythkerneltest.
+ * The ATSC tables are those of atsc_huffman.cpp, which is built in too.
+ */
+
+// Qt headers
+#include <QString>
+#include <QByteArray>
+
+/* Freesat */
+
+struct fsattab {
+    unsigned int value;
+    short bits;
+    char next;
+};
+
+#define START   '\0'
+#define STOP    '\0'
+#define ESCAPE  '\1'
+
+namespace reference {
+#include "freesat_tables.h"
+}
+using namespace reference;
+
+QString reference_freesat_huffman_to_string(const unsigned char *src, uint size)
+{
+    struct fsattab *fsat_table;
+    unsigned int *fsat_index;
+
+    if (src[1] == 1 || src[1] == 2)
+    {
+        if (src[1] == 1)
+        {
+            fsat_table = fsat_table_1;
+            fsat_index = fsat_index_1;
+        } else {
+            fsat_table = fsat_table_2;
+            fsat_index = fsat_index_2;
+        }
+        QByteArray uncompressed(size * 3, '\0');
+        int p = 0;
+        unsigned value = 0, byte = 2, bit = 0;
+        while (byte < 6 && byte < size)
+        {
+            value |= src[byte] << ((5-byte) * 8);
+            byte++;
+        }
+        char lastch = START;
+
+        do
+        {
+            bool found = false;
+            unsigned bitShift = 0;
+            char nextCh = STOP;
+            if (lastch == ESCAPE)
+            {
+                found = true;
+                // Encoded in the next 8 bits.
+                // Terminated by the first ASCII character.
+                nextCh = (value >> 24) & 0xff;
+                bitShift = 8;
+                if ((nextCh & 0x80) == 0)
+                {
+                    if (nextCh < ' ')
+                        nextCh = STOP;
+                    lastch = nextCh;
+                }
+            }
+            else
+            {
+                unsigned indx = (unsigned)lastch;
+                for (unsigned j = fsat_index[indx]; j < fsat_index[indx+1]; j++)
+                {
+                    unsigned mask = 0, maskbit = 0x80000000;
+                    for (short kk = 0; kk < fsat_table[j].bits; kk++)
+                    {
+                        mask |= maskbit;
+                        maskbit >>= 1;
+                    }
+                    if ((value & mask) == fsat_table[j].value)
+                    {
+                        nextCh = fsat_table[j].next;
+                        bitShift = fsat_table[j].bits;
+                        found = true;
+                        lastch = nextCh;
+                        break;
+                    }
+                }
+            }
+            if (found)
+            {
+                if (nextCh != STOP && nextCh != ESCAPE)
+                {
+                    if (p >= uncompressed.count())
+                        uncompressed.resize(p+10);
+                    uncompressed[p++] = nextCh;
+                }
+                // Shift up by the number of bits.
+                for (unsigned b = 0; b < bitShift; b++)
+                {
+                    value = (value << 1) & 0xfffffffe;
+                    if (byte < size)
+                        value |= (src[byte] >> (7-bit)) & 1;
+                    if (bit == 7)
+                    {
+                        bit = 0;
+                        byte++;
+                    }
+                    else bit++;
+                }
+            }
+            else
+            {
+                // Entry missing in table.
+                QString result = QString::fromUtf8(uncompressed, p);
+                result.append("...");
+                return result;
+            }
+        } while (lastch != STOP && byte < size+4);
+
+        return QString::fromUtf8(uncompressed, p);
+    }
+    else return QString("");
+}
+
+/* ATSC */
+
+
+/*------------------------------------------------------------------------
+ * Huffman Text Decompressors - 1 and 2 level routines. Tables defined in
+ * atsc_huffman.h
+ *------------------------------------------------------------------------*/
+
+extern unsigned char ATSC_C5[];
+extern unsigned char ATSC_C7[];
+static const unsigned char *reference_atsc_tables[] =
+{
+    NULL,
+    ATSC_C5,
+    ATSC_C7,
+};
+
+struct huffman_table {
+    unsigned int  encoded_sequence;
+    unsigned char character;
+    unsigned char number_of_bits;
+};
+extern struct huffman_table Table128[];
+extern struct huffman_table Table255[];
+
+extern unsigned char Huff2Lookup128[];
+extern unsigned char Huff2Lookup256[];
+
+/* returns the root for character input from table Table[] */
+static inline int huffman1_get_root(uint input, const unsigned char *table)
+{
+    if (input > 127)
+        return -1;
+    return (table[input * 2] << 8) | table[(input * 2) + 1];
+}
+
+/* Returns the bit number bit from string test[] */
+static inline bool huffman1_get_bit(const unsigned char *src, uint bit)
+{
+    return (src[(bit - (bit & 0x7)) >> 3] >> (7 - (bit & 0x7))) & 0x01;
+}
+
+QString reference_atsc_huffman1_to_string(const unsigned char *compressed,
+                                          uint size, uint table_index)
+{
+    QString retval = "";
+
+    const unsigned char *table = reference_atsc_tables[table_index];
+    int totalbits = size * 8;
+    int bit = 0;
+    int root = huffman1_get_root(0, table);
+    int node = 0;
+    bool thebit;
+    unsigned char val;
+
+    while (bit < totalbits)
+    {
+        thebit = huffman1_get_bit(compressed, bit);
+        val = (thebit) ? table[root + (node*2) + 1] : table[root + (node*2)];
+
+        if (val & 0x80)
+        {
+            /* Got a Null Character so return */
+            if ((val & 0x7F) == 0)
+            {
+                return retval;
+            }
+            /* Escape character so next character is uncompressed */
+            if ((val & 0x7F) == 27)
+            {
+                unsigned char val2 = 0;
+                for (int i = 0 ; i < 7 ; i++)
+                {
+                    val2 |=
+                        huffman1_get_bit(compressed, bit + i + 2) << (6 - i);
+                }
+                retval += QChar(val2);
+                bit += 8;
+                root = huffman1_get_root(val2, table);
+            }
+            /* Standard Character */
+            else
+            {
+                root = huffman1_get_root(val & 0x7F, table);
+                retval += QChar(val & 0x7F);
+            }
+            node = 0;
+        }
+        else
+            node = val;
+        bit++;
+    }
+    /* If you get here something went wrong so just return a blank string */
+    return QString("");
+}
+
+static inline int huffman2_get_bit(unsigned char &bitpos,
+                                   const unsigned char **bufptr)
+{
+   int ret = ((**bufptr & bitpos) != 0);
+   bitpos >>= 1;
+   if (!bitpos)
+   {
+       bitpos = 0x80;
+       (*bufptr)++;
+   }
+   return ret;
+}
+
+static inline void huffman2_set_pos(unsigned char &bitpos,
+                                    const unsigned char **bufptr,
+                                    const unsigned char *buffer,
+                                    uint pos)
+{
+    *bufptr = buffer + (pos >> 3);
+    bitpos  = 0x80 >> (pos & 0x7);
+}
+
+QString reference_atsc_huffman2_to_string(const unsigned char *compressed,
+                                          uint length, uint table)
+{
+    QString decompressed = "";
+
+    unsigned char        bitpos;
+    const unsigned char *bufptr;
+    huffman2_set_pos(bitpos, &bufptr, compressed, 0);
+
+    // Determine which huffman table to use
+    struct huffman_table *ptrTable;
+    const unsigned char  *lookup;
+    uint                  min_size;
+    uint                  max_size;
+    if (table == 1)
+    {
+        ptrTable = Table128;
+        lookup   = Huff2Lookup128;
+        min_size = 3;
+        max_size = 12;
+    }
+    else
+    {
+        ptrTable = Table255;
+        lookup   = Huff2Lookup256;
+        min_size = 2;
+        max_size = 14;
+    }
+
+    // walk thru all the bits in the byte array, finding each sequence in the
+    // list and decoding it to a character.
+    uint total_bits  = length << 3;
+    uint current_bit = 0;
+
+    while (current_bit + 3 < total_bits)
+    {
+        uint cur_size = 0;
+        uint bits     = 0;
+
+        for (; cur_size < min_size; cur_size++)
+            bits = (bits << 1) | huffman2_get_bit(bitpos, &bufptr);
+
+        while (cur_size < max_size)
+        {
+            uint key = lookup[bits];
+            if (key && (ptrTable[key].number_of_bits == cur_size))
+            {
+                decompressed += ptrTable[key].character;
+                current_bit += cur_size;
+                break;
+            }
+            bits = (bits << 1) | huffman2_get_bit(bitpos, &bufptr);
+            cur_size++;
+        }
+
+        if (cur_size == max_size)
+            huffman2_set_pos(bitpos, &bufptr, compressed, ++current_bit);
+    }
+
+    return decompressed;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,359 @@
+// ANSI C headers
+#include <cstdlib>
+#include <cstring>
+
+// C++ headers
+#include <iostream>
+#include <vector>
+using namespace std;
+
+// Qt headers
+#include <QString>
+
+// MythTV headers
+#include "freesat_huffman.h"
+#include "atsc_huffman.h"
+
+#include "kerneltest.h"
+
+// in huffman_reference.cpp
+QString reference_freesat_huffman_to_string(const unsigned char *src,
+                                            uint size);
+QString reference_atsc_huffman1_to_string(const unsigned char *compressed,
+                                          uint size, uint table_index);
+QString reference_atsc_huffman2_to_string(const unsigned char *compressed,
+                                          uint length, uint table);
+
+struct fsattab {
+    unsigned int value;
+    short bits;
+    char next;
+};
+
+namespace reference {
+extern struct fsattab fsat_table_1[];
+extern struct fsattab fsat_table_2[];
+extern unsigned int fsat_index_1[];
+extern unsigned int fsat_index_2[];
+};
+
+namespace {
+
+/* Room for the longest string plus the zero padding past its end. */
+const uint kBufSize = 4096;
+
+enum HuffmanScheme { kFreesat, kATSC, kDish };
+
+struct HuffmanFixture
+{
+    HuffmanScheme  scheme;
+    uint           table;
+    const char    *data;
+    uint           size;
+    const char    *expected;
+};
+
+/*
+ * Known answer strings, encoded with the code tables of the Freesat
+ * EPG, ATSC A/65 Annex C and Dish Network specifications. Freesat
+ * strings carry their 0x1f and table bytes, Dish uses the ATSC
+ * huffman2 decoder.
+ */
+const HuffmanFixture kFixtures[] =
+{
+    { kFreesat, 1, "\x1f\x01\x48\xe7\xd8", 5, "BBC News" },
+    { kFreesat, 1, "\x1f\x01\xb7\xa6\xbd\x71\xb1\x80", 8, "EastEnders" },
+    { kFreesat, 1, "\x1f\x01\xe2\xf2\x9d\x04\x53\x96\xdd\x80", 10,
+      "Match of the Day" },
+    { kFreesat, 2, "\x1f\x02\xe5\xba\xad\x5f\xb5\x51\x9e\xbf\xa7\xbb\x17"
+      "\xa9\x54\x67\xaf\xfb\x6b\x6c\xfc\x05\xb8\xce\xcd\x72", 26,
+      "The latest national and international news, with weather." },
+    { kFreesat, 2, "\x1f\x02\x38\x00\xee\xc8\x16\x7f\x32\xfb\x4e\xa8\x3f"
+      "\xa4", 14, "Drama in Albert Square." },
+    { kATSC, 1, "\x8c\xf4\x55\xb2\xf6", 5, "Evening News" },
+    { kATSC, 1, "\x66\x2b\x66\x61\x36\xc0", 6, "Jeopardy!" },
+    { kATSC, 2, "\x9d\x06\xdc\xdd\xd1\xff\xee\xff\xf7\x51\x37\xfb\xbf\x26"
+      "\xbb\x35\x37\x78\xe8\xf3\xd1\x80", 22,
+      "Local and national news, sports and weather." },
+    { kATSC, 2, "\x7f\xfa\xba\x8f\x29\xab\x3b\xdb\xee\x50\x9d\x5c\xaf\xae"
+      "\xee\xfa\xc4", 17, "Contestants answer trivia questions." },
+    { kDish, 1, "\xc5\x21\x0c\x10\xd1\x3b\x2b\xb0", 8, "The Simpsons" },
+    { kDish, 1, "\xc1\x3a\xc0\x6d\x9c\x9c\xca\x0f\x18", 9, "SportsCenter!" },
+    { kDish, 2, "\xef\x8e\x14\x53\x1c\x52\x47\x1b\xdb\xda\x42\x25\xa3\x4a"
+      "\x26\x34", 16, "Homer goes back to college" },
+    { kDish, 2, "\xef\x9e\x3c\x94\x9e\x3c\x90\x91\x99\x63\x84\x75\x8d\x5a"
+      "\xe4\x32\x21\x44\x7c\x75\x4f\x78", 22,
+      "Highlights from around the league!" },
+};
+
+const uint kNumFixtures = sizeof(kFixtures) / sizeof(kFixtures[0]);
+
+const char *kSchemeNames[] = { "freesat", "ATSC", "Dish" };
+
+void
+put_bits(vector<unsigned char> &buf, uint &pos, uint value, uint bits)
+{
+    for (uint b = 0; b < bits; b++, pos++)
+    {
+        if ((value >> (bits - 1 - b)) & 1)
+            buf[pos >> 3] |= 0x80 >> (pos & 7);
+    }
+}
+
+/*
+ * Encodes up to nchars random characters with a Freesat table, using the
+ * escape code for plain ASCII now and then. Returns the size in bytes,
+ * with a few bytes of padding at random.
+ */
+uint
+freesat_encode(vector<unsigned char> &buf, uint table, uint nchars)
+{
+    const fsattab      *tab = (table == 1) ?
+        reference::fsat_table_1 : reference::fsat_table_2;
+    const unsigned int *idx = (table == 1) ?
+        reference::fsat_index_1 : reference::fsat_index_2;
+
+    buf.assign(kBufSize, 0);
+    buf[0] = 0x1f;
+    buf[1] = table;
+
+    uint pos = 16, last = 0;
+    for (uint i = 0; i < nchars && pos < (kBufSize - 16) * 8; i++)
+    {
+        uint n = idx[last + 1] - idx[last];
+        if (!n)
+            break;
+
+        const fsattab &code = tab[idx[last] + random() % n];
+        put_bits(buf, pos, code.value >> (32 - code.bits), code.bits);
+        last = (unsigned char)code.next;
+
+        if (last == 1)
+        {
+            last = ' ' + random() % 90;
+            put_bits(buf, pos, last, 8);
+        }
+        if (!last)
+            break;
+    }
+
+    return (pos + 7) / 8 + random() % 3;
+}
+
+void
+fill_random(vector<unsigned char> &buf, uint size)
+{
+    buf.assign(kBufSize, 0);
+    for (uint i = 0; i < size; i++)
+        buf[i] = random() & 0xff;
+}
+
+bool
+check_freesat(void)
+{
+    const uint          kIterations = 100000;
+    vector<unsigned char> buf;
+    uint                failures = 0;
+
+    for (uint i = 0; i < kIterations; i++)
+    {
+        uint size;
+        switch (i % 4)
+        {
+            case 0:
+            case 1:
+                size = freesat_encode(buf, 1 + (i & 2) / 2, random() % 120);
+                break;
+            case 2:
+                size = 2 + random() % 200;
+                fill_random(buf, size);
+                buf[1] = 1 + random() % 2;
+                break;
+            default:
+                size = 2 + random() % 200;
+                fill_random(buf, size);
+                buf[1] = random() % 4;
+                break;
+        }
+        if (random() % 20 == 0)
+            size = 2 + random() % 6;
+
+        if (freesat_huffman_to_string(&buf[0], size) !=
+            reference_freesat_huffman_to_string(&buf[0], size))
+        {
+            if (failures++ < 5)
+            {
+                cerr << "freesat table " << (uint)buf[1] << " size "
+                     << size << ": output differs" << endl;
+            }
+        }
+    }
+
+    return !failures;
+}
+
+/*
+ * Decodes the known answer strings with both the table driven decoders
+ * and the reference ones.
+ */
+bool
+check_fixtures(void)
+{
+    vector<unsigned char> buf;
+    uint                  failures = 0;
+
+    for (uint i = 0; i < kNumFixtures; i++)
+    {
+        const HuffmanFixture &f = kFixtures[i];
+        buf.assign(kBufSize, 0);
+        memcpy(&buf[0], f.data, f.size);
+
+        QString decoded, reference;
+        switch (f.scheme)
+        {
+            case kFreesat:
+                decoded   = freesat_huffman_to_string(&buf[0], f.size);
+                reference = reference_freesat_huffman_to_string(
+                    &buf[0], f.size);
+                break;
+            case kATSC:
+                decoded   = atsc_huffman1_to_string(&buf[0], f.size, f.table);
+                reference = reference_atsc_huffman1_to_string(
+                    &buf[0], f.size, f.table);
+                break;
+            case kDish:
+                decoded   = atsc_huffman2_to_string(&buf[0], f.size, f.table);
+                reference = reference_atsc_huffman2_to_string(
+                    &buf[0], f.size, f.table);
+                break;
+        }
+
+        if (decoded != f.expected || reference != f.expected)
+        {
+            cerr << kSchemeNames[f.scheme] << " table " << f.table
+                 << ": expected \"" << f.expected << "\", decoded \""
+                 << decoded.toLatin1().constData() << "\", reference \""
+                 << reference.toLatin1().constData() << "\"" << endl;
+            failures++;
+        }
+    }
+
+    return !failures;
+}
+
+bool
+check_atsc(void)
+{
+    const uint          kIterations = 100000;
+    vector<unsigned char> buf;
+    uint                failures = 0;
+
+    for (uint i = 0; i < kIterations; i++)
+    {
+        uint size  = random() % 150;
+        uint table = 1 + random() % 2;
+        fill_random(buf, size);
+        // Every third buffer is mostly 7 bit, to reach the escape codes
+        if (i % 3 == 0)
+        {
+            for (uint j = 0; j < size; j++)
+                buf[j] &= 0x7f | ((random() & 1) << 7);
+        }
+
+        if (atsc_huffman1_to_string(&buf[0], size, table) !=
+            reference_atsc_huffman1_to_string(&buf[0], size, table))
+        {
+            if (failures++ < 5)
+            {
+                cerr << "ATSC huffman1 table " << table << " size "
+                     << size << ": output differs" << endl;
+            }
+        }
+
+        if (atsc_huffman2_to_string(&buf[0], size, table) !=
+            reference_atsc_huffman2_to_string(&buf[0], size, table))
+        {
+            if (failures++ < 5)
+            {
+                cerr << "ATSC huffman2 table " << table << " size "
+                     << size << ": output differs" << endl;
+            }
+        }
+    }
+
+    return !failures;
+}
+
+void
+benchmark(void)
+{
+    const uint              kStrings = 64;
+    const uint              kIterations = 20000;
+    vector<unsigned char>   fsat[kStrings], atsc[kStrings];
+    uint                    fsat_size[kStrings];
+    struct timeval          start;
+
+    for (uint i = 0; i < kStrings; i++)
+    {
+        fsat_size[i] = freesat_encode(fsat[i], 1 + (i & 1), 150);
+        fill_random(atsc[i], 200);
+    }
+
+    (void)gettimeofday(&start, NULL);
+    for (uint i = 0; i < kIterations; i++)
+    {
+        uint s = i % kStrings;
+        reference_freesat_huffman_to_string(&fsat[s][0], fsat_size[s]);
+    }
+    double fsat_ref = elapsed_ms(start);
+
+    (void)gettimeofday(&start, NULL);
+    for (uint i = 0; i < kIterations; i++)
+    {
+        uint s = i % kStrings;
+        freesat_huffman_to_string(&fsat[s][0], fsat_size[s]);
+    }
+    double fsat_new = elapsed_ms(start);
+
+    (void)gettimeofday(&start, NULL);
+    for (uint i = 0; i < kIterations; i++)
+    {
+        uint s = i % kStrings;
+        reference_atsc_huffman1_to_string(&atsc[s][0], 200, 1 + (i & 1));
+        reference_atsc_huffman2_to_string(&atsc[s][0], 200, 1 + (i & 1));
+    }
+    double atsc_ref = elapsed_ms(start);
+
+    (void)gettimeofday(&start, NULL);
+    for (uint i = 0; i < kIterations; i++)
+    {
+        uint s = i % kStrings;
+        atsc_huffman1_to_string(&atsc[s][0], 200, 1 + (i & 1));
+        atsc_huffman2_to_string(&atsc[s][0], 200, 1 + (i & 1));
+    }
+    double atsc_new = elapsed_ms(start);
+
+    cout << "  " << kIterations << " strings: freesat reference "
+         << fsat_ref << " ms, tables " << fsat_new << " ms" << endl
+         << "  " << kIterations << " strings: ATSC reference "
+         << atsc_ref << " ms, tables " << atsc_new << " ms" << endl;
+}
+
+};  /* namespace */
+
+bool
+huffman_kernel_test(bool benchmark_kernels)
+{
+    srandom(1);
+
+    bool ok = check_fixtures();
+    ok &= check_freesat();
+    ok &= check_atsc();
+
+    if (benchmark_kernels)
+        benchmark();
+
+    return ok;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
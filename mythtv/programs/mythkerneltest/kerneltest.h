@@ -0,0 +1,43 @@
+/*
+ * kerneltest.h
+ *
+ * Conformance checks and micro-benchmarks for the SIMD and table driven
+ * kernels. Each test compares the optimized kernel with the reference code
+ * it replaces and, when asked, times both.
+ */
+
+#ifndef __KERNELTEST_H__
+#define __KERNELTEST_H__
+
+#include <sys/time.h>
+#include <cstdlib>
+
+/* Returns true if the optimized kernels match the reference. */
+typedef bool (*KernelTestFunc)(bool benchmark);
+
+struct KernelTest
+{
+    const char     *name;
+    const char     *description;
+    KernelTestFunc  run;
+};
+
+bool commflag_kernel_test(bool benchmark);
+bool filter_kernel_test(bool benchmark);
+bool huffman_kernel_test(bool benchmark);
+bool tsparser_kernel_test(bool benchmark);
+bool programcodec_kernel_test(bool benchmark);
+
+void tsparser_set_input(const char *filename);
+
+static inline double elapsed_ms(const struct timeval &start)
+{
+    struct timeval now;
+    (void)gettimeofday(&now, NULL);
+    return (now.tv_sec - start.tv_sec) * 1000.0 +
+        (now.tv_usec - start.tv_usec) / 1000.0;
+}
+
+#endif  /* !__KERNELTEST_H__ */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
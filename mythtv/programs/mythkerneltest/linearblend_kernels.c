@@ -0,0 +1,34 @@
+/*
+ * The linearblend row kernel, built from the filter source so that
+ * mythkerneltest runs the same code as the plugin.
+ */
+
+#define filter_table linearblend_filter_table
+#include "../../filters/linearblend/filter_linearblend.c"
+
+void linearblend_row_test(unsigned char *src, int stride, int sse2);
+
+/*
+ * Blends the 8 lines at src with the MMX kernel, and with the SSE2 kernel
+ * for whole 16 column blocks if sse2 is set, as the filter would.
+ */
+void linearblend_row_test(unsigned char *src, int stride, int sse2)
+{
+    LBFilter filter;
+
+    memset(&filter, 0, sizeof(filter));
+    filter.subfilter = &linearBlend;
+#ifdef MMX
+    filter.subfilter = &linearBlendMMX;
+    if (sse2)
+        filter.subfilter16 = &linearBlendSSE2;
+#else
+    (void)sse2;
+#endif
+
+    linearBlendRow(&filter, src, stride);
+
+#ifdef MMX
+    emms();
+#endif
+}
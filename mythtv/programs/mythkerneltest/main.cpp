@@ -0,0 +1,92 @@
+#include <iostream>
+using namespace std;
+
+#include <QString>
+#include <QStringList>
+
+#include "exitcodes.h"
+#include "kerneltest.h"
+
+static const KernelTest kTests[] =
+{
+    { "commflag", "mythcommflag Canny smoothing and SGM kernels",
+      commflag_kernel_test },
+    { "filters",  "quickdnr and linearblend video filter kernels",
+      filter_kernel_test },
+    { "huffman",  "Freesat and ATSC EIT text Huffman decoders",
+      huffman_kernel_test },
+    { "tsparser", "MPEGStreamData TS packet parsing of a recording",
+      tsparser_kernel_test },
+    { "programcodec", "ProgramInfo compact and string list replies",
+      programcodec_kernel_test },
+};
+
+static const uint kNumTests = sizeof(kTests) / sizeof(kTests[0]);
+
+static void print_usage(void)
+{
+    cerr << "Usage: mythkerneltest [--benchmark] [--ts <file>] [test ...]"
+         << endl
+         << "Compares the optimized kernels with their reference code."
+         << endl << endl
+         << "  --ts <file>   Recording the tsparser test reads" << endl
+         << endl << "Tests:" << endl;
+    for (uint i = 0; i < kNumTests; i++)
+    {
+        cerr << "  " << QString(kTests[i].name).leftJustified(14)
+            .toLocal8Bit().constData()
+             << kTests[i].description << endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    bool benchmark = false;
+    QStringList names;
+
+    for (int argpos = 1; argpos < argc; argpos++)
+    {
+        QString arg(argv[argpos]);
+        if (arg == "-b" || arg == "--benchmark")
+            benchmark = true;
+        else if (arg == "--ts" && argpos + 1 < argc)
+            tsparser_set_input(argv[++argpos]);
+        else if (arg == "-h" || arg == "--help")
+        {
+            print_usage();
+            return GENERIC_EXIT_OK;
+        }
+        else if (arg.startsWith("-"))
+        {
+            cerr << "Unknown option: " << argv[argpos] << endl;
+            print_usage();
+            return GENERIC_EXIT_INVALID_CMDLINE;
+        }
+        else
+            names.push_back(arg);
+    }
+
+    uint ran = 0, failed = 0;
+    for (uint i = 0; i < kNumTests; i++)
+    {
+        if (!names.empty() && !names.contains(kTests[i].name))
+            continue;
+
+        ran++;
+        bool ok = kTests[i].run(benchmark);
+        cout << kTests[i].name << ": " << (ok ? "ok" : "FAILED") << endl;
+        if (!ok)
+            failed++;
+    }
+
+    if (ran < (uint)names.size())
+    {
+        cerr << "Unknown test name" << endl;
+        print_usage();
+        return GENERIC_EXIT_INVALID_CMDLINE;
+    }
+
+    return failed ? GENERIC_EXIT_NOT_OK : GENERIC_EXIT_OK;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
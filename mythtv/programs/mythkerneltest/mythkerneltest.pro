@@ -0,0 +1,39 @@
+include ( ../../settings.pro )
+include ( ../../version.pro )
+include ( ../programs-libs.pro )
+
+QT += network xml sql
+
+TEMPLATE = app
+CONFIG += thread
+TARGET = mythkerneltest
+target.path = $${PREFIX}/bin
+INSTALLS = target
+
+QMAKE_CLEAN += $(TARGET)
+
+# Input
+HEADERS += kerneltest.h
+
+SOURCES += main.cpp
+
+# Commercial flagging kernels, built from the mythcommflag sources
+INCLUDEPATH += ../mythcommflag
+SOURCES += commflagtest.cpp
+SOURCES += ../mythcommflag/pgm.cpp ../mythcommflag/EdgeDetector.cpp
+
+# Video filter kernels, built from the filter sources
+SOURCES += filtertest.cpp
+SOURCES += quickdnr_kernels.c linearblend_kernels.c
+
+# EIT text Huffman decoders, built from the libmythtv sources
+INCLUDEPATH += ../../libs/libmythtv/mpeg
+SOURCES += huffmantest.cpp huffman_reference.cpp
+SOURCES += ../../libs/libmythtv/mpeg/freesat_huffman.cpp
+SOURCES += ../../libs/libmythtv/mpeg/atsc_huffman.cpp
+
+# TS packet parsing, linked from libmythtv
+SOURCES += tsparsertest.cpp
+
+# ProgramInfo reply encodings, linked from libmyth
+SOURCES += programcodectest.cpp
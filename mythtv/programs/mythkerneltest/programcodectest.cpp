@@ -0,0 +1,190 @@
+// ANSI C headers
+#include <cstdlib>
+
+// C++ headers
+#include <iostream>
+using namespace std;
+
+// Qt headers
+#include <QStringList>
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+
+// MythTV headers
+#include "programlistcodec.h"
+#include "programinfo.h"
+
+#include "kerneltest.h"
+
+namespace {
+
+/* Programs per reply, about what a large recorded list holds. */
+const uint kPrograms = 5000;
+
+/* Replies per path when benchmarking. */
+const uint kIterations = 10;
+
+const uint kTitles   = 200;
+const uint kChannels = 100;
+
+/*
+ * Time spent in each stage of a reply, and the bytes on the wire.
+ */
+struct StageTimes
+{
+    StageTimes() : encode(0.0), transfer(0.0), decode(0.0), bytes(0) {}
+
+    double encode;
+    double transfer;
+    double decode;
+    uint   bytes;
+};
+
+/*
+ * Fills in a ProgramInfo::ToStringList() for recording i, with titles,
+ * channels and groups repeating as they do in a real recorded list.
+ */
+QStringList
+make_program(uint i)
+{
+    QStringList list;
+    ProgramInfo().ToStringList(list);
+
+    uint title   = random() % kTitles;
+    uint channel = random() % kChannels;
+    uint start   = QDateTime(QDate(2010, 1, 1)).toTime_t() + i * 1800;
+    uint length  = 1800 * (1 + random() % 4);
+
+    list[0]  = QString("Title %1").arg(title);
+    list[1]  = QString("Episode %1").arg(random() % 1000);
+    list[2]  = QString("Description of episode %1 of title %2, which "
+                       "runs for a sentence or two.")
+        .arg(random()).arg(title);
+    list[3]  = QString("Category %1").arg(title % 20);
+    list[4]  = QString::number(1001 + channel);
+    list[5]  = QString::number(1 + channel);
+    list[6]  = QString("CH%1").arg(channel);
+    list[7]  = QString("Channel %1").arg(channel);
+    list[8]  = QString("%1_%2.mpg").arg(1001 + channel).arg(start);
+    list[9]  = QString::number((uint64_t)length * 1000000 +
+                               random() % 1000000);
+    list[10] = QString::number(start);
+    list[11] = QString::number(start + length);
+    list[13] = QString("backend%1").arg(i % 2);
+    list[14] = QString::number(1 + channel % 2);
+    list[15] = QString::number(1 + i % 4);
+    list[16] = list[15];
+    list[18] = QString::number(rsRecorded);
+    list[19] = QString::number(1 + title);
+    list[20] = QString::number(kAllRecord);
+    list[23] = list[10];
+    list[24] = list[11];
+    list[26] = (title % 10) ? "Default" : "Kids";
+    list[28] = QString("EP%1").arg(title, 6, 10, QChar('0'));
+    list[29] = QString("EP%1%2").arg(title, 6, 10, QChar('0'))
+        .arg(random() % 10000, 4, 10, QChar('0'));
+    list[30] = list[11];
+
+    // Round trip it so that every field is in its canonical form
+    QStringList canonical;
+    ProgramInfo(list).ToStringList(canonical);
+    return canonical;
+}
+
+/*
+ * Sends a reply through the stages of a recorded list request: the
+ * backend serializes the programs and maybe encodes them, MythSocket
+ * joins and converts the list, and the frontend splits it, maybe
+ * decodes it and parses the programs again.
+ */
+QStringList
+send_reply(const ProgramList &programs, bool compact, StageTimes &times)
+{
+    struct timeval start;
+
+    (void)gettimeofday(&start, NULL);
+    QStringList reply(QString::number(programs.size()));
+    ProgramList::const_iterator it = programs.begin();
+    for (; it != programs.end(); ++it)
+        (*it)->ToStringList(reply);
+    if (compact)
+        ProgramListCodec::Encode(reply, 1, programs.size());
+    times.encode += elapsed_ms(start);
+
+    // As MythSocket::writeStringList() and readStringList() do
+    (void)gettimeofday(&start, NULL);
+    QByteArray utf8 = reply.join("[]:[]").toUtf8();
+    times.bytes = utf8.size();
+    QStringList received = QString::fromUtf8(utf8.data()).split("[]:[]");
+    times.transfer += elapsed_ms(start);
+
+    (void)gettimeofday(&start, NULL);
+    if (compact)
+        ProgramListCodec::Decode(received, 1);
+    ProgramList parsed;
+    QStringList::const_iterator sit = received.begin() + 1;
+    for (int i = 0; i < received[0].toInt(); i++)
+        parsed.push_back(new ProgramInfo(sit, received.end()));
+    times.decode += elapsed_ms(start);
+
+    QStringList result;
+    for (it = parsed.begin(); it != parsed.end(); ++it)
+        (*it)->ToStringList(result);
+    return result;
+}
+
+void
+print_times(const char *name, const StageTimes &times, uint iterations)
+{
+    cout << "  " << name << ": encode " << times.encode / iterations
+         << " ms, transfer " << times.transfer / iterations
+         << " ms, decode " << times.decode / iterations << " ms, "
+         << times.bytes << " bytes" << endl;
+}
+
+};  /* namespace */
+
+bool
+programcodec_kernel_test(bool benchmark)
+{
+    srandom(1);
+
+    ProgramList programs;
+    QStringList expected;
+    for (uint i = 0; i < kPrograms; i++)
+    {
+        QStringList list = make_program(i);
+        programs.push_back(new ProgramInfo(list));
+        expected += list;
+    }
+
+    uint       iterations = benchmark ? kIterations : 1;
+    StageTimes plain, compact;
+    bool       ok = true;
+
+    for (uint i = 0; i < iterations; i++)
+    {
+        if (send_reply(programs, false, plain) != expected)
+        {
+            cerr << "String list reply doesn't round trip" << endl;
+            ok = false;
+        }
+        if (send_reply(programs, true, compact) != expected)
+        {
+            cerr << "Compact reply doesn't round trip" << endl;
+            ok = false;
+        }
+    }
+
+    if (benchmark)
+    {
+        cout << "  " << kPrograms << " programs per reply" << endl;
+        print_times("string list", plain, iterations);
+        print_times("compact    ", compact, iterations);
+    }
+
+    return ok;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,33 @@
+/*
+ * The quickdnr plane kernels, built from the filter source so that
+ * mythkerneltest runs the same code as the plugin.
+ */
+
+#define filter_table quickdnr_filter_table
+#include "../../filters/quickdnr/filter_quickdnr.c"
+
+void quickdnr_plane_test(uint8_t *avg, uint8_t *buf, int size,
+                         int thr1, int thr2, int sse2);
+
+/* Runs the single threshold kernel if thr2 < 0, else the double one. */
+void quickdnr_plane_test(uint8_t *avg, uint8_t *buf, int size,
+                         int thr1, int thr2, int sse2)
+{
+#ifdef MMX
+    if (sse2)
+    {
+        if (thr2 < 0)
+            quickdnr_plane_sse2(avg, buf, size, thr1);
+        else
+            quickdnr2_plane_sse2(avg, buf, size, thr1, thr2);
+        return;
+    }
+#else
+    (void)sse2;
+#endif
+
+    if (thr2 < 0)
+        quickdnr_plane(avg, buf, size, thr1);
+    else
+        quickdnr2_plane(avg, buf, size, thr1, thr2);
+}
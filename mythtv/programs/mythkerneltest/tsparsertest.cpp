@@ -0,0 +1,264 @@
+// C++ headers
+#include <algorithm>
+#include <iostream>
+using namespace std;
+
+// Qt headers
+#include <QByteArray>
+#include <QString>
+#include <QFile>
+
+// MythTV headers
+#include "mpegstreamdata.h"
+#include "mpegtables.h"
+#include "tspacket.h"
+
+#include "kerneltest.h"
+
+namespace {
+
+/* Bytes handed to ProcessData() at once, as a stream handler reads them. */
+const uint kChunkSize = TSPacket::SIZE * 512;
+
+/* Passes over the file per path when benchmarking. */
+const uint kPasses = 5;
+
+QString ts_filename;
+
+/*
+ * Counts the packets handed to the listeners of a recorder, along with a
+ * hash of their headers in the order they arrive.
+ */
+class PacketCounter : public TSPacketListener, public TSPacketListenerAV
+{
+  public:
+    PacketCounter() : video(0), audio(0), writing(0), hash(0) {}
+
+    bool ProcessTSPacket(const TSPacket &tspacket)
+    {
+        writing++;
+        Add(tspacket);
+        return true;
+    }
+
+    bool ProcessVideoTSPacket(const TSPacket &tspacket)
+    {
+        video++;
+        Add(tspacket);
+        return true;
+    }
+
+    bool ProcessAudioTSPacket(const TSPacket &tspacket)
+    {
+        audio++;
+        Add(tspacket);
+        return true;
+    }
+
+    bool operator==(const PacketCounter &other) const
+    {
+        return (video == other.video && audio == other.audio &&
+                writing == other.writing && hash == other.hash);
+    }
+
+    uint     video;
+    uint     audio;
+    uint     writing;
+    uint32_t hash;
+
+  private:
+    void Add(const TSPacket &tspacket)
+    {
+        const unsigned char *d = tspacket.data();
+        hash = hash * 33 + ((d[1] << 16) | (d[2] << 8) | d[3]);
+    }
+};
+
+ostream &
+operator<<(ostream &os, const PacketCounter &c)
+{
+    return os << c.video << " video, " << c.audio << " audio, "
+              << c.writing << " other packets, hash " << hex << c.hash
+              << dec;
+}
+
+/*
+ * Returns the first program in the PAT of the stream, 0 if there is none.
+ */
+int
+find_program(const QByteArray &ts)
+{
+    MPEGStreamData sd(-1, true);
+    sd.ProcessData((const unsigned char*) ts.constData(), ts.size());
+
+    int program = 0;
+    pat_vec_t pats = sd.GetCachedPATs();
+    for (uint i = 0; i < pats.size() && !program; i++)
+    {
+        for (uint j = 0; j < pats[i]->ProgramCount() && !program; j++)
+            program = pats[i]->ProgramNumber(j);
+    }
+    sd.ReturnCachedPATTables(pats);
+
+    return program;
+}
+
+/*
+ * Feeds the stream through ProcessData() in chunks, carrying the bytes
+ * of a partial packet over to the next chunk. Returns the packets read.
+ */
+uint
+parse_chunks(const QByteArray &ts, MPEGStreamData &sd)
+{
+    const unsigned char *buf  = (const unsigned char*) ts.constData();
+    const uint           size = ts.size();
+
+    uint pos = 0;
+    while (pos < size)
+    {
+        uint len  = min(kChunkSize, size - pos);
+        int  left = sd.ProcessData(buf + pos, len);
+        if (len < kChunkSize)
+            break;
+        pos += ((uint)left < len) ? len - left : len;
+    }
+
+    return size / TSPacket::SIZE;
+}
+
+/*
+ * Reference: the packets one at a time through ProcessTSPacket(), as
+ * ProcessData() handled them before runs were batched. Resyncs on two
+ * sync bytes a packet apart.
+ */
+uint
+parse_packets(const QByteArray &ts, MPEGStreamData &sd)
+{
+    const unsigned char *buf  = (const unsigned char*) ts.constData();
+    const uint           size = ts.size();
+
+    uint pos = 0;
+    bool resync = false;
+    while (pos + TSPacket::SIZE <= size)
+    {
+        if (buf[pos] != SYNC_BYTE || resync)
+        {
+            pos++;
+            while (pos + TSPacket::SIZE <= size &&
+                   (buf[pos] != SYNC_BYTE ||
+                    (pos + 2 * TSPacket::SIZE <= size &&
+                     buf[pos + TSPacket::SIZE] != SYNC_BYTE)))
+            {
+                pos++;
+            }
+            resync = false;
+            continue;
+        }
+
+        const TSPacket *pkt = reinterpret_cast<const TSPacket*>(buf + pos);
+        if (sd.ProcessTSPacket(*pkt))
+            pos += TSPacket::SIZE;
+        else
+            resync = true;
+    }
+
+    return size / TSPacket::SIZE;
+}
+
+typedef uint (*ParseFunc)(const QByteArray &ts, MPEGStreamData &sd);
+
+/*
+ * Parses the stream passes times with a fresh MPEGStreamData for the
+ * program, as a recorder sets it up. Returns the time taken in ms.
+ */
+double
+parse(ParseFunc func, const QByteArray &ts, int program,
+      PacketCounter &counter, uint &packets, uint passes)
+{
+    struct timeval start;
+    (void)gettimeofday(&start, NULL);
+
+    packets = 0;
+    for (uint i = 0; i < passes; i++)
+    {
+        counter = PacketCounter();
+
+        MPEGStreamData sd(program, false);
+        sd.AddAVListener(&counter);
+        sd.AddWritingListener(&counter);
+        packets += func(ts, sd);
+        sd.RemoveWritingListener(&counter);
+        sd.RemoveAVListener(&counter);
+    }
+
+    return elapsed_ms(start);
+}
+
+};  /* namespace */
+
+/* Sets the recording that tsparser_kernel_test() reads. */
+void
+tsparser_set_input(const char *filename)
+{
+    ts_filename = filename;
+}
+
+bool
+tsparser_kernel_test(bool benchmark)
+{
+    if (ts_filename.isEmpty())
+    {
+        cout << "  no recording given with --ts, skipped" << endl;
+        return true;
+    }
+
+    QFile file(ts_filename);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        cerr << "Can't read " << ts_filename.toLocal8Bit().constData()
+             << endl;
+        return false;
+    }
+    QByteArray ts = file.readAll();
+    file.close();
+
+    int program = find_program(ts);
+    if (!program)
+    {
+        cerr << "No program in the PAT of "
+             << ts_filename.toLocal8Bit().constData() << endl;
+        return false;
+    }
+
+    uint passes = benchmark ? kPasses : 1;
+    PacketCounter batched, single;
+    uint batched_packets, single_packets;
+    double batched_ms = parse(parse_chunks, ts, program,
+                              batched, batched_packets, passes);
+    double single_ms  = parse(parse_packets, ts, program,
+                              single, single_packets, passes);
+
+    bool ok = (batched == single);
+    if (!ok)
+    {
+        cerr << "ProcessData() delivered " << batched << endl
+             << "ProcessTSPacket() delivered " << single << endl;
+    }
+
+    if (benchmark)
+    {
+        cout << "  program " << program << ": " << batched << endl
+             << "  " << batched_packets << " packets: ProcessData() "
+             << batched_ms << " ms, "
+             << (batched_ms > 0 ? batched_packets * 1000.0 / batched_ms : 0)
+             << " packets/s" << endl
+             << "  " << single_packets << " packets: ProcessTSPacket() "
+             << single_ms << " ms, "
+             << (single_ms > 0 ? single_packets * 1000.0 / single_ms : 0)
+             << " packets/s" << endl;
+    }
+
+    return ok;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
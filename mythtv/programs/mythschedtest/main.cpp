@@ -0,0 +1,422 @@
+/*
+ * mythschedtest
+ *
+ * Runs the scheduler offline against a scratch database, reports the
+ * time taken by each phase and checks that rescheduling single rules
+ * incrementally gives the same schedule as a full pass.
+ */
+
+// POSIX headers
+#include <sys/time.h>
+
+// C++ headers
+#include <algorithm>
+#include <iostream>
+using namespace std;
+
+// Qt headers
+#include <QCoreApplication>
+#include <QStringList>
+#include <QString>
+#include <QMap>
+
+// MythTV headers
+#include "mythcontext.h"
+#include "mythcorecontext.h"
+#include "mythverbose.h"
+#include "mythversion.h"
+#include "mythdbcon.h"
+#include "mythdb.h"
+#include "exitcodes.h"
+#include "dbcheck.h"
+#include "tv.h"
+
+// mythbackend headers
+#include "scheduler.h"
+#include "encoderlink.h"
+
+#include "snapshot.h"
+
+namespace {
+
+/// Reported schedule differences per check
+const uint kMaxDifferences = 5;
+
+/*
+ * Rule changes the check makes, each is undone by applying it again.
+ */
+const char *kRuleChanges[] =
+{
+    "UPDATE record SET recpriority = -recpriority - 1 "
+    "WHERE recordid = :RECORDID",
+    "UPDATE record SET inactive = NOT inactive "
+    "WHERE recordid = :RECORDID",
+    "UPDATE record SET dupin = dupin ^ 16 "
+    "WHERE recordid = :RECORDID",
+};
+
+void
+print_usage(void)
+{
+    cerr << "Usage: mythschedtest [options]" << endl
+         << "Schedules the recording rules of the configured database "
+            "offline, times the" << endl
+         << "phases of the scheduler and compares incremental passes "
+            "with full ones." << endl << endl
+         << "Options:" << endl
+         << "  --load <file>       Replace the tables in a mysqldump "
+            "snapshot and move its" << endl
+         << "                      listings to the current week" << endl
+         << "  --synthetic         Replace the scheduling tables with "
+            "generated ones" << endl
+         << "  --channels <n>      Synthetic channels (default 100)" << endl
+         << "  --days <n>          Synthetic days of listings "
+            "(default 14)" << endl
+         << "  --rules <n>         Synthetic recording rules "
+            "(default 200)" << endl
+         << "  --cards <n>         Synthetic tuners (default 4)" << endl
+         << "  --check <n>         Rules to reschedule incrementally "
+            "(default 10)" << endl
+         << "  --print             Print the final schedule" << endl
+         << "  -v, --verbose <m>   Verbose output mask" << endl << endl
+         << "--load and --synthetic overwrite the database, point "
+            "MYTHCONFDIR at the" << endl
+         << "settings of a scratch database. Only then the check also "
+            "changes each rule" << endl
+         << "and back, otherwise it reschedules them unchanged." << endl
+         << endl
+         << "A snapshot of a real setup is made with:" << endl
+         << "  mysqldump mythconverg videosource capturecard cardinput "
+            "channel program \\" << endl
+         << "      programgenres programrating record oldrecorded "
+            "recorded > snapshot.sql" << endl;
+}
+
+/*
+ * Returns one line per scheduled showing, with everything the
+ * scheduler decided about it.
+ */
+QStringList
+get_schedule(Scheduler &sched)
+{
+    QStringList schedule;
+    RecList     reclist;
+
+    sched.getAllPending(&reclist);
+    while (!reclist.empty())
+    {
+        RecordingInfo *p = reclist.front();
+        schedule.push_back(
+            QString("%1 %2 \"%3\" rule %4 card %5 input %6 status %7 "
+                    "priority %8")
+            .arg(p->GetChanID())
+            .arg(p->GetScheduledStartTime(ISODate))
+            .arg(p->GetTitle())
+            .arg(p->GetRecordingRuleID())
+            .arg(p->GetCardID())
+            .arg(p->GetInputID())
+            .arg(toString(p->GetRecordingStatus(), p->GetRecordingRuleType()))
+            .arg(p->GetRecordingPriority()));
+        delete p;
+        reclist.pop_front();
+    }
+
+    return schedule;
+}
+
+bool
+compare_schedules(const QStringList &incremental, const QStringList &full,
+                  int recordid)
+{
+    if (incremental == full)
+        return true;
+
+    cerr << "Rule " << recordid << ": incremental schedule has "
+         << incremental.size() << " entries, full schedule "
+         << full.size() << endl;
+
+    uint shown = 0;
+    for (int i = 0; i < incremental.size() && shown < kMaxDifferences; i++)
+    {
+        if (!full.contains(incremental[i]))
+        {
+            cerr << "  incremental only: "
+                 << incremental[i].toLocal8Bit().constData() << endl;
+            shown++;
+        }
+    }
+    for (int i = 0; i < full.size() && shown < kMaxDifferences; i++)
+    {
+        if (!incremental.contains(full[i]))
+        {
+            cerr << "  full only:        "
+                 << full[i].toLocal8Bit().constData() << endl;
+            shown++;
+        }
+    }
+
+    return false;
+}
+
+double
+elapsed_ms(const struct timeval &start)
+{
+    struct timeval now;
+    (void)gettimeofday(&now, NULL);
+    return (now.tv_sec - start.tv_sec) * 1000.0 +
+        (now.tv_usec - start.tv_usec) / 1000.0;
+}
+
+bool
+change_rule(int recordid, uint change)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare(kRuleChanges[change]);
+    query.bindValue(":RECORDID", recordid);
+    if (!query.exec())
+    {
+        MythDB::DBError("mythschedtest", query);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * PrintList() and PrintPhaseTimes() only print with VB_SCHEDULE,
+ * which would also log every phase of every pass.
+ */
+void
+print_phase_times(Scheduler &sched, const char *title)
+{
+    unsigned int mask = print_verbose_messages;
+    print_verbose_messages |= VB_SCHEDULE;
+    cout << title << endl;
+    sched.PrintPhaseTimes();
+    print_verbose_messages = mask;
+}
+
+/*
+ * Reschedules each rule incrementally, once as it is and, if modify is
+ * set, once changed and once changed back, and compares the result with
+ * that of a full pass each time.
+ */
+bool
+check_incremental(Scheduler &sched, const QList<int> &recordids,
+                  bool modify, double &inc_ms, double &full_ms,
+                  uint &passes)
+{
+    bool ok = true;
+
+    for (int i = 0; i < recordids.size(); i++)
+    {
+        int  recordid = recordids[i];
+        uint steps    = modify ? 3 : 1;
+        uint change   = i % (sizeof(kRuleChanges) / sizeof(char*));
+
+        for (uint step = 0; step < steps; step++)
+        {
+            if (step && !change_rule(recordid, change))
+                return false;
+
+            struct timeval start;
+            (void)gettimeofday(&start, NULL);
+            sched.TestReschedule(recordid);
+            inc_ms += elapsed_ms(start);
+
+            if (!passes)
+                print_phase_times(sched, "First incremental pass:");
+
+            QStringList incremental = get_schedule(sched);
+
+            (void)gettimeofday(&start, NULL);
+            sched.TestReschedule(-1);
+            full_ms += elapsed_ms(start);
+            passes++;
+
+            ok &= compare_schedules(incremental, get_schedule(sched),
+                                    recordid);
+        }
+    }
+
+    return ok;
+}
+
+};  /* namespace */
+
+int
+main(int argc, char **argv)
+{
+    QCoreApplication a(argc, argv);
+
+    QString         load_file;
+    bool            synthetic = false;
+    SyntheticSize   size;
+    uint            check = 10;
+    bool            print = false;
+
+    print_verbose_messages = VB_IMPORTANT;
+
+    for (int argpos = 1; argpos < a.argc(); argpos++)
+    {
+        QString arg(a.argv()[argpos]);
+        bool    has_value = (argpos + 1 < a.argc());
+        QString value = has_value ? QString(a.argv()[argpos + 1]) : QString();
+        bool    number_ok;
+        uint    number = value.toUInt(&number_ok);
+
+        if (arg == "-h" || arg == "--help")
+        {
+            print_usage();
+            return GENERIC_EXIT_OK;
+        }
+        else if (arg == "--synthetic")
+            synthetic = true;
+        else if (arg == "--print")
+            print = true;
+        else if (arg == "--load" && has_value)
+        {
+            load_file = value;
+            argpos++;
+        }
+        else if ((arg == "-v" || arg == "--verbose") && has_value)
+        {
+            if (parse_verbose_arg(value) == GENERIC_EXIT_INVALID_CMDLINE)
+                return GENERIC_EXIT_INVALID_CMDLINE;
+            argpos++;
+        }
+        else if (number_ok && number &&
+                 (arg == "--channels" || arg == "--days" ||
+                  arg == "--rules" || arg == "--cards"))
+        {
+            if (arg == "--channels")
+                size.channels = number;
+            else if (arg == "--days")
+                size.days = number;
+            else if (arg == "--rules")
+                size.rules = number;
+            else
+                size.cards = number;
+            argpos++;
+        }
+        else if (arg == "--check" && number_ok)
+        {
+            check = number;
+            argpos++;
+        }
+        else
+        {
+            cerr << "Invalid argument: " << a.argv()[argpos] << endl;
+            print_usage();
+            return GENERIC_EXIT_INVALID_CMDLINE;
+        }
+    }
+
+    if (synthetic && !load_file.isEmpty())
+    {
+        cerr << "Use either --load or --synthetic" << endl;
+        return GENERIC_EXIT_INVALID_CMDLINE;
+    }
+
+    gContext = new MythContext(MYTH_BINARY_VERSION);
+    if (!gContext->Init(false))
+    {
+        VERBOSE(VB_IMPORTANT, "Failed to init MythContext.");
+        return GENERIC_EXIT_NO_MYTHCONTEXT;
+    }
+
+    if (!UpgradeTVDatabaseSchema(true, true))
+    {
+        VERBOSE(VB_IMPORTANT, "Couldn't upgrade database to new schema");
+        return GENERIC_EXIT_DB_OUTOFDATE;
+    }
+
+    if (!load_file.isEmpty() && (!LoadSnapshot(load_file) || !ShiftSnapshot()))
+        return GENERIC_EXIT_DB_ERROR;
+    if (synthetic && !CreateSyntheticSnapshot(size))
+        return GENERIC_EXIT_DB_ERROR;
+
+    // Every tuner counts as available, and none is recording
+    QMap<int, EncoderLink *> tvList;
+    QList<int> recordids;
+    {
+        MSqlQuery query(MSqlQuery::InitCon());
+        if (!query.exec("SELECT cardid, hostname FROM capturecard"))
+        {
+            MythDB::DBError("mythschedtest", query);
+            return GENERIC_EXIT_DB_ERROR;
+        }
+        while (query.next())
+        {
+            int cardid = query.value(0).toInt();
+            tvList[cardid] = new EncoderLink(cardid, NULL,
+                                             query.value(1).toString());
+            tvList[cardid]->SetSleepStatus(sStatus_Asleep);
+        }
+
+        if (!query.exec("SELECT recordid FROM record ORDER BY recordid"))
+        {
+            MythDB::DBError("mythschedtest", query);
+            return GENERIC_EXIT_DB_ERROR;
+        }
+        QList<int> all;
+        while (query.next())
+            all.push_back(query.value(0).toInt());
+
+        // Spread the checked rules over all of them
+        uint count = min(check, (uint)all.size());
+        for (uint i = 0; i < count; i++)
+            recordids.push_back(all[i * all.size() / count]);
+    }
+
+    int ret = GENERIC_EXIT_OK;
+    {
+        Scheduler sched(false, &tvList);
+        if (sched.GetError())
+            return sched.GetError();
+
+        struct timeval start;
+        (void)gettimeofday(&start, NULL);
+        sched.TestReschedule(-1);
+        double first_ms = elapsed_ms(start);
+
+        QStringList schedule = get_schedule(sched);
+        cout << "Scheduled " << schedule.size() << " showings in "
+             << first_ms << " ms" << endl;
+        print_phase_times(sched, "First full pass:");
+
+        double inc_ms = 0.0, full_ms = 0.0;
+        uint   passes = 0;
+        bool   modify = synthetic || !load_file.isEmpty();
+        if (!check_incremental(sched, recordids, modify,
+                               inc_ms, full_ms, passes))
+        {
+            ret = GENERIC_EXIT_NOT_OK;
+        }
+
+        if (passes)
+        {
+            cout << passes << " passes: incremental "
+                 << inc_ms / passes << " ms, full "
+                 << full_ms / passes << " ms on average" << endl;
+        }
+        cout << "incremental: " << ((ret == GENERIC_EXIT_OK) ? "ok" : "FAILED")
+             << endl;
+
+        if (print)
+        {
+            print_verbose_messages |= VB_SCHEDULE;
+            sched.PrintList(true);
+        }
+    }
+
+    QMap<int, EncoderLink *>::iterator it = tvList.begin();
+    for (; it != tvList.end(); ++it)
+        delete *it;
+
+    delete gContext;
+    gContext = NULL;
+
+    return ret;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
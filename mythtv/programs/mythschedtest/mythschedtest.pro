@@ -0,0 +1,48 @@
+include ( ../../settings.pro )
+include ( ../../version.pro )
+include ( ../programs-libs.pro )
+
+QT += network xml sql
+
+TEMPLATE = app
+CONFIG += thread
+TARGET = mythschedtest
+target.path = $${PREFIX}/bin
+INSTALLS = target
+
+QMAKE_CLEAN += $(TARGET)
+
+# Input
+HEADERS += snapshot.h
+
+SOURCES += main.cpp snapshot.cpp
+
+# The scheduler and what it links against, built from the mythbackend
+# sources without their main()
+INCLUDEPATH += ../mythbackend
+
+HEADERS += ../mythbackend/autoexpire.h ../mythbackend/encoderlink.h
+HEADERS += ../mythbackend/filetransfer.h ../mythbackend/httpstatus.h
+HEADERS += ../mythbackend/mainserver.h ../mythbackend/playbacksock.h
+HEADERS += ../mythbackend/scheduler.h ../mythbackend/server.h
+HEADERS += ../mythbackend/housekeeper.h ../mythbackend/backendutil.h
+HEADERS += ../mythbackend/upnpcdstv.h ../mythbackend/upnpcdsmusic.h
+HEADERS += ../mythbackend/upnpcdsvideo.h ../mythbackend/mediaserver.h
+HEADERS += ../mythbackend/mythxml.h ../mythbackend/upnpmedia.h
+HEADERS += ../mythbackend/backendcontext.h
+HEADERS += ../mythbackend/recordingcatalog.h
+
+SOURCES += ../mythbackend/autoexpire.cpp ../mythbackend/encoderlink.cpp
+SOURCES += ../mythbackend/filetransfer.cpp ../mythbackend/httpstatus.cpp
+SOURCES += ../mythbackend/mainserver.cpp ../mythbackend/playbacksock.cpp
+SOURCES += ../mythbackend/scheduler.cpp ../mythbackend/server.cpp
+SOURCES += ../mythbackend/housekeeper.cpp ../mythbackend/backendutil.cpp
+SOURCES += ../mythbackend/upnpcdstv.cpp ../mythbackend/upnpcdsmusic.cpp
+SOURCES += ../mythbackend/upnpcdsvideo.cpp ../mythbackend/mediaserver.cpp
+SOURCES += ../mythbackend/mythxml.cpp ../mythbackend/upnpmedia.cpp
+SOURCES += ../mythbackend/backendcontext.cpp
+SOURCES += ../mythbackend/recordingcatalog.cpp
+
+using_oss:DEFINES += USING_OSS
+
+using_dvb:DEFINES += USING_DVB
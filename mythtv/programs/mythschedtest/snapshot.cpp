@@ -0,0 +1,394 @@
+// ANSI C headers
+#include <cstdlib>
+
+// C++ headers
+#include <vector>
+using namespace std;
+
+// Qt headers
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+#include <QDateTime>
+
+// MythTV headers
+#include "mythcorecontext.h"
+#include "mythverbose.h"
+#include "mythdbcon.h"
+#include "mythdb.h"
+#include "recordingtypes.h"
+#include "programtypes.h"
+
+#include "snapshot.h"
+
+#define LOC      QString("Snapshot: ")
+#define LOC_ERR  QString("Snapshot, Error: ")
+
+namespace {
+
+/// Rows per INSERT statement of the generated data
+const uint kRowsPerInsert = 500;
+
+/// Series of its own each synthetic channel shows
+const uint kSeriesPerChannel = 6;
+
+/// Tables CreateSyntheticSnapshot() replaces
+const char *kSyntheticTables[] =
+{
+    "videosource", "capturecard", "cardinput", "channel", "program",
+    "programgenres", "programrating", "record", "recordmatch",
+    "oldrecorded", "recorded",
+};
+
+/// Rule types of the synthetic rules, in turn
+const RecordingType kRuleTypes[] =
+{
+    kAllRecord, kChannelRecord, kFindOneRecord, kTimeslotRecord,
+    kAllRecord, kWeekslotRecord, kChannelRecord, kFindDailyRecord,
+};
+
+bool
+exec_query(MSqlQuery &query, const QString &sql)
+{
+    if (query.exec(sql))
+        return true;
+
+    MythDB::DBError("mythschedtest", query);
+    return false;
+}
+
+QString
+sql_time(const QDateTime &dt)
+{
+    return "'" + dt.toString("yyyy-MM-dd hh:mm:ss") + "'";
+}
+
+/*
+ * Collects the rows of a multi-row INSERT, which is run every
+ * kRowsPerInsert rows and by Flush().
+ */
+class BulkInsert
+{
+  public:
+    BulkInsert(MSqlQuery &query, const QString &head) :
+        m_query(query), m_head(head), m_ok(true) {}
+
+    void Add(const QString &row)
+    {
+        m_rows.push_back(row);
+        if ((uint)m_rows.size() >= kRowsPerInsert)
+            Flush();
+    }
+
+    bool Flush(void)
+    {
+        if (!m_rows.empty())
+        {
+            m_ok &= exec_query(m_query, m_head + m_rows.join(","));
+            m_rows.clear();
+        }
+        return m_ok;
+    }
+
+  private:
+    MSqlQuery   &m_query;
+    QString      m_head;
+    QStringList  m_rows;
+    bool         m_ok;
+};
+
+/* The first showing of a series, the slot and channel rules match it. */
+struct FirstShowing
+{
+    FirstShowing() : channel(0), length(0) {}
+
+    uint        channel;
+    QDateTime   start;
+    uint        length;
+};
+
+};  /* namespace */
+
+/** \fn LoadSnapshot(const QString&)
+ *  \brief Runs the statements of a mysqldump file, replacing the
+ *         tables it contains.
+ */
+bool LoadSnapshot(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        VERBOSE(VB_IMPORTANT, LOC_ERR +
+                QString("Unable to open '%1'").arg(filename));
+        return false;
+    }
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+
+    // mysqldump ends every statement at the end of a line, and escapes
+    // the line breaks in the data
+    QString statement;
+    uint count = 0;
+    while (!stream.atEnd())
+    {
+        QString line = stream.readLine();
+        if (statement.isEmpty() && (line.isEmpty() || line.startsWith("--")))
+            continue;
+
+        statement += line + "\n";
+        if (!line.trimmed().endsWith(";"))
+            continue;
+
+        if (!exec_query(query, statement))
+            return false;
+
+        statement.clear();
+        count++;
+    }
+
+    VERBOSE(VB_GENERAL, LOC + QString("Ran %1 statements from '%2'")
+            .arg(count).arg(filename));
+
+    return true;
+}
+
+/** \fn ShiftSnapshot(void)
+ *  \brief Moves the listings, rules and history of a snapshot forward
+ *         by whole weeks, so that the listings start this week.
+ *
+ *   Whole weeks keep the day of the week and the time of day the slot
+ *   rules match.
+ */
+bool ShiftSnapshot(void)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+    if (!exec_query(query, "SELECT TO_DAYS(CURDATE()) - "
+                    "TO_DAYS(MIN(starttime)) FROM program") ||
+        !query.next())
+    {
+        return false;
+    }
+
+    int days = query.value(0).toInt();
+    if (days <= 0)
+        return true;
+    days = (days + 6) / 7 * 7;
+
+    // Latest first, the keys include the start time
+    static const char *updates[] =
+    {
+        "UPDATE program SET starttime = starttime + INTERVAL %1 DAY, "
+        "endtime = endtime + INTERVAL %1 DAY ORDER BY starttime DESC",
+        "UPDATE programgenres SET starttime = starttime + INTERVAL %1 DAY "
+        "ORDER BY starttime DESC",
+        "UPDATE programrating SET starttime = starttime + INTERVAL %1 DAY "
+        "ORDER BY starttime DESC",
+        "UPDATE oldrecorded SET starttime = starttime + INTERVAL %1 DAY, "
+        "endtime = endtime + INTERVAL %1 DAY ORDER BY starttime DESC",
+        "UPDATE record SET startdate = startdate + INTERVAL %1 DAY, "
+        "enddate = enddate + INTERVAL %1 DAY",
+        "UPDATE record SET findid = findid + %1 WHERE findid > 0",
+        "UPDATE oldrecorded SET findid = findid + %1 WHERE findid > 0",
+        "UPDATE recorded SET findid = findid + %1 WHERE findid > 0",
+    };
+
+    for (uint i = 0; i < sizeof(updates) / sizeof(char*); i++)
+    {
+        if (!exec_query(query, QString(updates[i]).arg(days)))
+            return false;
+    }
+
+    VERBOSE(VB_GENERAL, LOC + QString("Moved the snapshot %1 days forward")
+            .arg(days));
+
+    return true;
+}
+
+/** \fn CreateSyntheticSnapshot(const SyntheticSize&)
+ *  \brief Replaces the scheduling tables with generated listings,
+ *         rules and history of the given size.
+ *
+ *   The listings start at midnight today. Each channel shows a few
+ *   series of its own, and every fourth showing is an episode of any
+ *   series shown again, so that the rules have both conflicts and
+ *   other showings to resolve them with. Apart from the dates the data
+ *   only depends on the size.
+ */
+bool CreateSyntheticSnapshot(const SyntheticSize &size)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+
+    for (uint i = 0; i < sizeof(kSyntheticTables) / sizeof(char*); i++)
+    {
+        if (!exec_query(query, QString("DELETE FROM %1")
+                        .arg(kSyntheticTables[i])))
+        {
+            return false;
+        }
+    }
+
+    srandom(1);
+
+    if (!exec_query(query, "INSERT INTO videosource (sourceid, name) "
+                    "VALUES (1, 'mythschedtest')"))
+    {
+        return false;
+    }
+
+    for (uint card = 1; card <= size.cards; card++)
+    {
+        query.prepare("INSERT INTO capturecard "
+                      "    (cardid, videodevice, cardtype, hostname) "
+                      "VALUES (:CARDID, :DEVICE, 'MPEG', :HOSTNAME)");
+        query.bindValue(":CARDID",   card);
+        query.bindValue(":DEVICE",   QString("/dev/video%1").arg(card - 1));
+        query.bindValue(":HOSTNAME", gCoreContext->GetHostName());
+        if (!query.exec())
+        {
+            MythDB::DBError("CreateSyntheticSnapshot", query);
+            return false;
+        }
+
+        query.prepare("INSERT INTO cardinput "
+                      "    (cardid, sourceid, inputname, displayname) "
+                      "VALUES (:CARDID, 1, 'Television', :NAME)");
+        query.bindValue(":CARDID", card);
+        query.bindValue(":NAME",   QString("Tuner %1").arg(card));
+        if (!query.exec())
+        {
+            MythDB::DBError("CreateSyntheticSnapshot", query);
+            return false;
+        }
+    }
+
+    BulkInsert channels(query,
+        "INSERT INTO channel (chanid, channum, sourceid, callsign, name, "
+        "    xmltvid, last_record) VALUES ");
+    for (uint chan = 1; chan <= size.channels; chan++)
+    {
+        channels.Add(QString("(%1,'%2',1,'SYN%2','Synthetic %2',"
+                             "'syn%2.mythschedtest',NOW())")
+                     .arg(1000 + chan).arg(chan));
+    }
+    if (!channels.Flush())
+        return false;
+
+    BulkInsert programs(query,
+        "INSERT INTO program (chanid, starttime, endtime, title, subtitle, "
+        "    description, category, category_type, previouslyshown, "
+        "    seriesid, programid, audioprop, subtitletypes, videoprop) "
+        "VALUES ");
+    BulkInsert history(query,
+        "INSERT INTO oldrecorded (chanid, starttime, endtime, title, "
+        "    subtitle, description, seriesid, programid, station, "
+        "    duplicate, recstatus) VALUES ");
+
+    uint                    nseries = size.channels * kSeriesPerChannel;
+    vector<uint>            episodes(nseries, 0);
+    vector<FirstShowing>    first(nseries);
+    QDateTime               start(QDate::currentDate());
+    QDateTime               end = start.addDays(size.days);
+
+    for (uint chan = 1; chan <= size.channels; chan++)
+    {
+        for (QDateTime t = start; t < end;)
+        {
+            uint length  = 30 * (1 + random() % 3);
+            uint series  = (chan - 1) * kSeriesPerChannel +
+                random() % kSeriesPerChannel;
+            bool repeat  = (random() % 4 == 0);
+            if (repeat)
+                series = random() % nseries;
+
+            uint episode;
+            if (repeat && episodes[series])
+                episode = 1 + random() % episodes[series];
+            else
+            {
+                episode = ++episodes[series];
+                repeat  = false;
+            }
+
+            if (!first[series].channel)
+            {
+                first[series].channel = chan;
+                first[series].start   = t;
+                first[series].length  = length;
+            }
+
+            QDateTime t_end = t.addSecs(length * 60);
+            QString   id    = QString("%1").arg(series, 6, 10, QChar('0'));
+            QString   ep    = QString("%1").arg(episode, 4, 10, QChar('0'));
+
+            programs.Add(
+                QString("(%1,%2,%3,'Series %4','Episode %5','','synthetic',"
+                        "'series',%6,'EP%7','EP%7%8','','','')")
+                .arg(1000 + chan).arg(sql_time(t)).arg(sql_time(t_end))
+                .arg(series).arg(episode).arg(repeat ? 1 : 0)
+                .arg(id).arg(ep));
+
+            // Some first showings were recorded before, as a rerun
+            if (!repeat && random() % 8 == 0)
+            {
+                history.Add(
+                    QString("(%1,%2,%3,'Series %4','Episode %5','',"
+                            "'EP%6','EP%6%7','SYN%8',1,%9)")
+                    .arg(1000 + chan).arg(sql_time(t.addDays(-28)))
+                    .arg(sql_time(t_end.addDays(-28)))
+                    .arg(series).arg(episode).arg(id).arg(ep)
+                    .arg(chan).arg(rsRecorded));
+            }
+
+            t = t_end;
+        }
+    }
+    if (!programs.Flush() || !history.Flush())
+        return false;
+
+    BulkInsert rules(query,
+        "INSERT INTO record (recordid, type, chanid, starttime, startdate, "
+        "    endtime, enddate, title, description, station, recpriority, "
+        "    dupmethod, maxepisodes, seriesid, findday, findtime, "
+        "    next_record, last_record, last_delete) VALUES ");
+    const uint kNumRuleTypes = sizeof(kRuleTypes) / sizeof(RecordingType);
+    for (uint rule = 1; rule <= size.rules; rule++)
+    {
+        uint series = random() % nseries;
+        while (!first[series].channel)
+            series = (series + 1) % nseries;
+
+        const FirstShowing &f = first[series];
+        QDateTime f_end = f.start.addSecs(f.length * 60);
+
+        rules.Add(
+            QString("(%1,%2,%3,'%4','%5','%6','%7','Series %8','','SYN%9',")
+            .arg(rule).arg(kRuleTypes[rule % kNumRuleTypes])
+            .arg(1000 + f.channel)
+            .arg(f.start.toString("hh:mm:ss"))
+            .arg(f.start.toString("yyyy-MM-dd"))
+            .arg(f_end.toString("hh:mm:ss"))
+            .arg(f_end.toString("yyyy-MM-dd"))
+            .arg(series).arg(f.channel) +
+            QString("%1,%2,%3,'EP%4',%5,'%6',%7,%7,%7)")
+            .arg((int)(random() % 5) - 2)
+            .arg((random() % 4 == 0) ? kDupCheckNone : kDupCheckSubDesc)
+            .arg((random() % 10 == 0) ? 5 : 0)
+            .arg(series, 6, 10, QChar('0'))
+            .arg((f.start.date().dayOfWeek() + 1) % 7)
+            .arg(f.start.toString("hh:mm:ss"))
+            .arg("'0000-00-00 00:00:00'"));
+    }
+    if (!rules.Flush())
+        return false;
+
+    VERBOSE(VB_GENERAL, LOC + QString("Created %1 channels, %2 days of "
+            "listings, %3 rules and %4 tuners")
+            .arg(size.channels).arg(size.days).arg(size.rules)
+            .arg(size.cards));
+
+    return true;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,29 @@
+/*
+ * snapshot.h
+ *
+ * Fills the scheduling tables of a scratch database for mythschedtest,
+ * either from a mysqldump of a real setup or with generated listings.
+ */
+
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include <QString>
+
+struct SyntheticSize
+{
+    SyntheticSize() : channels(100), days(14), rules(200), cards(4) {}
+
+    unsigned int channels;
+    unsigned int days;
+    unsigned int rules;
+    unsigned int cards;
+};
+
+bool LoadSnapshot(const QString &filename);
+bool ShiftSnapshot(void);
+bool CreateSyntheticSnapshot(const SyntheticSize &size);
+
+#endif  /* !__SNAPSHOT_H__ */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
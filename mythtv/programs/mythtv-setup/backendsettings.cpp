@@ -139,6 +139,18 @@ static HostCheckBox *TruncateDeletes()
     return hc;
 };
 
+static HostCheckBox *BackendZeroCopyStreaming()
+{
+    HostCheckBox *hc = new HostCheckBox("BackendZeroCopyStreaming");
+    hc->setLabel(QObject::tr("Zero-copy file streaming"));
+    hc->setValue(true);
+    hc->setHelpText(QObject::tr("If enabled, recordings and videos streamed "
+                    "to frontends are sent directly from the page cache to "
+                    "the network by the kernel, which lowers the backend's "
+                    "CPU use. Only used on platforms that support it."));
+    return hc;
+};
+
 static GlobalCheckBox *DeletesFollowLinks()
 {
     GlobalCheckBox *gc = new GlobalCheckBox("DeletesFollowLinks");
@@ -150,6 +162,20 @@ static GlobalCheckBox *DeletesFollowLinks()
     return gc;
 };
 
+static GlobalCheckBox *SeekTableBlobStorage()
+{
+    GlobalCheckBox *gc = new GlobalCheckBox("SeekTableBlobStorage");
+    gc->setLabel(QObject::tr("Compact seek tables"));
+    gc->setValue(false);
+    gc->setHelpText(QObject::tr("If enabled, the seek table of a new "
+                    "recording is stored as a single compact database "
+                    "entry instead of one row per keyframe. This makes "
+                    "the database much smaller and playback start faster, "
+                    "but the seek table is not visible to tools which read "
+                    "the recordedseek table directly."));
+    return gc;
+};
+
 static GlobalSpinBox *HDRingbufferSize()
 {
     GlobalSpinBox *bs = new GlobalSpinBox(
@@ -1007,6 +1033,8 @@ BackendSettings::BackendSettings() {
     fmh1->addChild(DeletesFollowLinks());
     fmh1->addChild(TruncateDeletes());
     fm->addChild(fmh1);
+    fm->addChild(BackendZeroCopyStreaming());
+    fm->addChild(SeekTableBlobStorage());
     fm->addChild(HDRingbufferSize());
     fm->addChild(StorageScheduler());
     group2->addChild(fm);
@@ -7,12 +7,13 @@ using_frontend {
     SUBDIRS += mythavtest mythfrontend mythcommflag
     SUBDIRS += mythtvosd mythjobqueue mythlcdserver
     SUBDIRS += mythwelcome mythshutdown
-    SUBDIRS += mythpreviewgen
+    SUBDIRS += mythpreviewgen mythkerneltest
     !mingw: SUBDIRS += mythtranscode/replex
 }
 
 using_backend {
     SUBDIRS += mythbackend mythfilldatabase mythtv-setup scripts
+    SUBDIRS += mythschedtest
 }
 
 using_mythtranscode: SUBDIRS += mythtranscode
@@ -1657,7 +1657,8 @@ EOF
                                            'recordedmarkup',
                                            'recordedprogram',
                                            'recordedrating',
-                                           'recordedseek');
+                                           'recordedseek',
+                                           'recordedseekblob');
             }
             if (!defined($restore_xmltvids))
             {